@@ -597,3 +597,19 @@ struct FVoxelState
 		}
 	}
 };
+
+FORCEINLINE uint32 GetTypeHash(const FVoxelState& State)
+{
+	uint32 Hash = GetTypeHash(State.Version);
+	Hash = HashCombine(Hash, GetTypeHash(State.FaceOneDirection));
+	Hash = HashCombine(Hash, GetTypeHash(State.Rotation));
+	Hash = HashCombine(Hash, GetTypeHash(State.AtlasOverride));
+	Hash = HashCombine(Hash, GetTypeHash(State.bIsVLO));
+
+	for (const FPlacedObjectState& Object : State.GameObjects)
+	{
+		Hash = HashCombine(Hash, GetTypeHash(Object));
+	}
+
+	return Hash;
+}
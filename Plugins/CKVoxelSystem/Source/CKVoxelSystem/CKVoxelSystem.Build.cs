@@ -40,7 +40,8 @@ public class CKVoxelSystem : ModuleRules
 				"Slate",
 				"SlateCore",
 				"CKSharedTypes",
-				"Skelot"
+				"Skelot",
+				"HTTPServer"
 			}
 			);
 		
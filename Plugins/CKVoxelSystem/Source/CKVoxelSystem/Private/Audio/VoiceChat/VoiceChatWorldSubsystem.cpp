@@ -1,6 +1,8 @@
 ﻿// Fill out your copyright notice in the Description page of Project Settings.
 #include "Audio/VoiceChat/VoiceChatWorldSubsystem.h"
 #include "Engine/Engine.h"
+#include "Shared/Types/Core/GameSessionSubsystem.h"
+#include "Network/Services/Communication/VoiceChatServiceSubsystem.h"
 
 DEFINE_LOG_CATEGORY(LogVoiceChat);
 
@@ -18,6 +20,28 @@ void UVoiceChatWorldSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 
 	AudioResampler = nullptr;
 	LastDeviceSampleRate = 0;
+	GameSessionSubsystem = nullptr;
+}
+
+void UVoiceChatWorldSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Game instance subsystems are not guaranteed to exist yet in Initialize
+	UGameInstance* GameInstance = InWorld.GetGameInstance();
+	if (!GameInstance)
+	{
+		return;
+	}
+
+	// Without it the listener chunk would stay at the origin and far speakers would never be heard
+	GameSessionSubsystem = GameInstance->GetSubsystem<UGameSessionSubsystem>();
+
+	// The service gates incoming speakers on our hearing range and frees decoders of timed out streams
+	if (UVoiceChatServiceSubsystem* VoiceService = GameInstance->GetSubsystem<UVoiceChatServiceSubsystem>())
+	{
+		VoiceService->SetVoiceChatManager(this);
+	}
 }
 
 void UVoiceChatWorldSubsystem::Deinitialize()
@@ -25,6 +49,13 @@ void UVoiceChatWorldSubsystem::Deinitialize()
 	// Clean up resources
 	StopVoiceChat();
 
+	UGameInstance* GameInstance = GetWorld() ? GetWorld()->GetGameInstance() : nullptr;
+	UVoiceChatServiceSubsystem* VoiceService = GameInstance ? GameInstance->GetSubsystem<UVoiceChatServiceSubsystem>() : nullptr;
+	if (VoiceService && VoiceService->GetVoiceChatManager() == this)
+	{
+		VoiceService->SetVoiceChatManager(nullptr);
+	}
+
 	// Delete buffers
 	if (CaptureBuffer)
 	{
@@ -43,6 +74,13 @@ void UVoiceChatWorldSubsystem::Deinitialize()
 		}
 	}
 
+	if (MixdownTrack.AudioComponent)
+	{
+		MixdownTrack.AudioComponent->Stop();
+		MixdownTrack.AudioComponent->DestroyComponent();
+		MixdownTrack.AudioComponent = nullptr;
+	}
+
 	if (AudioResampler)
 	{
 		src_delete(AudioResampler);
@@ -67,6 +105,8 @@ void UVoiceChatWorldSubsystem::PostSubsystemInit()
 		this, &UVoiceChatWorldSubsystem::HandleAudioDeviceDisconnection);
 
 	RootActor = GetWorld()->GetFirstPlayerController()->GetPawn();
+
+	GameSessionSubsystem = GetWorld()->GetGameInstance()->GetSubsystem<UGameSessionSubsystem>();
 }
 
 TStatId UVoiceChatWorldSubsystem::GetStatId() const
@@ -76,6 +116,12 @@ TStatId UVoiceChatWorldSubsystem::GetStatId() const
 
 void UVoiceChatWorldSubsystem::Tick(const float DeltaTime)
 {
+	// Keep a copy of the listener chunk for the network and playback threads
+	if (GameSessionSubsystem)
+	{
+		FScopeLock Lock(&ListenerLock);
+		ListenerChunkCoordinates = GameSessionSubsystem->GetPlayerCurrentChunkCoordinates();
+	}
 }
 
 void UVoiceChatWorldSubsystem::TickPlayback()
@@ -174,6 +220,14 @@ void UVoiceChatWorldSubsystem::PlayVoiceChat()
 
 	bIsProcessingIncomingAudio = true;
 
+	// Shared stream for every speaker that is not played at full fidelity
+	if (!MixdownTrack.AudioComponent)
+	{
+		FScopeLock Lock(&AudioCriticalSection);
+		CreateTrackPlayback(MixdownTrack, TargetSampleRate);
+		MixdownTrack.bFullFidelity = true;
+	}
+
 	TickPlayback();
 }
 
@@ -382,8 +436,17 @@ void UVoiceChatWorldSubsystem::ManagePlaybackBuffer()
 	// Lock for thread safety
 	FScopeLock Lock(&AudioCriticalSection);
 
+	const double CurrentTime = FPlatformTime::Seconds();
+	if (CurrentTime - LastPriorityUpdateTime >= PriorityUpdateInterval)
+	{
+		UpdateSpeakerPriorities();
+		LastPriorityUpdateTime = CurrentTime;
+	}
+
 	// Process each stream
 	StreamsToProcess.Reset();
+	MixdownBuffer.Reset();
+	NumMixedSpeakers = 0;
 
 	// Build list of streams to process
 	for (auto& StreamPair : SoundStreamMap)
@@ -396,6 +459,107 @@ void UVoiceChatWorldSubsystem::ManagePlaybackBuffer()
 	{
 		ProcessPlayerStream(StreamPair.Value);
 	}
+
+	// Flush the downmixed speakers as a single stream
+	if (NumMixedSpeakers > 0 && MixdownTrack.SoundWave)
+	{
+		// Equal-power scaling keeps a crowd from clipping while a single speaker stays at full level
+		const float MixGain = 1.0f / FMath::Sqrt(static_cast<float>(NumMixedSpeakers));
+		for (float& Sample : MixdownBuffer)
+		{
+			Sample *= MixGain;
+		}
+
+		QueueTrackAudio(MixdownTrack, MixdownBuffer);
+	}
+}
+
+void UVoiceChatWorldSubsystem::UpdateSpeakerPriorities()
+{
+	FInt64Vector ListenerChunk;
+	{
+		FScopeLock Lock(&ListenerLock);
+		ListenerChunk = ListenerChunkCoordinates;
+	}
+
+	// Score every speaker: loud speakers rank higher, distant ones are attenuated
+	TArray<TPair<float, FString>> RankedSpeakers;
+	RankedSpeakers.Reserve(SoundStreamMap.Num());
+
+	for (const auto& StreamPair : SoundStreamMap)
+	{
+		int64 ChunkDistance = 0;
+		if (const FInt64Vector* SpeakerChunk = SpeakerChunks.Find(StreamPair.Key))
+		{
+			const FInt64Vector Delta = *SpeakerChunk - ListenerChunk;
+			ChunkDistance = FMath::Max3(FMath::Abs(Delta.X), FMath::Abs(Delta.Y), FMath::Abs(Delta.Z));
+		}
+
+		const float Score = StreamPair.Value.Loudness / (1.0f + static_cast<float>(ChunkDistance));
+		RankedSpeakers.Emplace(Score, StreamPair.Key);
+	}
+
+	RankedSpeakers.Sort([](const TPair<float, FString>& A, const TPair<float, FString>& B)
+	{
+		return A.Key > B.Key;
+	});
+
+	TArray<FString> Promoted;
+	TArray<FString> Demoted;
+
+	for (int32 Rank = 0; Rank < RankedSpeakers.Num(); ++Rank)
+	{
+		FAudioTrack& Track = SoundStreamMap[RankedSpeakers[Rank].Value];
+		const bool bShouldBeFullFidelity = Rank < MaxFullFidelitySpeakers;
+
+		if (bShouldBeFullFidelity == Track.bFullFidelity)
+		{
+			continue;
+		}
+
+		Track.bFullFidelity = bShouldBeFullFidelity;
+		if (bShouldBeFullFidelity)
+		{
+			Promoted.Add(RankedSpeakers[Rank].Value);
+		}
+		else
+		{
+			Demoted.Add(RankedSpeakers[Rank].Value);
+		}
+	}
+
+	if (Promoted.Num() == 0 && Demoted.Num() == 0)
+	{
+		return;
+	}
+
+	// Audio components can only be created and stopped on the game thread
+	AsyncTask(ENamedThreads::GameThread, [this, Promoted = MoveTemp(Promoted), Demoted = MoveTemp(Demoted)]()
+	{
+		FScopeLock Lock(&AudioCriticalSection);
+
+		for (const FString& PlayerID : Promoted)
+		{
+			FAudioTrack* Track = GetPlayerStream(PlayerID);
+			if (Track && Track->bFullFidelity && !Track->AudioComponent)
+			{
+				CreateTrackPlayback(*Track, TargetSampleRate);
+			}
+		}
+
+		// Keep the objects of demoted speakers so they can be promoted again without reallocating
+		for (const FString& PlayerID : Demoted)
+		{
+			FAudioTrack* Track = GetPlayerStream(PlayerID);
+			if (Track && !Track->bFullFidelity && Track->AudioComponent)
+			{
+				Track->AudioComponent->Stop();
+				Track->SoundWave->ResetAudio();
+			}
+		}
+
+		UE_LOG(LogVoiceChat, Log, TEXT("Voice priorities updated: %d promoted, %d demoted"), Promoted.Num(), Demoted.Num());
+	});
 }
 
 void UVoiceChatWorldSubsystem::HandleIncomingAudio(const TArray<float>& IncomingAudioData, int32 SampleRate,
@@ -423,6 +587,18 @@ void UVoiceChatWorldSubsystem::HandleIncomingAudio(const TArray<float>& Incoming
 		FAudioTrack* PlayerStream = GetPlayerStream(PlayerID);
 		if (PlayerStream && PlayerStream->PlaybackBuffer)
 		{
+			// Track a smoothed RMS level for speaker prioritisation
+			if (IncomingAudioData.Num() > 0)
+			{
+				float SumOfSquares = 0.0f;
+				for (const float Sample : IncomingAudioData)
+				{
+					SumOfSquares += Sample * Sample;
+				}
+				const float RMS = FMath::Sqrt(SumOfSquares / IncomingAudioData.Num());
+				PlayerStream->Loudness = FMath::Lerp(PlayerStream->Loudness, RMS, 0.3f);
+			}
+
 			// Add audio data to the player's buffer
 			const float* AudioData = IncomingAudioData.GetData();
 
@@ -460,27 +636,27 @@ FAudioTrack* UVoiceChatWorldSubsystem::GetPlayerStream(const FString& PlayerID)
 
 void UVoiceChatWorldSubsystem::AddPlayerStream(const FString& PlayerID, uint32 SampleRate)
 {
+	FScopeLock Lock(&AudioCriticalSection);
+
+	if (DoesPlayerStreamExist(PlayerID))
+	{
+		return;
+	}
+
 	// Create a new audio track for this player
 	FAudioTrack NewTrack;
 
-	// Create procedural sound wave
-	NewTrack.SoundWave = NewObject<USoundWaveProcedural>();
-	if (NewTrack.SoundWave)
+	// Give the speaker its own playback objects while there is budget left, otherwise it starts in the mixdown
+	int32 NumFullFidelity = 0;
+	for (const auto& StreamPair : SoundStreamMap)
 	{
-		NewTrack.SoundWave->SetSampleRate(SampleRate);
-		NewTrack.SoundWave->NumChannels = 1;
-		NewTrack.SoundWave->Duration = INDEFINITELY_LOOPING_DURATION;
-		NewTrack.SoundWave->SoundGroup = SOUNDGROUP_Voice;
-		NewTrack.SoundWave->bLooping = false;
+		NumFullFidelity += StreamPair.Value.bFullFidelity ? 1 : 0;
 	}
 
-	// Create audio component for playback
-	NewTrack.AudioComponent = NewObject<UAudioComponent>(RootActor);
-	if (NewTrack.AudioComponent)
+	if (NumFullFidelity < MaxFullFidelitySpeakers)
 	{
-		NewTrack.AudioComponent->SetSound(NewTrack.SoundWave);
-		NewTrack.AudioComponent->bAutoActivate = true;
-		NewTrack.AudioComponent->RegisterComponent();
+		CreateTrackPlayback(NewTrack, SampleRate);
+		NewTrack.bFullFidelity = true;
 	}
 
 	// Create buffer for playback (2 second capacity)
@@ -517,6 +693,7 @@ void UVoiceChatWorldSubsystem::RemovePlayerStream(const FString& PlayerID)
 		// Remove from maps
 		SoundStreamMap.Remove(PlayerID);
 		LastUpdateTimes.Remove(PlayerID);
+		SpeakerChunks.Remove(PlayerID);
 
 		UE_LOG(LogVoiceChat, Log, TEXT("Removed player %s from voice chat"), *PlayerID);
 	}
@@ -524,7 +701,7 @@ void UVoiceChatWorldSubsystem::RemovePlayerStream(const FString& PlayerID)
 
 void UVoiceChatWorldSubsystem::ProcessPlayerStream(FAudioTrack* AudioTrack)
 {
-	if (!AudioTrack || !AudioTrack->PlaybackBuffer || !AudioTrack->SoundWave)
+	if (!AudioTrack || !AudioTrack->PlaybackBuffer)
 	{
 		return;
 	}
@@ -544,33 +721,85 @@ void UVoiceChatWorldSubsystem::ProcessPlayerStream(FAudioTrack* AudioTrack)
 
 		if (AudioTrack->PlaybackBuffer->TryDequeue(AudioChunk, SamplesToRead))
 		{
-			// Convert float [-1.0f, 1.0f] to 16-bit PCM
-			TArray<int16> PCMInt16Data;
-			PCMInt16Data.SetNumUninitialized(AudioChunk.Num());
-
-			for (int32 i = 0; i < AudioChunk.Num(); ++i)
+			if (AudioTrack->bFullFidelity && AudioTrack->SoundWave)
 			{
-				const float ClampedSample = FMath::Clamp(AudioChunk[i], -1.0f, 1.0f);
-				PCMInt16Data[i] = static_cast<int16>(ClampedSample * 32767.0f);
+				QueueTrackAudio(*AudioTrack, AudioChunk);
+				return;
 			}
 
-			// Convert to uint8 buffer for QueueAudio
-			TArray<uint8> PCMData;
-			PCMData.SetNumUninitialized(PCMInt16Data.Num() * sizeof(int16));
-			FMemory::Memcpy(PCMData.GetData(), PCMInt16Data.GetData(), PCMData.Num());
-
-			// Queue to sound wave
-			AudioTrack->SoundWave->QueueAudio(PCMData.GetData(), PCMData.Num());
+			// Sum into the shared mixdown stream
+			if (MixdownBuffer.Num() < AudioChunk.Num())
+			{
+				MixdownBuffer.SetNumZeroed(AudioChunk.Num());
+			}
 
-			// Start playback if not playing
-			if (AudioTrack->AudioComponent && !AudioTrack->AudioComponent->IsPlaying())
+			for (int32 i = 0; i < AudioChunk.Num(); ++i)
 			{
-				AudioTrack->AudioComponent->Play();
+				MixdownBuffer[i] += AudioChunk[i];
 			}
+			NumMixedSpeakers++;
 		}
 	}
 }
 
+void UVoiceChatWorldSubsystem::CreateTrackPlayback(FAudioTrack& AudioTrack, uint32 SampleRate)
+{
+	// Create procedural sound wave
+	AudioTrack.SoundWave = NewObject<USoundWaveProcedural>();
+	if (AudioTrack.SoundWave)
+	{
+		AudioTrack.SoundWave->SetSampleRate(SampleRate);
+		AudioTrack.SoundWave->NumChannels = 1;
+		AudioTrack.SoundWave->Duration = INDEFINITELY_LOOPING_DURATION;
+		AudioTrack.SoundWave->SoundGroup = SOUNDGROUP_Voice;
+		AudioTrack.SoundWave->bLooping = false;
+	}
+
+	// Create audio component for playback
+	AudioTrack.AudioComponent = NewObject<UAudioComponent>(RootActor);
+	if (AudioTrack.AudioComponent)
+	{
+		AudioTrack.AudioComponent->SetSound(AudioTrack.SoundWave);
+		AudioTrack.AudioComponent->bAutoActivate = true;
+		AudioTrack.AudioComponent->RegisterComponent();
+	}
+}
+
+void UVoiceChatWorldSubsystem::QueueTrackAudio(FAudioTrack& AudioTrack, const TArray<float>& AudioChunk)
+{
+	// Convert float [-1.0f, 1.0f] to 16-bit PCM
+	TArray<int16> PCMInt16Data;
+	PCMInt16Data.SetNumUninitialized(AudioChunk.Num());
+
+	for (int32 i = 0; i < AudioChunk.Num(); ++i)
+	{
+		const float ClampedSample = FMath::Clamp(AudioChunk[i], -1.0f, 1.0f);
+		PCMInt16Data[i] = static_cast<int16>(ClampedSample * 32767.0f);
+	}
+
+	// Queue to sound wave
+	AudioTrack.SoundWave->QueueAudio(reinterpret_cast<const uint8*>(PCMInt16Data.GetData()), PCMInt16Data.Num() * sizeof(int16));
+
+	// Start playback if not playing
+	if (AudioTrack.AudioComponent && !AudioTrack.AudioComponent->IsPlaying())
+	{
+		AudioTrack.AudioComponent->Play();
+	}
+}
+
+void UVoiceChatWorldSubsystem::SetSpeakerChunk(const FString& PlayerID, const FInt64Vector& ChunkCoordinates)
+{
+	FScopeLock Lock(&AudioCriticalSection);
+	SpeakerChunks.Add(PlayerID, ChunkCoordinates);
+}
+
+bool UVoiceChatWorldSubsystem::IsSpeakerAudible(const FInt64Vector& ChunkCoordinates) const
+{
+	FScopeLock Lock(&ListenerLock);
+	const FInt64Vector Delta = ChunkCoordinates - ListenerChunkCoordinates;
+	return FMath::Max3(FMath::Abs(Delta.X), FMath::Abs(Delta.Y), FMath::Abs(Delta.Z)) <= MaxAudibleChunkDistance;
+}
+
 void UVoiceChatWorldSubsystem::CheckStreamTimeouts()
 {
 	// Current time
@@ -4,12 +4,13 @@
 
 #include "GameObjects/Framework/Base/ActivatorBase.h"
 #include "GameObjects/Framework/Management/GameObjectsManager.h"
+#include "GameObjects/Framework/Management/ActivatorRegistrySubsystem.h"
 #include "Kismet/GameplayStatics.h"
 #include "Voxels/Core/VoxelWorldSubsystem.h"
 
 
 // Sets default values
-AActivatorBase::AActivatorBase(): TargetObject(nullptr), MapID(0),ChunkX(0), ChunkY(0), ChunkZ(0),
+AActivatorBase::AActivatorBase(): TargetObject(nullptr), ActivatorID(0), MapID(0),ChunkX(0), ChunkY(0), ChunkZ(0),
                                   GameObjectsManager(nullptr)
 {
 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
@@ -21,20 +22,77 @@ void AActivatorBase::BeginPlay()
 {
 	Super::BeginPlay();
 
-	OriginalLocation = GetActorLocation();
-	
 	if (!IsValid(TargetObject))
 	{
 		UE_LOG(LogTemp, Error, TEXT("ActivatorBaseObject: TargetObject is not valid"));
 	}
 
-	UVoxelWorldSubsystem* VoxelWorldController = UVoxelWorldSubsystem::StaticClass()->GetDefaultObject<UVoxelWorldSubsystem>();
+	UpdateSpawnLocation();
+	RegisterActivator();
+}
+
+void AActivatorBase::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UnregisterActivator();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AActivatorBase::UpdateSpawnLocation()
+{
+	OriginalLocation = GetActorLocation();
+
+	// The world's own subsystem, it holds the origin offset that makes the chunk coordinates absolute
+	const UVoxelWorldSubsystem* VoxelWorldController = GetWorld()->GetSubsystem<UVoxelWorldSubsystem>();
 
 	if (IsValid(VoxelWorldController))
 	{
-		VoxelWorldController->CalculateChunkCoordinatesAtWorldLocation(this->GetActorLocation(), ChunkX, ChunkY, ChunkZ);
-		UE_LOG(LogTemp, Log, TEXT("Activator's ChunkCoords set to %lld, %lld, %lld"), ChunkX, ChunkY, ChunkZ);
+		VoxelWorldController->CalculateChunkCoordinatesAtWorldLocation(OriginalLocation, ChunkX, ChunkY, ChunkZ);
+		UE_LOG(LogTemp, Verbose, TEXT("Activator's ChunkCoords set to %lld, %lld, %lld"), ChunkX, ChunkY, ChunkZ);
+	}
+
+	// Rebasing moves the origin by whole chunks, so the offset into the chunk is the same on every client
+	const FVector ChunkOrigin(FMath::FloorToDouble(OriginalLocation.X / CHUNK_SIZE_UNREAL) * CHUNK_SIZE_UNREAL,
+	                          FMath::FloorToDouble(OriginalLocation.Y / CHUNK_SIZE_UNREAL) * CHUNK_SIZE_UNREAL,
+	                          FMath::FloorToDouble(OriginalLocation.Z / CHUNK_SIZE_UNREAL) * CHUNK_SIZE_UNREAL);
+	LocationInChunk = OriginalLocation - ChunkOrigin;
+}
+
+void AActivatorBase::RegisterActivator()
+{
+	UActivatorRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UActivatorRegistrySubsystem>();
+	if (!Registry)
+	{
+		return;
 	}
+
+	const int64 NewActivatorID = UActivatorRegistrySubsystem::MakeActivatorID(ChunkX, ChunkY, ChunkZ, LocationInChunk,
+	                                                                           static_cast<uint16>(EventType));
+	ActivatorID = Registry->RegisterActivator(NewActivatorID, this) ? NewActivatorID : 0;
+}
+
+void AActivatorBase::UnregisterActivator()
+{
+	if (ActivatorID == 0)
+	{
+		return;
+	}
+
+	if (UActivatorRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UActivatorRegistrySubsystem>())
+	{
+		Registry->UnregisterActivator(ActivatorID, this);
+	}
+	ActivatorID = 0;
+}
+
+AGameObjectsManager* AActivatorBase::GetGameObjectsManager()
+{
+	if (!IsValid(GameObjectsManager))
+	{
+		const UActivatorRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UActivatorRegistrySubsystem>();
+		GameObjectsManager = Registry ? Registry->GetGameObjectsManager() : nullptr;
+	}
+	return GameObjectsManager;
 }
 
 // Called every frame
@@ -45,8 +103,12 @@ void AActivatorBase::Tick(const float DeltaTime)
 
 void AActivatorBase::ActivateEvent_Implementation(const FGameObjectState& NewState)
 {
-	UE_LOG(LogTemp, Log, TEXT("ActivatorBaseObject: ActivateEvent Called"));
-	UE_LOG(LogTemp, Log, TEXT("ActivatorBaseObject: Game Object State Changed"));
+	if (!IsValid(TargetObject))
+	{
+		UE_LOG(LogTemp, Error, TEXT("ActivatorBaseObject: ActivateEvent without a valid TargetObject"));
+		return;
+	}
+
 	TargetObject->ActivateGameObject(NewState);
 }
 
@@ -55,23 +117,24 @@ void AActivatorBase::SetGameObjectManagerReference(AGameObjectsManager* InGameOb
 	GameObjectsManager = InGameObjectManager;
 }
 
-void AActivatorBase::SetActivatorUUID(const FString& inUUID)
-{
-	ActivatorUUID = inUUID;
-}
-
 void AActivatorBase::RequestActivation_Implementation()
 {
 	FGameObjectState NewState;
 	NewState.bIsActive = true;
-	const uint16 EType = static_cast<uint16>(EventType);
-	GameObjectsManager->DispatchActivationRequest(MapID, ChunkX, ChunkY, ChunkZ, ActivatorUUID, EType, NewState);
+	RequestActivationWithState_Implementation(NewState);
 }
 
 void AActivatorBase::RequestActivationWithState_Implementation(const FGameObjectState& NewState)
 {
+	AGameObjectsManager* Manager = GetGameObjectsManager();
+	if (!IsValid(Manager) || ActivatorID == 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("ActivatorBaseObject: Cannot request activation, manager missing or activator not registered"));
+		return;
+	}
+
 	const uint16 EType = static_cast<uint16>(EventType);
-	GameObjectsManager->DispatchActivationRequest(MapID, ChunkX, ChunkY, ChunkZ, ActivatorUUID, EType, NewState);
+	Manager->DispatchActivationRequest(MapID, ChunkX, ChunkY, ChunkZ, ActivatorID, EType, NewState);
 }
 
 AGameObjectBase* AActivatorBase::GetAssociatedObject_Implementation()
@@ -83,3 +146,15 @@ FVector AActivatorBase::GetActorOriginalLocation_Implementation()
 {
 	return OriginalLocation;
 }
+
+void AActivatorBase::OnAcquiredFromPool_Implementation()
+{
+	// Placed somewhere else than last time, so it gets the ID of its new placement
+	UpdateSpawnLocation();
+	RegisterActivator();
+}
+
+void AActivatorBase::OnReleasedToPool_Implementation()
+{
+	UnregisterActivator();
+}
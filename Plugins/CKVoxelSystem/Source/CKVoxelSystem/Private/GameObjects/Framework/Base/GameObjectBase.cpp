@@ -1,6 +1,9 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "GameObjects/Framework/Base/GameObjectBase.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "GameObjects/Placeable/PlaceableObjectManager.h"
+#include "Voxels/Core/VoxelWorldSubsystem.h"
 
 
 // Sets default values
@@ -32,6 +35,16 @@ void AGameObjectBase::Tick(const float DeltaTime)
 
 void AGameObjectBase::ActivateGameObject(const FGameObjectState& NewState)
 {
+	// Before anything changes, the proxy still shows the old state, e.g. a closed door that is about to open
+	if (bInstanced)
+	{
+		const UVoxelWorldSubsystem* VoxelWorld = GetWorld()->GetSubsystem<UVoxelWorldSubsystem>();
+		if (APlaceableObjectManager* Manager = VoxelWorld ? VoxelWorld->GetPlaceableObjectManager() : nullptr)
+		{
+			Manager->PromoteGameObject(this);
+		}
+	}
+
 	SetGameObjectState(NewState);
 	//TODO: Implement all other functionality here
 	UE_LOG(LogTemp, Log, TEXT("GameObjectBaseObject: Activated"));
@@ -46,3 +59,53 @@ FVector AGameObjectBase::GetActorOriginalLocation_Implementation()
 {
 	return OriginalLocation;
 }
+
+void AGameObjectBase::SetInstanced(const bool bNewInstanced)
+{
+	if (bInstanced == bNewInstanced)
+	{
+		return;
+	}
+
+	bInstanced = bNewInstanced;
+
+	if (bInstanced)
+	{
+		bTickEnabledBeforeInstancing = IsActorTickEnabled();
+	}
+
+	SetActorHiddenInGame(bInstanced);
+	SetActorEnableCollision(!bInstanced);
+	SetActorTickEnabled(!bInstanced && bTickEnabledBeforeInstancing);
+}
+
+void AGameObjectBase::GetProxyMeshes(TArray<FGameObjectProxyMesh>& OutMeshes) const
+{
+	const FTransform ActorTransform = GetActorTransform();
+
+	TInlineComponentArray<UStaticMeshComponent*> MeshComponents(this);
+	for (const UStaticMeshComponent* Component : MeshComponents)
+	{
+		UStaticMesh* Mesh = Component->GetStaticMesh();
+		if (!Mesh || !Component->IsVisible())
+		{
+			continue;
+		}
+
+		const FTransform ComponentTransform = Component->GetComponentTransform().GetRelativeTransform(ActorTransform);
+		const bool bEnableCollision = Component->IsCollisionEnabled();
+
+		if (const UInstancedStaticMeshComponent* Instanced = Cast<UInstancedStaticMeshComponent>(Component))
+		{
+			for (int32 Index = 0; Index < Instanced->GetInstanceCount(); Index++)
+			{
+				FTransform InstanceTransform;
+				Instanced->GetInstanceTransform(Index, InstanceTransform, false);
+				OutMeshes.Add({Mesh, InstanceTransform * ComponentTransform, bEnableCollision});
+			}
+			continue;
+		}
+
+		OutMeshes.Add({Mesh, ComponentTransform, bEnableCollision});
+	}
+}
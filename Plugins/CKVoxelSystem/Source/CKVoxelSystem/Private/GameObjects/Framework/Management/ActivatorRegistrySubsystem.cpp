@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GameObjects/Framework/Management/ActivatorRegistrySubsystem.h"
+#include "GameObjects/Framework/Base/ActivatorBase.h"
+#include "Hash/CityHash.h"
+
+DEFINE_LOG_CATEGORY(LogActivatorRegistry);
+
+void UActivatorRegistrySubsystem::Deinitialize()
+{
+	Activators.Empty();
+	GameObjectsManager = nullptr;
+
+	Super::Deinitialize();
+}
+
+int64 UActivatorRegistrySubsystem::MakeActivatorID(const int64 ChunkX, const int64 ChunkY, const int64 ChunkZ,
+                                                   const FVector& Location, const uint16 EventType)
+{
+	// Fixed width fields, every supported platform is little endian so all clients hash the same bytes
+	const int64 Key[7] = {
+		ChunkX, ChunkY, ChunkZ,
+		FMath::RoundToInt64(Location.X), FMath::RoundToInt64(Location.Y), FMath::RoundToInt64(Location.Z),
+		EventType
+	};
+
+	const uint64 Hash = CityHash64(reinterpret_cast<const char*>(Key), sizeof(Key));
+
+	// Positive to fit Blueprint's int64, never 0 so 0 can mean unregistered
+	const int64 ActivatorID = static_cast<int64>(Hash & MAX_int64);
+	return ActivatorID != 0 ? ActivatorID : 1;
+}
+
+bool UActivatorRegistrySubsystem::RegisterActivator(const int64 ActivatorID, AActivatorBase* Activator)
+{
+	AActivatorBase*& Registered = Activators.FindOrAdd(ActivatorID);
+	if (IsValid(Registered) && Registered != Activator)
+	{
+		UE_LOG(LogActivatorRegistry, Error, TEXT("ActivatorRegistry: %s and %s share activator ID %lld, keeping the first."),
+		       *Registered->GetName(), *Activator->GetName(), ActivatorID);
+		return false;
+	}
+
+	Registered = Activator;
+	return true;
+}
+
+void UActivatorRegistrySubsystem::UnregisterActivator(const int64 ActivatorID, const AActivatorBase* Activator)
+{
+	// Only its own entry, a colliding activator may hold the ID
+	if (const AActivatorBase* const* Registered = Activators.Find(ActivatorID); Registered && *Registered == Activator)
+	{
+		Activators.Remove(ActivatorID);
+	}
+}
+
+AActivatorBase* UActivatorRegistrySubsystem::FindActivator(const int64 ActivatorID) const
+{
+	AActivatorBase* const* Activator = Activators.Find(ActivatorID);
+	return Activator && IsValid(*Activator) ? *Activator : nullptr;
+}
@@ -0,0 +1,177 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GameObjects/Framework/Management/ActorPoolSubsystem.h"
+#include "Engine/World.h"
+#include "Shared/Types/Interfaces/World/Poolable.h"
+
+DEFINE_LOG_CATEGORY(LogActorPool);
+
+void UActorPoolSubsystem::Deinitialize()
+{
+	// The actors themselves go with the world
+	Pools.Empty();
+
+	Super::Deinitialize();
+}
+
+AActor* UActorPoolSubsystem::AcquireActor(const TSubclassOf<AActor> ActorClass, const FTransform& Transform)
+{
+	if (!ActorClass)
+	{
+		UE_LOG(LogActorPool, Error, TEXT("ActorPool: AcquireActor called without a class."));
+		return nullptr;
+	}
+
+	AActor* Actor = nullptr;
+	if (FPooledActors* Pool = Pools.Find(ActorClass))
+	{
+		// Pooled actors can still be destroyed from outside, e.g. by a level unload
+		while (!Actor && Pool->Actors.Num() > 0)
+		{
+			AActor* Pooled = Pool->Actors.Pop(EAllowShrinking::No);
+			Actor = IsValid(Pooled) ? Pooled : nullptr;
+		}
+	}
+
+	if (!Actor)
+	{
+		return SpawnPooledActor(ActorClass, Transform);
+	}
+
+	Actor->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+	Activate(Actor);
+
+	if (Actor->Implements<UPoolable>())
+	{
+		IPoolable::Execute_OnAcquiredFromPool(Actor);
+	}
+
+	return Actor;
+}
+
+void UActorPoolSubsystem::ReleaseActor(AActor* Actor)
+{
+	if (!IsValid(Actor))
+	{
+		return;
+	}
+
+	FPooledActors& Pool = Pools.FindOrAdd(Actor->GetClass());
+	if (Pool.Actors.Num() >= MaxPooledPerClass)
+	{
+		Actor->Destroy();
+		return;
+	}
+
+	if (Pool.Actors.Contains(Actor))
+	{
+		UE_LOG(LogActorPool, Warning, TEXT("ActorPool: %s released twice."), *Actor->GetName());
+		return;
+	}
+
+	if (Actor->Implements<UPoolable>())
+	{
+		IPoolable::Execute_OnReleasedToPool(Actor);
+	}
+
+	Deactivate(Actor);
+	Pool.Actors.Add(Actor);
+}
+
+void UActorPoolSubsystem::Prewarm(const TSubclassOf<AActor> ActorClass, const int32 Count)
+{
+	if (!ActorClass)
+	{
+		return;
+	}
+
+	const int32 Target = FMath::Min(Count, MaxPooledPerClass);
+	FPooledActors& Pool = Pools.FindOrAdd(ActorClass);
+
+	while (Pool.Actors.Num() < Target)
+	{
+		AActor* Actor = SpawnPooledActor(ActorClass, FTransform::Identity);
+		if (!Actor)
+		{
+			break;
+		}
+
+		// Undoes what BeginPlay set up for use, e.g. an activator's registration
+		if (Actor->Implements<UPoolable>())
+		{
+			IPoolable::Execute_OnReleasedToPool(Actor);
+		}
+
+		Deactivate(Actor);
+		Pool.Actors.Add(Actor);
+	}
+
+	UE_LOG(LogActorPool, Log, TEXT("ActorPool: Prewarmed %d actors of %s."), Pool.Actors.Num(), *ActorClass->GetName());
+}
+
+void UActorPoolSubsystem::ReleaseOrDestroy(AActor* Actor)
+{
+	if (!IsValid(Actor))
+	{
+		return;
+	}
+
+	const UWorld* World = Actor->GetWorld();
+	if (UActorPoolSubsystem* ActorPool = World ? World->GetSubsystem<UActorPoolSubsystem>() : nullptr)
+	{
+		ActorPool->ReleaseActor(Actor);
+		return;
+	}
+
+	Actor->Destroy();
+}
+
+int32 UActorPoolSubsystem::GetNumPooled(const TSubclassOf<AActor> ActorClass) const
+{
+	const FPooledActors* Pool = Pools.Find(ActorClass);
+	return Pool ? Pool->Actors.Num() : 0;
+}
+
+AActor* UActorPoolSubsystem::SpawnPooledActor(UClass* ActorClass, const FTransform& Transform) const
+{
+	UWorld* World = GetWorld();
+	if (!World)
+	{
+		UE_LOG(LogActorPool, Error, TEXT("ActorPool: GetWorld() is null."));
+		return nullptr;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	return World->SpawnActor<AActor>(ActorClass, Transform, SpawnParams);
+}
+
+void UActorPoolSubsystem::Deactivate(AActor* Actor)
+{
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+	Actor->SetActorTickEnabled(false);
+
+	// Deactivating also stops the components ticking, movement components stop moving their updated component
+	for (UActorComponent* Component : Actor->GetComponents())
+	{
+		Component->Deactivate();
+	}
+}
+
+void UActorPoolSubsystem::Activate(AActor* Actor)
+{
+	for (UActorComponent* Component : Actor->GetComponents())
+	{
+		if (Component->bAutoActivate)
+		{
+			Component->Activate(true);
+		}
+	}
+
+	Actor->SetActorHiddenInGame(false);
+	Actor->SetActorEnableCollision(true);
+	Actor->SetActorTickEnabled(Actor->PrimaryActorTick.bCanEverTick && Actor->PrimaryActorTick.bStartWithTickEnabled);
+}
@@ -3,13 +3,14 @@
 
 #include "GameObjects/Framework/Management/GameObjectsManager.h"
 #include "GameObjects/Framework/Base/ActivatorBase.h"
+#include "GameObjects/Framework/Management/ActivatorRegistrySubsystem.h"
+#include "GameObjects/Framework/Management/ActorPoolSubsystem.h"
 #include "GameObjects/Interactive/Physics/Ball.h"
-#include "Kismet/GameplayStatics.h"
 #include "Network/Services/GameData/GameObjectsServiceSubsystem.h"
 
 
 // Sets default values
-AGameObjectsManager::AGameObjectsManager(): GameObjectService(nullptr)
+AGameObjectsManager::AGameObjectsManager(): ActorPool(nullptr), ActivatorRegistry(nullptr), GameObjectService(nullptr)
 {
 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = false;
@@ -17,9 +18,6 @@ AGameObjectsManager::AGameObjectsManager(): GameObjectService(nullptr)
 
 void AGameObjectsManager::InitializeEventMaps()
 {
-	// Add UUID Prefixes
-	EventTypeMap.Add("BALL", EEventType::Ball);
-
 	// Add Event Classes
 	EventActorClassMap.Add(EEventType::Ball, ABall::StaticClass());
 	
@@ -37,19 +35,10 @@ void AGameObjectsManager::SpawnBall(FBallState BallState)
 		UE_LOG(LogTemp, Error, TEXT("GameObjectsManager: GetWorld() is null."));
 	}
 
-	FTransform SpawnTransform = FTransform(BallState.Rotation, BallState.Location, BallState.Scale);
-	
-	FActorSpawnParameters SpawnParams;
-	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-	SpawnParams.bDeferConstruction = true;
+	const FTransform SpawnTransform = FTransform(BallState.Rotation, BallState.Location, BallState.Scale);
 
-	ABall* SpawnedBall = GetWorld()->SpawnActor<ABall>(ABall::StaticClass(), SpawnTransform, SpawnParams);
-	if (SpawnedBall)
-	{
-		SpawnedBall->SetSpawnVariables(BallState.Velocity, BallState.InitialSpeed, 0, 0);
-		SpawnedBall->FinishSpawning(SpawnTransform);
-		//UE_LOG(LogTemp, Log, TEXT("GameObjectsManager: Spawned Ball. Location: %f, %f, %f"), SpawnedBall->GetActorLocation().X, SpawnedBall->GetActorLocation().Y, SpawnedBall->GetActorLocation().Z);
-	}
+	LaunchBall(SpawnTransform, BallState.Velocity, BallState.InitialSpeed);
+	//UE_LOG(LogTemp, Log, TEXT("GameObjectsManager: Spawned Ball. Location: %f, %f, %f"), BallState.Location.X, BallState.Location.Y, BallState.Location.Z);
 }
 
 void AGameObjectsManager::SpawnBall(const FBallState& BallState) const
@@ -77,20 +66,57 @@ void AGameObjectsManager::SpawnBall(const FBallState& BallState) const
 	// Spawn transform
 	const FTransform SpawnTransform(BallState.Rotation, EstimatedLocation, BallState.Scale);
 
-	// Spawn parameters
-	FActorSpawnParameters SpawnParams;
-	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-	SpawnParams.bDeferConstruction = true;
+	// Reuse a pooled ball and apply the initial velocity
+	LaunchBall(SpawnTransform, BallState.Velocity * BallState.InitialSpeed, BallState.InitialSpeed);
+}
+
+ABall* AGameObjectsManager::LaunchBall(const FTransform& SpawnTransform, const FVector& LocalVelocity, const float Speed) const
+{
+	if (!IsValid(ActorPool))
+	{
+		UE_LOG(LogTemp, Error, TEXT("GameObjectsManager: ActorPool is not valid."));
+		return nullptr;
+	}
+
+	ABall* Ball = ActorPool->Acquire<ABall>(SpawnTransform);
+	if (!Ball)
+	{
+		return nullptr;
+	}
+
+	// What UProjectileMovementComponent::InitializeComponent does with an initial velocity in local space
+	FVector Velocity = LocalVelocity;
+	if (Speed > 0.0f)
+	{
+		Velocity = Velocity.GetSafeNormal() * Speed;
+	}
 
-	// Spawn the ball
-	ABall* SpawnedBall = GetWorld()->SpawnActor<ABall>(ABall::StaticClass(), SpawnTransform, SpawnParams);
+	Ball->SetSpawnVariables(SpawnTransform.TransformVectorNoScale(Velocity), Speed, 0, 0);
+	return Ball;
+}
 
-	if (SpawnedBall)
+AActivatorBase* AGameObjectsManager::SpawnActivator(const TSubclassOf<AActivatorBase> ActivatorClass, const FTransform& SpawnTransform)
+{
+	if (!IsValid(ActorPool) || !ActivatorClass)
 	{
-		// Apply initial velocity (assuming your ball class has this method)
-		SpawnedBall->SetSpawnVariables(BallState.Velocity*BallState.InitialSpeed, BallState.InitialSpeed, 0, 0);
+		UE_LOG(LogTemp, Error, TEXT("GameObjectsManager: Cannot spawn activator, ActorPool or class is not valid."));
+		return nullptr;
+	}
 
-		SpawnedBall->FinishSpawning(SpawnTransform);
+	AActivatorBase* Activator = ActorPool->Acquire<AActivatorBase>(SpawnTransform, ActivatorClass);
+	if (Activator)
+	{
+		Activator->SetGameObjectManagerReference(this);
+	}
+
+	return Activator;
+}
+
+void AGameObjectsManager::ReleaseActivator(AActivatorBase* Activator)
+{
+	if (IsValid(Activator))
+	{
+		UActorPoolSubsystem::ReleaseOrDestroy(Activator);
 	}
 }
 
@@ -101,26 +127,11 @@ void AGameObjectsManager::BeginPlay()
 {
 	Super::BeginPlay();
 
-	TArray<AActor*> Actors;
-	UGameplayStatics::GetAllActorsOfClass(GetWorld(), AActivatorBase::StaticClass(), Actors);
-
-	// Convert the array to AActivatorBase pointers if needed
-	TArray<AActivatorBase*> ActivatorActors;
-	for (AActor* Actor : Actors)
+	// Activators register themselves with the registry as they begin play, level placed or spawned by chunks
+	ActivatorRegistry = GetWorld()->GetSubsystem<UActivatorRegistrySubsystem>();
+	if (IsValid(ActivatorRegistry))
 	{
-		if (AActivatorBase* Activator = Cast<AActivatorBase>(Actor))
-		{
-			ActivatorActors.Add(Activator);
-		}
-	}
-
-	// Add the activators to the map
-	for (AActivatorBase* Activator : ActivatorActors)
-	{
-		FString NewUUId = FGuid::NewGuid().ToString();
-		ActivatorsMap.Add(NewUUId, Activator);
-		Activator->SetGameObjectManagerReference(this);
-		Activator->SetActivatorUUID(NewUUId);
+		ActivatorRegistry->SetGameObjectsManager(this);
 	}
 
 	// Ensuring Game Service Object exists and reference is set
@@ -131,62 +142,35 @@ void AGameObjectsManager::BeginPlay()
 		UE_LOG(LogTemp, Log, TEXT("GameObjectsManager: Service_GameObjectService is valid and reference is set."));
 	}
 
+	ActorPool = GetWorld()->GetSubsystem<UActorPoolSubsystem>();
+	if (IsValid(ActorPool))
+	{
+		ActorPool->Prewarm(ABall::StaticClass(), BallPoolPrewarmCount);
+	}
+
 	OnGameObjectActivationNotificationReceived.AddDynamic(this, &AGameObjectsManager::FindAndActivateObject);
 	OnBallEventReceived.AddUObject(this, &AGameObjectsManager::ProcessBallEvent);
 
 	InitializeEventMaps();
 }
 
-void AGameObjectsManager::FindAndActivateObject(const FString& ObjectUUID, const FGameObjectState& NewState)
+void AGameObjectsManager::FindAndActivateObject(const int64 ActivatorID, const FGameObjectState& NewState)
 {
-	UE_LOG(LogTemp, Log, TEXT("GameObjectsManager: FindAndActivateObject Called"));
-	if (ActivatorsMap.Contains(ObjectUUID))
-	{
-		UE_LOG(LogTemp, Log, TEXT("GameObjectsManager: ObjectUUID found in the map."));
-		ActivatorsMap[ObjectUUID]->ActivateEvent_Implementation(NewState);
-	}
-	else
+	AActivatorBase* Activator = IsValid(ActivatorRegistry) ? ActivatorRegistry->FindActivator(ActivatorID) : nullptr;
+	if (!Activator)
 	{
-		UE_LOG(LogTemp, Error, TEXT("GameObjectsManager: ObjectUUID not found in the map."));
-	}
-}
-
-void AGameObjectsManager::ProcessBallEvent(const FString& EventUUID, const FBallState& BallState) const
-{
-	if (DoesEventExist(EventUUID))
-	{
-		SpawnBall(BallState);
+		// The activator's chunk may not be loaded on this client
+		UE_LOG(LogTemp, Verbose, TEXT("GameObjectsManager: No activator registered for ID %lld."), ActivatorID);
 		return;
 	}
 
-	UE_LOG(LogTemp, Error, TEXT("GameObjectsManager: EventUUID not found in the map."));
+	Activator->ActivateEvent_Implementation(NewState);
 }
 
-
-bool AGameObjectsManager::DoesEventExist(const FString& EventUUID) const
+void AGameObjectsManager::ProcessBallEvent(const int64 EventID, const FBallState& BallState) const
 {
-	UE_LOG(LogTemp, Log, TEXT("GameObjectsManager: FindAndActivateEvent Called for UUID: %s"), *EventUUID);
-	
-	bool TypeFound = false;
-
-	for (const auto& Prefix: EventTypeMap)
-	{
-		if (EventUUID.StartsWith(Prefix.Key))
-		{
-			TypeFound = true;
-			break;
-		}
-	}
-
-	if (!TypeFound)
-	{
-		UE_LOG(LogTemp, Error, TEXT("GameObjectsManager: EventUUID not found in the map."));
-		return false;
-	}
-	
-	UE_LOG(LogTemp, Log, TEXT("GameObjectsManager: EventUUID found in the map."));
-	return true;
-	
+	// The event kind was already switched on by the service, ball events carry everything needed to spawn
+	SpawnBall(BallState);
 }
 
 // Called every frame
@@ -196,8 +180,8 @@ void AGameObjectsManager::Tick(const float DeltaTime)
 }
 
 void AGameObjectsManager::DispatchActivationRequest(const int64 MapId, const int64 ChunkX, const int64 ChunkY,
-	const int64 ChunkZ, const FString& ActivatorUUID, const uint16 EventType, const FGameObjectState& State) const
+	const int64 ChunkZ, const int64 ActivatorID, const uint16 EventType, const FGameObjectState& State) const
 {
-	GameObjectService->SendGameObjectActivationRequest(MapId, ChunkX, ChunkY, ChunkZ, ActivatorUUID, EventType, State);
+	GameObjectService->SendGameObjectActivationRequest(MapId, ChunkX, ChunkY, ChunkZ, ActivatorID, EventType, State);
 }
 
@@ -77,9 +77,8 @@ void AGO_Door::ActivateGameObject(const FGameObjectState& NewState)
 
 	if (bResetDoorAfterActivation)
 	{
-		FTimerHandle TimerHandle;
 		GetWorld()->GetTimerManager().SetTimer(
-			TimerHandle,
+			CloseDoorTimerHandle,
 			this,
 			&AGO_Door::CloseDoor,
 			5.0f,
@@ -87,6 +86,12 @@ void AGO_Door::ActivateGameObject(const FGameObjectState& NewState)
 	}
 }
 
+bool AGO_Door::IsAnimating() const
+{
+	return DoorTimeline.IsPlaying() || DoorTimeline.IsReversing() ||
+		GetWorldTimerManager().IsTimerActive(CloseDoorTimerHandle);
+}
+
 // Called every frame
 void AGO_Door::Tick(const float DeltaTime)
 {
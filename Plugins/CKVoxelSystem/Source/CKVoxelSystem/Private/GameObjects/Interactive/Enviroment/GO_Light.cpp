@@ -78,3 +78,8 @@ int32 AGO_Light::GetLightOrder()
 	return LightOrder;
 }
 
+bool AGO_Light::IsAnimating() const
+{
+	return Light->Intensity > 0.0f;
+}
+
@@ -4,6 +4,7 @@
 #include "GameObjects/Interactive/Physics/Ball.h"
 #include "Kismet/GameplayStatics.h"
 #include "GameFramework/Character.h"
+#include "GameObjects/Framework/Management/ActorPoolSubsystem.h"
 #include "Shared/Types/Interfaces/Interaction/Activatable.h"
 #include "Shared/Types/Interfaces/Player/HitResponseInterface.h"
 #include "Shared/Types/Interfaces/Player/PlayerInterface.h"
@@ -11,8 +12,9 @@
 // Sets default values
 ABall::ABall()
 {
-	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	// Only ticks while accelerating, see SetSpawnVariables
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
 
 	CollisionComponent = CreateDefaultSubobject<USphereComponent>(TEXT("CollisionComponent"));
 	CollisionComponent->SetCollisionProfileName("Custom");
@@ -79,6 +81,7 @@ void ABall::Tick(float DeltaTime)
 		if (AccelerationTimeRemaining <= 0.0f)
 		{
 			bIsAccelerating = false;
+			SetActorTickEnabled(false);
 
 			ProjectileMovement->Velocity = ProjectileMovement->Velocity.GetSafeNormal() * TargetSpeed;
 			ProjectileMovement->UpdateComponentVelocity();
@@ -117,10 +120,36 @@ void ABall::SetSpawnVariables(const FVector NewVelocity, const float NewSpeed, f
 	{
 		bIsAccelerating = false;
 	}
+
+	// Projectile movement ticks on its own, the actor only has to while it lerps the speed
+	SetActorTickEnabled(bIsAccelerating);
 	
 	ProjectileMovement->UpdateComponentVelocity();
 }
 
+void ABall::OnAcquiredFromPool_Implementation()
+{
+	// Projectile movement drops its updated component when it comes to rest
+	ProjectileMovement->SetUpdatedComponent(CollisionComponent);
+}
+
+void ABall::OnReleasedToPool_Implementation()
+{
+	GetWorldTimerManager().ClearTimer(ReleaseTimerHandle);
+
+	ProjectileMovement->StopMovementImmediately();
+	ProjectileMovement->ProjectileGravityScale = 0.0f;
+
+	bFirstContact = false;
+	bIsAccelerating = false;
+	AccelerationTimeRemaining = 0.0f;
+}
+
+void ABall::ReleaseBall()
+{
+	UActorPoolSubsystem::ReleaseOrDestroy(this);
+}
+
 void ABall::NotifyHit(class UPrimitiveComponent* MyComp, AActor* Other, class UPrimitiveComponent* OtherComp,
 	bool bSelfMoved, FVector HitLocation, FVector HitNormal, FVector NormalImpulse, const FHitResult& Hit)
 {
@@ -156,17 +185,8 @@ void ABall::NotifyHit(class UPrimitiveComponent* MyComp, AActor* Other, class UP
 		ProjectileMovement->ProjectileGravityScale = 1.0f;
 		if (const UWorld* World = GetWorld())
 		{
-			// Set a timer with lambda to destroy the ball after 10 seconds
-			FTimerHandle DestroyTimerHandle;
-			World->GetTimerManager().SetTimer(
-				DestroyTimerHandle,
-				[this]()
-				{
-					Destroy();
-				},
-				10.0f,
-				false
-			);
+			// Back to the pool after a while, the next ball event reuses it
+			World->GetTimerManager().SetTimer(ReleaseTimerHandle, this, &ABall::ReleaseBall, LifetimeAfterFirstContact, false);
 		}
 	}
 }
@@ -1,6 +1,11 @@
 #include "GameObjects/Placeable/PlaceableObjectManager.h"
+#include "GameObjects/Framework/Base/GameObjectBase.h"
 #include "Voxels/Core/VoxelChunk.h"
+#include "Voxels/Core/VoxelWorldSubsystem.h"
+#include "Shared/Types/Structures/Chunks/FChunkDataContainer.h"
+#include "Engine/AssetManager.h"
 #include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
 #include "Kismet/GameplayStatics.h"
 #include "Components/SceneComponent.h"
 #include "Engine/StaticMesh.h"
@@ -24,6 +29,28 @@ void APlaceableObjectManager::BeginPlay()
 {
 	Super::BeginPlay();
 	RebuildRegistry();
+
+	// Chunks look the manager up here when they spawn their placed objects
+	if (UVoxelWorldSubsystem* VoxelWorld = GetWorld()->GetSubsystem<UVoxelWorldSubsystem>())
+	{
+		VoxelWorld->SetPlaceableObjectManager(this);
+	}
+
+	GetWorldTimerManager().SetTimer(InstancingTimerHandle, this, &APlaceableObjectManager::UpdateInstancedObjects,
+	                                InstancingUpdateInterval, true);
+}
+
+void APlaceableObjectManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	GetWorldTimerManager().ClearTimer(InstancingTimerHandle);
+
+	UVoxelWorldSubsystem* VoxelWorld = GetWorld()->GetSubsystem<UVoxelWorldSubsystem>();
+	if (VoxelWorld && VoxelWorld->GetPlaceableObjectManager() == this)
+	{
+		VoxelWorld->SetPlaceableObjectManager(nullptr);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void APlaceableObjectManager::RebuildRegistry()
@@ -58,6 +85,31 @@ void APlaceableObjectManager::RebuildRegistry()
 	}
 
 	UE_LOG(LogPlaceableManager, Log, TEXT("Rebuilt registry: %d entries"), Registry.Num());
+
+	RequestThumbnails();
+}
+
+void APlaceableObjectManager::RequestThumbnails()
+{
+	TArray<FSoftObjectPath> Paths;
+	for (const TPair<FName, UGameObjectDef*>& Pair : Registry)
+	{
+		if (!Pair.Value->Thumbnail.IsNull() && !Pair.Value->Thumbnail.Get())
+		{
+			Paths.Add(Pair.Value->Thumbnail.ToSoftObjectPath());
+		}
+	}
+
+	if (Paths.IsEmpty())
+	{
+		return;
+	}
+
+	ThumbnailsHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(MoveTemp(Paths),
+		FStreamableDelegate::CreateWeakLambda(this, [this]()
+		{
+			OnCatalogThumbnailsLoaded.Broadcast();
+		}));
 }
 
 void APlaceableObjectManager::GetAllObjectsUI(TArray<FGameObjectUIEntry>& OutList) const
@@ -75,7 +127,7 @@ void APlaceableObjectManager::GetAllObjectsUI(TArray<FGameObjectUIEntry>& OutLis
 		FGameObjectUIEntry Row;
 		Row.Id = Entry->UniqueId;
 		Row.DisplayName = Entry->DisplayName;
-		Row.Thumbnail = Entry->ResolveThumbnailSync();
+		Row.Thumbnail = Entry->Thumbnail.Get();
 
 		const bool bIsActor =
 			Cast<UGameObjectActorDef>(Entry) != nullptr;
@@ -166,6 +218,12 @@ AActor* APlaceableObjectManager::SpawnActorFromDef(UGameObjectActorDef* ActorDef
 AActor* APlaceableObjectManager::SpawnById(FName Id, const FTransform& Transform, AVoxelChunk* OwningChunk,
 	UInstancedStaticMeshComponent*& OutHISM,
 	int32& OutInstanceIndex)
+{
+	return SpawnInternal(Id, Transform, OwningChunk, BLUEPRINT_KEY_BIT | NextBlueprintKey++, OutHISM, OutInstanceIndex);
+}
+
+AActor* APlaceableObjectManager::SpawnInternal(FName Id, const FTransform& Transform, AVoxelChunk* OwningChunk,
+	const uint64 InstanceKey, UInstancedStaticMeshComponent*& OutHISM, int32& OutInstanceIndex)
 {
 	OutHISM = nullptr;
 	OutInstanceIndex = INDEX_NONE;
@@ -197,7 +255,15 @@ AActor* APlaceableObjectManager::SpawnById(FName Id, const FTransform& Transform
 			return nullptr;
 		}
 
-		OutInstanceIndex = HISM->AddInstance(Transform);
+		// The chunk tracks the indices of its instances itself
+		if (OwningChunk)
+		{
+			OwningChunk->SetInstance(HISM, InstanceKey, Transform);
+		}
+		else
+		{
+			OutInstanceIndex = HISM->AddInstance(Transform);
+		}
 		OutHISM = HISM;
 
 		// For instanced meshes we do NOT return an actor; the manager owns the component.
@@ -207,7 +273,26 @@ AActor* APlaceableObjectManager::SpawnById(FName Id, const FTransform& Transform
 	// Actor route
 	if (UGameObjectActorDef* ADef = Cast<UGameObjectActorDef>(*Found))
 	{
-		return SpawnActorFromDef(ADef, Transform, OwningChunk);
+		AActor* Spawned = SpawnActorFromDef(ADef, Transform, OwningChunk);
+
+		// Only chunks have HISMs to draw idle game objects with
+		AGameObjectBase* GameObject = Cast<AGameObjectBase>(Spawned);
+		if (GameObject && OwningChunk && ADef->bInstanceWhenIdle)
+		{
+			FInstancedGameObject& Object = InstancedObjects.AddDefaulted_GetRef();
+			Object.Actor = GameObject;
+			Object.Chunk = OwningChunk;
+			Object.ProxyID = GameObject->GetUniqueID();
+
+			TArray<FVector> PlayerLocations;
+			GetPlayerLocations(PlayerLocations);
+			if (!IsInRange(GameObject->GetActorLocation(), PlayerLocations, DemoteDistance))
+			{
+				InstanceObject(Object);
+			}
+		}
+
+		return Spawned;
 	}
 
 	UE_LOG(LogPlaceableManager, Warning, TEXT("SpawnById: Id '%s' has unsupported def type"), *Id.ToString());
@@ -226,3 +311,255 @@ bool APlaceableObjectManager::RemoveInstance(UInstancedStaticMeshComponent* HISM
 	// RemoveInstance compacts the array; track indices externally if you need stable IDs.
 	return HISM->RemoveInstance(InstanceIndex);
 }
+
+void APlaceableObjectManager::ClearChunkObjects(const AVoxelChunk* Chunk)
+{
+	for (TPair<FSoftObjectPath, TArray<FDeferredPlaceableSpawn>>& Pair : DeferredSpawns)
+	{
+		Pair.Value.RemoveAllSwap([Chunk](const FDeferredPlaceableSpawn& Spawn) { return Spawn.Chunk.Get() == Chunk; });
+	}
+
+	for (int32 Index = InstancedObjects.Num() - 1; Index >= 0; Index--)
+	{
+		const FInstancedGameObject& Object = InstancedObjects[Index];
+		if (Object.Chunk.Get() != Chunk)
+		{
+			continue;
+		}
+
+		// The respawned actor gets other keys, this one's proxies would stay behind
+		RemoveProxyInstances(Object);
+
+		if (IsValid(Object.Actor))
+		{
+			Object.Actor->Destroy();
+		}
+		InstancedObjects.RemoveAtSwap(Index, EAllowShrinking::No);
+	}
+}
+
+void APlaceableObjectManager::UpdateInstancedObjects()
+{
+	TArray<FVector> PlayerLocations;
+	GetPlayerLocations(PlayerLocations);
+
+	for (int32 Index = InstancedObjects.Num() - 1; Index >= 0; Index--)
+	{
+		FInstancedGameObject& Object = InstancedObjects[Index];
+
+		// The chunk unloaded, its HISMs and attached actors went with it. An actor destroyed on its own leaves its proxies
+		if (!Object.Chunk.IsValid() || !IsValid(Object.Actor))
+		{
+			RemoveProxyInstances(Object);
+			InstancedObjects.RemoveAtSwap(Index, EAllowShrinking::No);
+			continue;
+		}
+
+		const FVector Location = Object.Actor->GetActorLocation();
+
+		if (Object.Actor->IsInstanced())
+		{
+			// An animating object is hidden behind its proxy, e.g. a light that was turned on far away
+			if (Object.Actor->IsAnimating() || IsInRange(Location, PlayerLocations, PromoteDistance))
+			{
+				PromoteObject(Object);
+			}
+		}
+		else if (!Object.Actor->IsAnimating() && !IsInRange(Location, PlayerLocations, DemoteDistance))
+		{
+			InstanceObject(Object);
+		}
+	}
+}
+
+void APlaceableObjectManager::GetPlayerLocations(TArray<FVector>& OutLocations) const
+{
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APawn* Pawn = It->Get() ? It->Get()->GetPawn() : nullptr)
+		{
+			OutLocations.Add(Pawn->GetActorLocation());
+		}
+	}
+}
+
+bool APlaceableObjectManager::IsInRange(const FVector& Location, const TArray<FVector>& PlayerLocations, const float Distance)
+{
+	const float DistanceSquared = FMath::Square(Distance);
+	for (const FVector& PlayerLocation : PlayerLocations)
+	{
+		if (FVector::DistSquared(Location, PlayerLocation) <= DistanceSquared)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void APlaceableObjectManager::InstanceObject(FInstancedGameObject& Object)
+{
+	AVoxelChunk* Chunk = Object.Chunk.Get();
+
+	TArray<FGameObjectProxyMesh> Meshes;
+	Object.Actor->GetProxyMeshes(Meshes);
+
+	const FTransform ActorTransform = Object.Actor->GetActorTransform();
+
+	for (int32 Index = 0; Index < Meshes.Num(); Index++)
+	{
+		UInstancedStaticMeshComponent* HISM = GetOrCreateHISM(Meshes[Index].Mesh, Meshes[Index].bEnableCollision, Chunk);
+		if (!HISM)
+		{
+			continue;
+		}
+
+		Chunk->SetInstance(HISM, ProxyKey(Object.ProxyID, Index), Meshes[Index].Transform * ActorTransform);
+
+		if (Object.ProxyComponents.IsValidIndex(Index))
+		{
+			Object.ProxyComponents[Index] = HISM;
+		}
+		else
+		{
+			Object.ProxyComponents.Add(HISM);
+		}
+	}
+
+	Object.Actor->SetInstanced(true);
+}
+
+void APlaceableObjectManager::PromoteObject(FInstancedGameObject& Object)
+{
+	RemoveProxyInstances(Object);
+	Object.Actor->SetInstanced(false);
+}
+
+void APlaceableObjectManager::RemoveProxyInstances(const FInstancedGameObject& Object)
+{
+	AVoxelChunk* Chunk = Object.Chunk.Get();
+	if (!Chunk)
+	{
+		return;
+	}
+
+	for (int32 Index = 0; Index < Object.ProxyComponents.Num(); Index++)
+	{
+		if (UInstancedStaticMeshComponent* HISM = Object.ProxyComponents[Index])
+		{
+			Chunk->RemoveInstance(HISM, ProxyKey(Object.ProxyID, Index));
+		}
+	}
+}
+
+void APlaceableObjectManager::PromoteGameObject(const AGameObjectBase* Actor)
+{
+	FInstancedGameObject* Object = InstancedObjects.FindByPredicate([Actor](const FInstancedGameObject& Instanced)
+	{
+		return Instanced.Actor == Actor;
+	});
+
+	// An unloaded chunk's objects are dropped on the next update
+	if (Object && Object->Chunk.IsValid() && Object->Actor->IsInstanced())
+	{
+		PromoteObject(*Object);
+	}
+}
+
+uint64 APlaceableObjectManager::ProxyKey(const uint32 ProxyID, const int32 ProxyIndex)
+{
+	return PROXY_KEY_BIT | (static_cast<uint64>(ProxyID) << 16) | static_cast<uint64>(ProxyIndex);
+}
+
+FSoftObjectPath APlaceableObjectManager::GetAssetPath(const UGameObjectDef* Def)
+{
+	if (const UGameObjectStaticMeshDef* SMDef = Cast<UGameObjectStaticMeshDef>(Def))
+	{
+		return SMDef->Mesh.ToSoftObjectPath();
+	}
+
+	if (const UGameObjectActorDef* ADef = Cast<UGameObjectActorDef>(Def))
+	{
+		return ADef->ActorClass.ToSoftObjectPath();
+	}
+
+	return FSoftObjectPath();
+}
+
+bool APlaceableObjectManager::RequestAsset(const FSoftObjectPath& Path)
+{
+	if (Path.IsNull() || Path.ResolveObject())
+	{
+		return true;
+	}
+
+	// Objects of the same type load with the first request
+	if (!AssetHandles.Contains(Path))
+	{
+		AssetHandles.Add(Path, UAssetManager::GetStreamableManager().RequestAsyncLoad(Path,
+			FStreamableDelegate::CreateUObject(this, &APlaceableObjectManager::OnAssetLoaded, Path)));
+	}
+
+	return false;
+}
+
+void APlaceableObjectManager::RequestSpawnById(const FName Id, const FTransform& Transform, AVoxelChunk* OwningChunk,
+                                               const uint64 InstanceKey)
+{
+	UGameObjectDef* const* Found = Registry.Find(Id);
+	const FSoftObjectPath Path = Found && *Found ? GetAssetPath(*Found) : FSoftObjectPath();
+
+	if (Path.IsNull() || Path.ResolveObject())
+	{
+		UInstancedStaticMeshComponent* OutHISM = nullptr;
+		int32 OutInstanceIndex = INDEX_NONE;
+		SpawnInternal(Id, Transform, OwningChunk, InstanceKey, OutHISM, OutInstanceIndex);
+		return;
+	}
+
+	// Queued before requesting, the delegate runs right away if the asset finished loading in between
+	DeferredSpawns.FindOrAdd(Path).Add({Id, Transform, OwningChunk, InstanceKey});
+	RequestAsset(Path);
+}
+
+void APlaceableObjectManager::PrefetchChunkObjects(const FChunkDataContainer& ChunkData)
+{
+	check(IsInGameThread());
+
+	for (const TPair<FVoxelCoordinate, FVoxelDefinition>& Pair : ChunkData.VoxelStatesMap)
+	{
+		for (const FPlacedObjectState& Object : Pair.Value.VoxelState.GameObjects)
+		{
+			if (UGameObjectDef* const* Found = Registry.Find(FName(*Object.ObjectID)))
+			{
+				RequestAsset(GetAssetPath(*Found));
+			}
+		}
+	}
+}
+
+void APlaceableObjectManager::OnAssetLoaded(const FSoftObjectPath Path)
+{
+	TArray<FDeferredPlaceableSpawn> Spawns;
+	DeferredSpawns.RemoveAndCopyValue(Path, Spawns);
+
+	// Checked before anything else, a prefetch fails with nobody waiting on it yet
+	if (!Path.ResolveObject())
+	{
+		UE_LOG(LogPlaceableManager, Error, TEXT("Failed to load '%s', %d objects not spawned"), *Path.ToString(), Spawns.Num());
+
+		// The next chunk placing it tries again
+		AssetHandles.Remove(Path);
+		return;
+	}
+
+	for (const FDeferredPlaceableSpawn& Spawn : Spawns)
+	{
+		// The chunk may have unloaded while the asset was loading
+		if (AVoxelChunk* Chunk = Spawn.Chunk.Get())
+		{
+			UInstancedStaticMeshComponent* OutHISM = nullptr;
+			int32 OutInstanceIndex = INDEX_NONE;
+			SpawnInternal(Spawn.Id, Spawn.Transform, Chunk, Spawn.InstanceKey, OutHISM, OutInstanceIndex);
+		}
+	}
+}
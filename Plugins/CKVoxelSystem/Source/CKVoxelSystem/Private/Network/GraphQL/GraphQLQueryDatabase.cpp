@@ -2,3 +2,49 @@
 
 
 #include "Network/GraphQL//GraphQLQueryDatabase.h"
+#include <openssl/evp.h>
+
+#if WITH_EDITOR
+#include "UObject/ObjectSaveContext.h"
+#endif
+
+void UGraphQLQueryDatabase::PostLoad()
+{
+	Super::PostLoad();
+	UpdatePersistedQueryHashes();
+}
+
+#if WITH_EDITOR
+void UGraphQLQueryDatabase::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	UpdatePersistedQueryHashes();
+}
+
+void UGraphQLQueryDatabase::PreSave(FObjectPreSaveContext ObjectSaveContext)
+{
+	Super::PreSave(ObjectSaveContext);
+	UpdatePersistedQueryHashes();
+}
+#endif
+
+void UGraphQLQueryDatabase::UpdatePersistedQueryHashes()
+{
+	for (FGraphQLQueryDef& QueryDef : QueryList)
+	{
+		// The server hashes the query text it receives, which is the body as typed
+		const FTCHARToUTF8 Utf8Body(*QueryDef.QueryBody);
+
+		// OpenSSL instead of FPlatformMisc::GetSHA256Signature, which not every platform implements
+		uint8 Digest[EVP_MAX_MD_SIZE];
+		unsigned int DigestLength = 0;
+		if (QueryDef.QueryBody.IsEmpty() ||
+		    !EVP_Digest(Utf8Body.Get(), Utf8Body.Length(), Digest, &DigestLength, EVP_sha256(), nullptr))
+		{
+			QueryDef.PersistedQueryHash.Empty();
+			continue;
+		}
+
+		QueryDef.PersistedQueryHash = BytesToHexLower(Digest, DigestLength);
+	}
+}
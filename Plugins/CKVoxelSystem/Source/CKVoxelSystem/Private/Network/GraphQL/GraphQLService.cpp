@@ -14,9 +14,53 @@
 #include "Network/Services/GameData/VoxelServiceSubsystem.h"
 #include "Network/Services/Core/UDPSubsystem.h"
 #include "Async/Async.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "String/Find.h"
+#include "TimerManager.h"
+
+#if !UE_BUILD_SHIPPING
+#include "HttpServerModule.h"
+#include "HttpServerRequest.h"
+#include "HttpServerResponse.h"
+#include "HttpPath.h"
+#include "IHttpRouter.h"
+#include "Containers/Ticker.h"
+#include "HAL/IConsoleManager.h"
+#endif
 
 DEFINE_LOG_CATEGORY(LogGraphQLService);
 
+namespace
+{
+	void AppendUtf8(TArray<uint8>& Out, const FString& Text)
+	{
+		const FTCHARToUTF8 Utf8Text(*Text);
+		Out.Append(reinterpret_cast<const uint8*>(Utf8Text.Get()), Utf8Text.Length());
+	}
+
+	// Condensed body up to the variables, with the trailing } of the object cut off
+	TArray<uint8> BuildPayloadPrefix(const TSharedRef<FJsonObject>& Body)
+	{
+		FString Prefix;
+		const TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer =
+			TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Prefix);
+		FJsonSerializer::Serialize(Body, Writer);
+
+		Prefix.LeftChopInline(1);
+		Prefix += TEXT(",\"variables\":");
+
+		TArray<uint8> Utf8Prefix;
+		AppendUtf8(Utf8Prefix, Prefix);
+		return Utf8Prefix;
+	}
+
+	bool ContainsText(const TArray<uint8>& Content, const FUtf8StringView Text)
+	{
+		const FUtf8StringView ContentView(reinterpret_cast<const UTF8CHAR*>(Content.GetData()), Content.Num());
+		return UE::String::FindFirst(ContentView, Text, ESearchCase::CaseSensitive) != INDEX_NONE;
+	}
+}
+
 void UGraphQLService::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
@@ -38,6 +82,13 @@ void UGraphQLService::Initialize(FSubsystemCollectionBase& Collection)
 
 void UGraphQLService::Deinitialize()
 {
+	bDeinitializing = true;
+
+	for (int32 Lane = 0; Lane < NUM_LANES; Lane++)
+	{
+		CancelLane(static_cast<EGraphQLRequestLane>(Lane));
+	}
+
 	// Clear any stored tokens
 	ClearAuthToken();
 	MessageParser = nullptr;
@@ -69,12 +120,26 @@ void UGraphQLService::PostSubsystemInit()
 void UGraphQLService::SetAuthToken(const FString& InAuthToken)
 {
 	AuthToken = InAuthToken;
+	{
+		FScopeLock Lock(&SchedulerLock);
+		AuthorizationHeader = FString::Printf(TEXT("Bearer %s"), *AuthToken);
+
+		// Cached responses belong to the previous user
+		ResponseCache.Empty();
+		CacheGeneration++;
+	}
 	UE_LOG(LogGraphQLService, Log, TEXT("GraphQL Service: Auth token set %s"), *AuthToken);
 }
 
 void UGraphQLService::ClearAuthToken()
 {
 	AuthToken.Empty();
+	{
+		FScopeLock Lock(&SchedulerLock);
+		AuthorizationHeader.Empty();
+		ResponseCache.Empty();
+		CacheGeneration++;
+	}
 	UE_LOG(LogGraphQLService, Log, TEXT("GraphQL Service: Auth token cleared"));
 }
 
@@ -105,259 +170,878 @@ FGraphQLStats UGraphQLService::GetStats() const
 	return Stats;
 }
 
-void UGraphQLService::ExecuteGraphQLQuery(const FString& Query, const bool bIncludeAuthToken,
-                                          const TSharedPtr<FJsonObject>& Variables)
+EGraphQLRequestLane UGraphQLService::GetLaneForQuery(const EGraphQLQuery QueryID)
+{
+	switch (QueryID)
+	{
+	case EGraphQLQuery::Login:
+	case EGraphQLQuery::Register:
+	case EGraphQLQuery::UDP_Access:
+	case EGraphQLQuery::TeleportRequest:
+	case EGraphQLQuery::GetVersionInfo:
+	case EGraphQLQuery::UpdateUserState:
+	case EGraphQLQuery::GetUserState:
+		return EGraphQLRequestLane::Interactive;
+
+	case EGraphQLQuery::GetChunkByDistance:
+	case EGraphQLQuery::VoxelList:
+	case EGraphQLQuery::ListVoxelUpdatesByDistance:
+		return EGraphQLRequestLane::Bulk;
+
+	default:
+		return EGraphQLRequestLane::Gameplay;
+	}
+}
+
+const FGraphQLLaneSettings& UGraphQLService::GetLaneSettings(const EGraphQLRequestLane Lane) const
 {
-	if (Query.IsEmpty())
+	switch (Lane)
+	{
+	case EGraphQLRequestLane::Interactive: return InteractiveLane;
+	case EGraphQLRequestLane::Bulk: return BulkLane;
+	default: return GameplayLane;
+	}
+}
+
+TSharedPtr<const FGraphQLQueryTemplate> UGraphQLService::GetQueryTemplate(const EGraphQLQuery QueryID)
+{
+	{
+		FScopeLock Lock(&SchedulerLock);
+		if (const TSharedPtr<const FGraphQLQueryTemplate>* Found = QueryTemplates.Find(QueryID))
+		{
+			return *Found;
+		}
+	}
+
+	FGraphQLQueryDef QueryDef;
+	FString Error;
+
+	if (!GraphQLQueryDatabase)
+	{
+		UE_LOG(LogGraphQLService, Error, TEXT("GraphQL Service: QueryDatabase is null"));
+		Error = TEXT("{\"error\": \"Internal error: query database missing\"}");
+	}
+	else if (!GraphQLQueryDatabase->GetQueryByID(QueryID, QueryDef))
+	{
+		UE_LOG(LogGraphQLService, Error, TEXT("GraphQL Service: Query not found for ID %d"), static_cast<int32>(QueryID));
+		Error = TEXT("{\"error\": \"Query not found\"}");
+	}
+	else if (QueryDef.QueryBody.IsEmpty())
 	{
 		UE_LOG(LogGraphQLService, Error, TEXT("GraphQL Service: Empty query provided"));
-		UE::Tasks::Launch(UE_SOURCE_LOCATION, [this]()
+		Error = TEXT("{\"error\": \"Empty query provided\"}");
+	}
+
+	if (!Error.IsEmpty())
+	{
+		AsyncTask(ENamedThreads::GameThread, [this, Error]()
 		{
-			OnComplete.ExecuteIfBound(false, TEXT("{\"error\": \"Empty query provided\"}"));
-		}, LowLevelTasks::ETaskPriority::Normal, UE::Tasks::EExtendedTaskPriority::GameThreadNormalPri);
+			OnComplete.ExecuteIfBound(false, Error);
+		});
+		return nullptr;
+	}
+
+	const TSharedRef<FGraphQLQueryTemplate> Template = MakeShared<FGraphQLQueryTemplate>();
+	Template->Lane = GetLaneForQuery(QueryID);
+	Template->DefaultVariables = QueryDef.DefaultVariables;
+	Template->bIsMutation = QueryDef.QueryBody.TrimStart().StartsWith(TEXT("mutation"));
+
+	// Escaped and encoded once here instead of on every request, only the variables are written per call
+	const TSharedRef<FJsonObject> QueryObject = MakeShared<FJsonObject>();
+	QueryObject->SetStringField(TEXT("query"), QueryDef.QueryBody);
+	Template->QueryPrefix = BuildPayloadPrefix(QueryObject);
+
+	if (!QueryDef.PersistedQueryHash.IsEmpty())
+	{
+		// Apollo's automatic persisted queries extension
+		const TSharedRef<FJsonObject> PersistedQuery = MakeShared<FJsonObject>();
+		PersistedQuery->SetNumberField(TEXT("version"), 1);
+		PersistedQuery->SetStringField(TEXT("sha256Hash"), QueryDef.PersistedQueryHash);
+
+		const TSharedRef<FJsonObject> Extensions = MakeShared<FJsonObject>();
+		Extensions->SetObjectField(TEXT("persistedQuery"), PersistedQuery);
+
+		const TSharedRef<FJsonObject> PersistedObject = MakeShared<FJsonObject>();
+		PersistedObject->SetObjectField(TEXT("extensions"), Extensions);
+		Template->PersistedPrefix = BuildPayloadPrefix(PersistedObject);
+
+		QueryObject->SetObjectField(TEXT("extensions"), Extensions);
+		Template->RegisterPrefix = BuildPayloadPrefix(QueryObject);
+	}
+
+	FScopeLock Lock(&SchedulerLock);
+	QueryTemplates.Add(QueryID, Template);
+	return Template;
+}
+
+int64 UGraphQLService::ExecuteQueryByID(EGraphQLQuery QueryID, const TMap<FString, FString>& RuntimeVariables,
+                                        const bool bIncludeAuthToken, const bool bUseNestedJson)
+{
+	const TSharedPtr<const FGraphQLQueryTemplate> Template = GetQueryTemplate(QueryID);
+	if (!Template.IsValid())
+	{
+		return INDEX_NONE;
+	}
 
+	FString Variables;
+	SerializeVariables(Template->DefaultVariables, RuntimeVariables, bUseNestedJson, Variables);
+
+	FGraphQLScheduledRequest Request;
+	Request.QueryID = QueryID;
+	Request.Lane = Template->Lane;
+	Request.bIncludeAuthToken = bIncludeAuthToken;
+	Request.bIsMutation = Template->bIsMutation;
+
+	if (!Template->bIsMutation)
+	{
+		Request.CacheKey = MakeCacheKey(QueryID, Variables);
+
+		int64 CachedRequestID;
+		if (ReplayCachedResponse(Request.CacheKey, CachedRequestID))
+		{
+			return CachedRequestID;
+		}
+	}
+
+	Request.PayloadKind = bUsePersistedQueries && bPersistedQueriesSupported && !Template->PersistedPrefix.IsEmpty()
+		                      ? EGraphQLPayloadKind::Persisted
+		                      : EGraphQLPayloadKind::Query;
+	AppendUtf8(Request.Variables, Variables);
+	Request.Template = Template;
+
+	return EnqueueRequest(MoveTemp(Request));
+}
+
+void UGraphQLService::SerializeVariables(const TMap<FString, FString>& DefaultVariables,
+                                         const TMap<FString, FString>& RuntimeVariables, const bool bUseNestedJson,
+                                         FString& OutVariables)
+{
+	const TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer =
+		TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&OutVariables);
+
+	if (!bUseNestedJson)
+	{
+		// Flat string variables are written straight out, runtime ones win over the defaults of the asset
+		Writer->WriteObjectStart();
+		for (const auto& Pair : RuntimeVariables)
+		{
+			Writer->WriteValue(Pair.Key, Pair.Value);
+		}
+		for (const auto& Pair : DefaultVariables)
+		{
+			if (!RuntimeVariables.Contains(Pair.Key))
+			{
+				Writer->WriteValue(Pair.Key, Pair.Value);
+			}
+		}
+		Writer->WriteObjectEnd();
+		Writer->Close();
 		return;
 	}
 
-	// Get HTTP module
-	FHttpModule* Http = &FHttpModule::Get();
-	if (!Http)
+	// Merge variables
+	const TSharedRef<FJsonObject> FinalVariables = MakeShared<FJsonObject>();
+
+	// Start with default vars from the asset
+	for (const auto& Pair : DefaultVariables)
+	{
+		FinalVariables->SetStringField(Pair.Key, Pair.Value);
+	}
+
+	for (const auto& Pair : RuntimeVariables)
 	{
-		UE_LOG(LogGraphQLService, Error, TEXT("GraphQL Service: Failed to get HTTP module"));
-		UE::Tasks::Launch(UE_SOURCE_LOCATION, [this]()
+		const FString& DotKey = Pair.Key;
+		const FString& Value = Pair.Value;
+
+		TArray<FString> Keys;
+		DotKey.ParseIntoArray(Keys, TEXT("."));
+
+		TSharedPtr<FJsonObject> Current = FinalVariables;
+
+		for (int32 i = 0; i < Keys.Num(); ++i)
 		{
-			OnComplete.ExecuteIfBound(false, TEXT("{\"error\": \"HTTP module not available\"}"));
-		}, LowLevelTasks::ETaskPriority::Normal, UE::Tasks::EExtendedTaskPriority::GameThreadNormalPri);
+			const FString& Key = Keys[i];
+
+			if (i == Keys.Num() - 1)
+			{
+				// Last key: set the value as number or string
+				if (Value.IsNumeric())
+				{
+					// Try parse as int first, fallback to double if needed
+					if (Value.IsNumeric() && !Value.Contains(TEXT(".")))
+					{
+						int64 IntVal = FCString::Atoi64(*Value);
+						Current->SetNumberField(Key, static_cast<double>(IntVal));
+					}
+					else
+					{
+						double DoubleVal = FCString::Atod(*Value);
+						Current->SetNumberField(Key, DoubleVal);
+					}
+				}
+				else
+				{
+					Current->SetStringField(Key, Value);
+				}
+			}
+			else
+			{
+				// Intermediate keys: descend or create nested object
+				TSharedPtr<FJsonObject> Next;
+				const TSharedPtr<FJsonObject>* ExistingPtr = nullptr;
+				if (Current->TryGetObjectField(Key, ExistingPtr) && ExistingPtr && ExistingPtr->IsValid())
+				{
+					Next = *ExistingPtr;
+				}
+				else
+				{
+					Next = MakeShared<FJsonObject>();
+					Current->SetObjectField(Key, Next);
+				}
+				Current = Next;
+			}
+		}
+	}
+
+	FJsonSerializer::Serialize(FinalVariables, Writer);
+}
+
+int64 UGraphQLService::EnqueueRequest(FGraphQLScheduledRequest&& Request)
+{
+	int64 RequestID;
+	{
+		FScopeLock Lock(&SchedulerLock);
 
+		if (!Request.CacheKey.IsEmpty())
+		{
+			// The services hear about the response of the pending one, asking twice gains nothing
+			if (const int64* PendingRequestID = PendingByCacheKey.Find(Request.CacheKey))
+			{
+				UE_LOG(LogGraphQLService, Verbose, TEXT("GraphQL Service: Query joins pending query %lld"), *PendingRequestID);
+				return *PendingRequestID;
+			}
+
+			PendingByCacheKey.Add(Request.CacheKey, NextRequestID);
+		}
+
+		RequestID = Request.RequestID = NextRequestID++;
+		Request.CacheGeneration = CacheGeneration;
+		QueuedRequests[static_cast<int32>(Request.Lane)].Add(MoveTemp(Request));
+	}
+
+	PumpRequestQueues();
+	return RequestID;
+}
+
+void UGraphQLService::PumpRequestQueues()
+{
+	if (bDeinitializing)
+	{
 		return;
 	}
 
-    // Create HTTP request
-	const TSharedRef<IHttpRequest> Request = Http->CreateRequest();
-	Request->SetURL(GetCurrentEndpoint());
-	Request->SetVerb(TEXT("POST"));
-	Request->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
-    Request->SetTimeout(30.0f);
+	TArray<TPair<int64, FHttpRequestRef>, TInlineAllocator<8>> Started;
+
+	// A request that fails to start frees its slot again
+	bool bSlotsFreed = true;
+	while (bSlotsFreed)
+	{
+		bSlotsFreed = false;
+		Started.Reset();
+
+		{
+			FScopeLock Lock(&SchedulerLock);
+
+			// Lanes in priority order
+			for (int32 Lane = 0; Lane < NUM_LANES; Lane++)
+			{
+				const FGraphQLLaneSettings& Settings = GetLaneSettings(static_cast<EGraphQLRequestLane>(Lane));
+				TArray<FGraphQLScheduledRequest>& Queue = QueuedRequests[Lane];
+
+				int32 NumStarted = 0;
+				while (NumStarted < Queue.Num() && NumInFlight[Lane] < Settings.MaxConcurrentRequests)
+				{
+					FGraphQLScheduledRequest& Request = Queue[NumStarted++];
+					const FHttpRequestRef HttpRequest = CreateHttpRequest(Request);
+					Request.HttpRequest = HttpRequest;
+
+					Started.Emplace(Request.RequestID, HttpRequest);
+					NumInFlight[Lane]++;
+					InFlightRequests.Add(Request.RequestID, MoveTemp(Request));
+				}
+
+				Queue.RemoveAt(0, NumStarted, EAllowShrinking::No);
+			}
+		}
+
+		for (const TPair<int64, FHttpRequestRef>& Pair : Started)
+		{
+			const FHttpRequestRef& HttpRequest = Pair.Value;
+
+			if (!HttpRequest->ProcessRequest())
+			{
+				UE_LOG(LogGraphQLService, Error, TEXT("GraphQL Service: Failed to process HTTP request"));
+
+				FGraphQLScheduledRequest Failed;
+				if (TakeInFlightRequest(Pair.Key, Failed))
+				{
+					{
+						FScopeLock Lock(&SchedulerLock);
+						ForgetPendingRequest(Failed);
+					}
+
+					bSlotsFreed = true;
+					AsyncTask(ENamedThreads::GameThread, [this]()
+					{
+						OnComplete.ExecuteIfBound(false, TEXT("{\"error\": \"Failed to process HTTP request\"}"));
+					});
+				}
+				continue;
+			}
+
+			// Stats
+			QueriesSentPerSecond.Increment();
+			int32 QuerySize = HttpRequest->GetVerb().Len();
+
+			TArray<FString> Headers = HttpRequest->GetAllHeaders();
+			for (const FString& Header : Headers)
+			{
+				QuerySize += Header.Len();
+			}
+
+			QuerySize += HttpRequest->GetContentLength();
+			QueriesBytesSentPerSecond.Set(QueriesBytesSentPerSecond.GetValue() + QuerySize);
+
+			UE_LOG(LogGraphQLService, Log, TEXT("GraphQL Service: GraphQL query %lld sent to %s"), Pair.Key, *GetCurrentEndpoint());
+		}
+	}
+}
+
+FHttpRequestRef UGraphQLService::CreateHttpRequest(const FGraphQLScheduledRequest& Request)
+{
+	const FHttpRequestRef HttpRequest = FHttpModule::Get().CreateRequest();
+	HttpRequest->SetURL(GraphQLEndpoint);
+	HttpRequest->SetVerb(TEXT("POST"));
+	HttpRequest->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
+	HttpRequest->SetTimeout(GetLaneSettings(Request.Lane).TimeoutSeconds);
 
 	// Add an authorization header only if requested and a token is available
-	if (bIncludeAuthToken && HasAuthToken())
+	if (Request.bIncludeAuthToken)
 	{
-		const FString AuthHeader = FString::Printf(TEXT("Bearer %s"), *AuthToken);
-		Request->SetHeader(TEXT("Authorization"), AuthHeader);
-		UE_LOG(LogGraphQLService, Log, TEXT("GraphQL Service: Added authorization header"));
+		if (!AuthorizationHeader.IsEmpty())
+		{
+			HttpRequest->SetHeader(TEXT("Authorization"), AuthorizationHeader);
+		}
+		else
+		{
+			UE_LOG(LogGraphQLService, Warning, TEXT("GraphQL Service: Auth requested but no token available"));
+		}
 	}
-	else if (bIncludeAuthToken && !HasAuthToken())
+
+	const FGraphQLQueryTemplate& Template = *Request.Template;
+	const TArray<uint8>& Prefix = Request.PayloadKind == EGraphQLPayloadKind::Persisted ? Template.PersistedPrefix
+		                              : Request.PayloadKind == EGraphQLPayloadKind::Register ? Template.RegisterPrefix
+		                              : Template.QueryPrefix;
+
+	TArray<uint8> Payload;
+	Payload.Reserve(Prefix.Num() + Request.Variables.Num() + 1);
+	Payload.Append(Prefix);
+	Payload.Append(Request.Variables);
+	Payload.Add('}');
+	HttpRequest->SetContent(MoveTemp(Payload));
+
+	HttpRequest->OnProcessRequestComplete().BindUObject(this, &UGraphQLService::OnHttpsRequestComplete, Request.RequestID);
+	return HttpRequest;
+}
+
+bool UGraphQLService::TakeInFlightRequest(const int64 RequestID, FGraphQLScheduledRequest& OutRequest)
+{
+	FScopeLock Lock(&SchedulerLock);
+	if (!InFlightRequests.RemoveAndCopyValue(RequestID, OutRequest))
+	{
+		return false;
+	}
+
+	NumInFlight[static_cast<int32>(OutRequest.Lane)]--;
+	OutRequest.HttpRequest.Reset();
+	return true;
+}
+
+bool UGraphQLService::ShouldRetry(const FGraphQLScheduledRequest& Request, const FHttpResponsePtr& Response,
+                                  const bool bWasSuccessful) const
+{
+	if (Request.Attempt >= GetLaneSettings(Request.Lane).MaxRetries)
+	{
+		return false;
+	}
+
+	if (!bWasSuccessful || !Response.IsValid())
+	{
+		// A mutation may have reached the server before the connection was lost
+		return !Request.bIsMutation;
+	}
+
+	const int32 ResponseCode = Response->GetResponseCode();
+
+	// Rejected before being processed
+	if (ResponseCode == EHttpResponseCodes::TooManyRequests || ResponseCode == EHttpResponseCodes::ServiceUnavail)
 	{
-		UE_LOG(LogGraphQLService, Warning, TEXT("GraphQL Service: Auth requested but no token available"));
+		return true;
 	}
-	else
+
+	return !Request.bIsMutation && (ResponseCode == EHttpResponseCodes::BadGateway || ResponseCode == EHttpResponseCodes::GatewayTimeout);
+}
+
+bool UGraphQLService::HandlePersistedQueryError(FGraphQLScheduledRequest& Request, const FHttpResponsePtr& Response)
+{
+	// Only the hash was sent. The error responses are small, a larger body is a result
+	if (Request.PayloadKind != EGraphQLPayloadKind::Persisted || !Response.IsValid() || Response->GetContent().Num() > 1024)
 	{
-		UE_LOG(LogGraphQLService, Log, TEXT("GraphQL Service: Sending request without authorization"));
+		return false;
 	}
 
-	// Create JSON payload
-	TSharedPtr<FJsonObject> JsonObject = MakeShareable(new FJsonObject);
-	JsonObject->SetStringField(TEXT("query"), Query);
+	const TArray<uint8>& Content = Response->GetContent();
+
+	if (ContainsText(Content, UTF8TEXTVIEW("PersistedQueryNotSupported")) ||
+	    ContainsText(Content, UTF8TEXTVIEW("PERSISTED_QUERY_NOT_SUPPORTED")))
+	{
+		UE_LOG(LogGraphQLService, Warning, TEXT("GraphQL Service: Persisted queries not supported by %s, sending query text"),
+		       *GetCurrentEndpoint());
+		bPersistedQueriesSupported = false;
+		Request.PayloadKind = EGraphQLPayloadKind::Query;
+		return true;
+	}
 
-	if (Variables.IsValid())
+	if (ContainsText(Content, UTF8TEXTVIEW("PersistedQueryNotFound")) ||
+	    ContainsText(Content, UTF8TEXTVIEW("PERSISTED_QUERY_NOT_FOUND")))
 	{
-		JsonObject->SetObjectField(TEXT("variables"), Variables);
+		UE_LOG(LogGraphQLService, Log, TEXT("GraphQL Service: Persisted query %lld not found, registering it"), Request.RequestID);
+		Request.PayloadKind = EGraphQLPayloadKind::Register;
+		return true;
 	}
 
-	FString OutputString;
-	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&OutputString);
-	FJsonSerializer::Serialize(JsonObject.ToSharedRef(), Writer);
+	return false;
+}
 
-	Request->SetContentAsString(OutputString);
+void UGraphQLService::ScheduleRetry(FGraphQLScheduledRequest&& Request)
+{
+	// Half fixed, half random, so a burst of failed requests does not come back in lockstep
+	const float Backoff = FMath::Min(RetryMaxDelay, RetryBaseDelay * FMath::Pow(2.0f, Request.Attempt));
+	const float Delay = FMath::Max(Backoff * 0.5f + FMath::FRandRange(0.0f, Backoff * 0.5f), KINDA_SMALL_NUMBER);
 
-    // Bind response delegate synchronously
-    Request->OnProcessRequestComplete().BindUObject(this, &UGraphQLService::OnHttpsRequestComplete);
+	Request.Attempt++;
+	const int64 RequestID = Request.RequestID;
 
+	UE_LOG(LogGraphQLService, Warning, TEXT("GraphQL Service: Retrying query %lld in %.2f s, attempt %d"), RequestID, Delay,
+	       Request.Attempt + 1);
 
-	// Execute request
-    if (!Request->ProcessRequest())
 	{
-		UE_LOG(LogGraphQLService, Error, TEXT("GraphQL Service: Failed to process HTTP request"));
-        AsyncTask(ENamedThreads::GameThread, [this]()
-        {
-            OnComplete.ExecuteIfBound(false, TEXT("{\"error\": \"Failed to process HTTP request\"}"));
-        });
+		FScopeLock Lock(&SchedulerLock);
+		AwaitingRetry.Add(RequestID, MoveTemp(Request));
 	}
-	else
+
+	// Cancelling removes the request from AwaitingRetry, which turns the timer into a no-op
+	FTimerHandle RetryTimerHandle;
+	GetGameInstance()->GetTimerManager().SetTimer(
+		RetryTimerHandle, FTimerDelegate::CreateUObject(this, &UGraphQLService::RetryRequest, RequestID), Delay, false);
+}
+
+void UGraphQLService::RetryRequest(const int64 RequestID)
+{
 	{
-		// Stats
-		QueriesSentPerSecond.Increment();
-		int32 QuerySize = 0;
-		QuerySize = Request->GetVerb().Len();
+		FScopeLock Lock(&SchedulerLock);
 
-		TArray<FString> Headers = Request->GetAllHeaders();
-		for (const FString& Header : Headers)
+		FGraphQLScheduledRequest Request;
+		if (!AwaitingRetry.RemoveAndCopyValue(RequestID, Request))
 		{
-			QuerySize += Header.Len();
+			return;
 		}
 
-		QuerySize += Request->GetContentLength();
-		QueriesBytesSentPerSecond.Set(QueriesBytesSentPerSecond.GetValue() + QuerySize);
-
-		UE_LOG(LogGraphQLService, Log, TEXT("GraphQL Service: GraphQL query sent to %s"), *GetCurrentEndpoint());
+		// Ahead of the requests queued since, it has waited the longest
+		QueuedRequests[static_cast<int32>(Request.Lane)].Insert(MoveTemp(Request), 0);
 	}
+
+	PumpRequestQueues();
 }
 
-void UGraphQLService::ExecuteQueryByID(EGraphQLQuery QueryID, const TMap<FString, FString>& RuntimeVariables,
-                                       const bool bIncludeAuthToken, const bool bUseNestedJson)
+bool UGraphQLService::CancelQuery(const int64 RequestID)
 {
-	UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, QueryID, RuntimeVariables, bIncludeAuthToken, bUseNestedJson]()
+	FHttpRequestPtr HttpRequest;
 	{
-		if (!GraphQLQueryDatabase)
+		FScopeLock Lock(&SchedulerLock);
+
+		FGraphQLScheduledRequest Request;
+		bool bFound = AwaitingRetry.RemoveAndCopyValue(RequestID, Request);
+
+		for (int32 Lane = 0; !bFound && Lane < NUM_LANES; Lane++)
 		{
-			UE_LOG(LogGraphQLService, Error, TEXT("GraphQL Service: QueryDatabase is null"));
-			UE::Tasks::Launch(UE_SOURCE_LOCATION, [this]()
+			const int32 Index = QueuedRequests[Lane].IndexOfByPredicate([RequestID](const FGraphQLScheduledRequest& Queued)
 			{
-				OnComplete.ExecuteIfBound(false, TEXT("{\"error\": \"Internal error: query database missing\"}"));
-			}, LowLevelTasks::ETaskPriority::Normal, UE::Tasks::EExtendedTaskPriority::GameThreadNormalPri);
-			return;
+				return Queued.RequestID == RequestID;
+			});
+
+			if (Index != INDEX_NONE)
+			{
+				Request = MoveTemp(QueuedRequests[Lane][Index]);
+				QueuedRequests[Lane].RemoveAt(Index);
+				bFound = true;
+			}
 		}
 
-		FGraphQLQueryDef QueryDef;
-		if (!GraphQLQueryDatabase->GetQueryByID(QueryID, QueryDef))
+		if (!bFound)
 		{
-			UE_LOG(LogGraphQLService, Error, TEXT("GraphQL Service: Query not found for ID %d"), static_cast<int32>(QueryID));
-			UE::Tasks::Launch(UE_SOURCE_LOCATION, [this]()
+			if (!InFlightRequests.RemoveAndCopyValue(RequestID, Request))
 			{
-				OnComplete.ExecuteIfBound(false, TEXT("{\"error\": \"Query not found\"}"));
-			}, LowLevelTasks::ETaskPriority::Normal, UE::Tasks::EExtendedTaskPriority::GameThreadNormalPri);
-			return;
+				return false;
+			}
+
+			NumInFlight[static_cast<int32>(Request.Lane)]--;
+			HttpRequest = Request.HttpRequest;
 		}
 
-		// Merge variables
-		const TSharedPtr<FJsonObject> FinalVariables = MakeShareable(new FJsonObject);
+		ForgetPendingRequest(Request);
+	}
+
+	UE_LOG(LogGraphQLService, Log, TEXT("GraphQL Service: Query %lld cancelled"), RequestID);
+
+	if (HttpRequest.IsValid())
+	{
+		// Completes with a failure that OnHttpsRequestComplete ignores, the request is no longer in flight
+		HttpRequest->CancelRequest();
+		PumpRequestQueues();
+	}
+
+	return true;
+}
+
+int32 UGraphQLService::CancelLane(const EGraphQLRequestLane Lane)
+{
+	TArray<int64> RequestIDs;
+	{
+		FScopeLock Lock(&SchedulerLock);
 
-		// Start with default vars from the asset
-		for (const auto& Pair : QueryDef.DefaultVariables)
+		// Waiting ones first, so no slot freed by a running one goes to a request about to be cancelled
+		for (const FGraphQLScheduledRequest& Request : QueuedRequests[static_cast<int32>(Lane)])
 		{
-			FinalVariables->SetStringField(Pair.Key, Pair.Value);
+			RequestIDs.Add(Request.RequestID);
 		}
 
-		if (!bUseNestedJson)
+		for (const TPair<int64, FGraphQLScheduledRequest>& Pair : AwaitingRetry)
 		{
-			// Overwrite/append with runtime vars
-			for (const auto& Pair : RuntimeVariables)
+			if (Pair.Value.Lane == Lane)
 			{
-				FinalVariables->SetStringField(Pair.Key, Pair.Value);
+				RequestIDs.Add(Pair.Key);
 			}
 		}
-		else
+
+		for (const TPair<int64, FGraphQLScheduledRequest>& Pair : InFlightRequests)
 		{
-			for (const auto& Pair : RuntimeVariables)
+			if (Pair.Value.Lane == Lane)
 			{
-				const FString& DotKey = Pair.Key;
-				const FString& Value = Pair.Value;
+				RequestIDs.Add(Pair.Key);
+			}
+		}
+	}
 
-				TArray<FString> Keys;
-				DotKey.ParseIntoArray(Keys, TEXT("."));
+	int32 NumCancelled = 0;
+	for (const int64 RequestID : RequestIDs)
+	{
+		NumCancelled += CancelQuery(RequestID) ? 1 : 0;
+	}
 
-				TSharedPtr<FJsonObject> Current = FinalVariables;
+	return NumCancelled;
+}
 
-				for (int32 i = 0; i < Keys.Num(); ++i)
-				{
-					const FString& Key = Keys[i];
+void UGraphQLService::OnHttpsRequestComplete(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful,
+                                             const int64 RequestID)
+{
+	FGraphQLScheduledRequest Finished;
+	if (!TakeInFlightRequest(RequestID, Finished))
+	{
+		// Cancelled
+		return;
+	}
 
-					if (i == Keys.Num() - 1)
-					{
-						// Last key: set the value as number or string
-						if (Value.IsNumeric())
-						{
-							// Try parse as int first, fallback to double if needed
-							if (Value.IsNumeric() && !Value.Contains(TEXT(".")))
-							{
-								int64 IntVal = FCString::Atoi64(*Value);
-								Current->SetNumberField(Key, static_cast<double>(IntVal));
-							}
-							else
-							{
-								double DoubleVal = FCString::Atod(*Value);
-								Current->SetNumberField(Key, DoubleVal);
-							}
-						}
-						else
-						{
-							Current->SetStringField(Key, Value);
-						}
-					}
-					else
-					{
-						// Intermediate keys: descend or create nested object
-						TSharedPtr<FJsonObject> Next;
-						const TSharedPtr<FJsonObject>* ExistingPtr = nullptr;
-						if (Current->TryGetObjectField(Key, ExistingPtr) && ExistingPtr && ExistingPtr->IsValid())
-						{
-							Next = *ExistingPtr;
-						}
-						else
-						{
-							Next = MakeShared<FJsonObject>();
-							Current->SetObjectField(Key, Next);
-						}
-						Current = Next;
-					}
-				}
-			}
+	if (HandlePersistedQueryError(Finished, Response))
+	{
+		{
+			// Not a failure, so it is resent right away and without using up an attempt
+			FScopeLock Lock(&SchedulerLock);
+			QueuedRequests[static_cast<int32>(Finished.Lane)].Insert(MoveTemp(Finished), 0);
 		}
+		PumpRequestQueues();
+		return;
+	}
 
-		// Delegate to the existing ExecuteGraphQLQuery
-		ExecuteGraphQLQuery(QueryDef.QueryBody, bIncludeAuthToken, FinalVariables);
-	}, LowLevelTasks::ETaskPriority::BackgroundNormal);
-}
+	if (ShouldRetry(Finished, Response, bWasSuccessful))
+	{
+		ScheduleRetry(MoveTemp(Finished));
+		PumpRequestQueues();
+		return;
+	}
 
-void UGraphQLService::OnHttpsRequestComplete(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
-{
-	UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, bWasSuccessful, Response]()
+	{
+		FScopeLock Lock(&SchedulerLock);
+		ForgetPendingRequest(Finished);
+	}
+
+	PumpRequestQueues();
+
+	if (Finished.bIsMutation && bWasSuccessful && Response.IsValid() && EHttpResponseCodes::IsOk(Response->GetResponseCode()))
+	{
+		InvalidateAfterMutation(Finished.QueryID);
+	}
+
+	// Decoding, parsing and the bulk chunk data all stay on this task, see ParseAndDispatchToServices
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, bWasSuccessful, Response, Finished = MoveTemp(Finished)]()
 	{
 		if (!bWasSuccessful || !Response.IsValid())
 		{
 			UE_LOG(LogGraphQLService, Error, TEXT("GraphQL Service: HTTP request failed"));
-        AsyncTask(ENamedThreads::GameThread, [this]()
-        {
-            OnComplete.ExecuteIfBound(false, TEXT("{\"error\": \"HTTP request failed\"}"));
-        });
+			AsyncTask(ENamedThreads::GameThread, [this]()
+			{
+				OnComplete.ExecuteIfBound(false, TEXT("{\"error\": \"HTTP request failed\"}"));
+			});
 
 			return;
 		}
 
-        const int32 ResponseCode = Response->GetResponseCode();
-        FString ResponseContent = Response->GetContentAsString();
+		const int32 ResponseCode = Response->GetResponseCode();
+		const TArray<uint8>& Content = Response->GetContent();
+
+		UE_LOG(LogGraphQLService, Log, TEXT("GraphQL Service: Response code: %d"), ResponseCode);
+		UE_LOG(LogGraphQLService, Verbose, TEXT("GraphQL Service: Response content length: %d"), Content.Num());
+
+		const bool bSuccess = (ResponseCode >= 200 && ResponseCode < 300);
+
+		if (!bSuccess)
+		{
+			UE_LOG(LogGraphQLService, Error, TEXT("GraphQL Service: Server returned error code: %d"), ResponseCode);
+			FString ResponseContent = Response->GetContentAsString();
+			if (ResponseContent.IsEmpty())
+			{
+				ResponseContent = FString::Printf(TEXT("{\"error\": \"Server returned status code %d\"}"), ResponseCode);
+			}
+
+			AsyncTask(ENamedThreads::GameThread, [this, ResponseContent = MoveTemp(ResponseContent)]()
+			{
+				OnComplete.ExecuteIfBound(false, ResponseContent);
+			});
+			return;
+		}
 
-        // Dispatch all follow-up work to the game thread for safety in packaged builds
-        AsyncTask(ENamedThreads::GameThread, [this, ResponseCode, ResponseContent]() mutable
-        {
-            UE_LOG(LogGraphQLService, Log, TEXT("GraphQL Service: Response code: %d"), ResponseCode);
-            UE_LOG(LogGraphQLService, Verbose, TEXT("GraphQL Service: Response content length: %d"), ResponseContent.Len());
+		ResponseReceivedPerSecond.Increment();
+		ResponseBytesReceivedPerSecond.Set(ResponseBytesReceivedPerSecond.GetValue() + Content.Num());
+		bIsReceivingData = true;
 
-            const bool bSuccess = (ResponseCode >= 200 && ResponseCode < 300);
+		StoreCachedResponse(Finished, Content);
+		HandleResponseContent(Content);
+	});
+}
 
-            if (!bSuccess)
-            {
-                UE_LOG(LogGraphQLService, Error, TEXT("GraphQL Service: Server returned error code: %d"), ResponseCode);
-                if (ResponseContent.IsEmpty())
-                {
-                    ResponseContent = FString::Printf(TEXT("{\"error\": \"Server returned status code %d\"}"), ResponseCode);
-                }
-                OnComplete.ExecuteIfBound(false, ResponseContent);
-                return;
-            }
+void UGraphQLService::HandleResponseContent(const TArray<uint8>& Content) const
+{
+	// Bulk chunk data is decoded straight from the UTF-8 bytes, everything else goes through the FJsonObject DOM
+	FString ResponseContent;
+	if (!VoxelService->HandleVoxelListGraphQLResponse(Content) && !ChunkService->HandleGetChunkResponse(Content))
+	{
+		ResponseContent = FString(FUTF8ToTCHAR(reinterpret_cast<const ANSICHAR*>(Content.GetData()), Content.Num()));
+		ParseAndDispatchToServices(ResponseContent);
+	}
 
-            ResponseReceivedPerSecond.Increment();
-            ResponseBytesReceivedPerSecond.Set(ResponseBytesReceivedPerSecond.GetValue() + ResponseContent.Len());
-        	bIsReceivingData = true;
+	// Queued after the handlers ParseAndDispatchToServices sent to the game thread, so it still runs after them
+	if (OnComplete.IsBound())
+	{
+		if (ResponseContent.IsEmpty())
+		{
+			ResponseContent = FString(FUTF8ToTCHAR(reinterpret_cast<const ANSICHAR*>(Content.GetData()), Content.Num()));
+		}
 
-            // Route to services on game thread
-            ParseAndDispatchToServices(ResponseContent);
+		AsyncTask(ENamedThreads::GameThread, [this, ResponseContent = MoveTemp(ResponseContent)]()
+		{
+			OnComplete.ExecuteIfBound(true, ResponseContent);
+		});
+	}
+}
 
-        	
-        	
-            OnComplete.ExecuteIfBound(true, ResponseContent);
-        });
-    });
+FString UGraphQLService::MakeCacheKey(const EGraphQLQuery QueryID, const FString& Variables) const
+{
+	return FString::Printf(TEXT("%d|%s"), static_cast<int32>(QueryID), *Variables);
+}
+
+bool UGraphQLService::ReplayCachedResponse(const FString& CacheKey, int64& OutRequestID)
+{
+	TSharedPtr<const TArray<uint8>> Content;
+	{
+		FScopeLock Lock(&SchedulerLock);
+
+		const FGraphQLCachedResponse* Cached = ResponseCache.Find(CacheKey);
+		if (!Cached)
+		{
+			return false;
+		}
+
+		if (Cached->ExpireTime <= FPlatformTime::Seconds())
+		{
+			ResponseCache.Remove(CacheKey);
+			return false;
+		}
+
+		Content = Cached->Content;
+		OutRequestID = NextRequestID++;
+	}
+
+	UE_LOG(LogGraphQLService, Verbose, TEXT("GraphQL Service: Query %lld answered from the cache"), OutRequestID);
+
+	// Same path as a response from the server, the services cannot tell the difference
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, Content = MoveTemp(Content)]()
+	{
+		HandleResponseContent(*Content);
+	});
+
+	return true;
+}
+
+void UGraphQLService::StoreCachedResponse(const FGraphQLScheduledRequest& Request, const TArray<uint8>& Content)
+{
+	const float* TimeToLive = Request.CacheKey.IsEmpty() ? nullptr : CacheTimeToLive.Find(Request.QueryID);
+	if (!TimeToLive || *TimeToLive <= 0.0f)
+	{
+		return;
+	}
+
+	// A response carrying errors is asked again next time
+	const FUtf8StringView ContentView(reinterpret_cast<const UTF8CHAR*>(Content.GetData()), Content.Num());
+	if (UE::String::FindFirst(ContentView, UTF8TEXTVIEW("\"errors\""), ESearchCase::CaseSensitive) != INDEX_NONE)
+	{
+		return;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	const TSharedRef<const TArray<uint8>> SharedContent = MakeShared<TArray<uint8>>(Content);
+
+	FScopeLock Lock(&SchedulerLock);
+	if (Request.CacheGeneration != CacheGeneration)
+	{
+		return;
+	}
+
+	if (ResponseCache.Num() >= MaxCachedResponses && !ResponseCache.Contains(Request.CacheKey))
+	{
+		// Expired entries first, then the one closest to expiring
+		for (auto It = ResponseCache.CreateIterator(); It; ++It)
+		{
+			if (It.Value().ExpireTime <= Now)
+			{
+				It.RemoveCurrent();
+			}
+		}
+
+		if (ResponseCache.Num() >= MaxCachedResponses)
+		{
+			const FString* Oldest = nullptr;
+			double OldestExpireTime = TNumericLimits<double>::Max();
+			for (const TPair<FString, FGraphQLCachedResponse>& Pair : ResponseCache)
+			{
+				if (Pair.Value.ExpireTime < OldestExpireTime)
+				{
+					Oldest = &Pair.Key;
+					OldestExpireTime = Pair.Value.ExpireTime;
+				}
+			}
+
+			if (Oldest)
+			{
+				ResponseCache.Remove(FString(*Oldest));
+			}
+		}
+	}
+
+	ResponseCache.Add(Request.CacheKey, FGraphQLCachedResponse { SharedContent, Now + *TimeToLive });
+}
+
+void UGraphQLService::ForgetPendingRequest(const FGraphQLScheduledRequest& Request)
+{
+	if (Request.CacheKey.IsEmpty())
+	{
+		return;
+	}
+
+	// An invalidation may have handed the key to a newer request already
+	if (const int64* PendingRequestID = PendingByCacheKey.Find(Request.CacheKey); PendingRequestID && *PendingRequestID == Request.RequestID)
+	{
+		PendingByCacheKey.Remove(Request.CacheKey);
+	}
+}
+
+void UGraphQLService::InvalidateCachedQuery(const EGraphQLQuery QueryID, const TMap<FString, FString>& RuntimeVariables,
+                                            const bool bUseNestedJson)
+{
+	const TSharedPtr<const FGraphQLQueryTemplate> Template = GetQueryTemplate(QueryID);
+	if (!Template.IsValid())
+	{
+		return;
+	}
+
+	FString Variables;
+	SerializeVariables(Template->DefaultVariables, RuntimeVariables, bUseNestedJson, Variables);
+	const FString CacheKey = MakeCacheKey(QueryID, Variables);
+
+	FScopeLock Lock(&SchedulerLock);
+	ResponseCache.Remove(CacheKey);
+
+	// A pending request may already carry the old data, the next one is sent on its own
+	PendingByCacheKey.Remove(CacheKey);
+	CacheGeneration++;
+}
+
+void UGraphQLService::InvalidateCachedQueries(const EGraphQLQuery QueryID)
+{
+	const FString KeyPrefix = MakeCacheKey(QueryID, FString());
+
+	FScopeLock Lock(&SchedulerLock);
+	for (auto It = ResponseCache.CreateIterator(); It; ++It)
+	{
+		if (It.Key().StartsWith(KeyPrefix, ESearchCase::CaseSensitive))
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	for (auto It = PendingByCacheKey.CreateIterator(); It; ++It)
+	{
+		if (It.Key().StartsWith(KeyPrefix, ESearchCase::CaseSensitive))
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	CacheGeneration++;
+}
+
+void UGraphQLService::InvalidateAfterMutation(const EGraphQLQuery QueryID)
+{
+	switch (QueryID)
+	{
+	case EGraphQLQuery::CreateAvatar:
+	case EGraphQLQuery::UpdateAvatarName:
+	case EGraphQLQuery::UpdateAvatarState:
+	case EGraphQLQuery::DeleteAvatar:
+		InvalidateCachedQueries(EGraphQLQuery::MyAvatars);
+		break;
+
+	case EGraphQLQuery::UpdateUserState:
+		InvalidateCachedQueries(EGraphQLQuery::GetUserState);
+		break;
+
+	case EGraphQLQuery::UpdateChunk:
+		InvalidateCachedQueries(EGraphQLQuery::VoxelList);
+		InvalidateCachedQueries(EGraphQLQuery::GetChunkByDistance);
+		break;
+
+	default:
+		break;
+	}
 }
 
 void UGraphQLService::ParseAndDispatchToServices(const FString& ResponseContent) const
@@ -389,40 +1073,81 @@ void UGraphQLService::ParseAndDispatchToServices(const FString& ResponseContent)
 			       *ErrorPath, ErrorCode, *ErrorMessage);
 		}
 
-		// Dispatch to the appropriate service based on an error type
-		switch (ErrorResponseType)
-		{
-		case EQueryResponseType::Login: UserService->HandleLoginResponse(ParsedData);
-			break;
-		case EQueryResponseType::Register: UserService->HandleRegisterResponse(ParsedData);
-			break;
-		case EQueryResponseType::UDP_Info: UDP_Service->HandleUDPAddressNotification(ParsedData);
-			break;
-		case EQueryResponseType::UpdateChunk: break;
-		case EQueryResponseType::GetChunkByDistance: break;
-		case EQueryResponseType::CreateAvatar: break;
-		case EQueryResponseType::MyAvatars: break;
-		case EQueryResponseType::UpdateAvatar: break;
-		case EQueryResponseType::UpdateAvatarState: break;
-		case EQueryResponseType::TeleportRequest: 
-			HandleTeleportResponse(ParsedData); 
-			break;
-		case EQueryResponseType::UpdateUserState:
-			UE_LOG(LogGraphQLService, Error, TEXT("UpdateUserState error reponse received!"));
-			UserStateService->HandleUpdateUserStateResponse(ParsedData);
-			break;
-		case EQueryResponseType::GetUserState:
-			UE_LOG(LogGraphQLService, Error, TEXT("GetUserState error reponse received!"));
-			UserStateService->HandleGetUserStateResponse(ParsedData);
-			break;
-		default:
-			UE_LOG(LogGraphQLService, Error, TEXT("Unknown error response type: %d"), static_cast<int32>(ErrorResponseType));
-			break;
-		}
+		AsyncTask(ENamedThreads::GameThread, [this, ErrorResponseType, ParsedData]()
+		{
+			DispatchErrorResponse(ErrorResponseType, ParsedData);
+		});
 
 		return; // Exit early since we handled the error
 	}
 
+	// Chunk data is decoded right here into FChunkDataContainer and handed to UChunkDataManager, which takes it under
+	// its own lock. These handlers broadcast their delegates through game thread tasks themselves
+	switch (ResponseType)
+	{
+	case GetChunkByDistance:
+		UE_LOG(LogGraphQLService, Log, TEXT("Handling get chunk response"));
+		ChunkService->HandleGetChunkResponse(ParsedData);
+		return;
+
+	case UpdateChunk:
+		UE_LOG(LogGraphQLService, Log, TEXT("Handling update chunk response"));
+		ChunkService->HandleUpdateChunkResponse(ParsedData);
+		return;
+
+	case VoxelList:
+		UE_LOG(LogGraphQLService, Log, TEXT("Handling voxel list response"));
+		VoxelService->HandleVoxelListGraphQLResponse(ParsedData);
+		return;
+
+	default:
+		break;
+	}
+
+	// The remaining responses are small and their handlers touch game state
+	AsyncTask(ENamedThreads::GameThread, [this, ResponseType, ParsedData]()
+	{
+		DispatchResponse(ResponseType, ParsedData);
+	});
+}
+
+void UGraphQLService::DispatchErrorResponse(const EQueryResponseType ErrorResponseType,
+                                            const TSharedPtr<FJsonObject>& ParsedData) const
+{
+	// Dispatch to the appropriate service based on an error type
+	switch (ErrorResponseType)
+	{
+	case EQueryResponseType::Login: UserService->HandleLoginResponse(ParsedData);
+		break;
+	case EQueryResponseType::Register: UserService->HandleRegisterResponse(ParsedData);
+		break;
+	case EQueryResponseType::UDP_Info: UDP_Service->HandleUDPAddressNotification(ParsedData);
+		break;
+	case EQueryResponseType::UpdateChunk: break;
+	case EQueryResponseType::GetChunkByDistance: break;
+	case EQueryResponseType::CreateAvatar: break;
+	case EQueryResponseType::MyAvatars: break;
+	case EQueryResponseType::UpdateAvatar: break;
+	case EQueryResponseType::UpdateAvatarState: break;
+	case EQueryResponseType::TeleportRequest: 
+		HandleTeleportResponse(ParsedData); 
+		break;
+	case EQueryResponseType::UpdateUserState:
+		UE_LOG(LogGraphQLService, Error, TEXT("UpdateUserState error reponse received!"));
+		UserStateService->HandleUpdateUserStateResponse(ParsedData);
+		break;
+	case EQueryResponseType::GetUserState:
+		UE_LOG(LogGraphQLService, Error, TEXT("GetUserState error reponse received!"));
+		UserStateService->HandleGetUserStateResponse(ParsedData);
+		break;
+	default:
+		UE_LOG(LogGraphQLService, Error, TEXT("Unknown error response type: %d"), static_cast<int32>(ErrorResponseType));
+		break;
+	}
+}
+
+void UGraphQLService::DispatchResponse(const EQueryResponseType ResponseType, const TSharedPtr<FJsonObject>& ParsedData) const
+{
 	switch (ResponseType)
 	{
 	case Login:
@@ -440,21 +1165,6 @@ void UGraphQLService::ParseAndDispatchToServices(const FString& ResponseContent)
 		UDP_Service->HandleUDPAddressNotification(ParsedData);
 		break;
 
-	case GetChunkByDistance:
-		UE_LOG(LogGraphQLService, Log, TEXT("Handling get chunk response"));
-		ChunkService->HandleGetChunkResponse(ParsedData);
-		break;
-
-	case UpdateChunk:
-		UE_LOG(LogGraphQLService, Log, TEXT("Handling update chunk response"));
-		ChunkService->HandleUpdateChunkResponse(ParsedData);
-		break;
-
-	case VoxelList:
-		UE_LOG(LogGraphQLService, Log, TEXT("Handling voxel list response"));
-		VoxelService->HandleVoxelListGraphQLResponse(ParsedData);
-		break;
-
 	case CreateAvatar:
 		UE_LOG(LogGraphQLService, Log, TEXT("Handling create avatar response"));
 		AvatarDataManager->HandleCreateAvatarResponse(ParsedData);
@@ -613,3 +1323,185 @@ void UGraphQLService::UpdateStats()
 	ResponseReceivedPerSecond.Set(0);
 	bIsReceivingData = false;
 }
+
+
+#if !UE_BUILD_SHIPPING
+
+namespace GraphQLServiceMock
+{
+	struct FLaneStats
+	{
+		int32 Received = 0;
+		int32 Failed = 0;
+		double LastArrival = 0.0;
+	};
+
+	// A GraphQL endpoint in this process that answers every POST after a delay, or fails it with a 503
+	struct FMockServer
+	{
+		TSharedPtr<IHttpRouter> Router;
+		FHttpRouteHandle Route;
+		FString PreviousEndpoint;
+		int32 LatencyMs = 250;
+		int32 FailurePercent = 25;
+		double StartTime = 0.0;
+		TMap<FString, FLaneStats> Lanes;
+	};
+
+	TUniquePtr<FMockServer> Server;
+
+	const TCHAR* LaneName(const EGraphQLRequestLane Lane)
+	{
+		switch (Lane)
+		{
+		case EGraphQLRequestLane::Interactive: return TEXT("Interactive");
+		case EGraphQLRequestLane::Bulk: return TEXT("Bulk");
+		default: return TEXT("Gameplay");
+		}
+	}
+
+	bool HandleRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+	{
+		if (!Server.IsValid())
+		{
+			return false;
+		}
+
+		// The harness tags every query with the lane it was sent on
+		FString MockLane = TEXT("Unknown");
+		TSharedPtr<FJsonObject> Body;
+		const FString BodyText(Request.Body.Num(), reinterpret_cast<const UTF8CHAR*>(Request.Body.GetData()));
+		const TSharedPtr<FJsonObject>* Variables;
+		if (FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(BodyText), Body) && Body.IsValid() &&
+		    Body->TryGetObjectField(TEXT("variables"), Variables))
+		{
+			(*Variables)->TryGetStringField(TEXT("mockLane"), MockLane);
+		}
+
+		const bool bFail = FMath::RandRange(0, 99) < Server->FailurePercent;
+
+		FLaneStats& Stats = Server->Lanes.FindOrAdd(MockLane);
+		Stats.Received++;
+		Stats.Failed += bFail ? 1 : 0;
+		Stats.LastArrival = FPlatformTime::Seconds() - Server->StartTime;
+
+		// Jittered around LatencyMs, so responses do not come back in the order they were sent
+		const float Delay = Server->LatencyMs * FMath::FRandRange(0.5f, 1.5f) / 1000.0f;
+		FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([OnComplete, bFail](float)
+		{
+			TUniquePtr<FHttpServerResponse> Response = FHttpServerResponse::Create(
+				bFail ? TEXT("{\"error\": \"Induced failure\"}") : TEXT("{\"data\":{}}"), TEXT("application/json"));
+			Response->Code = bFail ? EHttpServerResponseCodes::ServiceUnavail : EHttpServerResponseCodes::Ok;
+			OnComplete(MoveTemp(Response));
+			return false;
+		}), Delay);
+
+		return true;
+	}
+
+	UGraphQLService* GetService(const UWorld* World)
+	{
+		const UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+		return GameInstance ? GameInstance->GetSubsystem<UGraphQLService>() : nullptr;
+	}
+
+	void Start(const TArray<FString>& Args, UWorld* World)
+	{
+		UGraphQLService* Service = GetService(World);
+		if (!Service || Server.IsValid())
+		{
+			UE_LOG(LogGraphQLService, Warning, TEXT("GraphQL mock: no service, or already running"));
+			return;
+		}
+
+		int32 QueriesPerLane = 12;
+		int32 Port = 8089;
+		TUniquePtr<FMockServer> NewServer = MakeUnique<FMockServer>();
+		int32* const ArgValues[] = { &NewServer->LatencyMs, &NewServer->FailurePercent, &QueriesPerLane, &Port };
+		for (int32 Arg = 0; Arg < Args.Num() && Arg < UE_ARRAY_COUNT(ArgValues); Arg++)
+		{
+			LexFromString(*ArgValues[Arg], *Args[Arg]);
+		}
+
+		NewServer->Router = FHttpServerModule::Get().GetHttpRouter(Port, true);
+		if (!NewServer->Router.IsValid())
+		{
+			UE_LOG(LogGraphQLService, Error, TEXT("GraphQL mock: could not bind port %d"), Port);
+			return;
+		}
+
+		NewServer->Route = NewServer->Router->BindRoute(FHttpPath(TEXT("/graphql")), EHttpServerRequestVerbs::VERB_POST,
+		                                                FHttpRequestHandler::CreateStatic(&HandleRequest));
+		FHttpServerModule::Get().StartAllListeners();
+
+		NewServer->PreviousEndpoint = Service->GetCurrentEndpoint();
+		NewServer->StartTime = FPlatformTime::Seconds();
+		Server = MoveTemp(NewServer);
+
+		Service->SetEndpoint(FString::Printf(TEXT("http://127.0.0.1:%d/graphql"), Port));
+
+		// Bulk first, so the other lanes have to get past a full bulk queue
+		const TPair<EGraphQLQuery, EGraphQLRequestLane> Queries[] = {
+			{ EGraphQLQuery::VoxelList, EGraphQLRequestLane::Bulk },
+			{ EGraphQLQuery::MyAvatars, EGraphQLRequestLane::Gameplay },
+			{ EGraphQLQuery::GetUserState, EGraphQLRequestLane::Interactive }
+		};
+
+		for (const TPair<EGraphQLQuery, EGraphQLRequestLane>& Query : Queries)
+		{
+			for (int32 Index = 0; Index < QueriesPerLane; Index++)
+			{
+				// Distinct variables, identical queries would join each other
+				const TMap<FString, FString> Variables {
+					{ TEXT("mockLane"), LaneName(Query.Value) },
+					{ TEXT("mockIndex"), LexToString(Index) }
+				};
+				Service->ExecuteQueryByID(Query.Key, Variables, false);
+			}
+		}
+
+		UE_LOG(LogGraphQLService, Display, TEXT("GraphQL mock: %d queries per lane sent to port %d, %d ms latency, %d%% failures. "
+			       "CK.Network.GraphQLMockReport prints the result"), QueriesPerLane, Port, Server->LatencyMs, Server->FailurePercent);
+	}
+
+	void Report(const TArray<FString>& Args, UWorld* World)
+	{
+		if (!Server.IsValid())
+		{
+			UE_LOG(LogGraphQLService, Warning, TEXT("GraphQL mock: not running"));
+			return;
+		}
+
+		// Received counts retries too, each of them follows an induced failure
+		for (const TPair<FString, FLaneStats>& Pair : Server->Lanes)
+		{
+			UE_LOG(LogGraphQLService, Display, TEXT("GraphQL mock: %s lane, %d received, %d failed, last one %.2f s after the start"),
+			       *Pair.Key, Pair.Value.Received, Pair.Value.Failed, Pair.Value.LastArrival);
+		}
+
+		// Nothing the mock answered stays cached
+		if (UGraphQLService* Service = GetService(World))
+		{
+			Service->InvalidateCachedQueries(EGraphQLQuery::VoxelList);
+			Service->InvalidateCachedQueries(EGraphQLQuery::MyAvatars);
+			Service->InvalidateCachedQueries(EGraphQLQuery::GetUserState);
+			Service->SetEndpoint(Server->PreviousEndpoint);
+		}
+
+		Server->Router->UnbindRoute(Server->Route);
+		Server.Reset();
+	}
+
+	FAutoConsoleCommandWithWorldAndArgs StartCommand(
+		TEXT("CK.Network.GraphQLMock"),
+		TEXT("Starts a mock GraphQL server in this process and sends it bulk, gameplay and interactive queries. The services log "
+			"its empty answers as unknown responses. Args: [LatencyMs=250] [FailurePercent=25] [QueriesPerLane=12] [Port=8089]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&Start));
+
+	FAutoConsoleCommandWithWorldAndArgs ReportCommand(
+		TEXT("CK.Network.GraphQLMockReport"),
+		TEXT("Prints what the CK.Network.GraphQLMock server received per lane, then stops it and restores the endpoint"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&Report));
+}
+
+#endif
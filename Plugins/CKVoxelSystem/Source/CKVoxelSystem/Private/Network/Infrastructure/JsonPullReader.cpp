@@ -0,0 +1,296 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Network/Infrastructure/JsonPullReader.h"
+
+FJsonPullReader::FJsonPullReader(const TConstArrayView<uint8> InData)
+	: Cursor(reinterpret_cast<const UTF8CHAR*>(InData.GetData()))
+	, End(reinterpret_cast<const UTF8CHAR*>(InData.GetData()) + InData.Num())
+{
+	// Skip a byte order mark
+	if (End - Cursor >= 3 && Cursor[0] == 0xEF && Cursor[1] == 0xBB && Cursor[2] == 0xBF)
+	{
+		Cursor += 3;
+	}
+}
+
+FJsonPullReader::EToken FJsonPullReader::Next()
+{
+	if (Token == EToken::Error)
+	{
+		return Token;
+	}
+
+	while (Cursor < End)
+	{
+		const UTF8CHAR Char = *Cursor;
+		switch (Char)
+		{
+		case ' ':
+		case '\t':
+		case '\r':
+		case '\n':
+		case ':':
+			Cursor++;
+			continue;
+
+		case ',':
+			Cursor++;
+			bExpectKey = !Containers.IsEmpty() && Containers.Last();
+			continue;
+
+		case '{':
+		case '[':
+			Cursor++;
+			Containers.Add(Char == '{');
+			bExpectKey = Char == '{';
+			return Token = Char == '{' ? EToken::BeginObject : EToken::BeginArray;
+
+		case '}':
+		case ']':
+			if (Containers.IsEmpty() || Containers.Last() != (Char == '}'))
+			{
+				return Fail();
+			}
+			Cursor++;
+			Containers.Pop(EAllowShrinking::No);
+			bExpectKey = false;
+			return Token = Char == '}' ? EToken::EndObject : EToken::EndArray;
+
+		case '"':
+		{
+			const UTF8CHAR* Start = ++Cursor;
+			bHasEscapes = false;
+
+			while (Cursor < End && *Cursor != '"')
+			{
+				if (*Cursor == '\\')
+				{
+					bHasEscapes = true;
+					if (++Cursor == End)
+					{
+						break;
+					}
+				}
+				Cursor++;
+			}
+
+			if (Cursor >= End)
+			{
+				return Fail();
+			}
+
+			Text = FUtf8StringView(Start, static_cast<int32>(Cursor - Start));
+			Cursor++;
+
+			if (bExpectKey)
+			{
+				bExpectKey = false;
+				return Token = EToken::Key;
+			}
+			return Token = EToken::String;
+		}
+
+		case 't':
+			return ReadLiteral(UTF8TEXTVIEW("true"), EToken::True);
+
+		case 'f':
+			return ReadLiteral(UTF8TEXTVIEW("false"), EToken::False);
+
+		case 'n':
+			return ReadLiteral(UTF8TEXTVIEW("null"), EToken::Null);
+
+		default:
+		{
+			if (Char != '-' && (Char < '0' || Char > '9'))
+			{
+				return Fail();
+			}
+
+			const UTF8CHAR* Start = Cursor;
+			while (Cursor < End && ((*Cursor >= '0' && *Cursor <= '9') || *Cursor == '-' || *Cursor == '+' ||
+			                        *Cursor == '.' || *Cursor == 'e' || *Cursor == 'E'))
+			{
+				Cursor++;
+			}
+
+			Text = FUtf8StringView(Start, static_cast<int32>(Cursor - Start));
+			return Token = EToken::Number;
+		}
+		}
+	}
+
+	// Ran out of input inside a container
+	if (!Containers.IsEmpty())
+	{
+		return Fail();
+	}
+
+	return Token = EToken::None;
+}
+
+bool FJsonPullReader::GetInt64(int64& OutValue) const
+{
+	if ((Token != EToken::String && Token != EToken::Number) || Text.IsEmpty())
+	{
+		return false;
+	}
+
+	const bool bNegative = Text[0] == '-';
+	int32 Index = bNegative ? 1 : 0;
+	if (Index == Text.Len())
+	{
+		return false;
+	}
+
+	uint64 Value = 0;
+	for (; Index < Text.Len(); Index++)
+	{
+		const UTF8CHAR Digit = Text[Index];
+		if (Digit < '0' || Digit > '9')
+		{
+			return false;
+		}
+		Value = Value * 10 + (Digit - '0');
+	}
+
+	OutValue = bNegative ? -static_cast<int64>(Value) : static_cast<int64>(Value);
+	return true;
+}
+
+void FJsonPullReader::GetUnescapedText(TArray<UTF8CHAR>& OutText) const
+{
+	OutText.Reset(Text.Len());
+
+	auto AppendCodePoint = [&OutText](const uint32 CodePoint)
+	{
+		if (CodePoint < 0x80)
+		{
+			OutText.Add(static_cast<UTF8CHAR>(CodePoint));
+		}
+		else if (CodePoint < 0x800)
+		{
+			OutText.Add(static_cast<UTF8CHAR>(0xC0 | (CodePoint >> 6)));
+			OutText.Add(static_cast<UTF8CHAR>(0x80 | (CodePoint & 0x3F)));
+		}
+		else if (CodePoint < 0x10000)
+		{
+			OutText.Add(static_cast<UTF8CHAR>(0xE0 | (CodePoint >> 12)));
+			OutText.Add(static_cast<UTF8CHAR>(0x80 | ((CodePoint >> 6) & 0x3F)));
+			OutText.Add(static_cast<UTF8CHAR>(0x80 | (CodePoint & 0x3F)));
+		}
+		else
+		{
+			OutText.Add(static_cast<UTF8CHAR>(0xF0 | (CodePoint >> 18)));
+			OutText.Add(static_cast<UTF8CHAR>(0x80 | ((CodePoint >> 12) & 0x3F)));
+			OutText.Add(static_cast<UTF8CHAR>(0x80 | ((CodePoint >> 6) & 0x3F)));
+			OutText.Add(static_cast<UTF8CHAR>(0x80 | (CodePoint & 0x3F)));
+		}
+	};
+
+	auto ReadHex4 = [this](const int32 Start, uint32& OutCodeUnit)
+	{
+		if (Start + 4 > Text.Len())
+		{
+			return false;
+		}
+
+		OutCodeUnit = 0;
+		for (int32 Index = Start; Index < Start + 4; Index++)
+		{
+			const UTF8CHAR Char = Text[Index];
+			const int32 Digit = (Char >= '0' && Char <= '9') ? Char - '0'
+				: (Char >= 'a' && Char <= 'f') ? Char - 'a' + 10
+				: (Char >= 'A' && Char <= 'F') ? Char - 'A' + 10
+				: -1;
+			if (Digit < 0)
+			{
+				return false;
+			}
+			OutCodeUnit = (OutCodeUnit << 4) | Digit;
+		}
+		return true;
+	};
+
+	for (int32 Index = 0; Index < Text.Len(); Index++)
+	{
+		if (Text[Index] != '\\' || Index + 1 == Text.Len())
+		{
+			OutText.Add(Text[Index]);
+			continue;
+		}
+
+		const UTF8CHAR Escaped = Text[++Index];
+		switch (Escaped)
+		{
+		case 'b': OutText.Add(static_cast<UTF8CHAR>('\b')); break;
+		case 'f': OutText.Add(static_cast<UTF8CHAR>('\f')); break;
+		case 'n': OutText.Add(static_cast<UTF8CHAR>('\n')); break;
+		case 'r': OutText.Add(static_cast<UTF8CHAR>('\r')); break;
+		case 't': OutText.Add(static_cast<UTF8CHAR>('\t')); break;
+		case 'u':
+		{
+			uint32 CodePoint;
+			if (!ReadHex4(Index + 1, CodePoint))
+			{
+				OutText.Add(Escaped);
+				break;
+			}
+			Index += 4;
+
+			// Surrogate pair
+			uint32 Low;
+			if (CodePoint >= 0xD800 && CodePoint < 0xDC00 && Index + 2 < Text.Len() && Text[Index + 1] == '\\' &&
+			    Text[Index + 2] == 'u' && ReadHex4(Index + 3, Low) && Low >= 0xDC00 && Low < 0xE000)
+			{
+				CodePoint = 0x10000 + ((CodePoint - 0xD800) << 10) + (Low - 0xDC00);
+				Index += 6;
+			}
+
+			AppendCodePoint(CodePoint);
+			break;
+		}
+		// \" \\ \/
+		default: OutText.Add(Escaped); break;
+		}
+	}
+}
+
+bool FJsonPullReader::SkipValue()
+{
+	// A key followed by the end of its object has no value
+	if (Token == EToken::Key && (Next() == EToken::EndObject || Token == EToken::EndArray))
+	{
+		return false;
+	}
+
+	if (Token == EToken::BeginObject || Token == EToken::BeginArray)
+	{
+		const int32 Depth = Containers.Num() - 1;
+		while (Containers.Num() > Depth)
+		{
+			if (Next() == EToken::Error || Token == EToken::None)
+			{
+				return false;
+			}
+		}
+	}
+
+	return Token != EToken::Error;
+}
+
+FJsonPullReader::EToken FJsonPullReader::ReadLiteral(const FUtf8StringView Literal, const EToken LiteralToken)
+{
+	if (End - Cursor < Literal.Len() || !FUtf8StringView(Cursor, Literal.Len()).Equals(Literal, ESearchCase::CaseSensitive))
+	{
+		return Fail();
+	}
+
+	Cursor += Literal.Len();
+	return Token = LiteralToken;
+}
+
+FJsonPullReader::EToken FJsonPullReader::Fail()
+{
+	Cursor = End;
+	return Token = EToken::Error;
+}
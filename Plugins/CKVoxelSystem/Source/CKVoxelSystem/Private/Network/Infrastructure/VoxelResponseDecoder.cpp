@@ -0,0 +1,560 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Network/Infrastructure/VoxelResponseDecoder.h"
+#include "Misc/Base64.h"
+#include "Network/Infrastructure/JsonPullReader.h"
+#include "Shared/Types/Structures/Voxels/FVoxelState.h"
+
+#if !UE_BUILD_SHIPPING
+#include "HAL/IConsoleManager.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Shared/Types/Core/Common.h"
+#endif
+
+DEFINE_LOG_CATEGORY(LogVoxelResponseDecoder);
+
+namespace VoxelResponseDecoder
+{
+	namespace
+	{
+		using EToken = FJsonPullReader::EToken;
+
+		// Reused for every voxel state of a response
+		struct FScratch
+		{
+			TArray<UTF8CHAR> Unescaped;
+			TArray<uint8> Bytes;
+		};
+
+		struct FVoxelStateFields
+		{
+			int64 Coordinates[3] = {};
+			int64 VoxelType = 0;
+			bool bHasCoordinates = false;
+			bool bHasType = false;
+			bool bHasState = false;
+			// The state was decoded into FScratch::Bytes
+			bool bStateDecoded = false;
+		};
+
+		// Moves the reader onto the opening of data.<Operation>. False if data holds another operation or errors come first
+		bool EnterOperation(FJsonPullReader& Reader, const FUtf8StringView Operation)
+		{
+			if (Reader.Next() != EToken::BeginObject)
+			{
+				return false;
+			}
+
+			while (Reader.Next() == EToken::Key)
+			{
+				if (Reader.IsKey(UTF8TEXTVIEW("data")))
+				{
+					return Reader.Next() == EToken::BeginObject && Reader.Next() == EToken::Key && Reader.IsKey(Operation) &&
+					       Reader.Next() == EToken::BeginObject;
+				}
+
+				if (Reader.IsKey(UTF8TEXTVIEW("errors")) || !Reader.SkipValue())
+				{
+					return false;
+				}
+			}
+
+			return false;
+		}
+
+		// Reads the rest of the response after the operation, false if it is malformed or carries errors
+		bool FinishResponse(FJsonPullReader& Reader)
+		{
+			while (Reader.GetDepth() > 0)
+			{
+				const EToken Token = Reader.Next();
+				if (Token == EToken::Key)
+				{
+					if (Reader.GetDepth() == 1 && Reader.IsKey(UTF8TEXTVIEW("errors")))
+					{
+						// UQueryMessageParser treats any non empty errors array as an error response
+						if (Reader.Next() == EToken::BeginArray && Reader.Next() != EToken::EndArray)
+						{
+							return false;
+						}
+						continue;
+					}
+
+					if (!Reader.SkipValue())
+					{
+						return false;
+					}
+				}
+				else if (Token != EToken::EndObject)
+				{
+					return false;
+				}
+			}
+
+			return Reader.Next() == EToken::None;
+		}
+
+		// The reader is on the object's BeginObject. False if a coordinate is missing, check the reader for errors
+		bool ReadCoordinates(FJsonPullReader& Reader, int64 (&OutCoordinates)[3])
+		{
+			bool bFound[3] = {};
+
+			while (Reader.Next() == EToken::Key)
+			{
+				const int32 Axis = Reader.IsKey(UTF8TEXTVIEW("x")) ? 0
+					: Reader.IsKey(UTF8TEXTVIEW("y")) ? 1
+					: Reader.IsKey(UTF8TEXTVIEW("z")) ? 2
+					: INDEX_NONE;
+
+				if (Axis != INDEX_NONE && Reader.Next() != EToken::BeginObject && Reader.GetToken() != EToken::BeginArray)
+				{
+					bFound[Axis] = Reader.GetInt64(OutCoordinates[Axis]);
+				}
+				else if (!Reader.SkipValue())
+				{
+					return false;
+				}
+			}
+
+			return Reader.GetToken() == EToken::EndObject && bFound[0] && bFound[1] && bFound[2];
+		}
+
+		// The reader is on the string
+		bool DecodeBase64(const FJsonPullReader& Reader, FScratch& Scratch, TArray<uint8>& OutBytes)
+		{
+			FUtf8StringView Encoded = Reader.GetText();
+			if (Reader.HasEscapes())
+			{
+				// Some encoders escape the '/' of the Base64 alphabet
+				Reader.GetUnescapedText(Scratch.Unescaped);
+				Encoded = FUtf8StringView(Scratch.Unescaped.GetData(), Scratch.Unescaped.Num());
+			}
+
+			// Base64 is plain ASCII
+			const ANSICHAR* Source = reinterpret_cast<const ANSICHAR*>(Encoded.GetData());
+			const uint32 Length = static_cast<uint32>(Encoded.Len());
+
+			OutBytes.SetNumUninitialized(FBase64::GetDecodedDataSize(Source, Length), EAllowShrinking::No);
+			return FBase64::Decode(Source, Length, OutBytes.GetData());
+		}
+
+		// The reader is on the element's BeginObject. False if the response is malformed
+		bool ReadVoxelStateElement(FJsonPullReader& Reader, const FUtf8StringView CoordinatesKey, FScratch& Scratch,
+		                           FVoxelStateFields& OutFields)
+		{
+			while (Reader.Next() == EToken::Key)
+			{
+				if (Reader.IsKey(CoordinatesKey))
+				{
+					if (Reader.Next() == EToken::BeginObject)
+					{
+						OutFields.bHasCoordinates = ReadCoordinates(Reader, OutFields.Coordinates);
+					}
+					else if (!Reader.SkipValue())
+					{
+						return false;
+					}
+				}
+				else if (Reader.IsKey(UTF8TEXTVIEW("voxelType")))
+				{
+					Reader.Next();
+					OutFields.bHasType = Reader.GetInt64(OutFields.VoxelType);
+					if (!OutFields.bHasType && !Reader.SkipValue())
+					{
+						return false;
+					}
+				}
+				else if (Reader.IsKey(UTF8TEXTVIEW("state")))
+				{
+					if (Reader.Next() == EToken::String)
+					{
+						OutFields.bHasState = true;
+						OutFields.bStateDecoded = DecodeBase64(Reader, Scratch, Scratch.Bytes);
+					}
+					else if (!Reader.SkipValue())
+					{
+						return false;
+					}
+				}
+				else if (!Reader.SkipValue())
+				{
+					return false;
+				}
+			}
+
+			return Reader.GetToken() == EToken::EndObject;
+		}
+
+		// The reader is on the chunk's BeginObject. False if the response is malformed
+		bool ReadChunk(FJsonPullReader& Reader, FScratch& Scratch, FChunkDataContainer& OutChunk, bool& bOutValid)
+		{
+			int64 Coordinates[3] = {};
+			bool bHasCoordinates = false;
+			bool bHasVoxels = false;
+
+			while (Reader.Next() == EToken::Key)
+			{
+				if (Reader.IsKey(UTF8TEXTVIEW("coordinates")))
+				{
+					if (Reader.Next() == EToken::BeginObject)
+					{
+						bHasCoordinates = ReadCoordinates(Reader, Coordinates);
+					}
+					else if (!Reader.SkipValue())
+					{
+						return false;
+					}
+				}
+				else if (Reader.IsKey(UTF8TEXTVIEW("voxels")))
+				{
+					// Straight into the chunk's own voxel array
+					if (Reader.Next() == EToken::String)
+					{
+						bHasVoxels = DecodeBase64(Reader, Scratch, OutChunk.VoxelData);
+					}
+					else if (!Reader.SkipValue())
+					{
+						return false;
+					}
+				}
+				else if (Reader.IsKey(UTF8TEXTVIEW("voxelStates")))
+				{
+					if (Reader.Next() != EToken::BeginArray)
+					{
+						if (!Reader.SkipValue())
+						{
+							return false;
+						}
+						continue;
+					}
+
+					while (Reader.Next() == EToken::BeginObject)
+					{
+						FVoxelStateFields Fields;
+						if (!ReadVoxelStateElement(Reader, UTF8TEXTVIEW("voxelCoord"), Scratch, Fields))
+						{
+							return false;
+						}
+
+						if (!Fields.bHasCoordinates || !Fields.bHasType || !Fields.bStateDecoded)
+						{
+							UE_LOG(LogVoxelResponseDecoder, Warning, TEXT("Failed to extract voxel state fields"));
+							continue;
+						}
+
+						FVoxelState VoxelState;
+						VoxelState.DeserializeFromBytes(Scratch.Bytes);
+
+						OutChunk.VoxelStatesMap.Add(
+							FVoxelCoordinate(static_cast<uint8>(Fields.Coordinates[0]), static_cast<uint8>(Fields.Coordinates[1]),
+							                 static_cast<uint8>(Fields.Coordinates[2])),
+							FVoxelDefinition(1, static_cast<uint8>(Fields.VoxelType), VoxelState));
+					}
+
+					if (Reader.GetToken() != EToken::EndArray)
+					{
+						return false;
+					}
+				}
+				else if (!Reader.SkipValue())
+				{
+					return false;
+				}
+			}
+
+			if (Reader.GetToken() != EToken::EndObject)
+			{
+				return false;
+			}
+
+			bOutValid = bHasCoordinates && bHasVoxels;
+			if (!bOutValid)
+			{
+				UE_LOG(LogVoxelResponseDecoder, Warning, TEXT("Skipping chunk without coordinates or voxel data"));
+				return true;
+			}
+
+			OutChunk.ChunkCoordinate = FInt64Vector(Coordinates[0], Coordinates[1], Coordinates[2]);
+			return true;
+		}
+	}
+
+	EResult DecodeVoxelList(const TConstArrayView<uint8> Utf8Response, FInt64Vector& OutChunkCoordinate,
+	                        FChunkDataContainer& OutData)
+	{
+		FJsonPullReader Reader(Utf8Response);
+		if (!EnterOperation(Reader, UTF8TEXTVIEW("getVoxelList")))
+		{
+			return EResult::Unhandled;
+		}
+
+		FScratch Scratch;
+		int64 Coordinates[3] = {};
+		bool bHasCoordinates = false;
+		bool bHasVoxels = false;
+		bool bMalformed = false;
+
+		while (!bMalformed && Reader.Next() == EToken::Key)
+		{
+			if (Reader.IsKey(UTF8TEXTVIEW("coordinates")))
+			{
+				if (Reader.Next() == EToken::BeginObject)
+				{
+					bHasCoordinates = ReadCoordinates(Reader, Coordinates);
+				}
+				else
+				{
+					bMalformed = !Reader.SkipValue();
+				}
+			}
+			else if (Reader.IsKey(UTF8TEXTVIEW("voxels")))
+			{
+				if (Reader.Next() != EToken::BeginArray)
+				{
+					bMalformed = !Reader.SkipValue();
+					continue;
+				}
+
+				bHasVoxels = true;
+
+				while (Reader.Next() == EToken::BeginObject)
+				{
+					FVoxelStateFields Fields;
+					if (!ReadVoxelStateElement(Reader, UTF8TEXTVIEW("location"), Scratch, Fields))
+					{
+						break;
+					}
+
+					if (!Fields.bHasCoordinates)
+					{
+						UE_LOG(LogVoxelResponseDecoder, Warning, TEXT("Coordinates not found in voxel list element object"));
+						continue;
+					}
+
+					if (!Fields.bHasType)
+					{
+						UE_LOG(LogVoxelResponseDecoder, Warning, TEXT("Failed to extract core voxel list item(s)"));
+					}
+
+					FVoxelState VoxelState; // default-initialized
+					if (!Fields.bHasState)
+					{
+						UE_LOG(LogVoxelResponseDecoder, Warning, TEXT("Failed to extract voxel state"));
+					}
+					else if (!Fields.bStateDecoded)
+					{
+						UE_LOG(LogVoxelResponseDecoder, Warning, TEXT("Failed to decode voxel state, using default"));
+					}
+					else if (Scratch.Bytes.Num() < static_cast<int32>(sizeof(FVoxelState)))
+					{
+						UE_LOG(LogVoxelResponseDecoder, Warning, TEXT("Decoded state too small, using default"));
+					}
+					else
+					{
+						VoxelState.DeserializeFromBytes(Scratch.Bytes);
+					}
+
+					OutData.VoxelStatesMap.Add(
+						FVoxelCoordinate(static_cast<uint8>(Fields.Coordinates[0]), static_cast<uint8>(Fields.Coordinates[1]),
+						                 static_cast<uint8>(Fields.Coordinates[2])),
+						FVoxelDefinition(1, static_cast<uint8>(Fields.VoxelType), VoxelState));
+				}
+
+				bMalformed = Reader.GetToken() != EToken::EndArray;
+			}
+			else
+			{
+				bMalformed = !Reader.SkipValue();
+			}
+		}
+
+		bMalformed |= Reader.GetToken() != EToken::EndObject;
+
+		if (!bHasCoordinates)
+		{
+			OutData = FChunkDataContainer();
+			return EResult::Unhandled;
+		}
+
+		OutChunkCoordinate = FInt64Vector(Coordinates[0], Coordinates[1], Coordinates[2]);
+		OutData.ChunkCoordinate = OutChunkCoordinate;
+
+		if (bMalformed || !bHasVoxels)
+		{
+			UE_LOG(LogVoxelResponseDecoder, Error, TEXT("Failed to extract voxel list from json"));
+			OutData.VoxelStatesMap.Reset();
+			return EResult::Failed;
+		}
+
+		if (!FinishResponse(Reader))
+		{
+			OutData = FChunkDataContainer();
+			return EResult::Unhandled;
+		}
+
+		return EResult::Decoded;
+	}
+
+	EResult DecodeChunksByDistance(const TConstArrayView<uint8> Utf8Response, TArray<FChunkDataContainer>& OutChunks)
+	{
+		FJsonPullReader Reader(Utf8Response);
+		if (!EnterOperation(Reader, UTF8TEXTVIEW("getChunksByDistance")))
+		{
+			return EResult::Unhandled;
+		}
+
+		FScratch Scratch;
+		bool bHasChunks = false;
+		bool bMalformed = false;
+
+		while (!bMalformed && Reader.Next() == EToken::Key)
+		{
+			if (!Reader.IsKey(UTF8TEXTVIEW("chunks")) || Reader.Next() != EToken::BeginArray)
+			{
+				bMalformed = !Reader.SkipValue();
+				continue;
+			}
+
+			bHasChunks = true;
+
+			while (!bMalformed && Reader.Next() == EToken::BeginObject)
+			{
+				FChunkDataContainer& Chunk = OutChunks.AddDefaulted_GetRef();
+
+				bool bValid = false;
+				bMalformed = !ReadChunk(Reader, Scratch, Chunk, bValid);
+				if (!bValid)
+				{
+					OutChunks.Pop(EAllowShrinking::No);
+				}
+			}
+
+			bMalformed |= Reader.GetToken() != EToken::EndArray;
+		}
+
+		if (bMalformed || !bHasChunks || Reader.GetToken() != EToken::EndObject || !FinishResponse(Reader))
+		{
+			OutChunks.Reset();
+			return EResult::Unhandled;
+		}
+
+		return EResult::Decoded;
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+
+namespace VoxelResponseDecoder
+{
+	namespace
+	{
+		FString BuildVoxelListFixture(const int32 NumVoxels, const FString& EncodedState)
+		{
+			FString Json = TEXT("{\"data\":{\"getVoxelList\":{\"coordinates\":{\"x\":\"12\",\"y\":\"-3\",\"z\":\"0\"},\"voxels\":[");
+			for (int32 Index = 0; Index < NumVoxels; Index++)
+			{
+				Json += FString::Printf(TEXT("%s{\"location\":{\"x\":\"%d\",\"y\":\"%d\",\"z\":\"%d\"},\"voxelType\":\"%d\",\"state\":\"%s\"}"),
+				                        Index ? TEXT(",") : TEXT(""), Index % CHUNK_SIZE, Index / CHUNK_SIZE % CHUNK_SIZE,
+				                        Index / (CHUNK_SIZE * CHUNK_SIZE) % CHUNK_SIZE, 1 + Index % 8, *EncodedState);
+			}
+			Json += TEXT("]}}}");
+			return Json;
+		}
+
+		FString BuildChunksFixture(const int32 NumChunks, const int32 StatesPerChunk, const FString& EncodedState)
+		{
+			FRandomStream Random(NumChunks);
+
+			TArray<uint8> Voxels;
+			Voxels.SetNumUninitialized(NUM_VOXELS_IN_CHUNK);
+
+			FString Json = TEXT("{\"data\":{\"getChunksByDistance\":{\"chunks\":[");
+			for (int32 Chunk = 0; Chunk < NumChunks; Chunk++)
+			{
+				for (uint8& Voxel : Voxels)
+				{
+					Voxel = static_cast<uint8>(Random.RandRange(0, 8));
+				}
+
+				Json += FString::Printf(TEXT("%s{\"coordinates\":{\"x\":\"%d\",\"y\":\"0\",\"z\":\"0\"},\"voxels\":\"%s\",\"voxelStates\":["),
+				                        Chunk ? TEXT(",") : TEXT(""), Chunk, *FBase64::Encode(Voxels));
+				for (int32 State = 0; State < StatesPerChunk; State++)
+				{
+					Json += FString::Printf(TEXT("%s{\"voxelCoord\":{\"x\":\"%d\",\"y\":\"%d\",\"z\":\"0\"},\"voxelType\":\"2\",\"state\":\"%s\"}"),
+					                        State ? TEXT(",") : TEXT(""), State % CHUNK_SIZE, State / CHUNK_SIZE % CHUNK_SIZE,
+					                        *EncodedState);
+				}
+				Json += TEXT("]}");
+			}
+			Json += TEXT("]}}}");
+			return Json;
+		}
+
+		// Mirrors UGraphQLService before the pull decoder: the content as FString, then the FJsonObject DOM. The DOM walk
+		// and Base64 decoding the services did on top are not included, so the comparison favours this side
+		double TimeDomParse(const TArray<uint8>& Utf8Response, const int32 Iterations)
+		{
+			const double Start = FPlatformTime::Seconds();
+			for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+			{
+				const FUTF8ToTCHAR Converter(reinterpret_cast<const ANSICHAR*>(Utf8Response.GetData()), Utf8Response.Num());
+				const FString Content(Converter.Length(), Converter.Get());
+
+				TSharedPtr<FJsonObject> ParsedData;
+				FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Content), ParsedData);
+			}
+			return (FPlatformTime::Seconds() - Start) * 1000.0 / Iterations;
+		}
+
+		void RunBenchmark(const TArray<FString>& Args)
+		{
+			const int32 NumVoxels = Args.IsValidIndex(0) ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 2048;
+			const int32 Iterations = Args.IsValidIndex(1) ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 20;
+
+			const FString EncodedState = FBase64::Encode(FVoxelState().SerializeToBytes());
+
+			auto ToUtf8 = [](const FString& Json)
+			{
+				const FTCHARToUTF8 Converter(*Json);
+				return TArray<uint8>(reinterpret_cast<const uint8*>(Converter.Get()), Converter.Length());
+			};
+
+			const TArray<uint8> VoxelList = ToUtf8(BuildVoxelListFixture(NumVoxels, EncodedState));
+			const TArray<uint8> Chunks = ToUtf8(BuildChunksFixture(FMath::Max(NumVoxels / 128, 1), 64, EncodedState));
+
+			const double VoxelListDom = TimeDomParse(VoxelList, Iterations);
+			const double ChunksDom = TimeDomParse(Chunks, Iterations);
+
+			double Start = FPlatformTime::Seconds();
+			for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+			{
+				FInt64Vector ChunkCoordinate;
+				FChunkDataContainer Data;
+				ensure(DecodeVoxelList(VoxelList, ChunkCoordinate, Data) == EResult::Decoded);
+			}
+			const double VoxelListPull = (FPlatformTime::Seconds() - Start) * 1000.0 / Iterations;
+
+			Start = FPlatformTime::Seconds();
+			for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+			{
+				TArray<FChunkDataContainer> AllChunkData;
+				ensure(DecodeChunksByDistance(Chunks, AllChunkData) == EResult::Decoded);
+			}
+			const double ChunksPull = (FPlatformTime::Seconds() - Start) * 1000.0 / Iterations;
+
+			UE_LOG(LogVoxelResponseDecoder, Display, TEXT("getVoxelList, %d voxels, %d bytes: DOM parse %.3f ms, pull decode %.3f ms"),
+			       NumVoxels, VoxelList.Num(), VoxelListDom, VoxelListPull);
+			UE_LOG(LogVoxelResponseDecoder, Display, TEXT("getChunksByDistance, %d chunks, %d bytes: DOM parse %.3f ms, pull decode %.3f ms"),
+			       FMath::Max(NumVoxels / 128, 1), Chunks.Num(), ChunksDom, ChunksPull);
+		}
+
+		FAutoConsoleCommand BenchmarkCommand(
+			TEXT("CK.Network.BenchmarkVoxelDecoder"),
+			TEXT("Times the FJsonObject path against the pull decoder on generated getVoxelList and getChunksByDistance responses. Args: [Voxels=2048] [Iterations=20]"),
+			FConsoleCommandWithArgsDelegate::CreateStatic(&RunBenchmark));
+	}
+}
+
+#endif
@@ -36,6 +36,31 @@ void UVoiceChatServiceSubsystem::PostSubsystemInit()
 	UE_LOG(LogVoiceService, Log, TEXT("Voice Chat Service Subsystem Initialized"));
 }
 
+void UVoiceChatServiceSubsystem::SetVoiceChatManager(UVoiceChatWorldSubsystem* InVoiceChatManager)
+{
+	if (VoiceChatManager == InVoiceChatManager)
+	{
+		return;
+	}
+
+	// The previous world's manager stops feeding us
+	if (VoiceChatManager)
+	{
+		VoiceChatManager->OnAudioDataGenerated.RemoveDynamic(this, &UVoiceChatServiceSubsystem::CompressAudioData);
+		VoiceChatManager->OnStreamTimeout.RemoveDynamic(this, &UVoiceChatServiceSubsystem::CleanupDecoder);
+	}
+
+	VoiceChatManager = InVoiceChatManager;
+	if (!VoiceChatManager)
+	{
+		return;
+	}
+
+	VoiceChatManager->OnAudioDataGenerated.AddUniqueDynamic(this, &UVoiceChatServiceSubsystem::CompressAudioData);
+	VoiceChatManager->OnStreamTimeout.AddUniqueDynamic(this, &UVoiceChatServiceSubsystem::CleanupDecoder);
+	UE_LOG(LogVoiceService, Log, TEXT("Voice Chat Manager Set"));
+}
+
 
 void UVoiceChatServiceSubsystem::CompressAudioData(const TArray<float>& InAudioData, int32 SampleRate, int32 NumChannels)
 {
@@ -229,8 +254,8 @@ void UVoiceChatServiceSubsystem::SendAudioData(const TArray<uint8>& InAudioData,
 
 void UVoiceChatServiceSubsystem::HandleClientAudioNotification(const TArray<uint8>& Payload)
 {
-    // Validate minimum payload size (UUID [32] + SampleRate [4] + NumChannels [4])
-    constexpr int32 MinHeaderSize = 32 + sizeof(int32) * 2;
+    // Validate minimum payload size (MapID + Chunk [32] + UUID [32] + SampleRate [4] + NumChannels [4] + FrameCount [4])
+    constexpr int32 MinHeaderSize = sizeof(int64) * 4 + 32 + sizeof(int32) * 3;
     if (Payload.Num() < MinHeaderSize)
     {
         UE_LOG(LogVoiceService, Error, TEXT("Incomplete Audio Packet Size."));
@@ -244,11 +269,12 @@ void UVoiceChatServiceSubsystem::HandleClientAudioNotification(const TArray<uint
 	//int64 MapId = reinterpret_cast<const int64>(Payload.GetData() + Offset);
 	Offset += sizeof(int64);
 
-	//int64 ChunkX = reinterpret_cast<const int64>(Payload.GetData() + Offset);
+	FInt64Vector SpeakerChunk;
+	FMemory::Memcpy(&SpeakerChunk.X, Payload.GetData() + Offset, sizeof(int64));
 	Offset += sizeof(int64);
-	//int64 ChunkY = reinterpret_cast<const int64>(Payload.GetData() + Offset);
+	FMemory::Memcpy(&SpeakerChunk.Y, Payload.GetData() + Offset, sizeof(int64));
 	Offset += sizeof(int64);
-	//int64 ChunkZ = reinterpret_cast<const int64>(Payload.GetData() + Offset);
+	FMemory::Memcpy(&SpeakerChunk.Z, Payload.GetData() + Offset, sizeof(int64));
 	Offset += sizeof(int64);
 	
 	
@@ -287,6 +313,16 @@ void UVoiceChatServiceSubsystem::HandleClientAudioNotification(const TArray<uint
 		return;
 	}
 
+	// Don't spend decode time on speakers out of hearing range, their stream times out and frees the decoder
+	if (VoiceChatManager)
+	{
+		if (!VoiceChatManager->IsSpeakerAudible(SpeakerChunk))
+		{
+			return;
+		}
+		VoiceChatManager->SetSpeakerChunk(UUID, SpeakerChunk);
+	}
+
 	OpusDecoder* Decoder = GetOrCreateDecoder(UUID, SampleRate, NumChannels);
 	if (!Decoder)
 	{
@@ -5,9 +5,14 @@
 #include "HttpModule.h"
 #include "FunctionLibraries/Network/FL_Serialization.h"
 #include "Interfaces/IHttpResponse.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/IConsoleManager.h"
+#include "Engine/GameInstance.h"
+#include "Shared/Types/Core/Common.h"
 #include "Network/Services/GameData/VoxelServiceSubsystem.h"
 #include "Shared/Types/Core/GameSessionSubsystem.h"
-#include "Voxels/Data/VoxelDataManager.h"
 #include "Voxels/Rendering/ChunkDataManager.h"
 
 
@@ -18,6 +23,7 @@ void UCDNServiceSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 	Super::Initialize(Collection);
 	CDNStats.CDNRequestsPerSecond = 0;
 	CDNStats.CDNResponsePerSecond = 0;
+	ChunkCache.Empty(MaxCachedChunks);
 }
 
 void UCDNServiceSubsystem::Deinitialize()
@@ -30,10 +36,9 @@ void UCDNServiceSubsystem::PostSubsystemInit()
 	ChunkServiceSubsystem = GetWorld()->GetGameInstance()->GetSubsystem<UChunkServiceSubsystem>();
 	VoxelServiceSubsystem = GetWorld()->GetGameInstance()->GetSubsystem<UVoxelServiceSubsystem>();
 	GameSessionSubsystem = GetWorld()->GetGameInstance()->GetSubsystem<UGameSessionSubsystem>();
-	VoxelDataManager = GetWorld()->GetGameInstance()->GetSubsystem<UVoxelDataManager>();
 	ChunkDataManager = GetWorld()->GetGameInstance()->GetSubsystem<UChunkDataManager>();
 
-	if (!ChunkServiceSubsystem || !VoxelServiceSubsystem || !GameSessionSubsystem || !VoxelDataManager || !ChunkDataManager)
+	if (!ChunkServiceSubsystem || !VoxelServiceSubsystem || !GameSessionSubsystem || !ChunkDataManager)
 	{
 		UE_LOG(LogCDNService, Error, TEXT("Some or one of the subsystem is invalid."));
 		return;
@@ -47,18 +52,37 @@ void UCDNServiceSubsystem::PostSubsystemInit()
 
 bool UCDNServiceSubsystem::GetChunkCDN(int64 X, int64 Y, int64 Z)
 {
+	const FInt64Vector ChunkCoordinate(X, Y, Z);
+
+	if (CDN_Endpoint.IsEmpty())
+	{
+		UE_LOG(LogCDNService, Verbose, TEXT("GET_CHUNK_CDN skipped, no CDN endpoint set"));
+		ChunkDataManager->OnCDNDataReceived(false, ChunkCoordinate, FChunkDataContainer());
+		return false;
+	}
+
 	FHttpModule* Http = &FHttpModule::Get();
 
 	// Create an HTTP request
 	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = Http->CreateRequest();
 
 	// Set the URL for the request
-	FString URL = FString::Printf(TEXT("%s/m/0/%lld/0/%lld/0/%lld/0/%lld/0/d2.bin"), 
-		*CDN_Endpoint, GameSessionSubsystem->GetMapID(), X, Y, Z);
+	FString URL = FString::Printf(TEXT("%s/m/0/%lld/0/%lld/0/%lld/0/%lld/0/d2.bin%s"), 
+		*CDN_Endpoint, GameSessionSubsystem->GetMapID(), X, Y, Z, bRequestCompressedChunks ? TEXT(".lz4") : TEXT(""));
 	Request->SetURL(URL);
 
-	// Bind a callback function that handles the response
-	Request->OnProcessRequestComplete().BindUObject(this, &UCDNServiceSubsystem::OnCDNResponseReceived);
+	// Revalidate what we already have, an unchanged chunk comes back as an empty 304
+	{
+		FScopeLock Lock(&ChunkCacheLock);
+		if (const FCDNChunkCacheEntry* CacheEntry = ChunkCache.FindAndTouch(ChunkCoordinate))
+		{
+			Request->SetHeader(TEXT("If-None-Match"), CacheEntry->ETag);
+		}
+	}
+
+	// Bind a callback function that handles the response, the chunk travels with it instead of being parsed back out of the URL
+	Request->OnProcessRequestComplete().BindUObject(this, &UCDNServiceSubsystem::OnCDNResponseReceived, ChunkCoordinate,
+	                                                 bRequestCompressedChunks);
 
 	// Send the request
 	if (Request->ProcessRequest())
@@ -84,10 +108,19 @@ bool UCDNServiceSubsystem::GetChunkCDN(int64 X, int64 Y, int64 Z)
 	}
 
 	UE_LOG(LogCDNService, Warning, TEXT("GET_CHUNK_CDN not sent:  %lld %lld %lld"), X, Y, Z);
+	ChunkDataManager->OnCDNDataReceived(false, ChunkCoordinate, FChunkDataContainer());
 	return false;
 }
 
+void UCDNServiceSubsystem::SetCDNEndpoint(FString Endpoint)
+{
+	CDN_Endpoint = Endpoint;
+	UE_LOG(LogCDNService, Log, TEXT("CDN Endpoint set to %s"), *CDN_Endpoint);
 
+	// ETags are only meaningful to the server that handed them out
+	FScopeLock Lock(&ChunkCacheLock);
+	ChunkCache.Empty(MaxCachedChunks);
+}
 
 FCDNStats UCDNServiceSubsystem::GetCDNStats() const
 {
@@ -116,86 +149,156 @@ void UCDNServiceSubsystem::UpdateCDNStats()
 	CDNIncomingBytes.Set(0);
 }
 
-void UCDNServiceSubsystem::OnCDNResponseReceived(const FHttpRequestPtr Request, FHttpResponsePtr Response, const bool bWasSuccessful)
+void UCDNServiceSubsystem::OnCDNResponseReceived(const FHttpRequestPtr Request, FHttpResponsePtr Response, const bool bWasSuccessful,
+                                                 const FInt64Vector ChunkCoordinate, const bool bCompressed)
 {
-	if (!bWasSuccessful)
+	if (!bWasSuccessful || !Response.IsValid())
 	{
 		UE_LOG(LogCDNService, Error, TEXT("CDN HTTP request failed: %s"), *Request->GetURL());
+		ChunkDataManager->OnCDNDataReceived(false, ChunkCoordinate, FChunkDataContainer());
+		return;
+	}
+
+	// Stats
+	CDNResponsePerSecond.Increment();
+	CDNIncomingBytes.Add(Response->GetContent().Num());
+
+	const int32 ResponseCode = Response->GetResponseCode();
+
+	if (ResponseCode == EHttpResponseCodes::NotModified)
+	{
+		FChunkDataContainer CachedData;
+		bool bIsCached = false;
+		{
+			FScopeLock Lock(&ChunkCacheLock);
+			if (const FCDNChunkCacheEntry* CacheEntry = ChunkCache.Find(ChunkCoordinate))
+			{
+				CachedData = CacheEntry->Data;
+				bIsCached = true;
+			}
+		}
+
+		// Evicted while the request was out, the next request fetches it in full
+		UE_LOG(LogCDNService, Verbose, TEXT("OnCDNResponseReceived: Chunk %lld, %lld, %lld not modified, cached: %d"),
+		       ChunkCoordinate.X, ChunkCoordinate.Y, ChunkCoordinate.Z, bIsCached);
+		ChunkDataManager->OnCDNDataReceived(bIsCached, ChunkCoordinate, CachedData);
 		return;
 	}
 
-	if (!Response.IsValid())
+	if (!EHttpResponseCodes::IsOk(ResponseCode))
 	{
-		UE_LOG(LogCDNService, Error, TEXT("CDN HTTP response invalid"));
+		// Chunks nobody built on yet have no file
+		UE_LOG(LogCDNService, Verbose, TEXT("OnCDNResponseReceived: HTTP %d for chunk %lld, %lld, %lld"), ResponseCode,
+		       ChunkCoordinate.X, ChunkCoordinate.Y, ChunkCoordinate.Z);
+		ChunkDataManager->OnCDNDataReceived(false, ChunkCoordinate, FChunkDataContainer());
 		return;
 	}
 
-	// Extract chunk coords from request url
-	FString ReqUrl = Request->GetURL();
-	TArray<FString> URLTokens;
-	ReqUrl.ParseIntoArray(URLTokens, TEXT("/0/"), true);
+	UE_LOG(LogCDNService, Log, TEXT("OnCDNResponseReceived: Received chunk data for %lld, %lld, %lld"),
+	       ChunkCoordinate.X, ChunkCoordinate.Y, ChunkCoordinate.Z);
 
-	if (URLTokens.Num() < 4)
+	TArray<uint8> RespContent;
+	if (bCompressed)
 	{
-		UE_LOG(LogCDNService, Error, TEXT("Unable to parse chunk coordinates"));
+		if (!DecompressChunkBody(Response->GetContent(), RespContent))
+		{
+			UE_LOG(LogCDNService, Warning, TEXT("OnCDNResponseReceived: Failed to decompress chunk %lld, %lld, %lld"),
+			       ChunkCoordinate.X, ChunkCoordinate.Y, ChunkCoordinate.Z);
+			ChunkDataManager->OnCDNDataReceived(false, ChunkCoordinate, FChunkDataContainer());
+			return;
+		}
+	}
+	else
+	{
+		RespContent = Response->GetContent();
+	}
+
+	FChunkDataContainer DataContainer;
+	if (!ParseChunkBody(RespContent, DataContainer))
+	{
+		ChunkDataManager->OnCDNDataReceived(false, ChunkCoordinate, FChunkDataContainer());
 		return;
 	}
+	DataContainer.ChunkCoordinate = ChunkCoordinate;
 
-	// Stats
-	CDNResponsePerSecond.Increment();
+	// Extract the 'Last-Modified' header
+	FString LastModified = Response->GetHeader("Last-Modified");
+	FDateTime DateTime;
 
-	const int64 X = FCString::Atoi(*URLTokens[2]);
-	const int64 Y = FCString::Atoi(*URLTokens[3]);
-	const int64 Z = FCString::Atoi(*URLTokens[4]);
+	UE_LOG(LogCDNService, Log, TEXT("Last-Modified: %s, Chunk Data:%d,  Chunk Coordinates %lld, %lld, %lld"), *LastModified,
+	       RespContent.Num(), ChunkCoordinate.X, ChunkCoordinate.Y, ChunkCoordinate.Z);
 
-	UE_LOG(LogCDNService, Log, TEXT("OnCDNResponseReceived: Received chunk data for %lld, %lld, %lld"), X, Y, Z);
-	
-	// Get chunk voxel data 
-	TArray<uint8> RespContent = Response->GetContent();
-	
-	if (RespContent.Num() < 4096)
+	if (FDateTime::ParseHttpDate(LastModified, DateTime))
+	{
+		PreviousTimestamp = static_cast<int32>(DateTime.ToUnixTimestamp());
+	}
+
+	const FString ETag = Response->GetHeader(TEXT("ETag"));
+	if (!ETag.IsEmpty())
+	{
+		// Evicts the least recently requested chunk once MaxCachedChunks is reached
+		FScopeLock Lock(&ChunkCacheLock);
+		ChunkCache.Add(ChunkCoordinate, FCDNChunkCacheEntry{ETag, DataContainer});
+	}
+
+	ChunkDataManager->OnCDNDataReceived(true, ChunkCoordinate, DataContainer);
+}
+
+bool UCDNServiceSubsystem::DecompressChunkBody(const TArray<uint8>& Body, TArray<uint8>& OutBody)
+{
+	// uint32 uncompressed size followed by a single LZ4 block
+	uint32 UncompressedSize = 0;
+	if (!UFL_Serialization::DeserializeValue(Body, UncompressedSize, 0))
+	{
+		return false;
+	}
+
+	// Voxels, the states length and at most that many bytes of states
+	if (UncompressedSize < NUM_VOXELS_IN_CHUNK || UncompressedSize > NUM_VOXELS_IN_CHUNK + sizeof(uint16) + MAX_uint16)
+	{
+		return false;
+	}
+
+	OutBody.SetNumUninitialized(UncompressedSize);
+	return FCompression::UncompressMemory(NAME_LZ4, OutBody.GetData(), UncompressedSize, Body.GetData() + sizeof(uint32),
+	                                      Body.Num() - sizeof(uint32));
+}
+
+bool UCDNServiceSubsystem::ParseChunkBody(const TArray<uint8>& RespContent, FChunkDataContainer& OutData)
+{
+	if (RespContent.Num() < NUM_VOXELS_IN_CHUNK)
 	{
 		UE_LOG(LogCDNService, Warning, TEXT("OnCDNResponseReceived: Payload does not contain enough data for voxel data: %d"), RespContent.Num());
-		FInt64Vector ChunkCoord = FInt64Vector(X, Y, Z);
-		FChunkDataContainer DataContainer;
-		ChunkDataManager->OnCDNDataReceived(false, ChunkCoord, DataContainer);
-		return;
+		return false;
 	}
 
 	int32 Offset = 0;
 
-	TArray<uint8> Voxels;
-	Voxels.SetNumUninitialized(16*16*16);
-	FMemory::Memcpy(Voxels.GetData(), RespContent.GetData() + Offset, Voxels.Num());
-	Offset += 4096;
+	OutData.VoxelData.SetNumUninitialized(NUM_VOXELS_IN_CHUNK);
+	FMemory::Memcpy(OutData.VoxelData.GetData(), RespContent.GetData() + Offset, OutData.VoxelData.Num());
+	Offset += NUM_VOXELS_IN_CHUNK;
 
-	uint16 VoxelStatesLength;
+	uint16 VoxelStatesLength = 0;
 	UFL_Serialization::DeserializeValue(RespContent, VoxelStatesLength, Offset);
 	Offset += sizeof(VoxelStatesLength);
 
-	UE_LOG(LogVoxelService, Log, TEXT("OnCDNResponseReceived: Voxel States Length: %d"), VoxelStatesLength);
+	UE_LOG(LogCDNService, Verbose, TEXT("OnCDNResponseReceived: Voxel States Length: %d"), VoxelStatesLength);
 
-	TArray<FChunkVoxelState> VoxelStates;
 	const int32 StartOffset = Offset;
 	const int32 EndOffset = StartOffset + VoxelStatesLength;
 
 	if (EndOffset > RespContent.Num())
 	{
+		// Voxels without their states are still better than nothing
 		//UE_LOG(LogCDNService, Error, TEXT("OnCDNResponseReceived: Payload does not contain enough data for states"));
-		FChunkDataContainer DataContainer;
-		DataContainer.VoxelData = Voxels;
-		ChunkDataManager->OnCDNDataReceived(true, FInt64Vector(X, Y, Z), DataContainer);
-		//VoxelDataManager->OnCDNResponseReceived(false, X, Y, Z, {}, {}, PreviousTimestamp);
-		return;
+		return true;
 	}
 
 	//UE_LOG(LogCDNService, Log, TEXT("OnCDNResponseReceived: StartOffset = %d, EndOffset = %d"), StartOffset, EndOffset);
 
-	FChunkDataContainer DataContainer;
-	
 	while (Offset < EndOffset)
 	{
-		if (Offset + 4 > RespContent.Num())
+		if (Offset + 6 > RespContent.Num())
 		{
 			UE_LOG(LogCDNService, Error, TEXT("OnCDNResponseReceived: Not enough data for voxel state header"));
 			break;
@@ -217,49 +320,190 @@ void UCDNServiceSubsystem::OnCDNResponseReceived(const FHttpRequestPtr Request,
 
 		//UE_LOG(LogCDNService, Log, TEXT("OnCDNResponseReceived: Each Voxel State Length:%d, expected size:%llu"), VoxelStateLength, sizeof(FVoxelState));
 
-		FChunkVoxelState ChunkVoxelState;
-		ChunkVoxelState.Vx = x;
-		ChunkVoxelState.Vy = y;
-		ChunkVoxelState.Vz = z;
-		ChunkVoxelState.VoxelType = VoxelType;
-
-		//UE_LOG(LogCDNService, Log, TEXT("OnCDNResponseReceived: All Voxel Data: Coords: %d, %d, %d, Type: %d"), ChunkVoxelState.Vx,
-		//		   ChunkVoxelState.Vy, ChunkVoxelState.Vz, ChunkVoxelState.VoxelType);
-
 		if (VoxelStateLength > 0)
 		{
 			FVoxelState VoxelState;
 
-			if (RespContent[Offset] == 1)
+			if (Offset < RespContent.Num() && RespContent[Offset] == 1)
 			{
 				VoxelState.DeserializeFromBytes(RespContent, Offset);
 			}
 			
-			ChunkVoxelState.VoxelState = VoxelState;
 			Offset += VoxelStateLength;
-			VoxelStates.Add(ChunkVoxelState);
-			DataContainer.VoxelStatesMap.Add(FVoxelCoordinate(x, y,z), FVoxelDefinition(1, VoxelType, VoxelState));
+			OutData.VoxelStatesMap.Add(FVoxelCoordinate(x, y, z), FVoxelDefinition(1, VoxelType, VoxelState));
 		}
 	}
 
-	
-	// Extract the 'Last-Modified' header
-	FString LastModified = Response->GetHeader("Last-Modified");
-	FDateTime DateTime;
+	return true;
+}
 
-	UE_LOG(LogCDNService, Log, TEXT("Last-Modified: %s, Chunk Data:%d,  Chunk Coordinates %lld, %lld, %lld"), *LastModified, RespContent.Num(), X, Y, Z);
-	
-	
-	if (FDateTime::ParseHttpDate(LastModified, DateTime) && RespContent.Num() >= 4096)
+#if !UE_BUILD_SHIPPING
+
+namespace CDNServiceChecks
+{
+	// Deterministic per chunk, so the check can rebuild what the fixture wrote
+	TArray<uint8> BuildFixtureBody(const FInt64Vector& ChunkCoordinate)
 	{
-		int32 UnixTimestamp = static_cast<int32>(DateTime.ToUnixTimestamp());
-		PreviousTimestamp = UnixTimestamp;
-		DataContainer.VoxelData = Voxels;
-		ChunkDataManager->OnCDNDataReceived(true, FInt64Vector(X,Y, Z), DataContainer);
+		TArray<uint8> Body;
+		Body.SetNumUninitialized(NUM_VOXELS_IN_CHUNK);
+		for (int32 Index = 0; Index < NUM_VOXELS_IN_CHUNK; Index++)
+		{
+			Body[Index] = static_cast<uint8>((Index * 31 + ChunkCoordinate.X + ChunkCoordinate.Y * 7 + ChunkCoordinate.Z * 13) & 0xFF);
+		}
+
+		// One state entry with a one byte state that is not serialized, enough to walk the states block
+		const uint8 StateEntry[] = {1, 2, 3, 5, 1, 0, 0};
+		const uint16 StatesLength = UE_ARRAY_COUNT(StateEntry);
+		Body.Append(reinterpret_cast<const uint8*>(&StatesLength), sizeof(StatesLength));
+		Body.Append(StateEntry, UE_ARRAY_COUNT(StateEntry));
+		return Body;
 	}
-	else
+
+	TArray<uint8> CompressFixtureBody(const TArray<uint8>& Body)
 	{
-		ChunkDataManager->OnCDNDataReceived(true, FInt64Vector(X, Y, Z), DataContainer);
+		int32 CompressedSize = FCompression::CompressMemoryBound(NAME_LZ4, Body.Num());
+		TArray<uint8> Compressed;
+		Compressed.SetNumUninitialized(sizeof(uint32) + CompressedSize);
+
+		const uint32 UncompressedSize = Body.Num();
+		FMemory::Memcpy(Compressed.GetData(), &UncompressedSize, sizeof(UncompressedSize));
+		if (!FCompression::CompressMemory(NAME_LZ4, Compressed.GetData() + sizeof(uint32), CompressedSize, Body.GetData(), Body.Num()))
+		{
+			return TArray<uint8>();
+		}
+
+		Compressed.SetNum(sizeof(uint32) + CompressedSize);
+		return Compressed;
 	}
-	
+
+	FString ChunkPath(const int64 MapID, const FInt64Vector& ChunkCoordinate, const bool bCompressed)
+	{
+		return FString::Printf(TEXT("m/0/%lld/0/%lld/0/%lld/0/%lld/0/d2.bin%s"), MapID, ChunkCoordinate.X, ChunkCoordinate.Y,
+		                       ChunkCoordinate.Z, bCompressed ? TEXT(".lz4") : TEXT(""));
+	}
+}
+
+void UCDNServiceSubsystem::WriteEndpointFixture(const FString& Directory, const FInt64Vector& ChunkCoordinate) const
+{
+	const int64 MapID = GameSessionSubsystem ? GameSessionSubsystem->GetMapID() : 0;
+	const TArray<uint8> Body = CDNServiceChecks::BuildFixtureBody(ChunkCoordinate);
+
+	const FString PlainPath = FPaths::Combine(Directory, CDNServiceChecks::ChunkPath(MapID, ChunkCoordinate, false));
+	const FString CompressedPath = FPaths::Combine(Directory, CDNServiceChecks::ChunkPath(MapID, ChunkCoordinate, true));
+
+	const bool bWritten = FFileHelper::SaveArrayToFile(Body, *PlainPath) &&
+		FFileHelper::SaveArrayToFile(CDNServiceChecks::CompressFixtureBody(Body), *CompressedPath);
+
+	UE_LOG(LogCDNService, Display, TEXT("CDN fixture for %lld, %lld, %lld %s: %s"), ChunkCoordinate.X, ChunkCoordinate.Y,
+	       ChunkCoordinate.Z, bWritten ? TEXT("written") : TEXT("failed"), *PlainPath);
+}
+
+void UCDNServiceSubsystem::CheckEndpoint(const FString& Endpoint, const FInt64Vector& ChunkCoordinate, const bool bCompressed) const
+{
+	const int64 MapID = GameSessionSubsystem ? GameSessionSubsystem->GetMapID() : 0;
+	const FString URL = FString::Printf(TEXT("%s/%s"), *Endpoint, *CDNServiceChecks::ChunkPath(MapID, ChunkCoordinate, bCompressed));
+
+	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+	Request->SetURL(URL);
+	Request->OnProcessRequestComplete().BindLambda([URL, ChunkCoordinate, bCompressed](
+		FHttpRequestPtr, const FHttpResponsePtr Response, const bool bWasSuccessful)
+	{
+		if (!bWasSuccessful || !Response.IsValid() || !EHttpResponseCodes::IsOk(Response->GetResponseCode()))
+		{
+			UE_LOG(LogCDNService, Error, TEXT("CDN check: %s failed, HTTP %d"), *URL, Response.IsValid() ? Response->GetResponseCode() : 0);
+			return;
+		}
+
+		TArray<uint8> Body;
+		bool bDecoded = true;
+		if (bCompressed)
+		{
+			bDecoded = DecompressChunkBody(Response->GetContent(), Body);
+		}
+		else
+		{
+			Body = Response->GetContent();
+		}
+
+		FChunkDataContainer Data;
+		const TArray<uint8> Expected = CDNServiceChecks::BuildFixtureBody(ChunkCoordinate);
+		const bool bMatches = bDecoded && Body == Expected && ParseChunkBody(Body, Data) &&
+			FMemory::Memcmp(Data.VoxelData.GetData(), Expected.GetData(), NUM_VOXELS_IN_CHUNK) == 0 && Data.VoxelStatesMap.Num() == 1;
+
+		UE_LOG(LogCDNService, Display, TEXT("CDN check: %s body %s, %d bytes"), *URL, bMatches ? TEXT("matches") : TEXT("DOES NOT match"),
+		       Response->GetContent().Num());
+
+		const FString ETag = Response->GetHeader(TEXT("ETag"));
+		if (ETag.IsEmpty())
+		{
+			UE_LOG(LogCDNService, Display, TEXT("CDN check: %s sent no ETag, revalidation not checked"), *URL);
+			return;
+		}
+
+		// What GetChunkCDN sends for a cached chunk, the fixture itself stays out of ChunkCache
+		TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Revalidate = FHttpModule::Get().CreateRequest();
+		Revalidate->SetURL(URL);
+		Revalidate->SetHeader(TEXT("If-None-Match"), ETag);
+		Revalidate->OnProcessRequestComplete().BindLambda([URL](FHttpRequestPtr, const FHttpResponsePtr RevalidateResponse,
+		                                                        const bool bRevalidated)
+		{
+			const int32 ResponseCode = bRevalidated && RevalidateResponse.IsValid() ? RevalidateResponse->GetResponseCode() : 0;
+			UE_LOG(LogCDNService, Display, TEXT("CDN check: %s revalidation HTTP %d (%s)"), *URL, ResponseCode,
+			       ResponseCode == EHttpResponseCodes::NotModified ? TEXT("expected") : TEXT("expected 304"));
+		});
+		Revalidate->ProcessRequest();
+	});
+
+	if (!Request->ProcessRequest())
+	{
+		UE_LOG(LogCDNService, Error, TEXT("CDN check: %s not sent"), *URL);
+	}
+}
+
+namespace CDNServiceChecks
+{
+	UCDNServiceSubsystem* GetService(const UWorld* World)
+	{
+		const UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+		return GameInstance ? GameInstance->GetSubsystem<UCDNServiceSubsystem>() : nullptr;
+	}
+
+	FInt64Vector ParseChunkCoordinate(const TArray<FString>& Args, const int32 First)
+	{
+		FInt64Vector ChunkCoordinate(0, 0, 0);
+		if (Args.Num() >= First + 3)
+		{
+			LexFromString(ChunkCoordinate.X, *Args[First]);
+			LexFromString(ChunkCoordinate.Y, *Args[First + 1]);
+			LexFromString(ChunkCoordinate.Z, *Args[First + 2]);
+		}
+		return ChunkCoordinate;
+	}
+
+	FAutoConsoleCommandWithWorldAndArgs WriteFixtureCommand(
+		TEXT("CK.Network.WriteCDNFixture"),
+		TEXT("Writes a d2.bin and d2.bin.lz4 fixture laid out like the CDN, serve the directory with any static file server. Args: <Directory> [X Y Z]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+		{
+			UCDNServiceSubsystem* Service = GetService(World);
+			if (Service && Args.Num() >= 1)
+			{
+				Service->WriteEndpointFixture(Args[0], ParseChunkCoordinate(Args, 1));
+			}
+		}));
+
+	FAutoConsoleCommandWithWorldAndArgs CheckEndpointCommand(
+		TEXT("CK.Network.CheckCDN"),
+		TEXT("Fetches the CK.Network.WriteCDNFixture chunk plain and LZ4 compressed from a CDN stand-in and revalidates it by ETag. Args: <Endpoint> [X Y Z]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+		{
+			UCDNServiceSubsystem* Service = GetService(World);
+			if (Service && Args.Num() >= 1)
+			{
+				Service->CheckEndpoint(Args[0], ParseChunkCoordinate(Args, 1), false);
+				Service->CheckEndpoint(Args[0], ParseChunkCoordinate(Args, 1), true);
+			}
+		}));
 }
+
+#endif
@@ -3,9 +3,9 @@
 
 #include "FunctionLibraries/Network/FL_Serialization.h"
 #include "Shared/Types/Structures/Voxels/FChunkVoxelState.h"
+#include "Network/Infrastructure/VoxelResponseDecoder.h"
 #include "Network/GraphQL/GraphQLService.h"
 #include "Shared/Types/Core/GameSessionSubsystem.h"
-#include "Voxels/Data/VoxelDataManager.h"
 #include "Shared/Types/Structures/Chunks/FChunkDataContainer.h"
 #include "Shared/Types/Structures/Voxels/FChunkData.h"
 #include "Voxels/Rendering/ChunkDataManager.h"
@@ -25,12 +25,11 @@ void UChunkServiceSubsystem::Deinitialize()
 void UChunkServiceSubsystem::PostSubsystemInit()
 {
 	CDNServiceSubsystem = GetWorld()->GetGameInstance()->GetSubsystem<UCDNServiceSubsystem>();
-	VoxelDataManager = GetWorld()->GetGameInstance()->GetSubsystem<UVoxelDataManager>();
 	GraphQLService = GetWorld()->GetGameInstance()->GetSubsystem<UGraphQLService>();
 	GameSessionSubsystem = GetWorld()->GetGameInstance()->GetSubsystem<UGameSessionSubsystem>();
 	ChunkDataManager = GetWorld()->GetGameInstance()->GetSubsystem<UChunkDataManager>();
 
-	if (!CDNServiceSubsystem || !VoxelDataManager || !GraphQLService || !GameSessionSubsystem)
+	if (!CDNServiceSubsystem || !ChunkDataManager || !GraphQLService || !GameSessionSubsystem)
 	{
 		UE_LOG(LogChunkService, Error, TEXT("Some or one of the subsystem is invalid."));
 		return;
@@ -279,3 +278,16 @@ void UChunkServiceSubsystem::HandleGetChunkResponse(const TSharedPtr<FJsonObject
 	UE_LOG(LogChunkService, Log, TEXT("Processing %d chunks from GetChunksByDistance response"), AllChunkData.Num());
 	ChunkDataManager->OnGetChunkDataReceived(true, AllChunkData);
  }
+
+bool UChunkServiceSubsystem::HandleGetChunkResponse(const TConstArrayView<uint8> Utf8Response) const
+{
+	TArray<FChunkDataContainer> AllChunkData;
+	if (VoxelResponseDecoder::DecodeChunksByDistance(Utf8Response, AllChunkData) != VoxelResponseDecoder::EResult::Decoded)
+	{
+		return false;
+	}
+
+	UE_LOG(LogChunkService, Log, TEXT("Processing %d chunks from GetChunksByDistance response"), AllChunkData.Num());
+	ChunkDataManager->OnGetChunkDataReceived(true, AllChunkData);
+	return true;
+}
@@ -9,6 +9,52 @@
 #include "Shared/Types/Core/GameSessionSubsystem.h"
 #include "Shared/Types/Enums/Events/EEventType.h"
 
+DEFINE_LOG_CATEGORY(LogGameObjectsService);
+
+namespace
+{
+	/**
+	 * Header shared by every game event, the state of the event follows it. The kind sits at a fixed offset so the
+	 * event can be routed before anything else is read.
+	 */
+	constexpr int32 MapIDOffset = 0;
+	constexpr int32 ChunkOffset = MapIDOffset + sizeof(int64);
+	constexpr int32 EventKindOffset = ChunkOffset + 3 * sizeof(int64);
+	constexpr int32 ObjectIDOffset = EventKindOffset + sizeof(uint16);
+	constexpr int32 EventHeaderSize = ObjectIDOffset + sizeof(int64);
+
+	template <typename T>
+	T ReadValue(const TArray<uint8>& Payload, const int32 Offset)
+	{
+		T Value;
+		FMemory::Memcpy(&Value, Payload.GetData() + Offset, sizeof(T));
+		return Value;
+	}
+
+	template <typename T>
+	void AppendValue(TArray<uint8>& Payload, const T& Value)
+	{
+		Payload.Append(reinterpret_cast<const uint8*>(&Value), sizeof(T));
+	}
+
+	template <typename TState>
+	TArray<uint8> MakeEventPayload(const int64 MapID, const int64 ChunkX, const int64 ChunkY, const int64 ChunkZ,
+	                               const uint16 EventKind, const int64 ObjectID, const TState& State)
+	{
+		TArray<uint8> Payload;
+		Payload.Reserve(EventHeaderSize + sizeof(TState));
+
+		AppendValue(Payload, MapID);
+		AppendValue(Payload, ChunkX);
+		AppendValue(Payload, ChunkY);
+		AppendValue(Payload, ChunkZ);
+		AppendValue(Payload, EventKind);
+		AppendValue(Payload, ObjectID);
+		AppendValue(Payload, State);
+
+		return Payload;
+	}
+}
 
 void UGameObjectsServiceSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 {
@@ -28,257 +74,113 @@ void UGameObjectsServiceSubsystem::PostSubsystemInit()
 
 	if (!UDPSubsystem || !GameSessionSubsystem)
 	{
-		UE_LOG(LogTemp, Error, TEXT("Some or one of the subsystem is invalid."));
+		UE_LOG(LogGameObjectsService, Error, TEXT("Some or one of the subsystem is invalid."));
 		return;
 	}
 
-	UE_LOG(LogTemp, Log, TEXT("Game Objects Service Subsystem Initialized."));
+	UE_LOG(LogGameObjectsService, Log, TEXT("Game Objects Service Subsystem Initialized."));
 }
 
 void UGameObjectsServiceSubsystem::SendGameObjectActivationRequest(const int64 MapId, const int64 ChunkX,
-                                                                   const int64 ChunkY, const int64 ChunkZ, const FString& ActivatorUUID, const uint16 EventType,
+                                                                   const int64 ChunkY, const int64 ChunkZ, const int64 ActivatorID, const uint16 EventType,
                                                                    const FGameObjectState& State) const
 {
-	// Start with an empty payload
-	TArray<uint8> Payload;
-
-	// Append Map ID
-	const int64 MapID = GameSessionSubsystem->GetMapID();
-	Payload.Append(UFL_Serialization::SerializeValue(MapID));
+	const TArray<uint8> Payload = MakeEventPayload(GameSessionSubsystem->GetMapID(), ChunkX, ChunkY, ChunkZ, EventType,
+	                                               ActivatorID, State);
 
-	// Append Chunk Data
-	Payload.Append(UFL_Serialization::SerializeValue(ChunkX));
-	Payload.Append(UFL_Serialization::SerializeValue(ChunkY));
-	Payload.Append(UFL_Serialization::SerializeValue(ChunkZ));
+	UE_LOG(LogGameObjectsService, Verbose, TEXT("Sending activation request for activator %lld, active: %d"), ActivatorID, State.bIsActive);
 
-	// Append Activator UUID
-	const FTCHARToUTF8 ConvertedUUID(*ActivatorUUID);
-	Payload.Append(reinterpret_cast<const uint8*>(ConvertedUUID.Get()), ConvertedUUID.Length());
-
-	// Append the event type
-	Payload.Append(UFL_Serialization::SerializeValue(EventType));
-
-	// Append the state size and state itself
-	//constexpr int32 StateSize = sizeof(FGameObjectState);
-	//Payload.Append(UFL_Serialization::SerializeValue(StateSize));
-
-	TArray<uint8> StateBytes;
-	StateBytes.SetNumUninitialized(sizeof(FGameObjectState));
-
-	FMemory::Memcpy(StateBytes.GetData(), &State, sizeof(FGameObjectState));
-	Payload.Append(StateBytes);
-	
-	UE_LOG(LogTemp, Log, TEXT("Service_GameObjectService: Sending GameObject Activation Request"));
-
-	UE_LOG(LogTemp, Log, TEXT("Service_GameObjectService: Sending State is: %s"), State.bIsActive ? TEXT("True"): TEXT("False"));
 	//Dispatch with UDP Service
 	if (!UDPSubsystem->QueueUDPMessage(EMessageType::CLIENT_EVENT_NOTIFICATION, Payload))
 	{
-		UE_LOG(LogTemp, Error, TEXT("Service_GameObjectService: Failed to send GameObject Activation Request"));
+		UE_LOG(LogGameObjectsService, Error, TEXT("Failed to send GameObject Activation Request"));
 	}
 }
 
 void UGameObjectsServiceSubsystem::HandleGameObjectActivationNotification(const TArray<uint8>& Payload) const
 {
 	// Payload Validation
-	if (Payload.Num() < 0)
+	if (Payload.Num() < EventHeaderSize + static_cast<int32>(sizeof(FGameObjectState)))
 	{
-		UE_LOG(LogTemp, Error, TEXT("Service_GameObjectService: Invalid payload size :%d"), Payload.Num());
+		UE_LOG(LogGameObjectsService, Error, TEXT("Invalid activation payload size :%d"), Payload.Num());
 		return;
 	}
-	
-	int32 Offset = 0;
-
-	// Extract Map ID
-	int64 MapId;
-	UFL_Serialization::DeserializeValue(Payload, MapId, Offset);
-	Offset += sizeof(MapId);
-
-	// Extract Chunk Coords
-	int64 ChunkX, ChunkY, ChunkZ;
-	UFL_Serialization::DeserializeValue(Payload, ChunkX, Offset);
-	Offset += sizeof(ChunkX);
-	UFL_Serialization::DeserializeValue(Payload, ChunkY, Offset);
-	Offset += sizeof(ChunkY);
-	UFL_Serialization::DeserializeValue(Payload, ChunkZ, Offset);
-	Offset += sizeof(ChunkZ);
-
-	// Extract Activator UUID
-	FString ActivatorUUID = UFL_Serialization::DeserializeString(Payload, Offset, 32);
-	Offset += 32;
-
-	// Extract Event Type
-	Offset += sizeof(uint16);
-
-	// Extract State Size
-	//Offset += sizeof(int32);
-
-	// Extract State
-	FGameObjectState State;
-	FMemory::Memcpy(&State, Payload.GetData() + Offset, sizeof(FGameObjectState));
-	
-	
-	UE_LOG(LogTemp, Log, TEXT("Service_GameObjectService: Received GameObject Activation Notification. Dispatching to GameObjectsManager"));
-
-	UE_LOG(LogTemp, Log, TEXT("Service_GameObjectService: Received State is: %s"), State.bIsActive ? TEXT("True"): TEXT("False"));
+
+	const int64 ActivatorID = ReadValue<int64>(Payload, ObjectIDOffset);
+	const FGameObjectState State = ReadValue<FGameObjectState>(Payload, EventHeaderSize);
+
+	UE_LOG(LogGameObjectsService, Verbose, TEXT("Received activation for activator %lld, active: %d"), ActivatorID, State.bIsActive);
+
 	//Activate The Object
-	AsyncTask(ENamedThreads::GameThread, [this, ActivatorUUID, State]()
+	AsyncTask(ENamedThreads::GameThread, [this, ActivatorID, State]()
 	{
-		GameObjectsManager->OnGameObjectActivationNotificationReceived.Broadcast(ActivatorUUID, State);
+		if (IsValid(GameObjectsManager))
+		{
+			GameObjectsManager->OnGameObjectActivationNotificationReceived.Broadcast(ActivatorID, State);
+		}
 	});
 }
 
-void UGameObjectsServiceSubsystem::SendTriggerBallEventRequest(const int64 ChunkX, const int64 ChunkY, const int64 ChunkZ, const FString InUUID, const FBallState BallState)
+void UGameObjectsServiceSubsystem::SendTriggerBallEventRequest(const int64 ChunkX, const int64 ChunkY, const int64 ChunkZ, const int64 EventID, const FBallState BallState)
 {
-	TArray<uint8> Payload;
-
-	// Append Map ID
-	const int64 MapID = GameSessionSubsystem->GetMapID();
-	Payload.Append(UFL_Serialization::SerializeValue(MapID));
-
-	// Append Chunk Data
-	Payload.Append(UFL_Serialization::SerializeValue(ChunkX));
-	Payload.Append(UFL_Serialization::SerializeValue(ChunkY));
-	Payload.Append(UFL_Serialization::SerializeValue(ChunkZ));
+	constexpr uint16 EventType = static_cast<uint16>(EEventType::Ball);
+	const TArray<uint8> Payload = MakeEventPayload(GameSessionSubsystem->GetMapID(), ChunkX, ChunkY, ChunkZ, EventType,
+	                                               EventID, BallState);
 
-	// Event UUID 
-	const FTCHARToUTF8 ConvertedUUID(*InUUID);
-	Payload.Append(reinterpret_cast<const uint8*>(ConvertedUUID.Get()), ConvertedUUID.Length());
+	UE_LOG(LogGameObjectsService, Verbose, TEXT("Sending ball event %lld"), EventID);
 
-	//Event Type
-	constexpr uint16 EventType = static_cast<uint16>(EEventType::Ball);
-	Payload.Append(UFL_Serialization::SerializeValue(EventType));
-
-	// Event State Size
-	//constexpr int32 StateSize = sizeof(FBallState);
-	//Payload.Append(UFL_Serialization::SerializeValue(StateSize));
-	
-	// Prepare and append ball state
-	TArray<uint8> BallStateBytes;
-	BallStateBytes.SetNumUninitialized(sizeof(FBallState));
-	
-	FMemory::Memcpy(BallStateBytes.GetData(), &BallState, sizeof(FBallState));
-	Payload.Append(BallStateBytes);
-	
-	UE_LOG(LogTemp, Log, TEXT("Service_GameObjectService: Sending Trigger Ball Event Request"));
-	
 	if (!UDPSubsystem->QueueUDPMessage(EMessageType::CLIENT_EVENT_NOTIFICATION, Payload))
 	{
-		UE_LOG(LogTemp, Error, TEXT("Service_GameObjectService: Failed to send Trigger Ball Event Request"));
+		UE_LOG(LogGameObjectsService, Error, TEXT("Failed to send Trigger Ball Event Request"));
 	}
 }
 
 void UGameObjectsServiceSubsystem::HandleTriggerBallEventNotification(const TArray<uint8>& Payload) const
 {
 	// Payload Validation
-	if (Payload.Num() < 0)
+	if (Payload.Num() < EventHeaderSize + static_cast<int32>(sizeof(FBallState)))
 	{
-		UE_LOG(LogTemp, Error, TEXT("Service_GameObjectService: Invalid payload size :%d"), Payload.Num());
+		UE_LOG(LogGameObjectsService, Error, TEXT("Payload too small to contain FBallState data :%d"), Payload.Num());
 		return;
 	}
 
-	int32 Offset = 0;
-
-	// Extract Map ID
-	int64 MapId;
-	UFL_Serialization::DeserializeValue(Payload, MapId, Offset);
-	Offset += sizeof(MapId);
-
-	// Extract Chunk Coords
-	int64 ChunkX, ChunkY, ChunkZ;
-	UFL_Serialization::DeserializeValue(Payload, ChunkX, Offset);
-	Offset += sizeof(ChunkX);
-	UFL_Serialization::DeserializeValue(Payload, ChunkY, Offset);
-	Offset += sizeof(ChunkY);
-	UFL_Serialization::DeserializeValue(Payload, ChunkZ, Offset);
-	Offset += sizeof(ChunkZ);
-
-	// Extract UUID
-	FString UUID = UFL_Serialization::DeserializeString(Payload, Offset, 32);
-	Offset += 32;
-
-	// Skip Event Type
-	Offset += sizeof(uint16);
+	const int64 EventID = ReadValue<int64>(Payload, ObjectIDOffset);
+	const FBallState BallState = ReadValue<FBallState>(Payload, EventHeaderSize);
 
-	// Skip State Size
-	//Offset += sizeof(int32);
-
-	FBallState BallState;
-	
-	if (Offset + sizeof(FBallState) <= Payload.Num())
+	AsyncTask(ENamedThreads::GameThread, [this, EventID, BallState]()
 	{
-		FMemory::Memcpy(&BallState, Payload.GetData() + Offset, sizeof(FBallState));
-		if (GameObjectsManager)
+		if (IsValid(GameObjectsManager))
 		{
-			AsyncTask(ENamedThreads::GameThread, [this, UUID, BallState]()
-			{
-				GameObjectsManager->OnBallEventReceived.Broadcast(UUID, BallState);
-			});
-			return;
+			GameObjectsManager->OnBallEventReceived.Broadcast(EventID, BallState);
 		}
-	}
-	else
-	{
-		UE_LOG(LogTemp, Error, TEXT("Service_GameObjectService: Payload too small to contain FBallState data"));
-	}
-
-	UE_LOG(LogTemp, Log, TEXT("Service_GameObjectService: GameObjects Manager reference invalid"));
+	});
 }
 
 void UGameObjectsServiceSubsystem::HandleGameEventNotification(const TArray<uint8>& Payload) const
 {
-	const int32 PayloadSize = Payload.Num();
-
-	if (PayloadSize <= 0)
+	if (Payload.Num() < EventHeaderSize)
 	{
-		UE_LOG(LogTemp, Error, TEXT("Service_GameObjectService: Invalid payload size :%d"), PayloadSize);
+		UE_LOG(LogGameObjectsService, Error, TEXT("Invalid payload size :%d"), Payload.Num());
 		return;
 	}
 
-	// We get the event type directly
-	int32 Offset = 0;
-	Offset += sizeof(int64); //skip mapID
-
-	// Skip Chunk Coordinates
-	Offset += sizeof(int64); //skip chunkX
-	Offset += sizeof(int64); //skip ChunkY
-	Offset += sizeof(int64); //skip ChunkZ
-
-	// Skip UUID
-	Offset += 32; //skip UUID
-
-	// Get the event type
-	uint16 EventType;
-	UFL_Serialization::DeserializeValue(Payload, EventType, Offset);
-
-	// Cast to EEventType
-    EEventType TypedEvent = static_cast<EEventType>(EventType);
+	// The kind is at a fixed offset, the handlers read the rest
+	const EEventType TypedEvent = static_cast<EEventType>(ReadValue<uint16>(Payload, EventKindOffset));
 
 	switch (TypedEvent)
 	{
 		case EEventType::Ball:
-		UE_LOG(LogTemp, Log, TEXT("Service_GameObjectService: Ball Event Received."));
 		HandleTriggerBallEventNotification(Payload);
 		break;
 
 		case EEventType::Door:
-		UE_LOG(LogTemp, Log, TEXT("Service_GameObjectService: Door Event Received"));
-		HandleGameObjectActivationNotification(Payload);
-		break;
-
 		case EEventType::Light:
-		UE_LOG(LogTemp, Log, TEXT("Service_GameObjectService: Light Event Received"));
-		HandleGameObjectActivationNotification(Payload);
-		break;
-
 		case EEventType::Checkpoint:
-		UE_LOG(LogTemp, Log, TEXT("Service_GameObjectService: Checkpoint Event Received"));
 		HandleGameObjectActivationNotification(Payload);
 		break;
 		
 		default:
-		UE_LOG(LogTemp, Error, TEXT("Service_GameObjectService: Unknown Event Type"));
+		UE_LOG(LogGameObjectsService, Error, TEXT("Unknown Event Type %d"), static_cast<int32>(TypedEvent));
 		break;
 	}
-	
 }
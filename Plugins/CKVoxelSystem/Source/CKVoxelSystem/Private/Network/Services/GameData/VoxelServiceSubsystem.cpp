@@ -4,10 +4,10 @@
 #include "FunctionLibraries/Network/FL_Serialization.h"
 #include "Shared/Types/Structures/Voxels/FChunkVoxelState.h"
 #include "Network/Infrastructure/NetworkMessageParser.h"
+#include "Network/Infrastructure/VoxelResponseDecoder.h"
 #include "Network/GraphQL/GraphQLService.h"
 #include "Network/Services/Core/UDPSubsystem.h"
 #include "Shared/Types/Core/GameSessionSubsystem.h"
-#include "Voxels/Data/VoxelDataManager.h"
 #include "Voxels/Rendering/ChunkDataManager.h"
 
 
@@ -27,11 +27,10 @@ void UVoxelServiceSubsystem::PostSubsystemInit()
 {
 	GameSessionSubsystem = GetWorld()->GetGameInstance()->GetSubsystem<UGameSessionSubsystem>();
 	UDPSubsystem = GetWorld()->GetGameInstance()->GetSubsystem<UUDPSubsystem>();
-	VoxelDataManager = GetWorld()->GetGameInstance()->GetSubsystem<UVoxelDataManager>();
 	GraphQLService = GetWorld()->GetGameInstance()->GetSubsystem<UGraphQLService>();
 	ChunkDataManager = GetWorld()->GetGameInstance()->GetSubsystem<UChunkDataManager>();
 
-	if (!GameSessionSubsystem || !UDPSubsystem || !VoxelDataManager || !GraphQLService)
+	if (!GameSessionSubsystem || !UDPSubsystem || !ChunkDataManager || !GraphQLService)
 	{
 		UE_LOG(LogVoxelService, Error, TEXT("Some or one of the subsystem is invalid."));
 		return;
@@ -48,14 +47,19 @@ void UVoxelServiceSubsystem::SendVoxelListRequest(int64 X, int64 Y, int64 Z, int
 		return;
 	}
 
+	GraphQLService->ExecuteQueryByID(EGraphQLQuery::VoxelList, MakeVoxelListVariables(GameSessionSubsystem->GetMapID(), X, Y, Z));
+}
+
+TMap<FString, FString> UVoxelServiceSubsystem::MakeVoxelListVariables(const int64 MapId, const int64 X, const int64 Y, const int64 Z)
+{
 	TMap<FString, FString> QueryVariables;
 
-	QueryVariables.Add(TEXT("mapId"), FString::Printf(TEXT("%lld"), GameSessionSubsystem->GetMapID()));
+	QueryVariables.Add(TEXT("mapId"), FString::Printf(TEXT("%lld"), MapId));
 	QueryVariables.Add(TEXT("x"), FString::Printf(TEXT("%lld"), X));
 	QueryVariables.Add(TEXT("y"), FString::Printf(TEXT("%lld"), Y));
 	QueryVariables.Add(TEXT("z"), FString::Printf(TEXT("%lld"), Z));
 
-	GraphQLService->ExecuteQueryByID(EGraphQLQuery::VoxelList, QueryVariables);
+	return QueryVariables;
 }
 
 void UVoxelServiceSubsystem::SendVoxelStateUpdateRequest(const int64 Cx, const int64 Cy, const int64 Cz, const int32 Vx, const int32 Vy, const int32 Vz,
@@ -158,6 +162,9 @@ void UVoxelServiceSubsystem::HandleNewVoxelUpdateNotification(const TArray<uint8
 	// Dispatch the call for voxel update on the game thread.
 	UE_LOG(LogTemp, Log, TEXT("Voxel Update Response for coords %d, %d, %d"), Vx, Vy, Vz);
 	UE_LOG(LogTemp, Log, TEXT("Voxel Update Response Voxel Type: %d"), VoxelType);
+
+	// The cached voxel list of the chunk no longer matches the server
+	GraphQLService->InvalidateCachedQuery(EGraphQLQuery::VoxelList, MakeVoxelListVariables(MapId, ChunkX, ChunkY, ChunkZ));
 	
 	FGraphEventRef Task = FFunctionGraphTask::CreateAndDispatchWhenReady([this, ChunkX, ChunkY, ChunkZ, Vx, Vy, Vz, VoxelType, VoxelState, bHasState]
 	{
@@ -205,7 +212,7 @@ void UVoxelServiceSubsystem::HandleNewVoxelListResponse(const TArray<uint8>& Pay
 	if (ErrorCode != EErrorCode::SUCCESS)
 	{
 		UE_LOG(LogVoxelService, Warning, TEXT("HandleNewVoxelListResponse: Error received: %d"), static_cast<int32>(ErrorCode));
-		VoxelDataManager->OnVoxelListResponse(false, {}, {}, {}, {} );
+		ChunkDataManager->OnVoxelListDataReceived(false, FInt64Vector(ChunkX, ChunkY, ChunkZ), FChunkDataContainer());
 		return;
 	}
 	
@@ -221,8 +228,9 @@ void UVoxelServiceSubsystem::HandleNewVoxelListResponse(const TArray<uint8>& Pay
 
 	if (EndOffset > PayloadLength)
 	{
-		//UE_LOG(LogVoxelService, Error, TEXT("HandleNewVoxelListResponse: Payload too short for voxel states"));
-		VoxelDataManager->OnVoxelListResponse(true, ChunkX, ChunkY, ChunkZ, {});
+		// Truncated, reported as failed instead of merging an empty voxel list
+		UE_LOG(LogVoxelService, Warning, TEXT("HandleNewVoxelListResponse: Payload too short for voxel states"));
+		ChunkDataManager->OnVoxelListDataReceived(false, FInt64Vector(ChunkX, ChunkY, ChunkZ), FChunkDataContainer());
 		return;
 	}
 
@@ -280,7 +288,14 @@ void UVoxelServiceSubsystem::HandleNewVoxelListResponse(const TArray<uint8>& Pay
 
 	//UE_LOG(LogVoxelService, Log, TEXT("HandleNewVoxelListResponse: Total Voxel States Extracted for Chunk:%lld, %lld, %lld : %d"), ChunkX, ChunkY, ChunkZ, VoxelStates.Num());
 
-	VoxelDataManager->OnVoxelListResponse(true, ChunkX, ChunkY, ChunkZ, VoxelStates);
+	FChunkDataContainer DataContainer;
+	for (const FChunkVoxelState& ChunkVoxelState : VoxelStates)
+	{
+		DataContainer.VoxelStatesMap.Add(FVoxelCoordinate(ChunkVoxelState.Vx, ChunkVoxelState.Vy, ChunkVoxelState.Vz),
+		                                 FVoxelDefinition(1, ChunkVoxelState.VoxelType, ChunkVoxelState.VoxelState));
+	}
+
+	ChunkDataManager->OnVoxelListDataReceived(true, FInt64Vector(ChunkX, ChunkY, ChunkZ), DataContainer);
 }
 
 void UVoxelServiceSubsystem::HandleVoxelUpdateResponse(const TArray<uint8>& Payload) const
@@ -318,6 +333,8 @@ void UVoxelServiceSubsystem::HandleVoxelUpdateResponse(const TArray<uint8>& Payl
 
 	UE_LOG(LogTemp, Log, TEXT("Voxel Update Response for coords %d, %d, %d"), Vx, Vy, Vz);
 
+	GraphQLService->InvalidateCachedQuery(EGraphQLQuery::VoxelList, MakeVoxelListVariables(MapId, ChunkX, ChunkY, ChunkZ));
+
 	if (Offset < Payload.Num()) {
 		const EErrorCode ErrorCode = static_cast<EErrorCode>(Payload[Offset]);
 		UE_LOG(LogTemp, Log, TEXT("Voxel Update Response Error Code: %hhd"), ErrorCode);
@@ -341,8 +358,8 @@ void UVoxelServiceSubsystem::HandleVoxelListGraphQLResponse(const TSharedPtr<FJs
 {
 	if (!Payload.IsValid())
 	{
+		// No chunk to attribute the failure to, the request times out in UChunkDataManager instead
 		UE_LOG(LogVoxelService, Warning, TEXT("Invalid payload."));
-		VoxelDataManager->OnVoxelListResponse(false, {}, {}, {}, {});
 		return;
 	}
 
@@ -376,7 +393,7 @@ void UVoxelServiceSubsystem::HandleVoxelListGraphQLResponse(const TSharedPtr<FJs
 	if (!(*VoxelListObject)->TryGetArrayField(TEXT("voxels"), VoxelListArray))
 	{
 		UE_LOG(LogVoxelService, Error, TEXT("Failed to extract voxel list from json"));
-		//VoxelDataManager->OnVoxelListResponse(false, X, Y, Z, {});
+		ChunkDataManager->OnVoxelListDataReceived(false, FInt64Vector(X, Y, Z), FChunkDataContainer());
 		return;
 	}
 
@@ -458,5 +475,24 @@ void UVoxelServiceSubsystem::HandleVoxelListGraphQLResponse(const TSharedPtr<FJs
 	}
 	
 	ChunkDataManager->OnVoxelListDataReceived(true, FInt64Vector(X,Y,Z), DataContainer);
-	//VoxelDataManager->OnVoxelListResponse(true, X, Y, Z, VoxelStates);
+}
+
+bool UVoxelServiceSubsystem::HandleVoxelListGraphQLResponse(const TConstArrayView<uint8> Utf8Response) const
+{
+	FInt64Vector ChunkCoordinate;
+	FChunkDataContainer DataContainer;
+
+	switch (VoxelResponseDecoder::DecodeVoxelList(Utf8Response, ChunkCoordinate, DataContainer))
+	{
+	case VoxelResponseDecoder::EResult::Decoded:
+		ChunkDataManager->OnVoxelListDataReceived(true, ChunkCoordinate, DataContainer);
+		return true;
+
+	case VoxelResponseDecoder::EResult::Failed:
+		ChunkDataManager->OnVoxelListDataReceived(false, ChunkCoordinate, FChunkDataContainer());
+		return true;
+
+	default:
+		return false;
+	}
 }
@@ -1,6 +1,8 @@
 #include "Player/NonAuthClients/SkelotInstanceManager.h"
 #include "Voxels/Core/VoxelWorldSubsystem.h"
 #include "Network/Services/GameData/ActorServiceSubsystem.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
 
 
 // Sets default values
@@ -24,42 +26,101 @@ void ASkelotInstanceManager::Tick(const float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	if (!SkelotWorld)
+	{
+		return;
+	}
+
+	ApplyPendingRemoteUpdates();
+
+	FVector ViewLocation;
+	const bool bUseLOD = bEnableCrowdLOD && GetViewLocation(ViewLocation);
+	const uint32 FrameNumber = LODFrameCounter++;
+
+	UpdateRemoteLODBuckets(bUseLOD ? &ViewLocation : nullptr);
+
 	constexpr float SmoothingSpeed = 10.0f;
 
 	// For Replicated Instances Only
-	ParallelFor(RemoteInstancesData.Num(), [this, DeltaTime](const int32 Index)
+	ParallelFor(RemoteInstances.Num(), [this, DeltaTime, FrameNumber](const int32 Index)
 	{
-		FSkelotInstanceHandle& Handle = RemoteInstancesData[Index]->InstanceHandle;
-		FRemoteActorState& State = RemoteInstancesData[Index]->RemoteActorState;
+		const int32 InstanceIndex = RemoteInstances.InstanceHandles[Index].InstanceIndex;
+		const ECrowdLODBucket Bucket = RemoteInstances.LODBuckets[Index];
+
+		float& TimeSinceLastUpdate = RemoteInstances.TimeSinceLastUpdate[Index];
+		TimeSinceLastUpdate += DeltaTime;
+
+		float& TimeSinceVisualUpdate = RemoteInstances.TimeSinceVisualUpdate[Index];
+		TimeSinceVisualUpdate += DeltaTime;
+
+		// Far instances only move when the network tells them to
+		if (Bucket == ECrowdLODBucket::Far)
+		{
+			if (RemoteInstances.TransformDirty[Index])
+			{
+				RemoteInstances.TransformDirty[Index] = false;
+				TimeSinceVisualUpdate = 0.0f;
+
+				SkelotWorld->SetInstanceLocationAndRotation(
+					InstanceIndex,
+					RemoteInstances.LastKnownLocations[Index],
+					FQuat4f(FQuat(RemoteInstances.LastKnownRotations[Index]))
+				);
+			}
+			return;
+		}
+
+		if (!ShouldUpdateInBucket(Bucket, FrameNumber, RemoteInstances.DenseToHandle[Index], CrowdLODSettings, true))
+		{
+			return;
+		}
 
-		State.TimeSinceLastUpdate += DeltaTime;
+		// Throttled instances catch up with the time elapsed since their last write
+		const float Alpha = FMath::Min(TimeSinceVisualUpdate * SmoothingSpeed, 1.0f);
+		TimeSinceVisualUpdate = 0.0f;
+		RemoteInstances.TransformDirty[Index] = false;
 
 		// --- Location ---
-		const FVector PredictedLocation = State.LastKnownLocation + (State.Velocity * State.TimeSinceLastUpdate);
-		const FVector CurrentLocation = SkelotWorld->GetInstanceLocation(Handle.InstanceIndex);
-		const FVector SmoothedLocation = FMath::Lerp(CurrentLocation, PredictedLocation, DeltaTime * SmoothingSpeed);
+		const FVector PredictedLocation = RemoteInstances.LastKnownLocations[Index] + (RemoteInstances.Velocities[Index] * TimeSinceLastUpdate);
+		const FVector CurrentLocation = SkelotWorld->GetInstanceLocation(InstanceIndex);
+		const FVector SmoothedLocation = FMath::Lerp(CurrentLocation, PredictedLocation, Alpha);
 
 		// --- Rotation ---
-		const FRotator CurrentRotation = FQuat(SkelotWorld->GetInstanceRotation(Handle.InstanceIndex)).Rotator();
-		const FRotator TargetRotation = State.LastKnownRotation;
-		const FRotator SmoothedRotation = FMath::Lerp(CurrentRotation, TargetRotation, DeltaTime * SmoothingSpeed);
+		const FRotator CurrentRotation = FQuat(SkelotWorld->GetInstanceRotation(InstanceIndex)).Rotator();
+		const FRotator TargetRotation = RemoteInstances.LastKnownRotations[Index];
+		const FRotator SmoothedRotation = FMath::Lerp(CurrentRotation, TargetRotation, Alpha);
 
 		SkelotWorld->SetInstanceLocationAndRotation(
-			Handle.InstanceIndex,
+			InstanceIndex,
 			SmoothedLocation,
 			FQuat4f(FQuat(SmoothedRotation))
 		);
 	});
 
-
 	// For Locally Spawned Instances Only
-	ParallelFor(LocalInstanceCounter, [this, DeltaTime](const int32 Index)
+	ParallelFor(LocalInstanceCounter, [this, DeltaTime, FrameNumber, bUseLOD, &ViewLocation](const int32 Index)
 	{
 		FLocalInstanceData& LocalInstanceData = LocalInstancesData[Index];
 
 		FLocalActorState& LocalActorState = LocalInstanceData.LocalActorState;
 
-		LocalActorState.TimeSinceLastDirectionChange += DeltaTime;
+		LocalInstanceData.LODBucket = bUseLOD
+			                              ? ComputeLODBucket(FVector::DistSquared(LocalActorState.Location, ViewLocation),
+			                                                 LocalInstanceData.LODBucket, CrowdLODSettings)
+			                              : ECrowdLODBucket::Near;
+
+		LocalInstanceData.PendingDeltaTime += DeltaTime;
+
+		if (!ShouldUpdateInBucket(LocalInstanceData.LODBucket, FrameNumber, Index, CrowdLODSettings, false))
+		{
+			return;
+		}
+
+		// Simulate the whole throttled interval in one step
+		const float StepTime = LocalInstanceData.PendingDeltaTime;
+		LocalInstanceData.PendingDeltaTime = 0.0f;
+
+		LocalActorState.TimeSinceLastDirectionChange += StepTime;
 
 		if (LocalActorState.TimeSinceLastDirectionChange >= LocalActorState.DirectionChangeInterval)
 		{
@@ -70,7 +131,7 @@ void ASkelotInstanceManager::Tick(const float DeltaTime)
 			LocalActorState.Velocity = FRotator(0.0f, Angle, 0.0f).Vector() * LocalActorState.MovementSpeed;
 		}
 
-		LocalActorState.Location += LocalActorState.Velocity * DeltaTime;
+		LocalActorState.Location += LocalActorState.Velocity * StepTime;
 
 		if (!LocalActorState.Velocity.IsNearlyZero())
 		{
@@ -81,7 +142,7 @@ void ASkelotInstanceManager::Tick(const float DeltaTime)
 			{
 				const FRotator TargetRotation = Forward2D.Rotation() - FRotator(
 					0.0f, InstanceConstants::ROTATION_YAW_OFFSET, 0.0f);
-				LocalActorState.Rotation = FMath::RInterpTo(LocalActorState.Rotation, TargetRotation, DeltaTime, 10.0f);
+				LocalActorState.Rotation = FMath::RInterpTo(LocalActorState.Rotation, TargetRotation, StepTime, 10.0f);
 			}
 		}
 
@@ -93,148 +154,315 @@ void ASkelotInstanceManager::Tick(const float DeltaTime)
 	});
 }
 
-void ASkelotInstanceManager::AddInstance(const FString& UUID, const FActorState& State)
+bool ASkelotInstanceManager::GetViewLocation(FVector& OutLocation) const
 {
-	if (RemoteInstanceMap.Contains(UUID))
+	const APlayerController* PlayerController = GetWorld() ? GetWorld()->GetFirstPlayerController() : nullptr;
+	if (!PlayerController || !PlayerController->PlayerCameraManager)
 	{
-		UE_LOG(LogTemp, Log, TEXT("Instance already exists: %s"), *UUID);
-		return;
+		return false;
 	}
 
-	if (!SkelotWorld)
+	OutLocation = PlayerController->PlayerCameraManager->GetCameraLocation();
+	return true;
+}
+
+ECrowdLODBucket ASkelotInstanceManager::ComputeLODBucket(const float DistanceSquared, const ECrowdLODBucket CurrentBucket,
+                                                         const FCrowdLODSettings& Settings)
+{
+	// Thresholds are pushed outwards for the bucket the instance is already in, so leaving needs the extra hysteresis distance
+	const float NearDistance = Settings.NearDistance + (CurrentBucket == ECrowdLODBucket::Near ? Settings.Hysteresis : 0.0f);
+	const float MidDistance = Settings.MidDistance + (CurrentBucket != ECrowdLODBucket::Far ? Settings.Hysteresis : 0.0f);
+
+	if (DistanceSquared <= FMath::Square(NearDistance))
 	{
-		UE_LOG(LogTemp, Error, TEXT("SkelotWorld is not valid"));
-		return;
+		return ECrowdLODBucket::Near;
 	}
 
-	// Set the Spawn Transform
-	FTransform InstanceTransform;
+	if (DistanceSquared <= FMath::Square(MidDistance))
+	{
+		return ECrowdLODBucket::Mid;
+	}
 
-	InstanceTransform.SetLocation(State.Position - FVector(0.0f, 0.0f, InstanceConstants::STANDING_HEIGHT_OFFSET));
-	InstanceTransform.SetRotation(
-		(State.Rotation - FRotator(0.0f, InstanceConstants::ROTATION_YAW_OFFSET, 0.0f)).Quaternion());
+	return ECrowdLODBucket::Far;
+}
 
+bool ASkelotInstanceManager::ShouldUpdateInBucket(const ECrowdLODBucket Bucket, const uint32 FrameNumber, const int32 StaggerKey,
+                                                  const FCrowdLODSettings& Settings, const bool bRemote)
+{
+	int32 Interval = 1;
 
-	// Create the Instance
-	const FSkelotInstanceHandle NewInstanceHandle = SkelotWorld->CreateInstance(
-		InstanceTransform, FSkelotUtils::GetArrayElementRandom(RenderParams));
-	
-	// Initialize State
-	const TSharedPtr<FRemoteInstanceData> RemoteInstanceData = MakeShared<FRemoteInstanceData>();
-	RemoteInstanceData->UUID = UUID;
-	RemoteInstanceData->InstanceHandle = NewInstanceHandle;
-
-	// Set up State
-	FRemoteActorState RemoteActorState;
-	RemoteActorState.LastKnownLocation = InstanceTransform.GetLocation();
-	RemoteActorState.LastKnownRotation = InstanceTransform.GetRotation().Rotator();
-	RemoteActorState.Velocity = FVector::ZeroVector;
-	RemoteActorState.LastUpdateTime = FPlatformTime().Seconds();
-	RemoteActorState.TimeSinceLastUpdate = 0.0f;
-
-	// Set the reference for state instance
-	RemoteInstanceData->RemoteActorState = RemoteActorState;
-
-	// Add to map and array for tracking 
-	RemoteInstanceMap.Add(UUID, RemoteInstanceData);
-	RemoteInstancesData.Add(RemoteInstanceData);
-
-	UE_LOG(LogTemp, Log, TEXT("Added Instance: %s"), *UUID);
-
-	// Play Random Animation
-	UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, NewInstanceHandle]()
+	switch (Bucket)
 	{
-		SkelotWorld->InstancePlayAnimation(
-			NewInstanceHandle.InstanceIndex, FSkelotAnimPlayParams{
-				.Animation = AnimationMap[Idle],
-				.bLoop = true
-			});
-	}, LowLevelTasks::ETaskPriority::Normal, UE::Tasks::EExtendedTaskPriority::GameThreadNormalPri);
+	case ECrowdLODBucket::Near: return true;
+	case ECrowdLODBucket::Mid: Interval = Settings.MidUpdateInterval; break;
+	// Remote far instances are driven by network updates instead of the frame schedule
+	case ECrowdLODBucket::Far:
+		if (bRemote)
+		{
+			return false;
+		}
+		Interval = Settings.FarUpdateInterval;
+		break;
+	}
+
+	Interval = FMath::Max(Interval, 1);
+	return (FrameNumber + static_cast<uint32>(StaggerKey)) % static_cast<uint32>(Interval) == 0;
 }
 
-void ASkelotInstanceManager::RemoveInstance(const FString& UUID)
+void ASkelotInstanceManager::UpdateRemoteLODBuckets(const FVector* ViewLocation)
 {
-	if (!RemoteInstanceMap.Contains(UUID))
+	for (int32 Index = 0; Index < RemoteInstances.Num(); Index++)
 	{
-		UE_LOG(LogTemp, Log, TEXT("Instance does not exist: %s"), *UUID);
-		return;
-	}
+		const ECrowdLODBucket CurrentBucket = RemoteInstances.LODBuckets[Index];
+		const ECrowdLODBucket NewBucket = ViewLocation
+			                                  ? ComputeLODBucket(FVector::DistSquared(RemoteInstances.LastKnownLocations[Index], *ViewLocation),
+			                                                     CurrentBucket, CrowdLODSettings)
+			                                  : ECrowdLODBucket::Near;
 
-	if (!SkelotWorld)
-	{
-		UE_LOG(LogTemp, Log, TEXT("Skelot World is invalid. Returning..."));
-		return;
+		if (NewBucket == CurrentBucket)
+		{
+			continue;
+		}
+
+		RemoteInstances.LODBuckets[Index] = NewBucket;
+		const int32 InstanceIndex = RemoteInstances.InstanceHandles[Index].InstanceIndex;
+
+		if (NewBucket == ECrowdLODBucket::Far)
+		{
+			// Freeze the pose and snap to the last known state on the next transform pass
+			SkelotWorld->SetAnimationPaused(InstanceIndex, true);
+			RemoteInstances.TransformDirty[Index] = true;
+		}
+		else if (CurrentBucket == ECrowdLODBucket::Far)
+		{
+			// Animation selection was skipped while far, catch up with the latest received state
+			SkelotWorld->SetAnimationPaused(InstanceIndex, false);
+
+			const ERemoteAnimState DesiredState = EvaluateAnimationState(
+				RemoteInstances.Velocities[Index],
+				RemoteInstances.LastKnownRotations[Index] + FRotator(0.0f, InstanceConstants::ROTATION_YAW_OFFSET, 0.0f),
+				RemoteInstances.Crouching[Index]);
+
+			if (RemoteInstances.AnimStates[Index] != DesiredState)
+			{
+				RemoteInstances.AnimStates[Index] = DesiredState;
+				PlayRemoteAnimation(Index);
+			}
+		}
 	}
+}
+
+void ASkelotInstanceManager::PlayRemoteAnimation(const int32 DenseIndex)
+{
+	SkelotWorld->InstancePlayAnimation(
+		RemoteInstances.InstanceHandles[DenseIndex].InstanceIndex, FSkelotAnimPlayParams{
+			.Animation = AnimationMap[RemoteInstances.AnimStates[DenseIndex]],
+			.bLoop = true
+		});
+}
 
-	// Get the instance
-	const TSharedPtr<FRemoteInstanceData> RemoteInstanceData = RemoteInstanceMap[UUID];
-	RemoteInstancesData.Remove(RemoteInstanceData);
+void ASkelotInstanceManager::AddInstance(const FString& UUID, const FActorState& State)
+{
+	// Creation happens on the game thread when the update is applied
+	PendingRemoteUpdates.Enqueue(FRemoteInstanceUpdate{UUID, State, FRemoteInstanceUpdate::EOp::Add});
+}
 
-	// Destroy Instance
-	SkelotWorld->DestroyInstance(RemoteInstanceData->InstanceHandle);
-	RemoteInstanceMap.Remove(UUID);
-	UE_LOG(LogTemp, Log, TEXT("Removed Instance: %s"), *UUID);
+void ASkelotInstanceManager::RemoveInstance(const FString& UUID)
+{
+	PendingRemoteUpdates.Enqueue(FRemoteInstanceUpdate{UUID, FActorState(), FRemoteInstanceUpdate::EOp::Remove});
 }
 
 void ASkelotInstanceManager::UpdateInstance(const FString& UUID, const FActorState& State)
 {
-	if (!RemoteInstanceMap.Contains(UUID))
+	PendingRemoteUpdates.Enqueue(FRemoteInstanceUpdate{UUID, State, FRemoteInstanceUpdate::EOp::Update});
+}
+
+void ASkelotInstanceManager::ApplyPendingRemoteUpdates()
+{
+	// Pool handles whose animation state changed this frame, played once after all updates are applied
+	TArray<int32, TInlineAllocator<64>> AnimationChanges;
+
+	FRemoteInstanceUpdate Update;
+	while (PendingRemoteUpdates.Dequeue(Update))
 	{
-		UE_LOG(LogTemp, Log, TEXT("Instance does not exist: %s"), *UUID);
-		return;
+		const int32* FoundHandle = RemoteHandleByUUID.Find(Update.UUID);
+
+		if (Update.Op == FRemoteInstanceUpdate::EOp::Remove)
+		{
+			if (!FoundHandle)
+			{
+				UE_LOG(LogTemp, Log, TEXT("Instance does not exist: %s"), *Update.UUID);
+				continue;
+			}
+
+			const int32 Handle = *FoundHandle;
+			SkelotWorld->DestroyInstance(RemoteInstances.InstanceHandles[RemoteInstances.GetDenseIndex(Handle)]);
+			RemoteInstances.Remove(Handle);
+			RemoteHandleByUUID.Remove(Update.UUID);
+			UE_LOG(LogTemp, Log, TEXT("Removed Instance: %s"), *Update.UUID);
+			continue;
+		}
+
+		if (FoundHandle)
+		{
+			if (ApplyRemoteState(RemoteInstances.GetDenseIndex(*FoundHandle), Update.State))
+			{
+				AnimationChanges.AddUnique(*FoundHandle);
+			}
+			continue;
+		}
+
+		// An update that arrived after its instance was removed must not bring it back
+		if (Update.Op == FRemoteInstanceUpdate::EOp::Update)
+		{
+			UE_LOG(LogTemp, Verbose, TEXT("Instance does not exist: %s"), *Update.UUID);
+			continue;
+		}
+
+		// Set the Spawn Transform
+		FTransform InstanceTransform;
+
+		InstanceTransform.SetLocation(Update.State.Position - FVector(0.0f, 0.0f, InstanceConstants::STANDING_HEIGHT_OFFSET));
+		InstanceTransform.SetRotation(
+			(Update.State.Rotation - FRotator(0.0f, InstanceConstants::ROTATION_YAW_OFFSET, 0.0f)).Quaternion());
+
+		// Create the Instance
+		const FSkelotInstanceHandle NewInstanceHandle = SkelotWorld->CreateInstance(
+			InstanceTransform, FSkelotUtils::GetArrayElementRandom(RenderParams));
+
+		const int32 Handle = RemoteInstances.Add(NewInstanceHandle, InstanceTransform.GetLocation(),
+		                                         InstanceTransform.GetRotation().Rotator());
+		RemoteHandleByUUID.Add(Update.UUID, Handle);
+
+		// New instances start idle
+		RemoteInstances.AnimStates[RemoteInstances.GetDenseIndex(Handle)] = Idle;
+		AnimationChanges.AddUnique(Handle);
+
+		UE_LOG(LogTemp, Log, TEXT("Added Instance: %s"), *Update.UUID);
 	}
 
-	if (!SkelotWorld)
+	for (const int32 Handle : AnimationChanges)
 	{
-		UE_LOG(LogTemp, Log, TEXT("Skelot World is invalid. Returning..."));
-		return;
+		// Removed later in the same batch
+		const int32 DenseIndex = RemoteInstances.GetDenseIndex(Handle);
+		if (DenseIndex == INDEX_NONE)
+		{
+			continue;
+		}
+
+		PlayRemoteAnimation(DenseIndex);
 	}
+}
 
+bool ASkelotInstanceManager::ApplyRemoteState(const int32 DenseIndex, const FActorState& State)
+{
 	// Updating and storing the state variables
-	const TSharedPtr<FRemoteInstanceData> InstanceData = RemoteInstanceMap[UUID];
-	FRemoteActorState& StoredState = InstanceData->RemoteActorState;
-
-	StoredState.LastKnownLocation = State.bCrouch
+	RemoteInstances.LastKnownLocations[DenseIndex] = State.bCrouch
 		                                ? State.Position - FVector(0, 0, InstanceConstants::CROUCHING_HEIGHT_OFFSET)
 		                                : State.Position - FVector(
 			                                0.0f, 0.0f, InstanceConstants::STANDING_HEIGHT_OFFSET);
 
-	StoredState.LastKnownRotation = State.Rotation - FRotator(0.0f, InstanceConstants::ROTATION_YAW_OFFSET, 0.0f);
-	StoredState.Velocity = State.Velocity;
-	StoredState.LastUpdateTime = FPlatformTime().Seconds();
-	StoredState.TimeSinceLastUpdate = 0.0f;
+	RemoteInstances.LastKnownRotations[DenseIndex] = State.Rotation - FRotator(0.0f, InstanceConstants::ROTATION_YAW_OFFSET, 0.0f);
+	RemoteInstances.Velocities[DenseIndex] = State.Velocity;
+	RemoteInstances.TimeSinceLastUpdate[DenseIndex] = 0.0f;
+	RemoteInstances.Crouching[DenseIndex] = State.bCrouch;
+	RemoteInstances.TransformDirty[DenseIndex] = true;
 
+	// Far instances keep their paused pose, the state is re-evaluated when they come back into range
+	if (RemoteInstances.LODBuckets[DenseIndex] == ECrowdLODBucket::Far)
+	{
+		return false;
+	}
+
+	const ERemoteAnimState DesiredState = EvaluateAnimationState(State.Velocity, State.Rotation, State.bCrouch);
+
+	// Avoid playing the same animation repeatedly
+	if (RemoteInstances.AnimStates[DenseIndex] == DesiredState)
+	{
+		return false;
+	}
+
+	RemoteInstances.AnimStates[DenseIndex] = DesiredState;
+	return true;
+}
+
+ERemoteAnimState ASkelotInstanceManager::EvaluateAnimationState(const FVector& Velocity, const FRotator& FacingRotation,
+                                                                 const bool bIsCrouching)
+{
 	// Get the 2D velocity (ignore vertical component)
-	const FVector Velocity2D = FVector(State.Velocity.X, State.Velocity.Y, 0.0f);
+	const FVector Velocity2D = FVector(Velocity.X, Velocity.Y, 0.0f);
 	const float Speed = Velocity2D.Size();
 
-	const bool bIsCrouching = State.bCrouch;
+	if (Speed < 150.0f && !bIsCrouching)
+	{
+		return Idle;
+	}
 
-	ERemoteAnimState DesiredState = Idle;
+	const FVector MovementDirection = Velocity2D.GetSafeNormal();
+	const FVector FacingDirection = FacingRotation.Vector().GetSafeNormal2D();
+	const EMovementDirection Direction = GetMovementDirection(FacingDirection, MovementDirection);
+	return SelectAnimationState(Speed, bIsCrouching, Direction);
+}
 
-	if (Speed >= 150.0f || bIsCrouching)
+int32 FRemoteInstancePool::Add(const FSkelotInstanceHandle& InstanceHandle, const FVector& Location, const FRotator& Rotation)
+{
+	int32 Handle;
+	if (FreeHandles.Num() > 0)
 	{
-		const FVector MovementDirection = Velocity2D.GetSafeNormal();
-		const FVector FacingDirection = State.Rotation.Vector().GetSafeNormal2D();
-		const EMovementDirection Direction = GetMovementDirection(FacingDirection, MovementDirection);
-		DesiredState = SelectAnimationState(Speed, bIsCrouching, Direction);
+		Handle = FreeHandles.Pop(EAllowShrinking::No);
 	}
-
-	// Avoid playing the same animation repeatedly
-	if (InstanceData->RemoteActorState.CurrentAnimState != DesiredState)
+	else
 	{
-		InstanceData->RemoteActorState.CurrentAnimState = DesiredState;
+		Handle = HandleToDense.Add(INDEX_NONE);
+	}
 
-		FSkelotAnimPlayParams Params;
-		Params.bLoop = true;
-		Params.Animation = AnimationMap[DesiredState];
+	const int32 DenseIndex = InstanceHandles.Add(InstanceHandle);
+	LastKnownLocations.Add(Location);
+	LastKnownRotations.Add(Rotation);
+	Velocities.Add(FVector::ZeroVector);
+	TimeSinceLastUpdate.Add(0.0f);
+	AnimStates.Add(None);
+	Crouching.Add(false);
+	LODBuckets.Add(ECrowdLODBucket::Near);
+	TimeSinceVisualUpdate.Add(0.0f);
+	TransformDirty.Add(false);
+	DenseToHandle.Add(Handle);
+
+	HandleToDense[Handle] = DenseIndex;
+	return Handle;
+}
 
-		// Play the selected animation
-		UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, InstanceData, Params]()
-		{
-			SkelotWorld->InstancePlayAnimation(InstanceData->InstanceHandle.InstanceIndex, Params);
-		}, LowLevelTasks::ETaskPriority::Normal, UE::Tasks::EExtendedTaskPriority::GameThreadNormalPri);
+void FRemoteInstancePool::Remove(const int32 Handle)
+{
+	const int32 DenseIndex = GetDenseIndex(Handle);
+	if (DenseIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	// Swap the last slot into the hole and patch its handle
+	const int32 LastIndex = InstanceHandles.Num() - 1;
+	const int32 MovedHandle = DenseToHandle[LastIndex];
+
+	InstanceHandles.RemoveAtSwap(DenseIndex, 1, EAllowShrinking::No);
+	LastKnownLocations.RemoveAtSwap(DenseIndex, 1, EAllowShrinking::No);
+	LastKnownRotations.RemoveAtSwap(DenseIndex, 1, EAllowShrinking::No);
+	Velocities.RemoveAtSwap(DenseIndex, 1, EAllowShrinking::No);
+	TimeSinceLastUpdate.RemoveAtSwap(DenseIndex, 1, EAllowShrinking::No);
+	AnimStates.RemoveAtSwap(DenseIndex, 1, EAllowShrinking::No);
+	Crouching.RemoveAtSwap(DenseIndex, 1, EAllowShrinking::No);
+	LODBuckets.RemoveAtSwap(DenseIndex, 1, EAllowShrinking::No);
+	TimeSinceVisualUpdate.RemoveAtSwap(DenseIndex, 1, EAllowShrinking::No);
+	TransformDirty.RemoveAtSwap(DenseIndex, 1, EAllowShrinking::No);
+	DenseToHandle.RemoveAtSwap(DenseIndex, 1, EAllowShrinking::No);
+
+	if (MovedHandle != Handle)
+	{
+		HandleToDense[MovedHandle] = DenseIndex;
 	}
+
+	HandleToDense[Handle] = INDEX_NONE;
+	FreeHandles.Add(Handle);
 }
 
 void ASkelotInstanceManager::AddLocalInstance(const FTransform SpawnTransform)
@@ -393,28 +621,23 @@ void ASkelotInstanceManager::SendActorUpdates() const
 EMovementDirection ASkelotInstanceManager::GetMovementDirection(const FVector& FacingDirection,
                                                                 const FVector& MovementDirection)
 {
-	const float Dot = FVector::DotProduct(FacingDirection, MovementDirection);
-	const float AngleDeg = FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(Dot, -1.f, 1.f)));
-	const float CrossZ = FVector::CrossProduct(FacingDirection, MovementDirection).Z;
+	// Octant boundaries sit at 22.5 and 67.5 degrees off the facing axis, so comparing the dot product against
+	// their cosines picks the sector without an acos. The cross product sign picks the side
+	constexpr float Cos22_5 = 0.92387953f;
+	constexpr float Cos67_5 = 0.38268343f;
 
-	const float SignedAngle = (CrossZ < 0) ? -AngleDeg : AngleDeg;
-	const float Yaw360 = FMath::Fmod(SignedAngle + 360.0f, 360.0f);
+	const float Dot = FVector::DotProduct(FacingDirection, MovementDirection);
+	const bool bRight = FVector::CrossProduct(FacingDirection, MovementDirection).Z >= 0.0f;
 
-	if (Yaw360 >= 337.5f || Yaw360 < 22.5f)
+	if (Dot > Cos22_5)
 		return EMovementDirection::Forward;
-	if (Yaw360 >= 22.5f && Yaw360 < 67.5f)
-		return EMovementDirection::ForwardRight;
-	if (Yaw360 >= 67.5f && Yaw360 < 112.5f)
-		return EMovementDirection::Right;
-	if (Yaw360 >= 112.5f && Yaw360 < 157.5f)
-		return EMovementDirection::BackwardRight;
-	if (Yaw360 >= 157.5f && Yaw360 < 202.5f)
-		return EMovementDirection::Backward;
-	if (Yaw360 >= 202.5f && Yaw360 < 247.5f)
-		return EMovementDirection::BackwardLeft;
-	if (Yaw360 >= 247.5f && Yaw360 < 292.5f)
-		return EMovementDirection::Left;
-	return EMovementDirection::ForwardLeft;
+	if (Dot > Cos67_5)
+		return bRight ? EMovementDirection::ForwardRight : EMovementDirection::ForwardLeft;
+	if (Dot > -Cos67_5)
+		return bRight ? EMovementDirection::Right : EMovementDirection::Left;
+	if (Dot > -Cos22_5)
+		return bRight ? EMovementDirection::BackwardRight : EMovementDirection::BackwardLeft;
+	return EMovementDirection::Backward;
 }
 
 ERemoteAnimState ASkelotInstanceManager::SelectAnimationState(const float Speed, bool bIsCrouching,
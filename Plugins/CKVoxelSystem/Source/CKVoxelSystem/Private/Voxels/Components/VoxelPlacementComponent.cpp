@@ -258,8 +258,13 @@ void UVoxelPlacementComponent::RemoveObject(UInstancedStaticMeshComponent* ISMCo
 	
 	VoxelServiceSubsystem->SendVoxelStateUpdateRequest(Cx, Cy, Cz, Vx, Vy, Vz, VType, VState, true);
 
-	ISMComponent->RemoveInstance(InstanceIndex);
-	
+	// Through the chunk's batcher, removing from the component directly would shift the indices it keeps
+	if (!VoxelChunk->RemoveInstanceAt(ISMComponent, InstanceIndex))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("RemoveObject: instance %d is not tracked by its chunk, it goes with the state update"),
+		       InstanceIndex);
+	}
+
 }
 
 void UVoxelPlacementComponent::RemoveVoxel()
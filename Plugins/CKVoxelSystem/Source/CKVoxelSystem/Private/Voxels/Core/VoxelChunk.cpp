@@ -4,10 +4,11 @@
 #include "GameObjects/Placeable/PlaceableObjectManager.h"
 #include "Containers/Array.h"
 #include "Voxels/Rendering/AtlasManager.h"
+#include "Voxels/Rendering/ChunkLOD.h"
 #include "Shared/Types/Structures/Voxels/FChunkVoxelState.h"
 #include "Kismet/KismetMathLibrary.h"
-#include "Kismet/GameplayStatics.h"
 #include "Voxels/Rendering/VLOMeshProvider.h"
+#include "Voxels/Core/VoxelWorldSubsystem.h"
 
 DEFINE_LOG_CATEGORY(LogVoxelChunk);
 
@@ -79,11 +80,7 @@ void AVoxelChunk::BeginPlay()
 
     MaterialInstance = LoadObject<UMaterialInterface>(nullptr, TEXT("/Game/Assets/Materials/MI_NewVoxelMaterial.MI_NewVoxelMaterial"));
     
-	if (MaterialInstance)
-	{
-		DynamicMaterialInstance = UMaterialInstanceDynamic::Create(MaterialInstance, this);
-	}
-	else
+	if (!MaterialInstance)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("Failed to load material instance."));
 	}
@@ -92,6 +89,14 @@ void AVoxelChunk::BeginPlay()
     
 }
 
+void AVoxelChunk::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    ReleaseAtlasMaterials(HeldAtlasMaterials);
+    HeldAtlasMaterials.Reset();
+
+    Super::EndPlay(EndPlayReason);
+}
+
 void AVoxelChunk::DrawChunkBounds()
 {
     FVector ChunkCenter = GetActorLocation();
@@ -166,7 +171,7 @@ int AVoxelChunk::DistanceToChunk(FInt64Vector chunkPos) const
     return FMath::Max3(FMath::Abs(X - chunkPos.X), FMath::Abs(Y - chunkPos.Y), FMath::Abs(Z - chunkPos.Z));
 }
 
-void AVoxelChunk::UpdateChunk(const TArray<uint8>& voxels)
+void AVoxelChunk::UpdateChunk(const TArray<uint8>& voxels, const bool bRegenerateMesh)
 {
     if (!bInitialized)
     {
@@ -180,7 +185,7 @@ void AVoxelChunk::UpdateChunk(const TArray<uint8>& voxels)
         return;
     }
 
-    if (voxels == Voxels)
+    if (Voxels.Matches(voxels))
     {
         UE_LOG(LogVoxelChunk, Warning, TEXT("AVoxelChunk::UpdateChunk called with identical voxels!"));
         return;
@@ -196,8 +201,12 @@ void AVoxelChunk::UpdateChunk(const TArray<uint8>& voxels)
 
     OcclusionLevel = static_cast<float>(NumOfEmptyVoxels) / static_cast<float>(NumOfVoxels);
 
-    Voxels = voxels;
-    RegenerateChunk();
+    Voxels.Assign(voxels);
+
+    if (bRegenerateMesh)
+    {
+        RegenerateChunk();
+    }
 }
 
 void AVoxelChunk::UpdateVoxel(const int x, const int y, const int z, const uint8 voxelType)
@@ -219,11 +228,11 @@ void AVoxelChunk::UpdateVoxel(const int x, const int y, const int z, const uint8
     //UE_LOG(LogVoxelChunk, Log, TEXT("AVoxelChunk::UpdateVoxel(%d, %d, %d) called"), x, y, z);
 
     constexpr uint8 EmptyVoxel = static_cast<uint8>(EVoxelType::AIR);
-    if ((Voxels[voxelIndex] == EmptyVoxel) && (voxelType != EmptyVoxel))
+    if ((Voxels.Get(voxelIndex) == EmptyVoxel) && (voxelType != EmptyVoxel))
     {
         OcclusionLevel += SingleVoxelOcclusion;
     }
-    else if ((Voxels[voxelIndex] != EmptyVoxel) && (voxelType == EmptyVoxel))
+    else if ((Voxels.Get(voxelIndex) != EmptyVoxel) && (voxelType == EmptyVoxel))
     {
         OcclusionLevel -= SingleVoxelOcclusion;
     }
@@ -236,7 +245,7 @@ void AVoxelChunk::UpdateVoxel(const int x, const int y, const int z, const uint8
         VoxelStates[voxelIndex].bIsVLO = false;
     }
     
-    Voxels[voxelIndex] = voxelType;
+    Voxels.Set(voxelIndex, voxelType);
     VoxelStates[voxelIndex].ResetVoxelState();
     RegenerateChunk();
 }
@@ -261,16 +270,16 @@ void AVoxelChunk::UpdateVoxelWithState(const int x, const int y, const int z, co
     //UE_LOG(LogVoxelChunk, Log, TEXT("AVoxelChunk::UpdateVoxel(%d, %d, %d) called"), x, y, z);
 
     constexpr uint8 EmptyVoxel = static_cast<uint8>(EVoxelType::AIR);
-    if ((Voxels[voxelIndex] == EmptyVoxel) && (voxelType != EmptyVoxel))
+    if ((Voxels.Get(voxelIndex) == EmptyVoxel) && (voxelType != EmptyVoxel))
     {
         OcclusionLevel += SingleVoxelOcclusion;
     }
-    else if ((Voxels[voxelIndex] != EmptyVoxel) && (voxelType == EmptyVoxel))
+    else if ((Voxels.Get(voxelIndex) != EmptyVoxel) && (voxelType == EmptyVoxel))
     {
         OcclusionLevel -= SingleVoxelOcclusion;
     }
 
-    Voxels[voxelIndex] = voxelType;
+    Voxels.Set(voxelIndex, voxelType);
 
     FVoxelState& CurrentVoxelState = GetVoxelState(x, y, z);
     CurrentVoxelState.Rotation = State.Rotation;
@@ -314,7 +323,7 @@ void AVoxelChunk::UpdateStates(const TMap<FVoxelCoordinate, FVoxelDefinition>& V
         }
 
         // Early-diff check
-        if (VoxelStates[VoxelStateIndex] != VoxelDef.VoxelState || Voxels[VoxelStateIndex] != VoxelDef.VoxelType)
+        if (VoxelStates[VoxelStateIndex] != VoxelDef.VoxelState || Voxels.Get(VoxelStateIndex) != VoxelDef.VoxelType)
         {
             bHasAnyChange = true;
             break;
@@ -341,7 +350,7 @@ void AVoxelChunk::UpdateStates(const TMap<FVoxelCoordinate, FVoxelDefinition>& V
         }
 
         VoxelStates[VoxelStateIndex] = VoxelDef.VoxelState;
-        Voxels[VoxelStateIndex] = VoxelDef.VoxelType;
+        Voxels.Set(VoxelStateIndex, VoxelDef.VoxelType);
     }
 
     RegenerateChunk();
@@ -361,16 +370,16 @@ void AVoxelChunk::UpdateVoxels(const TArray<FVoxelListItem>& voxels)
         }
 
         constexpr uint8 EmptyVoxel = static_cast<uint8>(EVoxelType::AIR);
-        if ((Voxels[voxelIndex] == EmptyVoxel) && (voxel.type != EmptyVoxel))
+        if ((Voxels.Get(voxelIndex) == EmptyVoxel) && (voxel.type != EmptyVoxel))
         {
             OcclusionLevel += SingleVoxelOcclusion;
         }
-        else if ((Voxels[voxelIndex] != EmptyVoxel) && (voxel.type == EmptyVoxel))
+        else if ((Voxels.Get(voxelIndex) != EmptyVoxel) && (voxel.type == EmptyVoxel))
         {
             OcclusionLevel -= SingleVoxelOcclusion;
         }
 
-        Voxels[voxelIndex] = voxel.type;
+        Voxels.Set(voxelIndex, voxel.type);
     }
 
     RegenerateChunk();
@@ -378,7 +387,13 @@ void AVoxelChunk::UpdateVoxels(const TArray<FVoxelListItem>& voxels)
 
 void AVoxelChunk::UpdateVoxelsAtlas(UTexture* TextureAtlas)
 {
-	DynamicMaterialInstance->SetTextureParameterValue(FName("TextureAtlas"), TextureAtlas);
+    DefaultAtlasTexture = TextureAtlas;
+
+    // Shared default atlas materials are rebound through AAtlasManager::SetDefaultAtlas
+    if (DynamicMaterialInstance)
+    {
+        DynamicMaterialInstance->SetTextureParameterValue(FName("TextureAtlas"), TextureAtlas);
+    }
 }
 
 void AVoxelChunk::UpdateVoxelAtWorldCoords(const FVector worldLocation, const uint8 voxelType)
@@ -426,9 +441,11 @@ void AVoxelChunk::FillChunk(const uint8 voxelType)
     RegenerateChunk();
 }
 
-const TArray<uint8>& AVoxelChunk::GetVoxelArray()
+TArray<uint8> AVoxelChunk::GetVoxelArray() const
 {
-    return Voxels;
+    TArray<uint8> VoxelArray;
+    Voxels.Decode(VoxelArray);
+    return VoxelArray;
 }
 
 const uint8 AVoxelChunk::GetVoxel(const int x, const int y, const int z)
@@ -442,7 +459,7 @@ const uint8 AVoxelChunk::GetVoxel(const int x, const int y, const int z)
         return static_cast<uint8>(EVoxelType::AIR);
     }
 
-    return Voxels[index];
+    return Voxels.Get(index);
 }
 
 void AVoxelChunk::ToggleChunkBounds(bool bEnable)
@@ -541,7 +558,7 @@ float AVoxelChunk::GetOcclusionLvl() const
     return OcclusionLevel;
 }
 
-void AVoxelChunk::ApplyVoxelUpdates(const FChunkDataContainer& VoxelUpdateData)
+void AVoxelChunk::ApplyVoxelUpdates(const FChunkDataContainer& VoxelUpdateData, const bool bRegenerateMesh)
 {
     if (!bInitialized)
     {
@@ -571,14 +588,16 @@ void AVoxelChunk::ApplyVoxelUpdates(const FChunkDataContainer& VoxelUpdateData)
             UE_LOG(LogVoxelChunk, Log, TEXT("Chunk %lld, %lld, %lld Applying update for voxel %d, %d, %d"),
                    VoxelUpdateData.ChunkCoordinate.X, VoxelUpdateData.ChunkCoordinate.Y,
                    VoxelUpdateData.ChunkCoordinate.Z, VoxelCoord.X, VoxelCoord.Y, VoxelCoord.Z);
-            Voxels[Index] = VoxelDef.VoxelType;
+            Voxels.Set(Index, VoxelDef.VoxelType);
             VoxelStates[Index] = VoxelDef.VoxelState;
         }
         
     }
 
-    RegenerateChunk();
-    
+    if (bRegenerateMesh)
+    {
+        RegenerateChunk();
+    }
 }
 
 void AVoxelChunk::RegenerateChunk()
@@ -592,7 +611,18 @@ void AVoxelChunk::RegenerateChunk()
     mesh->ClearMeshSection(0);
     mesh->ClearAllMeshSections();
 
-    ClearAllVLOInstances();
+    // VLOs and placed objects are set again below, only the instances that changed are touched on the next flush
+    InstanceBatcher.BeginRebuild();
+    QueueInstanceFlush();
+
+    UVoxelWorldSubsystem* VoxelWorld = GetWorld()->GetSubsystem<UVoxelWorldSubsystem>();
+
+    // Placed objects are spawned again below
+    APlaceableObjectManager* PlaceableManager = VoxelWorld->GetPlaceableObjectManager();
+    if (PlaceableManager)
+    {
+        PlaceableManager->ClearChunkObjects(this);
+    }
     
     struct FMeshData
     {
@@ -603,16 +633,36 @@ void AVoxelChunk::RegenerateChunk()
         TArray<FVector2D> UVs;
         TArray<FProcMeshTangent> Tangents;
         int32 VertexOffset = 0;
-        UMaterialInstanceDynamic* AtlasMaterial;
+        UMaterialInterface* AtlasMaterial = nullptr;
     };
 
     TMap<int64, FMeshData> OverrideMeshData;
     FMeshData DefaultMeshData;
 
-    TMap<uint8, TArray<FTransform>> VLOInstancesTransforms;
+    // Keyed by voxel index, so unchanged VLOs keep their instance
+    TMap<uint8, TArray<TPair<uint64, FTransform>>> VLOInstancesTransforms;
 
     int32 CulledFaces = 0;
 
+    // Held for the whole pass so a table rebuilt meanwhile can't change under us
+    const FVoxelTypeTablePtr TypeTablePtr = VoxelWorld->GetVoxelTypeTable();
+    const FVoxelTypeTable& TypeTable = *TypeTablePtr;
+
+    // A chunk of a single empty type has no faces and no VLOs, only placed objects are left to spawn
+    if (Voxels.IsUniform() && TypeTable.bEmpty[Voxels.GetUniformValue()]
+        && !VoxelStates.ContainsByPredicate([](const FVoxelState& State) { return State.GameObjects.Num() > 0; }))
+    {
+        ReleaseAtlasMaterials(HeldAtlasMaterials);
+        HeldAtlasMaterials.Reset();
+        return;
+    }
+
+    if (LODLevel > 0)
+    {
+        RegenerateLODMesh(TypeTable);
+        return;
+    }
+
     for (uint32 x = 0U; x < ChunkSize; ++x)
     {
         for (uint32 y = 0U; y < ChunkSize; ++y)
@@ -626,42 +676,32 @@ void AVoxelChunk::RegenerateChunk()
 
                 // Get Voxel State
                 FVoxelState& CurrentVoxelState = GetVoxelState(x, y, z);
+                const uint64 VoxelIndex = x + y * ChunkSize + z * ChunkSize * ChunkSize;
                 
-                // Get Placeable Manager to spawn game objects
-                TArray<AActor*> FoundActors;
-                UGameplayStatics::GetAllActorsOfClass(GetWorld(), APlaceableObjectManager::StaticClass(), FoundActors);
-
-                APlaceableObjectManager* Manager = nullptr;
-                if (FoundActors.Num() > 0)
+                if (CurrentVoxelState.GameObjects.Num() > 0 && !PlaceableManager)
                 {
-                    Manager = Cast<APlaceableObjectManager>(FoundActors[0]);
+                    UE_LOG(LogVoxelChunk, Error, TEXT("Placeable object manager not found! Unable to spawn game objects"));
                 }
-
-                if (Manager)
+                else
                 {
-                    for (auto& ObjState : CurrentVoxelState.GameObjects)
+                    for (int32 ObjIndex = 0; ObjIndex < CurrentVoxelState.GameObjects.Num(); ++ObjIndex)
                     {
-                        UInstancedStaticMeshComponent* OutHISM = nullptr;
-                        int32 OutInstanceIndex = INDEX_NONE;
-
+                        const auto& ObjState = CurrentVoxelState.GameObjects[ObjIndex];
                         FVector ObjWrldLocation = GetVoxelCenter(VoxelPosition) + ObjState.Location;
 
-                        UE_LOG(LogVoxelChunk, Log, TEXT("Spawning object at location (%f, %f, %f)"), ObjWrldLocation.X, ObjWrldLocation.Y, ObjWrldLocation.Z);
+                        UE_LOG(LogVoxelChunk, Verbose, TEXT("Spawning object at location (%f, %f, %f)"), ObjWrldLocation.X, ObjWrldLocation.Y, ObjWrldLocation.Z);
 
-                        Manager->SpawnById(
+                        // Deferred until the object's mesh or class has loaded, the first time its type shows up
+                        PlaceableManager->RequestSpawnById(
                             FName(*ObjState.ObjectID),
                             FTransform(ObjState.Rotation, ObjWrldLocation, ObjState.Scale),
                             this,
-                            OutHISM, OutInstanceIndex
+                            (VoxelIndex << 16) | ObjIndex
                         );
                     }
                 }
-                else
-                {
-                    UE_LOG(LogVoxelChunk, Error, TEXT("Placeable object manager not found! Unable to spawn game objects"));
-                }
 
-                if (VoxelType == static_cast<uint8>(EVoxelType::AIR))
+                if (TypeTable.bEmpty[VoxelType])
 	            {
 	                continue;
 	            }
@@ -669,7 +709,7 @@ void AVoxelChunk::RegenerateChunk()
                 // In the VLO section of RegenerateChunk(), add detailed logging:
                 if (CurrentVoxelState.IsVLO() && VLOMeshProvider)
                 {
-                    if (VLOMeshProvider->HasVLOMesh(VoxelType))
+                    if (TypeTable.bHasVLOMesh[VoxelType])
                     {
                         FVector LocalVoxelPosition;
                         LocalVoxelPosition.X = (VoxelPosition.X - ChunkSize / 2.0f + 0.5f) * VoxelSize;
@@ -681,15 +721,14 @@ void AVoxelChunk::RegenerateChunk()
                         FRotator VLORotation = CalculateVLORotation(CurrentVoxelState.FaceOneDirection, CurrentVoxelState.Rotation);
                         FVector AdjustedPosition = CalculateVLOPosition(WorldPosition, CurrentVoxelState.FaceOneDirection, CurrentVoxelState.Rotation);
                          
-                        // Debug logging
-                        UE_LOG(LogVoxelChunk, Warning, TEXT("VLO Debug - Chunk: (%lld,%lld,%lld), VoxelPos: (%d,%d,%d), LocalPos: (%.2f,%.2f,%.2f), ChunkWorldPos: (%.2f,%.2f,%.2f)"), 
+                        UE_LOG(LogVoxelChunk, VeryVerbose, TEXT("VLO Debug - Chunk: (%lld,%lld,%lld), VoxelPos: (%d,%d,%d), LocalPos: (%.2f,%.2f,%.2f), ChunkWorldPos: (%.2f,%.2f,%.2f)"), 
                                X, Y, Z,
                                (int32)VoxelPosition.X, (int32)VoxelPosition.Y, (int32)VoxelPosition.Z,
                                LocalVoxelPosition.X, LocalVoxelPosition.Y, LocalVoxelPosition.Z,
                                GetActorLocation().X, GetActorLocation().Y, GetActorLocation().Z);
                          
                         FTransform VLOTransform = FTransform(VLORotation, AdjustedPosition, FVector::OneVector);
-                        VLOInstancesTransforms.FindOrAdd(VoxelType).Add(VLOTransform);
+                        VLOInstancesTransforms.FindOrAdd(VoxelType).Emplace(VoxelIndex, VLOTransform);
                         continue;
                     }
                     else
@@ -702,18 +741,15 @@ void AVoxelChunk::RegenerateChunk()
                 // Cull hidden faces // Bottom Front Top Right Back Left
                 // Cull hidden faces // Bottom Front Top Right Back Left
                 bool VisibleFaces[6] = {
-                    (z == 0U)            || IsVoxelTransparentForCulling(x, y, z-1),
-                    (x == 0U)            || IsVoxelTransparentForCulling(x-1, y, z),
-                    (z == ChunkSize - 1) || IsVoxelTransparentForCulling(x, y, z+1),
-                    (y == ChunkSize - 1) || IsVoxelTransparentForCulling(x, y+1, z),
-                    (x == ChunkSize - 1) || IsVoxelTransparentForCulling(x+1, y, z),
-                    (y == 0U)            || IsVoxelTransparentForCulling(x, y-1, z)
+                    (z == 0U)            || IsVoxelTransparentForCulling(TypeTable, x, y, z-1),
+                    (x == 0U)            || IsVoxelTransparentForCulling(TypeTable, x-1, y, z),
+                    (z == ChunkSize - 1) || IsVoxelTransparentForCulling(TypeTable, x, y, z+1),
+                    (y == ChunkSize - 1) || IsVoxelTransparentForCulling(TypeTable, x, y+1, z),
+                    (x == ChunkSize - 1) || IsVoxelTransparentForCulling(TypeTable, x+1, y, z),
+                    (y == 0U)            || IsVoxelTransparentForCulling(TypeTable, x, y-1, z)
                 };
 
-
-                UEnum* EnumPtr = StaticEnum<EVoxelType>();
-
-                float VoxelTypeIndex = static_cast<float>(VoxelType - 1) / static_cast<float>(EnumPtr->GetMaxEnumValue() - 1);
+                const float VoxelTypeIndex = TypeTable.AtlasIndex[VoxelType];
 
                 FVector HalfSize = FVector(ChunkSize * VoxelSize / 2);
 
@@ -734,7 +770,10 @@ void AVoxelChunk::RegenerateChunk()
         }
     }
 
-    DefaultMeshData.AtlasMaterial = DynamicMaterialInstance;
+    // Acquired before the previous ones are released, so materials still in use are never recreated
+    TArray<int64> NewHeldAtlasMaterials;
+
+    DefaultMeshData.AtlasMaterial = AcquireAtlasMaterial(AAtlasManager::DEFAULT_ATLAS_ID, NewHeldAtlasMaterials);
     mesh->CreateMeshSection_LinearColor(0, DefaultMeshData.Vertices, DefaultMeshData.Triangles, DefaultMeshData.Normals, DefaultMeshData.UVs, DefaultMeshData.VertexColors, DefaultMeshData.Tangents, true);
     mesh->SetMaterial(0, DefaultMeshData.AtlasMaterial);
     
@@ -744,13 +783,8 @@ void AVoxelChunk::RegenerateChunk()
         const int64 AtlasOverride = Pair.Key;
         FMeshData& MeshData = Pair.Value;
         mesh->CreateMeshSection_LinearColor(SectionIndex, MeshData.Vertices, MeshData.Triangles, MeshData.Normals, MeshData.UVs, MeshData.VertexColors, MeshData.Tangents, true);
-        if (AtlasManager->DoesAtlasExist(AtlasOverride))
-        {
-            UTexture* AtlasOverrideTexture = AtlasManager->GetAtlas(AtlasOverride);
-            UMaterialInstanceDynamic* NewMat = CreateNewMaterialInstance(AtlasOverrideTexture);
-            MeshData.AtlasMaterial = NewMat;
-        }
-        else
+        MeshData.AtlasMaterial = AcquireAtlasMaterial(AtlasOverride, NewHeldAtlasMaterials);
+        if (!MeshData.AtlasMaterial && AtlasManager)
         {
             AtlasManager->RequestAtlas(AtlasOverride);
         }
@@ -759,26 +793,30 @@ void AVoxelChunk::RegenerateChunk()
         SectionIndex++;
     }
 
+    ReleaseAtlasMaterials(HeldAtlasMaterials);
+    HeldAtlasMaterials = MoveTemp(NewHeldAtlasMaterials);
+
     // Generate VLO instances
     for (const auto& VLOPair : VLOInstancesTransforms)
     {
         uint8 VoxelType = VLOPair.Key;
-        const TArray<FTransform>& VLOTransforms = VLOPair.Value;
+        const TArray<TPair<uint64, FTransform>>& VLOTransforms = VLOPair.Value;
     
-        UE_LOG(LogVoxelChunk, Log, TEXT("Processing VLO instances for voxel type %d: %d instances"), VoxelType, VLOTransforms.Num());
+        UE_LOG(LogVoxelChunk, Verbose, TEXT("Processing VLO instances for voxel type %d: %d instances"), VoxelType, VLOTransforms.Num());
     
         if (VLOMeshProvider)
         {
-            UStaticMesh* VLOMesh = VLOMeshProvider->GetVLOMesh(VoxelType);
+            UStaticMesh* VLOMesh = TypeTable.VLOMeshes[VoxelType];
             if (VLOMesh)
             {
-                UE_LOG(LogVoxelChunk, Log, TEXT("Found VLO mesh for voxel type %d: %s"), VoxelType, *VLOMesh->GetName());
+                UE_LOG(LogVoxelChunk, Verbose, TEXT("Found VLO mesh for voxel type %d: %s"), VoxelType, *VLOMesh->GetName());
             
                 if (UInstancedStaticMeshComponent* VLOComponent = GetOrCreateVLOComponent(VoxelType, VLOMesh))
                 {
-                    UE_LOG(LogVoxelChunk, Log, TEXT("Adding %d instances to VLO component for voxel type %d"), VLOTransforms.Num(), VoxelType);
-                    VLOComponent->AddInstances(VLOTransforms, false, true);
-                    UE_LOG(LogVoxelChunk, Log, TEXT("Successfully added VLO instances. Total instances in component: %d"), VLOComponent->GetInstanceCount());
+                    for (const TPair<uint64, FTransform>& VLO : VLOTransforms)
+                    {
+                        SetInstance(VLOComponent, VLO.Key, VLO.Value);
+                    }
                 }
                 else
                 {
@@ -798,6 +836,45 @@ void AVoxelChunk::RegenerateChunk()
 	//UE_LOG(LogVoxelChunk, Log, TEXT("Generated mesh: %d (%d)"), Vertices.Num(), CulledFaces);
 }
 
+bool AVoxelChunk::SetLODLevel(const int32 Level)
+{
+    const int32 NewLevel = FMath::Clamp(Level, 0, ChunkLOD::IMPOSTOR_LEVEL - 1);
+    if (NewLevel == LODLevel)
+    {
+        return false;
+    }
+
+    LODLevel = NewLevel;
+    return true;
+}
+
+void AVoxelChunk::GetDownsampledVoxels(const int32 Factor, const FVoxelTypeTable& TypeTable, TArray<uint8>& OutCells) const
+{
+    ChunkLOD::Downsample(Voxels, ChunkSize, Factor, TypeTable, OutCells);
+}
+
+void AVoxelChunk::RegenerateLODMesh(const FVoxelTypeTable& TypeTable)
+{
+    const int32 Factor = ChunkLOD::GetDownsampleFactor(LODLevel);
+    const int32 CellsPerAxis = ChunkSize / Factor;
+
+    TArray<uint8> Cells;
+    ChunkLOD::Downsample(Voxels, ChunkSize, Factor, TypeTable, Cells);
+
+    ChunkLOD::FMeshData MeshData;
+    ChunkLOD::BuildMesh(Cells, FIntVector(CellsPerAxis), VoxelSize * Factor, FVector(-(ChunkSize * VoxelSize / 2.0f)),
+                        TypeTable, MeshData);
+
+    TArray<int64> NewHeldAtlasMaterials;
+    UMaterialInterface* AtlasMaterial = AcquireAtlasMaterial(AAtlasManager::DEFAULT_ATLAS_ID, NewHeldAtlasMaterials);
+
+    mesh->CreateMeshSection_LinearColor(0, MeshData.Vertices, MeshData.Triangles, MeshData.Normals, MeshData.UVs, MeshData.VertexColors, MeshData.Tangents, true);
+    mesh->SetMaterial(0, AtlasMaterial);
+
+    ReleaseAtlasMaterials(HeldAtlasMaterials);
+    HeldAtlasMaterials = MoveTemp(NewHeldAtlasMaterials);
+}
+
 void AVoxelChunk::GenerateCubeMesh(FVector Position, FVector HalfSize, float VoxelSize, const bool VisibleFaces[6], TArray<FVector>& Vertices, TArray<int32>& Triangles,
                                     TArray<FVector>& Normals, TArray<FVector2D>& UVs, int32& VertexOffset, int32& culledFaces, TArray<FLinearColor>& VertexColors, float VoxelTypeIndex, FVoxelState
                                     & State, TArray<FProcMeshTangent>& Tangents)
@@ -1132,11 +1209,43 @@ void AVoxelChunk::DetermineVoxelFaces(const uint8& FaceOneDirection, const uint8
     }
 }
 
-UMaterialInstanceDynamic* AVoxelChunk::CreateNewMaterialInstance(UTexture* InTexture)
+UMaterialInterface* AVoxelChunk::AcquireAtlasMaterial(const int64 AtlasID, TArray<int64>& OutHeldAtlasIDs)
 {
-    UMaterialInstanceDynamic* NewAtlasMaterial = UMaterialInstanceDynamic::Create(MaterialInstance, this);
-    NewAtlasMaterial->SetTextureParameterValue("TextureAtlas", InTexture);
-    return NewAtlasMaterial;
+    if (IsValid(AtlasManager))
+    {
+        UMaterialInstanceDynamic* Material = AtlasManager->AcquireAtlasMaterial(MaterialInstance, AtlasID);
+        if (Material)
+        {
+            OutHeldAtlasIDs.Add(AtlasID);
+        }
+        return Material;
+    }
+
+    if (AtlasID != AAtlasManager::DEFAULT_ATLAS_ID || !MaterialInstance)
+    {
+        return nullptr;
+    }
+
+    if (!DynamicMaterialInstance)
+    {
+        DynamicMaterialInstance = UMaterialInstanceDynamic::Create(MaterialInstance, this);
+        DynamicMaterialInstance->SetTextureParameterValue(FName("TextureAtlas"), DefaultAtlasTexture);
+    }
+
+    return DynamicMaterialInstance;
+}
+
+void AVoxelChunk::ReleaseAtlasMaterials(const TArray<int64>& AtlasIDs)
+{
+    if (!IsValid(AtlasManager))
+    {
+        return;
+    }
+
+    for (const int64 AtlasID : AtlasIDs)
+    {
+        AtlasManager->ReleaseAtlasMaterial(MaterialInstance, AtlasID);
+    }
 }
 
 
@@ -1208,6 +1317,10 @@ bool AVoxelChunk::IsNonStandardVoxel(const int x, const int y, const int z)
 
 void AVoxelChunk::SetAtlasManagerReference(AAtlasManager* InAtlasManger)
 {
+    // Materials are only ever given back to the manager they came from
+    ReleaseAtlasMaterials(HeldAtlasMaterials);
+    HeldAtlasMaterials.Reset();
+
     AtlasManager = InAtlasManger;
     AtlasManager->OnAtlasLoaded.AddDynamic(this, &AVoxelChunk::HandleAtlasOverrides);
 }
@@ -1217,11 +1330,9 @@ void AVoxelChunk::HandleAtlasOverrides(UTexture* inAtlas)
     RegenerateChunk();
 }
 
-bool AVoxelChunk::IsVoxelTransparentForCulling(const uint32 Vx, const uint32 Vy, const uint32 Vz)
+bool AVoxelChunk::IsVoxelTransparentForCulling(const FVoxelTypeTable& TypeTable, const uint32 Vx, const uint32 Vy, const uint32 Vz)
 {
-    uint8 VoxelType = GetVoxel(Vx, Vy, Vz);
-
-    if (VoxelType == static_cast<uint8>(EVoxelType::AIR))
+    if (TypeTable.bEmpty[GetVoxel(Vx, Vy, Vz)])
     {
         return true;
     }
@@ -1310,23 +1421,48 @@ FVector AVoxelChunk::GetVoxelCenter(const FVector VoxelPosition) const
     return WorldPosition;
 }
 
-void AVoxelChunk::ClearAllVLOInstances()
+void AVoxelChunk::SetInstance(UInstancedStaticMeshComponent* Component, const uint64 Key, const FTransform& WorldTransform)
 {
-    for (auto& Pair : VLOInstancedMeshes)
+    InstanceBatcher.SetInstance(Component, Key, WorldTransform);
+    QueueInstanceFlush();
+}
+
+void AVoxelChunk::RemoveInstance(UInstancedStaticMeshComponent* Component, const uint64 Key)
+{
+    InstanceBatcher.RemoveInstance(Component, Key);
+    QueueInstanceFlush();
+}
+
+bool AVoxelChunk::RemoveInstanceAt(UInstancedStaticMeshComponent* Component, const int32 InstanceIndex)
+{
+    uint64 Key = 0;
+    if (!InstanceBatcher.FindInstanceKey(Component, InstanceIndex, Key))
     {
-        if (UInstancedStaticMeshComponent* Component = Pair.Value)
-        {
-            Component->ClearInstances();
-        }
+        return false;
     }
 
-    for (auto& Pair : ObjectInstancedMeshes)
+    RemoveInstance(Component, Key);
+    return true;
+}
+
+void AVoxelChunk::QueueInstanceFlush()
+{
+    if (bInstanceFlushQueued)
     {
-        if (TObjectPtr<UInstancedStaticMeshComponent> Component = Pair.Value)
-        {
-            Component->ClearInstances();
-        }
+        return;
     }
+
+    if (UVoxelWorldSubsystem* VoxelWorld = GetWorld()->GetSubsystem<UVoxelWorldSubsystem>())
+    {
+        VoxelWorld->QueueInstanceFlush(this);
+        bInstanceFlushQueued = true;
+    }
+}
+
+void AVoxelChunk::FlushInstances()
+{
+    bInstanceFlushQueued = false;
+    InstanceBatcher.Flush();
 }
 
 UInstancedStaticMeshComponent* AVoxelChunk::GetOrCreateVLOComponent(uint8 VoxelType, UStaticMesh* Mesh)
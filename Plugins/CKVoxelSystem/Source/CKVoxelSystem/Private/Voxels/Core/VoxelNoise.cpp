@@ -0,0 +1,211 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Voxels/Core/VoxelNoise.h"
+#include "Math/RandomStream.h"
+#include "Math/VectorRegister.h"
+
+DEFINE_LOG_CATEGORY(LogVoxelNoise);
+
+namespace
+{
+	// Same permutation as FMath::PerlinNoise3D, the batched kernel has to match it bit for bit
+	constexpr int32 BasePermutation[256] = {
+		63, 9, 212, 205, 31, 128, 72, 59, 137, 203, 195, 170, 181, 115, 165, 40,
+		116, 139, 175, 225, 132, 99, 222, 2, 41, 15, 197, 93, 169, 90, 228, 43,
+		244, 81, 226, 17, 49, 122, 153, 21, 220, 158, 235, 42, 138, 144, 107, 85,
+		108, 22, 248, 255, 45, 104, 18, 187, 8, 120, 163, 231, 65, 36, 188, 230,
+		6, 118, 26, 34, 174, 44, 76, 168, 179, 29, 189, 55, 186, 191, 98, 58,
+		148, 246, 52, 157, 236, 151, 48, 114, 92, 126, 67, 102, 101, 19, 171, 140,
+		173, 7, 100, 196, 214, 73, 185, 38, 135, 162, 200, 83, 5, 61, 4, 23,
+		80, 233, 121, 142, 129, 198, 119, 64, 62, 35, 161, 84, 111, 112, 16, 193,
+		250, 167, 247, 97, 145, 11, 150, 221, 124, 184, 24, 199, 94, 51, 60, 78,
+		160, 10, 123, 47, 130, 254, 183, 164, 149, 103, 178, 229, 79, 237, 176, 159,
+		201, 28, 53, 110, 3, 56, 75, 131, 182, 207, 57, 192, 20, 82, 54, 117,
+		143, 89, 91, 215, 69, 30, 213, 70, 194, 66, 0, 12, 106, 180, 242, 127,
+		105, 217, 113, 245, 88, 209, 166, 32, 39, 74, 238, 204, 13, 1, 172, 240,
+		25, 86, 208, 216, 33, 219, 210, 152, 96, 71, 87, 224, 211, 50, 253, 156,
+		27, 227, 95, 218, 37, 239, 14, 134, 190, 109, 146, 77, 155, 206, 234, 46,
+		141, 241, 125, 154, 68, 133, 177, 223, 136, 232, 252, 147, 251, 249, 202, 243,
+	};
+
+	// Repeated once so lattice hashes never need wrapping
+	struct FPermutationTable
+	{
+		int32 P[512];
+
+		constexpr FPermutationTable() : P{}
+		{
+			for (int32 i = 0; i < 512; i++)
+			{
+				P[i] = BasePermutation[i & 255];
+			}
+		}
+	};
+
+	constexpr FPermutationTable Permutation;
+
+	// Keeps the output range close to [-1, 1], then clamped into it, same as the engine noise
+	constexpr float NOISE_SCALE = 0.97f;
+
+	FORCEINLINE float Grad3(const int32 Hash, const float X, const float Y, const float Z)
+	{
+		switch (Hash & 15)
+		{
+		// 12 cube midpoints
+		case 0: return X + Z;
+		case 1: return X + Y;
+		case 2: return Y + Z;
+		case 3: return -X + Y;
+		case 4: return -X + Z;
+		case 5: return -X - Y;
+		case 6: return -Y + Z;
+		case 7: return X - Y;
+		case 8: return X - Z;
+		case 9: return Y - Z;
+		case 10: return -X - Z;
+		case 11: return -Y - Z;
+		// 4 vertices of regular tetrahedron
+		case 12: return X + Y;
+		case 13: return -X + Y;
+		case 14: return -Y + Z;
+		case 15: return -Y - Z;
+		default: return 0.0f;
+		}
+	}
+
+	FORCEINLINE float SmoothCurve(const float X)
+	{
+		return X * X * X * (X * (X * 6.0f - 15.0f) + 10.0f);
+	}
+
+	FORCEINLINE VectorRegister4Float SmoothCurve(const VectorRegister4Float& X)
+	{
+		// Same operation order as the scalar version, and no fused multiply-add, so lanes round identically
+		const VectorRegister4Float Inner = VectorAdd(VectorMultiply(X, VectorSubtract(VectorMultiply(X, VectorSetFloat1(6.0f)), VectorSetFloat1(15.0f))), VectorSetFloat1(10.0f));
+		return VectorMultiply(VectorMultiply(VectorMultiply(X, X), X), Inner);
+	}
+
+	// A + Alpha * (B - A), matching FMath::Lerp
+	FORCEINLINE VectorRegister4Float Lerp(const VectorRegister4Float& A, const VectorRegister4Float& B, const VectorRegister4Float& Alpha)
+	{
+		return VectorAdd(A, VectorMultiply(Alpha, VectorSubtract(B, A)));
+	}
+}
+
+void VoxelNoise::PerlinNoise3DColumn(const float X, const float Y, const float* Z, const int32 Num, float* OutNoise)
+{
+	const int32* P = Permutation.P;
+
+	// Everything that only depends on X and Y is shared by the whole column
+	const float Xfl = FMath::FloorToFloat(X);
+	const float Yfl = FMath::FloorToFloat(Y);
+	const int32 Xi = static_cast<int32>(Xfl) & 255;
+	const int32 Yi = static_cast<int32>(Yfl) & 255;
+	const float Fx = X - Xfl;
+	const float Fy = Y - Yfl;
+	const float Xm1 = Fx - 1.0f;
+	const float Ym1 = Fy - 1.0f;
+
+	const int32 AA = P[Xi] + Yi;
+	const int32 AB = AA + 1;
+	const int32 BA = P[Xi + 1] + Yi;
+	const int32 BB = BA + 1;
+	const int32 PAA = P[AA];
+	const int32 PAB = P[AB];
+	const int32 PBA = P[BA];
+	const int32 PBB = P[BB];
+
+	const VectorRegister4Float U = VectorSetFloat1(SmoothCurve(Fx));
+	const VectorRegister4Float V = VectorSetFloat1(SmoothCurve(Fy));
+	const VectorRegister4Float Scale = VectorSetFloat1(NOISE_SCALE);
+	const VectorRegister4Float MinNoise = VectorSetFloat1(-1.0f);
+	const VectorRegister4Float MaxNoise = VectorSetFloat1(1.0f);
+
+	for (int32 First = 0; First < Num; First += 4)
+	{
+		const int32 NumLanes = FMath::Min(4, Num - First);
+
+		alignas(16) float LaneZ[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		FMemory::Memcpy(LaneZ, Z + First, NumLanes * sizeof(float));
+
+		// Corner gradients, gathered per lane since the permutation lookups can't be vectorised
+		alignas(16) float Grads[8][4];
+		alignas(16) float LaneFz[4];
+
+		for (int32 Lane = 0; Lane < 4; Lane++)
+		{
+			const float Zfl = FMath::FloorToFloat(LaneZ[Lane]);
+			const int32 Zi = static_cast<int32>(Zfl) & 255;
+			const float Fz = LaneZ[Lane] - Zfl;
+			const float Zm1 = Fz - 1.0f;
+			LaneFz[Lane] = Fz;
+
+			Grads[0][Lane] = Grad3(P[PAA + Zi], Fx, Fy, Fz);
+			Grads[1][Lane] = Grad3(P[PBA + Zi], Xm1, Fy, Fz);
+			Grads[2][Lane] = Grad3(P[PAB + Zi], Fx, Ym1, Fz);
+			Grads[3][Lane] = Grad3(P[PBB + Zi], Xm1, Ym1, Fz);
+			Grads[4][Lane] = Grad3(P[PAA + Zi + 1], Fx, Fy, Zm1);
+			Grads[5][Lane] = Grad3(P[PBA + Zi + 1], Xm1, Fy, Zm1);
+			Grads[6][Lane] = Grad3(P[PAB + Zi + 1], Fx, Ym1, Zm1);
+			Grads[7][Lane] = Grad3(P[PBB + Zi + 1], Xm1, Ym1, Zm1);
+		}
+
+		const VectorRegister4Float W = SmoothCurve(VectorLoadAligned(LaneFz));
+
+		const VectorRegister4Float Near = Lerp(
+			Lerp(VectorLoadAligned(Grads[0]), VectorLoadAligned(Grads[1]), U),
+			Lerp(VectorLoadAligned(Grads[2]), VectorLoadAligned(Grads[3]), U), V);
+
+		const VectorRegister4Float Far = Lerp(
+			Lerp(VectorLoadAligned(Grads[4]), VectorLoadAligned(Grads[5]), U),
+			Lerp(VectorLoadAligned(Grads[6]), VectorLoadAligned(Grads[7]), U), V);
+
+		alignas(16) float Result[4];
+		VectorStoreAligned(VectorMin(VectorMax(VectorMultiply(Scale, Lerp(Near, Far, W)), MinNoise), MaxNoise), Result);
+		FMemory::Memcpy(OutNoise + First, Result, NumLanes * sizeof(float));
+	}
+}
+
+bool VoxelNoise::IsBatchedKernelExact()
+{
+	static const bool bExact = []()
+	{
+		constexpr int32 NumColumns = 64;
+		constexpr int32 NumSamples = 37;
+
+		FRandomStream Rand(0x5EED);
+		float Z[NumSamples];
+		float Noise[NumSamples];
+
+		for (int32 Column = 0; Column < NumColumns; Column++)
+		{
+			// Half the columns on integer lattice offsets, as terrain coordinates often are
+			const bool bLattice = (Column & 1) != 0;
+			const float X = bLattice ? static_cast<float>(Rand.RandRange(-4096, 4096)) : Rand.FRandRange(-4096.0f, 4096.0f);
+			const float Y = Rand.FRandRange(-4096.0f, 4096.0f);
+
+			for (int32 i = 0; i < NumSamples; i++)
+			{
+				Z[i] = Rand.FRandRange(-4096.0f, 4096.0f);
+			}
+
+			PerlinNoise3DColumn(X, Y, Z, NumSamples, Noise);
+
+			for (int32 i = 0; i < NumSamples; i++)
+			{
+				const float Expected = FMath::PerlinNoise3D(FVector(X, Y, Z[i]));
+				if (Noise[i] != Expected)
+				{
+					UE_LOG(LogVoxelNoise, Warning, TEXT("Batched Perlin kernel differs from FMath::PerlinNoise3D at (%f, %f, %f): %f vs %f, using the engine noise"),
+					       X, Y, Z[i], Noise[i], Expected);
+					return false;
+				}
+			}
+		}
+
+		UE_LOG(LogVoxelNoise, Log, TEXT("Batched Perlin kernel matches FMath::PerlinNoise3D"));
+		return true;
+	}();
+
+	return bExact;
+}
@@ -1,35 +1,92 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "Voxels/Core/VoxelWorldSubsystem.h"
+#include "GameObjects/Placeable/PlaceableObjectManager.h"
 #include "ProceduralMeshComponent.h"
 #include "DSP/MidiNoteQuantizer.h"
 #include "Materials/MaterialInterface.h"
 #include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/GameViewportClient.h"
 #include "Shared/Types/Core/Common.h"
 #include <limits>
 #include "Network/Services/GameData/ChunkServiceSubsystem.h"
 #include "Network/Services/GameData/VoxelServiceSubsystem.h"
-#include "Voxels/Data/VoxelDataManager.h"
+#include "Voxels/Rendering/AtlasManager.h"
 #include "Voxels/Rendering/ChunkDataManager.h"
+#include "Voxels/Rendering/ChunkLOD.h"
+#include "Voxels/Rendering/ChunkRegionImpostor.h"
 #include "Voxels/Rendering/VLOMeshProvider.h"
+#include "Voxels/Core/VoxelNoise.h"
+#include "Tasks/Task.h"
+#include "Async/ParallelFor.h"
+#include "World/Terrain/TerrainGenerator.h"
 
 DEFINE_LOG_CATEGORY(LogVoxel);
 
 void UVoxelWorldSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
+
+	RebuildVoxelTypeTable();
 }
 
 void UVoxelWorldSubsystem::Deinitialize()
 {
+	PendingChunkWork.Empty();
 	VoxelChunks.Empty();
+	RegionImpostors.Empty();
+	DirtyImpostorRegions.Empty();
+	ChunksWithPendingInstances.Empty();
 	Super::Deinitialize();
 }
 
+TStatId UVoxelWorldSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UVoxelWorldSubsystem, STATGROUP_Tickables);
+}
+
+void UVoxelWorldSubsystem::Tick(const float DeltaTime)
+{
+	ProcessChunkWork();
+	FlushChunkInstances();
+	ProcessImpostorWork();
+}
+
+void UVoxelWorldSubsystem::FlushChunkInstances()
+{
+	// Chunks unloaded since they queued had their components destroyed with them
+	for (const TWeakObjectPtr<AVoxelChunk>& Chunk : ChunksWithPendingInstances)
+	{
+		if (AVoxelChunk* ChunkPtr = Chunk.Get())
+		{
+			ChunkPtr->FlushInstances();
+		}
+	}
+
+	ChunksWithPendingInstances.Reset();
+}
+
 void UVoxelWorldSubsystem::SetReferences(APawn* PawnReference, UTexture* DefaultAtlas = nullptr)
 {
 	this->CurrentTextureAtlas = DefaultAtlas;
 	this->Player = PawnReference;
+
+	if (AtlasManager)
+	{
+		AtlasManager->SetDefaultAtlas(CurrentTextureAtlas);
+	}
+}
+
+void UVoxelWorldSubsystem::SetAtlasManager(AAtlasManager* InAtlasManager)
+{
+	AtlasManager = InAtlasManager;
+
+	if (AtlasManager)
+	{
+		AtlasManager->SetDefaultAtlas(CurrentTextureAtlas);
+	}
 }
 
 
@@ -78,17 +135,7 @@ void UVoxelWorldSubsystem::UpdateWorld(const FVector PlayerWorldLocation)
 	}
 	
 
-	const int32 DesiredRadius = LoadDistance;
-
-	const bool bOutsideLoadedRange = FMath::Abs(CurrentPlayerChunkCoordinate.X - LastRequestedCenterChunk.X) > 3 ||
-		FMath::Abs(CurrentPlayerChunkCoordinate.Y - LastRequestedCenterChunk.Y) > 3 ||
-		FMath::Abs(CurrentPlayerChunkCoordinate.Z - LastRequestedCenterChunk.Z) > 3;
-
-	if (bOutsideLoadedRange)
-	{
-		LastRequestedCenterChunk = CurrentPlayerChunkCoordinate;
-		RequestChunksAround(CurrentPlayerChunkCoordinate, DesiredRadius);
-	}
+	RequestChunksAround(CurrentPlayerChunkCoordinate, LoadDistance);
 	
 	AVoxelChunk* Chunk = GetChunkAtWorldCoord(PlayerWorldLocation);
 	SetCurrentChunk(Chunk);
@@ -116,6 +163,9 @@ void UVoxelWorldSubsystem::TeleportToChunk(int64 X, int64 Y, int64 Z)
 	UChunkDataManager* ChunkDataManager = GetWorld()->GetGameInstance()->GetSubsystem<UChunkDataManager>();
 	ChunkDataManager->UnloadAllChunkData();
 
+	// Nothing requested so far is of use at the destination
+	LastRequestedRadius = 0;
+
 	// Unload old chunks and load a new section around origin
 	//UnloadAllChunks();
 
@@ -232,6 +282,11 @@ void UVoxelWorldSubsystem::UpdateTextureAtlas(UTexture* TextureAtlas)
 {
 	CurrentTextureAtlas = TextureAtlas;
 
+	if (AtlasManager)
+	{
+		AtlasManager->SetDefaultAtlas(TextureAtlas);
+	}
+
 	for (const auto& Chunk : VoxelChunks)
 	{
 		if (Chunk.Value != nullptr)
@@ -239,6 +294,14 @@ void UVoxelWorldSubsystem::UpdateTextureAtlas(UTexture* TextureAtlas)
 			Chunk.Value->UpdateVoxelsAtlas(TextureAtlas);
 		}
 	}
+
+	for (const auto& Pair : RegionImpostors)
+	{
+		if (IsValid(Pair.Value))
+		{
+			Pair.Value->UpdateAtlas(TextureAtlas);
+		}
+	}
 }
 
 AVoxelChunk* UVoxelWorldSubsystem::UpdateChunk(const int64 X, const int64 Y, const int64 Z, const TArray<uint8>& voxels,
@@ -296,37 +359,207 @@ void UVoxelWorldSubsystem::UpdateChunks(const TArray<FChunkDataContainer>& NewCh
 
 void UVoxelWorldSubsystem::ApplyVoxelUpdatesOnChunks(const TArray<FChunkDataContainer>& VoxelUpdateData)
 {
+	check(IsInGameThread());
+
 	for (const auto& Chunk : VoxelUpdateData)
 	{
-		const FChunkCoordinate ChunkPosition(DEFAULT_MAP_ID, Chunk.ChunkCoordinate.X, Chunk.ChunkCoordinate.Y,
-		                                     Chunk.ChunkCoordinate.Z);
+		UE_LOG(LogVoxel, Verbose, TEXT("ApplyVoxelUpdatesOnChunks: %lld %lld %lld"), Chunk.ChunkCoordinate.X, Chunk.ChunkCoordinate.Y, Chunk.ChunkCoordinate.Z);
 
-		UE_LOG(LogTemp, Warning, TEXT("ApplyVoxelUpdatesOnChunks: %lld %lld %lld"), ChunkPosition.X, ChunkPosition.Y, ChunkPosition.Z);
+		// Placed objects' assets load while the chunk waits its turn, instead of hitching when it is meshed
+		if (IsValid(PlaceableObjectManager))
+		{
+			PlaceableObjectManager->PrefetchChunkObjects(Chunk);
+		}
 
-		AVoxelChunk* ChunkActor;
+		FPendingChunkWork& Work = PendingChunkWork.FindOrAdd(Chunk.ChunkCoordinate);
 
-		if (VoxelChunks.Contains(ChunkPosition))
+		// A full chunk is a snapshot, states missing from it are gone and must not come back from the older update
+		if (Work.bHasUpdates && Chunk.VoxelData.Num() != NUM_VOXELS_IN_CHUNK)
 		{
-			ChunkActor = VoxelChunks.FindRef(ChunkPosition);
+			// Newer states win
+			Work.Updates.VoxelStatesMap.Append(Chunk.VoxelStatesMap);
 		}
 		else
 		{
-			TArray<uint8> Voxels;
-			Voxels.Init(0, NUM_VOXELS_IN_CHUNK);
-			ChunkActor = CreateVoxelChunk(Chunk.ChunkCoordinate.X, Chunk.ChunkCoordinate.Y, Chunk.ChunkCoordinate.Z,
-			                              Voxels);
+			Work.Updates = Chunk;
+			Work.bHasUpdates = true;
 		}
+	}
+}
 
-		ChunkActor->ApplyVoxelUpdates(Chunk);
-		
+void UVoxelWorldSubsystem::SetChunkWorkBudget(const float Milliseconds)
+{
+	if (Milliseconds <= 0.0f)
+	{
+		UE_LOG(LogVoxel, Warning, TEXT("Invalid chunk work budget: %f ms"), Milliseconds);
+		return;
+	}
+
+	ChunkWorkBudgetMs = Milliseconds;
+}
+
+FChunkWorkQueueStats UVoxelWorldSubsystem::GetChunkWorkQueueStats() const
+{
+	return ChunkWorkStats;
+}
+
+void UVoxelWorldSubsystem::ProcessChunkWork()
+{
+	ChunkWorkStats = FChunkWorkQueueStats();
+
+	if (PendingChunkWork.IsEmpty())
+	{
+		return;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	const double Budget = ChunkWorkBudgetMs / 1000.0;
+
+	FVector ViewLocation;
+	const bool bHasView = GetViewLocation(ViewLocation);
+
+	constexpr double HALF_SIZE{CHUNK_SIZE_UNREAL / 2.0};
+	ChunkWorkOrder.Reset();
+
+	for (const auto& Pair : PendingChunkWork)
+	{
+		const FVector ChunkCenter = CalculateChunkWorldPositionOrigin(Pair.Key.X, Pair.Key.Y, Pair.Key.Z) + FVector(HALF_SIZE);
+		ChunkWorkOrder.Emplace(bHasView ? FVector::DistSquared(ChunkCenter, ViewLocation) : 0.0, Pair.Key);
+	}
+
+	ChunkWorkOrder.Sort([](const TPair<double, FInt64Vector>& A, const TPair<double, FInt64Vector>& B)
+	{
+		return A.Key < B.Key;
+	});
+
+	bool bOutOfBudget = false;
+
+	for (const TPair<double, FInt64Vector>& Entry : ChunkWorkOrder)
+	{
+		FPendingChunkWork& Work = PendingChunkWork.FindChecked(Entry.Value);
+
+		bool bHasMoreWork = true;
+		while (bHasMoreWork)
+		{
+			// Always make some progress, even if a single item is over budget
+			if (ChunkWorkStats.ItemsLastFrame > 0 && FPlatformTime::Seconds() - StartTime >= Budget)
+			{
+				bOutOfBudget = true;
+				break;
+			}
+
+			bHasMoreWork = RunNextChunkWorkItem(Entry.Value, Work);
+			ChunkWorkStats.ItemsLastFrame++;
+		}
+
+		if (bOutOfBudget)
+		{
+			break;
+		}
+
+		PendingChunkWork.Remove(Entry.Value);
+	}
+
+	ChunkWorkStats.MillisecondsLastFrame = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+	for (const auto& Pair : PendingChunkWork)
+	{
+		if (!VoxelChunks.Contains(FChunkCoordinate(DEFAULT_MAP_ID, Pair.Key.X, Pair.Key.Y, Pair.Key.Z)))
+		{
+			ChunkWorkStats.PendingSpawns++;
+		}
+
+		ChunkWorkStats.PendingApplies += Pair.Value.bHasUpdates ? 1 : 0;
+		ChunkWorkStats.PendingMeshUploads += Pair.Value.bHasUpdates || Pair.Value.bNeedsMesh ? 1 : 0;
 	}
 }
 
+bool UVoxelWorldSubsystem::RunNextChunkWorkItem(const FInt64Vector& ChunkCoordinate, FPendingChunkWork& Work)
+{
+	AVoxelChunk* ChunkActor = VoxelChunks.FindRef(FChunkCoordinate(DEFAULT_MAP_ID, ChunkCoordinate.X, ChunkCoordinate.Y, ChunkCoordinate.Z));
+
+	if (!IsValid(ChunkActor))
+	{
+		// Empty, so spawning never builds a mesh
+		ChunkActor = SpawnVoxelChunk(ChunkCoordinate.X, ChunkCoordinate.Y, ChunkCoordinate.Z);
+
+		return ChunkActor != nullptr && (Work.bHasUpdates || Work.bNeedsMesh);
+	}
+
+	if (Work.bHasUpdates)
+	{
+		// Base voxels come with merged chunk data only, plain voxel updates carry none. An empty chunk is already empty
+		if (Work.Updates.VoxelData.Num() == NUM_VOXELS_IN_CHUNK && !ChunkActor->HasVoxels(Work.Updates.VoxelData))
+		{
+			ChunkActor->UpdateChunk(Work.Updates.VoxelData, false);
+		}
+
+		ChunkActor->ApplyVoxelUpdates(Work.Updates, false);
+		Work.Updates = FChunkDataContainer();
+		Work.bHasUpdates = false;
+		Work.bNeedsMesh = true;
+		return true;
+	}
+
+	if (Work.bNeedsMesh)
+	{
+		ChunkActor->RegenerateChunk();
+		Work.bNeedsMesh = false;
+
+		if (RegionImpostors.Contains(ChunkLOD::GetRegion(ChunkCoordinate)))
+		{
+			DirtyImpostorRegions.Add(ChunkLOD::GetRegion(ChunkCoordinate));
+		}
+
+		if (UChunkDataManager* ChunkDataManager = GetWorld()->GetGameInstance()->GetSubsystem<UChunkDataManager>())
+		{
+			ChunkDataManager->AdvanceChunkStage(ChunkCoordinate, EChunkPipelineStage::Meshed);
+
+			if (!ChunkActor->IsChunkHidden())
+			{
+				ChunkDataManager->AdvanceChunkStage(ChunkCoordinate, EChunkPipelineStage::Visible);
+			}
+		}
+	}
+
+	return false;
+}
+
+bool UVoxelWorldSubsystem::GetViewLocation(FVector& OutLocation) const
+{
+	const APlayerController* PlayerController = GetWorld() ? GetWorld()->GetFirstPlayerController() : nullptr;
+	if (PlayerController && PlayerController->PlayerCameraManager)
+	{
+		OutLocation = PlayerController->PlayerCameraManager->GetCameraLocation();
+		return true;
+	}
+
+	if (IsValid(Player))
+	{
+		OutLocation = Player->GetActorLocation();
+		return true;
+	}
+
+	return false;
+}
+
 void UVoxelWorldSubsystem::UnloadFarChunks()
 {
 	//UE_LOG(LogVoxel, Log, TEXT("UnloadFarChunks called. Unload distance in chunks: %lld"), LoadDistance);
 
 	TArray<FChunkCoordinate> ChunksToRemove;
+	TArray<FInt64Vector> ChunksShown;
+
+	FVector ViewLocation;
+	const bool bHasView = GetViewLocation(ViewLocation);
+	const double ScreenScale = GetScreenScale();
+
+	// Radius of the sphere around a chunk, so the error is measured from its nearest point
+	constexpr double CHUNK_RADIUS { CHUNK_SIZE_UNREAL * UE_HALF_SQRT_3 };
+
+	// Level of every remaining chunk, and the finest level of any chunk in each region
+	TArray<TPair<AVoxelChunk*, int32>> ChunkLevels;
+	TMap<FInt64Vector, int32> RegionLevels;
 
 	for (auto& ChunkPair : VoxelChunks)
 	{
@@ -350,28 +583,101 @@ void UVoxelWorldSubsystem::UnloadFarChunks()
 
 		const int Distance = chunkPtr->DistanceToChunk(CurrentChunkCoord);
 
-		if (Distance > RenderDistance)
+		if (Distance > LoadDistance)
 		{
-			chunkPtr->SetChunkHidden(true);
+			// Remove chunk from memory
+			chunkPtr->Destroy();
+			ChunksToRemove.Add(ChunkPair.Key);
+			continue;
 		}
-		else if (chunkPtr->IsChunkHidden())
+
+		// Chunk is stale
+		if (Distance >= STALE_DISTANCE)
 		{
-			chunkPtr->SetChunkHidden(false);
+			chunkPtr->SetStale(true);
 		}
 
-		if (Distance > LoadDistance)
+		// Beyond RenderDistance only impostors are drawn
+		int32 Level = ChunkLOD::IMPOSTOR_LEVEL;
+		if (Distance <= RenderDistance)
 		{
-			// Remove chunk from memory
-			chunkPtr->Destroy();
-			ChunksToRemove.Add(ChunkPair.Key);
+			const double ViewDistance = bHasView ? FVector::Dist(chunkPtr->GetActorLocation(), ViewLocation) - CHUNK_RADIUS : 0.0;
+			Level = ChunkLOD::SelectLevel(ViewDistance, ScreenScale, MaxScreenSpaceError);
 		}
-		else
+
+		ChunkLevels.Emplace(chunkPtr, Level);
+
+		const FInt64Vector Region = ChunkLOD::GetRegion(FInt64Vector(ChunkPair.Key.X, ChunkPair.Key.Y, ChunkPair.Key.Z));
+		int32& RegionLevel = RegionLevels.FindOrAdd(Region, ChunkLOD::IMPOSTOR_LEVEL);
+		RegionLevel = FMath::Min(RegionLevel, Level);
+	}
+
+	// A region is only replaced once none of its chunks needs more detail than the impostor has
+	for (auto It = RegionImpostors.CreateIterator(); It; ++It)
+	{
+		const int32* RegionLevel = RegionLevels.Find(It.Key());
+		if (!RegionLevel || *RegionLevel < ChunkLOD::IMPOSTOR_LEVEL)
 		{
-			// Chunk is stale
-			if (Distance >= STALE_DISTANCE)
+			if (IsValid(It.Value()))
 			{
-				chunkPtr->SetStale(true);
+				It.Value()->Destroy();
 			}
+
+			DirtyImpostorRegions.Remove(It.Key());
+			It.RemoveCurrent();
+		}
+	}
+
+	for (const TPair<FInt64Vector, int32>& RegionLevel : RegionLevels)
+	{
+		if (RegionLevel.Value < ChunkLOD::IMPOSTOR_LEVEL || RegionImpostors.Contains(RegionLevel.Key))
+		{
+			continue;
+		}
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		const FVector RegionOrigin = CalculateChunkWorldPositionOrigin(RegionLevel.Key.X * ChunkLOD::IMPOSTOR_REGION_SIZE,
+		                                                               RegionLevel.Key.Y * ChunkLOD::IMPOSTOR_REGION_SIZE,
+		                                                               RegionLevel.Key.Z * ChunkLOD::IMPOSTOR_REGION_SIZE);
+
+		AChunkRegionImpostor* Impostor = GetWorld()->SpawnActor<AChunkRegionImpostor>(AChunkRegionImpostor::StaticClass(), RegionOrigin,
+		                                                                              FRotator::ZeroRotator, SpawnParams);
+		if (!Impostor)
+		{
+			UE_LOG(LogVoxel, Error, TEXT("Failed to spawn impostor for region %lld, %lld, %lld"), RegionLevel.Key.X, RegionLevel.Key.Y, RegionLevel.Key.Z);
+			continue;
+		}
+
+		Impostor->Initialize(RegionLevel.Key, AtlasManager);
+		Impostor->UpdateAtlas(CurrentTextureAtlas);
+		RegionImpostors.Add(RegionLevel.Key, Impostor);
+		DirtyImpostorRegions.Add(RegionLevel.Key);
+	}
+
+	for (const TPair<AVoxelChunk*, int32>& ChunkLevel : ChunkLevels)
+	{
+		AVoxelChunk* chunkPtr = ChunkLevel.Key;
+		const FInt64Vector ChunkCoordinate(chunkPtr->X, chunkPtr->Y, chunkPtr->Z);
+
+		// Hidden once the impostor has a mesh, until then the chunk stands in at the coarsest chunk level
+		const AChunkRegionImpostor* Impostor = RegionImpostors.FindRef(ChunkLOD::GetRegion(ChunkCoordinate));
+		if (Impostor && Impostor->IsBuilt())
+		{
+			chunkPtr->SetChunkHidden(true);
+			continue;
+		}
+
+		if (chunkPtr->SetLODLevel(ChunkLevel.Value))
+		{
+			PendingChunkWork.FindOrAdd(ChunkCoordinate).bNeedsMesh = true;
+		}
+
+		if (chunkPtr->IsChunkHidden())
+		{
+			chunkPtr->SetChunkHidden(false);
+			ChunksShown.Add(ChunkCoordinate);
 		}
 	}
 
@@ -384,11 +690,153 @@ void UVoxelWorldSubsystem::UnloadFarChunks()
 	{
 		ChunksToRemoveCoords.Add(FInt64Vector(ChunkToRemove.X, ChunkToRemove.Y, ChunkToRemove.Z));
 		VoxelChunks.Remove(ChunkToRemove);
+		PendingChunkWork.Remove(ChunksToRemoveCoords.Last());
+		DirtyImpostorRegions.Add(ChunkLOD::GetRegion(ChunksToRemoveCoords.Last()));
+	}
+
+	for (const FInt64Vector& ChunkCoordinate : ChunksShown)
+	{
+		ChunkDataManager->AdvanceChunkStage(ChunkCoordinate, EChunkPipelineStage::Visible);
 	}
 
 	ChunkDataManager->UnloadFarOffChunksData(ChunksToRemoveCoords);
 }
 
+void UVoxelWorldSubsystem::SetMaxScreenSpaceError(const float Pixels)
+{
+	if (Pixels <= 0.0f)
+	{
+		UE_LOG(LogVoxel, Warning, TEXT("Invalid max screen space error: %f px"), Pixels);
+		return;
+	}
+
+	MaxScreenSpaceError = Pixels;
+}
+
+double UVoxelWorldSubsystem::GetScreenScale() const
+{
+	float FOVDegrees = 90.0f;
+	const APlayerController* PlayerController = GetWorld() ? GetWorld()->GetFirstPlayerController() : nullptr;
+	if (PlayerController && PlayerController->PlayerCameraManager)
+	{
+		FOVDegrees = PlayerController->PlayerCameraManager->GetFOVAngle();
+	}
+
+	FVector2D ViewportSize(1920.0, 1080.0);
+	if (UGameViewportClient* Viewport = GetWorld() ? GetWorld()->GetGameViewport() : nullptr)
+	{
+		Viewport->GetViewportSize(ViewportSize);
+	}
+
+	return ViewportSize.X / (2.0 * FMath::Tan(FMath::DegreesToRadians(FOVDegrees) / 2.0));
+}
+
+void UVoxelWorldSubsystem::ProcessImpostorWork()
+{
+	if (DirtyImpostorRegions.IsEmpty())
+	{
+		return;
+	}
+
+	// Whatever chunk work left of the budget, but at least one impostor per frame
+	const double StartTime = FPlatformTime::Seconds();
+	const double Budget = FMath::Max(ChunkWorkBudgetMs - ChunkWorkStats.MillisecondsLastFrame, 0.0f) / 1000.0;
+	int32 NumBuilt = 0;
+
+	for (auto It = DirtyImpostorRegions.CreateIterator(); It; ++It)
+	{
+		if (NumBuilt > 0 && FPlatformTime::Seconds() - StartTime >= Budget)
+		{
+			break;
+		}
+
+		AChunkRegionImpostor* Impostor = RegionImpostors.FindRef(*It);
+		if (IsValid(Impostor))
+		{
+			RebuildImpostor(*Impostor);
+			NumBuilt++;
+		}
+
+		It.RemoveCurrent();
+	}
+}
+
+void UVoxelWorldSubsystem::RebuildImpostor(AChunkRegionImpostor& Impostor)
+{
+	const int32 Factor = ChunkLOD::GetDownsampleFactor(ChunkLOD::IMPOSTOR_LEVEL);
+	const int32 CellsPerChunk = CHUNK_SIZE / Factor;
+	const int32 CellsPerAxis = CellsPerChunk * ChunkLOD::IMPOSTOR_REGION_SIZE;
+
+	TArray<uint8> Cells;
+	Cells.Init(static_cast<uint8>(EVoxelType::AIR), CellsPerAxis * CellsPerAxis * CellsPerAxis);
+
+	const FInt64Vector FirstChunk(Impostor.GetRegion().X * ChunkLOD::IMPOSTOR_REGION_SIZE,
+	                              Impostor.GetRegion().Y * ChunkLOD::IMPOSTOR_REGION_SIZE,
+	                              Impostor.GetRegion().Z * ChunkLOD::IMPOSTOR_REGION_SIZE);
+
+	TArray<AVoxelChunk*, TInlineAllocator<64>> RegionChunks;
+	TArray<uint8> ChunkCells;
+
+	for (int32 ChunkZ = 0; ChunkZ < ChunkLOD::IMPOSTOR_REGION_SIZE; ChunkZ++)
+	{
+		for (int32 ChunkY = 0; ChunkY < ChunkLOD::IMPOSTOR_REGION_SIZE; ChunkY++)
+		{
+			for (int32 ChunkX = 0; ChunkX < ChunkLOD::IMPOSTOR_REGION_SIZE; ChunkX++)
+			{
+				AVoxelChunk* Chunk = VoxelChunks.FindRef(FChunkCoordinate(DEFAULT_MAP_ID, FirstChunk.X + ChunkX,
+				                                                           FirstChunk.Y + ChunkY, FirstChunk.Z + ChunkZ));
+				if (!IsValid(Chunk))
+				{
+					continue;
+				}
+
+				RegionChunks.Add(Chunk);
+				Chunk->GetDownsampledVoxels(Factor, *VoxelTypeTable, ChunkCells);
+
+				for (int32 Z = 0; Z < CellsPerChunk; Z++)
+				{
+					for (int32 Y = 0; Y < CellsPerChunk; Y++)
+					{
+						for (int32 X = 0; X < CellsPerChunk; X++)
+						{
+							const int32 RegionX = ChunkX * CellsPerChunk + X;
+							const int32 RegionY = ChunkY * CellsPerChunk + Y;
+							const int32 RegionZ = ChunkZ * CellsPerChunk + Z;
+
+							Cells[RegionX + RegionY * CellsPerAxis + RegionZ * CellsPerAxis * CellsPerAxis] =
+								ChunkCells[X + Y * CellsPerChunk + Z * CellsPerChunk * CellsPerChunk];
+						}
+					}
+				}
+			}
+		}
+	}
+
+	ChunkLOD::FMeshData MeshData;
+	ChunkLOD::BuildMesh(Cells, FIntVector(CellsPerAxis), VOXEL_SIZE * Factor, FVector::ZeroVector, *VoxelTypeTable, MeshData);
+	Impostor.UpdateMesh(MeshData);
+
+	// Now that the impostor covers them
+	for (AVoxelChunk* Chunk : RegionChunks)
+	{
+		Chunk->SetChunkHidden(true);
+	}
+}
+
+void UVoxelWorldSubsystem::DestroyImpostors()
+{
+	for (const auto& Pair : RegionImpostors)
+	{
+		if (IsValid(Pair.Value))
+		{
+			Pair.Value->Destroy();
+		}
+	}
+
+	RegionImpostors.Empty();
+	DirtyImpostorRegions.Empty();
+}
+
 void UVoxelWorldSubsystem::UnloadAllChunks()
 {
 	//UE_LOG(LogVoxel, Log, TEXT("UnloadAllChunks called."));
@@ -405,6 +853,8 @@ void UVoxelWorldSubsystem::UnloadAllChunks()
 	}
 
 	VoxelChunks.Empty();
+	PendingChunkWork.Empty();
+	DestroyImpostors();
 }
 
 AVoxelChunk* UVoxelWorldSubsystem::CreateVoxelChunk(int64 X, int64 Y, int64 Z, const TArray<uint8>& voxels,
@@ -458,6 +908,17 @@ AVoxelChunk* UVoxelWorldSubsystem::CreateVoxelChunk(int64 X, int64 Y, int64 Z, c
 }
 
 AVoxelChunk* UVoxelWorldSubsystem::CreateVoxelChunk(int64 X, int64 Y, int64 Z, const TArray<uint8>& voxels)
+{
+	AVoxelChunk* NewChunk = SpawnVoxelChunk(X, Y, Z);
+	if (NewChunk)
+	{
+		NewChunk->UpdateChunk(voxels);
+	}
+
+	return NewChunk;
+}
+
+AVoxelChunk* UVoxelWorldSubsystem::SpawnVoxelChunk(int64 X, int64 Y, int64 Z)
 {
 	UWorld* World = GetWorld();
 
@@ -485,7 +946,6 @@ AVoxelChunk* UVoxelWorldSubsystem::CreateVoxelChunk(int64 X, int64 Y, int64 Z, c
 
 	// Initialize the chunk with data (if necessary)
 	NewChunk->Initialize(X, Y, Z, VOXEL_SIZE, CHUNK_SIZE);
-	NewChunk->UpdateChunk(voxels);
 	NewChunk->UpdateVoxelsAtlas(CurrentTextureAtlas);
 	NewChunk->SetAtlasManagerReference(AtlasManager);
 	NewChunk->SetVLOMeshProvider(VLOMeshProvider);
@@ -662,7 +1122,24 @@ void UVoxelWorldSubsystem::ToggleVoxelBillboards(const bool bEnable)
 
 void UVoxelWorldSubsystem::SetVLOMeshProvider(AVLOMeshProvider* InVLOMeshProvider)
 {
+	if (VLOMeshProvider)
+	{
+		VLOMeshProvider->OnVLOMeshesChanged.Remove(VLOMeshesChangedHandle);
+	}
+
 	VLOMeshProvider = InVLOMeshProvider;
+
+	if (VLOMeshProvider)
+	{
+		VLOMeshesChangedHandle = VLOMeshProvider->OnVLOMeshesChanged.AddUObject(this, &UVoxelWorldSubsystem::RebuildVoxelTypeTable);
+	}
+
+	RebuildVoxelTypeTable();
+}
+
+void UVoxelWorldSubsystem::RebuildVoxelTypeTable()
+{
+	VoxelTypeTable = FVoxelTypeTable::Build(VLOMeshProvider);
 }
 
 // Terrain Related --Start--
@@ -707,100 +1184,250 @@ TArray<uint8> UVoxelWorldSubsystem::GenerateVoxelsWithPerlinNoise(int64 Xmin, in
 	return voxelArr;
 }
 
-TArray<FChunkData> UVoxelWorldSubsystem::PopulateChunksFromPerlinNoise(TArray<uint8> GeneratedVoxels, int64 Xmin,
-                                                                       int64 Ymin, int64 Zmin, int64 Xmax, int64 Ymax,
-                                                                       int64 Zmax)
+namespace
 {
-	const int32 VoxelPerChunk = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
-	const int32 TotalChunks = GeneratedVoxels.Num() / VoxelPerChunk;
-
-	int32 TotalChunksX = (Xmax - Xmin) + 1;
-	int32 TotalChunksY = (Ymax - Ymin) + 1;
-	int32 TotalChunksZ = (Zmax - Zmin) + 1;
+	struct FPerlinTerrainParams
+	{
+		float Frequency;
+		float Amplitude;
+		float Threshold;
+		int32 Seed;
+		uint8 VoxelType;
+	};
 
-	int32 TotalVoxelsX = TotalChunksX * CHUNK_SIZE;
-	int32 TotalVoxelsY = TotalChunksY * CHUNK_SIZE;
-	int32 TotalVoxelsZ = TotalChunksZ * CHUNK_SIZE;
+	// Fills one chunk; voxel offsets are relative to the first generated chunk, like the global voxel coordinates of GenerateVoxelsWithPerlinNoise
+	void GeneratePerlinChunk(FChunkData& Chunk, const int32 VoxelOffsetX, const int32 VoxelOffsetY, const int32 VoxelOffsetZ,
+	                         const FPerlinTerrainParams& Params, const bool bBatchedKernel)
+	{
+		Chunk.VoxelData.SetNumUninitialized(NUM_VOXELS_IN_CHUNK);
+		uint8* Voxels = Chunk.VoxelData.GetData();
 
+		// Coordinates are computed exactly like the legacy generator so the noise samples match bit for bit
+		float ZCoords[CHUNK_SIZE];
+		for (int32 z = 0; z < CHUNK_SIZE; z++)
+		{
+			ZCoords[z] = (VoxelOffsetZ + z + Params.Seed * VOXEL_SIZE) / Params.Frequency;
+		}
 
-	// UE_LOG(LogTemp, Log, TEXT("Total Voxels: %d, Total Chunks: %d"), GeneratedVoxels.Num(), TotalChunks);
+		float Noise[CHUNK_SIZE];
 
+		for (int32 x = 0; x < CHUNK_SIZE; x++)
+		{
+			const float NoiseX = (VoxelOffsetX + x + Params.Seed * VOXEL_SIZE) / Params.Frequency;
 
-	TMap<FInt64Vector, FChunkData> ChunkMap;
+			for (int32 y = 0; y < CHUNK_SIZE; y++)
+			{
+				const float NoiseY = (VoxelOffsetY + y + Params.Seed * VOXEL_SIZE) / Params.Frequency;
 
+				if (bBatchedKernel)
+				{
+					VoxelNoise::PerlinNoise3DColumn(NoiseX, NoiseY, ZCoords, CHUNK_SIZE, Noise);
+				}
+				else
+				{
+					for (int32 z = 0; z < CHUNK_SIZE; z++)
+					{
+						Noise[z] = UVoxelWorldSubsystem::PerlinNoise(NoiseX, NoiseY, ZCoords[z]);
+					}
+				}
 
-	// UE_LOG(LogTemp, Log, TEXT("X: %d, Y: %d, Z: %d"), TotalVoxelX, TotalVoxelY, TotalVoxelZ);
+				// Chunk voxels are z-contiguous, a column is one run of the array
+				uint8* Column = Voxels + (x * CHUNK_SIZE + y) * CHUNK_SIZE;
+				for (int32 z = 0; z < CHUNK_SIZE; z++)
+				{
+					const float NoiseValue = Noise[z] * Params.Amplitude;
+					Column[z] = (NoiseValue < Params.Threshold) ? Params.VoxelType : 0;
+				}
+			}
+		}
+	}
 
-	for (int32 VoxelIndex = 0; VoxelIndex < GeneratedVoxels.Num(); VoxelIndex++)
+	TArray<FChunkData> GeneratePerlinChunks(const int64 Xmin, const int64 Ymin, const int64 Zmin, const int64 Xmax, const int64 Ymax,
+	                                        const int64 Zmax, const FPerlinTerrainParams& Params, const bool bParallel,
+	                                        const bool bBatchedKernel)
 	{
-		//Calculate 3D Voxel Coords
-		const int32 GlobalVoxelX = VoxelIndex % TotalVoxelsX;
-		const int32 GlobalVoxelY = (VoxelIndex / TotalVoxelsX) % TotalVoxelsY;
-		const int32 GlobalVoxelZ = VoxelIndex / (TotalVoxelsX * TotalVoxelsY);
-
-		//Calculate Chunk Coordinates
-		const int64 ChunkX = Xmin + GlobalVoxelX / CHUNK_SIZE;
-		const int64 ChunkY = Ymin + GlobalVoxelY / CHUNK_SIZE;
-		const int64 ChunkZ = Zmin + GlobalVoxelZ / CHUNK_SIZE;
+		const int32 TotalChunksX = Xmax - Xmin + 1;
+		const int32 TotalChunksY = Ymax - Ymin + 1;
+		const int32 TotalChunksZ = Zmax - Zmin + 1;
 
+		TArray<FChunkData> Chunks;
+		if (TotalChunksX <= 0 || TotalChunksY <= 0 || TotalChunksZ <= 0)
+		{
+			return Chunks;
+		}
 
-		//int64 ChunkX = (VoxelX / CHUNK_SIZE) % (TotalVoxelsX/CHUNK_SIZE);
-		//int64 ChunkY = (VoxelY / CHUNK_SIZE) % (TotalVoxelsY/CHUNK_SIZE);
-		//int64 ChunkZ = (VoxelZ / CHUNK_SIZE) % TotalVoxelsZ;
+		// Same chunk order as PopulateChunksFromPerlinNoise: x fastest, then y, then z
+		Chunks.SetNum(TotalChunksX * TotalChunksY * TotalChunksZ);
 
+		TArray<UE::Tasks::FTask> Tasks;
+		if (bParallel)
+		{
+			Tasks.Reserve(Chunks.Num());
+		}
 
-		/*UE_LOG(LogTemp, Log, TEXT("Voxel Index: %d, Voxel X: %d, Voxel Y: %d, Voxel Z: %d"),
-		       VoxelIndex, VoxelX, VoxelY, VoxelZ);
-		UE_LOG(LogTemp, Log, TEXT("Calculated Chunk X: %lld, Chunk Y: %lld, Chunk Z: %lld"),
-		       ChunkX, ChunkY, ChunkZ);
-		*/
+		int32 ChunkIndex = 0;
+		for (int32 cz = 0; cz < TotalChunksZ; cz++)
+		{
+			for (int32 cy = 0; cy < TotalChunksY; cy++)
+			{
+				for (int32 cx = 0; cx < TotalChunksX; cx++)
+				{
+					FChunkData& Chunk = Chunks[ChunkIndex++];
+					Chunk.ChunkX = Xmin + cx;
+					Chunk.ChunkY = Ymin + cy;
+					Chunk.ChunkZ = Zmin + cz;
+
+					if (bParallel)
+					{
+						Tasks.Add(UE::Tasks::Launch(UE_SOURCE_LOCATION, [&Chunk, cx, cy, cz, &Params, bBatchedKernel]()
+						{
+							GeneratePerlinChunk(Chunk, cx * CHUNK_SIZE, cy * CHUNK_SIZE, cz * CHUNK_SIZE, Params, bBatchedKernel);
+						}));
+					}
+					else
+					{
+						GeneratePerlinChunk(Chunk, cx * CHUNK_SIZE, cy * CHUNK_SIZE, cz * CHUNK_SIZE, Params, bBatchedKernel);
+					}
+				}
+			}
+		}
 
-		// Not used in game, just for comparison purposes in a map
-		FInt64Vector ChunkCoords(ChunkX, ChunkY, ChunkZ);
+		UE::Tasks::Wait(Tasks);
+		return Chunks;
+	}
 
-		//We check if the map already contains said Chunk
-		if (!ChunkMap.Contains(ChunkCoords))
+	int32 CountMismatchedVoxels(const TArray<FChunkData>& A, const TArray<FChunkData>& B)
+	{
+		if (A.Num() != B.Num())
 		{
-			FChunkData NewChunkData;
-			NewChunkData.ChunkX = ChunkX;
-			NewChunkData.ChunkY = ChunkY;
-			NewChunkData.ChunkZ = ChunkZ;
-			NewChunkData.VoxelData.SetNumUninitialized(CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE);
-			ChunkMap.Add(ChunkCoords, NewChunkData);
+			return INDEX_NONE;
 		}
 
+		int32 Mismatches = 0;
+		for (int32 i = 0; i < A.Num(); i++)
+		{
+			if (A[i].ChunkX != B[i].ChunkX || A[i].ChunkY != B[i].ChunkY || A[i].ChunkZ != B[i].ChunkZ)
+			{
+				return INDEX_NONE;
+			}
 
-		FChunkData& ChunkData = ChunkMap[ChunkCoords];
+			for (int32 v = 0; v < NUM_VOXELS_IN_CHUNK; v++)
+			{
+				Mismatches += A[i].VoxelData[v] != B[i].VoxelData[v] ? 1 : 0;
+			}
+		}
 
+		return Mismatches;
+	}
+}
 
-		//Calculate Local Voxel Coords within Chunk, not sure if needed or not
-		FVector LocalVoxelCoords;
-		LocalVoxelCoords.X = GlobalVoxelX % CHUNK_SIZE;
-		LocalVoxelCoords.Y = GlobalVoxelY % CHUNK_SIZE;
-		LocalVoxelCoords.Z = GlobalVoxelZ % CHUNK_SIZE;
-		uint8 VoxelValue = GeneratedVoxels[VoxelIndex];
+TArray<FChunkData> UVoxelWorldSubsystem::GenerateChunksWithPerlinNoise(int64 Xmin, int64 Ymin, int64 Zmin, int64 Xmax,
+                                                                      int64 Ymax, int64 Zmax, const uint8 voxelType,
+                                                                      const float frequencyInput,
+                                                                      const float amplitudeInput,
+                                                                      const float thresholdInput, const
+                                                                      int seedValue)
+{
+	const FPerlinTerrainParams Params{frequencyInput, amplitudeInput, thresholdInput, seedValue, voxelType};
+	return GeneratePerlinChunks(Xmin, Ymin, Zmin, Xmax, Ymax, Zmax, Params, true, VoxelNoise::IsBatchedKernelExact());
+}
+
+void UVoxelWorldSubsystem::BenchmarkPerlinGeneration(const int32 ChunksPerAxis)
+{
+	const int64 Max = FMath::Max(ChunksPerAxis, 1) - 1;
+	const FPerlinTerrainParams Params{20.0f, 1.0f, 0.0f, 1234, 1};
+	const int32 NumChunks = (Max + 1) * (Max + 1) * (Max + 1);
 
-		int32 LocalIndex = (LocalVoxelCoords.X * CHUNK_SIZE * CHUNK_SIZE) +
-			(LocalVoxelCoords.Y * CHUNK_SIZE) +
-			LocalVoxelCoords.Z;
+	double StartTime = FPlatformTime::Seconds();
+	const TArray<uint8> LegacyVoxels = GenerateVoxelsWithPerlinNoise(0, 0, 0, Max, Max, Max, Params.VoxelType, Params.Frequency,
+	                                                                 Params.Amplitude, Params.Threshold, Params.Seed);
+	const TArray<FChunkData> LegacyChunks = PopulateChunksFromPerlinNoise(LegacyVoxels, 0, 0, 0, Max, Max, Max);
+	const double LegacyTime = FPlatformTime::Seconds() - StartTime;
 
-		//Assigning the Voxel data
-		ChunkData.VoxelData[LocalIndex] = GeneratedVoxels[VoxelIndex];
+	UE_LOG(LogVoxel, Display, TEXT("Perlin benchmark, %d chunks: legacy %.1f chunks/s"), NumChunks, NumChunks / LegacyTime);
 
-		/*
-		UE_LOG(LogTemp, Log, TEXT("Voxel 1D Index:%d, Voxel Value: %u Voxel 3D Index: %f, %f, %f"),
-		    VoxelIndex, VoxelValue, LocalVoxelCoords.X, LocalVoxelCoords.Y, LocalVoxelCoords.Z );
-		 */
+	for (const bool bBatchedKernel : {false, true})
+	{
+		for (const bool bParallel : {false, true})
+		{
+			StartTime = FPlatformTime::Seconds();
+			const TArray<FChunkData> Chunks = GeneratePerlinChunks(0, 0, 0, Max, Max, Max, Params, bParallel, bBatchedKernel);
+			const double Time = FPlatformTime::Seconds() - StartTime;
+
+			UE_LOG(LogVoxel, Display, TEXT("Perlin benchmark, %d chunks: %s %s %.1f chunks/s (%.2fx legacy), %d voxels differ from legacy"),
+			       NumChunks, bBatchedKernel ? TEXT("batched kernel") : TEXT("engine noise"),
+			       bParallel ? TEXT("multi-threaded") : TEXT("single-threaded"), NumChunks / Time, LegacyTime / Time,
+			       CountMismatchedVoxels(LegacyChunks, Chunks));
+		}
 	}
+}
+
+TArray<FChunkData> UVoxelWorldSubsystem::GenerateTerrainChunks(int64 Xmin, int64 Ymin, int64 Zmin, int64 Xmax, int64 Ymax, int64 Zmax,
+                                                             const FTerrainGenerationSettings& Settings)
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	TArray<FChunkData> Chunks = FTerrainGenerator(Settings).GenerateChunks(FInt64Vector(Xmin, Ymin, Zmin), FInt64Vector(Xmax, Ymax, Zmax));
+
+	UE_LOG(LogTerrainGenerator, Log, TEXT("Generated %d terrain chunks in %.2f ms"), Chunks.Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	return Chunks;
+}
+
+TArray<FChunkData> UVoxelWorldSubsystem::PopulateChunksFromPerlinNoise(TArray<uint8> GeneratedVoxels, int64 Xmin,
+                                                                       int64 Ymin, int64 Zmin, int64 Xmax, int64 Ymax,
+                                                                       int64 Zmax)
+{
+	const int32 TotalChunksX = (Xmax - Xmin) + 1;
+	const int32 TotalChunksY = (Ymax - Ymin) + 1;
+	const int32 TotalChunksZ = (Zmax - Zmin) + 1;
+
+	const int32 TotalVoxelsX = TotalChunksX * CHUNK_SIZE;
+	const int32 TotalVoxelsY = TotalChunksY * CHUNK_SIZE;
+	const int32 TotalVoxelsZ = TotalChunksZ * CHUNK_SIZE;
 
-	//Adding to array of ChunkData type, which contains structs for each chunk and their voxels.
 	TArray<FChunkData> Chunks;
-	Chunks.Empty();
-	for (const auto& ChunkEntry : ChunkMap)
+
+	if (TotalChunksX <= 0 || TotalChunksY <= 0 || TotalChunksZ <= 0 || GeneratedVoxels.Num() < TotalVoxelsX * TotalVoxelsY * TotalVoxelsZ)
 	{
-		Chunks.Add(ChunkEntry.Value);
+		UE_LOG(LogVoxel, Error, TEXT("PopulateChunksFromPerlinNoise: %d voxels don't cover the requested chunk range"), GeneratedVoxels.Num());
+		return Chunks;
 	}
 
+	// Chunks in the order their first voxel appears in the generated array: x fastest, then y, then z
+	Chunks.SetNum(TotalChunksX * TotalChunksY * TotalChunksZ);
+
+	ParallelFor(Chunks.Num(), [&](const int32 ChunkIndex)
+	{
+		const int32 cx = ChunkIndex % TotalChunksX;
+		const int32 cy = (ChunkIndex / TotalChunksX) % TotalChunksY;
+		const int32 cz = ChunkIndex / (TotalChunksX * TotalChunksY);
+
+		FChunkData& ChunkData = Chunks[ChunkIndex];
+		ChunkData.ChunkX = Xmin + cx;
+		ChunkData.ChunkY = Ymin + cy;
+		ChunkData.ChunkZ = Zmin + cz;
+		ChunkData.VoxelData.SetNumUninitialized(NUM_VOXELS_IN_CHUNK);
+
+		for (int32 x = 0; x < CHUNK_SIZE; x++)
+		{
+			for (int32 y = 0; y < CHUNK_SIZE; y++)
+			{
+				for (int32 z = 0; z < CHUNK_SIZE; z++)
+				{
+					const int32 GlobalVoxelX = cx * CHUNK_SIZE + x;
+					const int32 GlobalVoxelY = cy * CHUNK_SIZE + y;
+					const int32 GlobalVoxelZ = cz * CHUNK_SIZE + z;
+
+					const int32 VoxelIndex = GlobalVoxelX + TotalVoxelsX * (GlobalVoxelY + TotalVoxelsY * GlobalVoxelZ);
+					const int32 LocalIndex = (x * CHUNK_SIZE * CHUNK_SIZE) + (y * CHUNK_SIZE) + z;
+
+					//Assigning the Voxel data
+					ChunkData.VoxelData[LocalIndex] = GeneratedVoxels[VoxelIndex];
+				}
+			}
+		}
+	});
+
 	return Chunks;
 }
 
@@ -839,30 +1466,58 @@ float UVoxelWorldSubsystem::PerlinNoise(const float X, const float Y, const floa
 
 // Terrain Related --End--
 
-void UVoxelWorldSubsystem::RequestChunksAround(const FInt64Vector& CenterChunk, const int32 Radius) const
+void UVoxelWorldSubsystem::RequestChunksAround(const FInt64Vector& CenterChunk, const int32 Radius)
 {
 	UChunkDataManager* ChunkDataManager = GetWorld()->GetGameInstance()->GetSubsystem<UChunkDataManager>();
-	
-	UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, ChunkDataManager, CenterChunk]()
+
+	FChunkStreamingView View;
+	View.CenterChunk = CenterChunk;
+	View.PredictedCenter = FVector(CenterChunk.X, CenterChunk.Y, CenterChunk.Z);
+	View.Radius = Radius;
+
+	if (IsValid(Player))
 	{
-		TArray<FInt64Vector> ChunksToRequest;
-		for (int32 dx = -3; dx <= 3; ++dx)
+		View.PredictedCenter += Player->GetVelocity() * StreamingPredictionSeconds / CHUNK_SIZE_UNREAL;
+		View.ViewForward = Player->GetBaseAimRotation().Vector();
+	}
+
+	const FInt64Vector PreviousCenter = LastRequestedCenterChunk;
+	const int32 PreviousRadius = LastRequestedRadius;
+	LastRequestedCenterChunk = CenterChunk;
+	LastRequestedRadius = Radius;
+
+	// Piped so a later view can never be applied before an earlier one
+	StreamingPipe.Launch(UE_SOURCE_LOCATION, [ChunkDataManager, View, PreviousCenter, PreviousRadius]()
+	{
+		// Only the shell the view moved into, the rest was requested before
+		TArray<FInt64Vector> NewChunks;
+		const FInt64Vector& Center = View.CenterChunk;
+
+		for (int64 X = Center.X - View.Radius; X <= Center.X + View.Radius; ++X)
 		{
-			for (int32 dy = -3; dy <= 3; ++dy)
+			for (int64 Y = Center.Y - View.Radius; Y <= Center.Y + View.Radius; ++Y)
 			{
-				for (int32 dz = -3; dz <= 3; ++dz)
+				const bool bColumnRequested = PreviousRadius > 0 && FMath::Abs(X - PreviousCenter.X) <= PreviousRadius &&
+					FMath::Abs(Y - PreviousCenter.Y) <= PreviousRadius;
+				const int64 RequestedMinZ = bColumnRequested ? PreviousCenter.Z - PreviousRadius : 1;
+				const int64 RequestedMaxZ = bColumnRequested ? PreviousCenter.Z + PreviousRadius : 0;
+
+				for (int64 Z = Center.Z - View.Radius; Z <= Center.Z + View.Radius; ++Z)
 				{
-					FInt64Vector ChunkCoordinate = FInt64Vector(CenterChunk.X + dx, CenterChunk.Y + dy, CenterChunk.Z + dz);
-					ChunksToRequest.Add(ChunkCoordinate);
+					if (Z >= RequestedMinZ && Z <= RequestedMaxZ)
+					{
+						Z = RequestedMaxZ;
+						continue;
+					}
+
+					NewChunks.Add(FInt64Vector(X, Y, Z));
 				}
 			}
 		}
 
-		ChunkDataManager->SetNewCenterCoordinate(CenterChunk);
-		ChunkDataManager->EnqueueChunksForRequesting(ChunksToRequest);
+		ChunkDataManager->UpdateStreamingView(View, NewChunks);
 		
 	}, LowLevelTasks::ETaskPriority::BackgroundLow);
-	
 }
 
 bool UVoxelWorldSubsystem::ValidateOriginChunks()
@@ -0,0 +1,166 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Voxels/Data/ChunkDataSources.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Network/Services/GameData/CDNServiceSubsystem.h"
+#include "Network/Services/GameData/VoxelServiceSubsystem.h"
+#include "Shared/Types/Core/Common.h"
+#include "Shared/Types/Core/GameSessionSubsystem.h"
+#include "Tasks/Task.h"
+#include "Voxels/Data/VoxelStorage.h"
+#include "Voxels/Rendering/ChunkDataManager.h"
+#include "World/Terrain/TerrainGenerator.h"
+
+DEFINE_LOG_CATEGORY(LogChunkDataSource);
+
+FGraphQLChunkDataSource::FGraphQLChunkDataSource(UVoxelServiceSubsystem* InVoxelService)
+	: VoxelService(InVoxelService)
+{
+}
+
+void FGraphQLChunkDataSource::RequestChunks(const TArray<FInt64Vector>& ChunkCoordinates)
+{
+	UVoxelServiceSubsystem* Service = VoxelService.Get();
+	if (!Service)
+	{
+		return;
+	}
+
+	// The voxel list is always requested in full
+	constexpr int32 Timestamp = 0;
+
+	for (const FInt64Vector& ChunkCoordinate : ChunkCoordinates)
+	{
+		Service->SendVoxelListRequest(ChunkCoordinate.X, ChunkCoordinate.Y, ChunkCoordinate.Z, Timestamp);
+	}
+}
+
+FCDNChunkDataSource::FCDNChunkDataSource(UCDNServiceSubsystem* InCDNService)
+	: CDNService(InCDNService)
+{
+}
+
+void FCDNChunkDataSource::RequestChunks(const TArray<FInt64Vector>& ChunkCoordinates)
+{
+	UCDNServiceSubsystem* Service = CDNService.Get();
+	if (!Service)
+	{
+		return;
+	}
+
+	for (const FInt64Vector& ChunkCoordinate : ChunkCoordinates)
+	{
+		Service->GetChunkCDN(ChunkCoordinate.X, ChunkCoordinate.Y, ChunkCoordinate.Z);
+	}
+}
+
+FDiskChunkDataSource::FDiskChunkDataSource(UChunkDataManager* InManager, UGameSessionSubsystem* InGameSession)
+	: Manager(InManager), GameSession(InGameSession)
+{
+}
+
+void FDiskChunkDataSource::RequestChunks(const TArray<FInt64Vector>& ChunkCoordinates)
+{
+	TArray<TPair<FInt64Vector, FString>> Files;
+	Files.Reserve(ChunkCoordinates.Num());
+
+	for (const FInt64Vector& ChunkCoordinate : ChunkCoordinates)
+	{
+		Files.Emplace(ChunkCoordinate, GetChunkFilePath(ChunkCoordinate));
+	}
+
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [Manager = Manager, Files = MoveTemp(Files)]()
+	{
+		for (const TPair<FInt64Vector, FString>& File : Files)
+		{
+			UChunkDataManager* ChunkDataManager = Manager.Get();
+			if (!ChunkDataManager)
+			{
+				return;
+			}
+
+			FChunkDataContainer ChunkData;
+			ChunkData.ChunkCoordinate = File.Key;
+
+			// A missing or malformed file is a miss, not an error
+			TArray<uint8> Encoded;
+			const bool bLoaded = FFileHelper::LoadFileToArray(Encoded, *File.Value, FILEREAD_Silent)
+				&& VoxelRLE::Decode(Encoded, NUM_VOXELS_IN_CHUNK, ChunkData.VoxelData);
+
+			ChunkDataManager->OnSourceDataReceived(EChunkDataSource::Disk, bLoaded, File.Key, ChunkData);
+		}
+	}, LowLevelTasks::ETaskPriority::BackgroundNormal);
+}
+
+void FDiskChunkDataSource::OnChunkMerged(const FChunkDataContainer& MergedData)
+{
+	if (MergedData.VoxelData.Num() != NUM_VOXELS_IN_CHUNK)
+	{
+		return;
+	}
+
+	TArray<uint8> Encoded;
+	VoxelRLE::Encode(MergedData.VoxelData, Encoded);
+
+	const FString FilePath = GetChunkFilePath(MergedData.ChunkCoordinate);
+	if (!FFileHelper::SaveArrayToFile(Encoded, *FilePath))
+	{
+		UE_LOG(LogChunkDataSource, Warning, TEXT("Failed to write chunk cache file %s"), *FilePath);
+	}
+}
+
+FString FDiskChunkDataSource::GetChunkFilePath(const FInt64Vector& ChunkCoordinate) const
+{
+	const UGameSessionSubsystem* Session = GameSession.Get();
+	const int64 MapId = Session ? Session->GetMapID() : DEFAULT_MAP_ID;
+
+	return FPaths::ProjectSavedDir() / TEXT("ChunkCache") / FString::Printf(TEXT("%lld_%lld_%lld_%lld.rle"), MapId,
+		ChunkCoordinate.X, ChunkCoordinate.Y, ChunkCoordinate.Z);
+}
+
+FProceduralChunkDataSource::FProceduralChunkDataSource(UChunkDataManager* InManager, const FTerrainGenerationSettings& Settings)
+	: Manager(InManager)
+{
+	SetSettings(Settings);
+}
+
+void FProceduralChunkDataSource::SetSettings(const FTerrainGenerationSettings& Settings)
+{
+	FScopeLock Lock(&GeneratorLock);
+	Generator = MakeShared<const FTerrainGenerator, ESPMode::ThreadSafe>(Settings);
+}
+
+void FProceduralChunkDataSource::RequestChunks(const TArray<FInt64Vector>& ChunkCoordinates)
+{
+	TSharedPtr<const FTerrainGenerator, ESPMode::ThreadSafe> CurrentGenerator;
+	{
+		FScopeLock Lock(&GeneratorLock);
+		CurrentGenerator = Generator;
+	}
+
+	for (const FInt64Vector& ChunkCoordinate : ChunkCoordinates)
+	{
+		UE::Tasks::Launch(UE_SOURCE_LOCATION, [Manager = Manager, CurrentGenerator, ChunkCoordinate]()
+		{
+			TArray<FChunkData> Generated = CurrentGenerator->GenerateChunks(ChunkCoordinate, ChunkCoordinate);
+
+			UChunkDataManager* ChunkDataManager = Manager.Get();
+			if (!ChunkDataManager)
+			{
+				return;
+			}
+
+			FChunkDataContainer ChunkData;
+			ChunkData.ChunkCoordinate = ChunkCoordinate;
+
+			if (Generated.Num() == 1)
+			{
+				ChunkData.VoxelData = MoveTemp(Generated[0].VoxelData);
+			}
+
+			ChunkDataManager->OnSourceDataReceived(EChunkDataSource::Procedural, ChunkData.VoxelData.Num() == NUM_VOXELS_IN_CHUNK,
+			                                       ChunkCoordinate, ChunkData);
+		}, LowLevelTasks::ETaskPriority::BackgroundNormal);
+	}
+}
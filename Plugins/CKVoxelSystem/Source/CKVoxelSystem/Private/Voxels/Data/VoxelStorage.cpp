@@ -0,0 +1,256 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Voxels/Data/VoxelStorage.h"
+
+void FPalettedVoxelArray::Init(const uint8 Value, const int32 InNum)
+{
+	NumVoxels = FMath::Max(InNum, 0);
+	BitsPerVoxel = 0;
+	Palette.Reset();
+	Palette.Add(Value);
+	Words.Empty();
+}
+
+void FPalettedVoxelArray::Assign(const TArray<uint8>& Voxels)
+{
+	if (Voxels.IsEmpty())
+	{
+		Init(0, 0);
+		return;
+	}
+
+	int32 PaletteIndices[256];
+	FMemory::Memset(PaletteIndices, 0xFF, sizeof(PaletteIndices));
+
+	Palette.Reset();
+	for (const uint8 Voxel : Voxels)
+	{
+		if (PaletteIndices[Voxel] == INDEX_NONE)
+		{
+			PaletteIndices[Voxel] = Palette.Add(Voxel);
+		}
+	}
+
+	NumVoxels = Voxels.Num();
+	BitsPerVoxel = GetBitsForPaletteSize(Palette.Num());
+
+	if (BitsPerVoxel == 0)
+	{
+		Words.Empty();
+		return;
+	}
+
+	if (BitsPerVoxel == 8)
+	{
+		Palette.SetNumUninitialized(256);
+		for (int32 Type = 0; Type < 256; Type++)
+		{
+			Palette[Type] = static_cast<uint8>(Type);
+			PaletteIndices[Type] = Type;
+		}
+	}
+
+	Words.Reset();
+	Words.SetNumZeroed((NumVoxels * BitsPerVoxel + 31) / 32);
+
+	for (int32 Index = 0; Index < NumVoxels; Index++)
+	{
+		SetIndex(Index, PaletteIndices[Voxels[Index]]);
+	}
+}
+
+void FPalettedVoxelArray::Decode(TArray<uint8>& OutVoxels) const
+{
+	OutVoxels.SetNumUninitialized(NumVoxels);
+
+	if (BitsPerVoxel == 0)
+	{
+		FMemory::Memset(OutVoxels.GetData(), Palette[0], NumVoxels);
+		return;
+	}
+
+	const uint32 Mask = (1u << BitsPerVoxel) - 1;
+	const int32 VoxelsPerWord = 32 / BitsPerVoxel;
+	uint8* Out = OutVoxels.GetData();
+	int32 Index = 0;
+
+	for (const uint32 Word : Words)
+	{
+		const int32 End = FMath::Min(Index + VoxelsPerWord, NumVoxels);
+		for (uint32 Bits = Word; Index < End; Index++, Bits >>= BitsPerVoxel)
+		{
+			Out[Index] = Palette[Bits & Mask];
+		}
+	}
+}
+
+bool FPalettedVoxelArray::Matches(const TArray<uint8>& Voxels) const
+{
+	if (Voxels.Num() != NumVoxels)
+	{
+		return false;
+	}
+
+	for (int32 Index = 0; Index < NumVoxels; Index++)
+	{
+		if (Voxels[Index] != Get(Index))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void FPalettedVoxelArray::Set(const int32 Index, const uint8 Value)
+{
+	check(IsValidIndex(Index));
+
+	if (Get(Index) == Value)
+	{
+		return;
+	}
+
+	int32 PaletteIndex = Palette.Find(Value);
+	if (PaletteIndex == INDEX_NONE)
+	{
+		PaletteIndex = Palette.Add(Value);
+
+		const int32 NewBits = GetBitsForPaletteSize(Palette.Num());
+		if (NewBits != BitsPerVoxel)
+		{
+			Repack(NewBits);
+
+			// The palette is the identity from 8 bits on
+			if (NewBits == 8)
+			{
+				PaletteIndex = Value;
+			}
+		}
+	}
+
+	SetIndex(Index, PaletteIndex);
+}
+
+void FPalettedVoxelArray::Repack(const int32 NewBits)
+{
+	TArray<uint8> Voxels;
+	Decode(Voxels);
+
+	int32 PaletteIndices[256];
+	FMemory::Memset(PaletteIndices, 0, sizeof(PaletteIndices));
+
+	if (NewBits == 8)
+	{
+		Palette.SetNumUninitialized(256);
+		for (int32 Type = 0; Type < 256; Type++)
+		{
+			Palette[Type] = static_cast<uint8>(Type);
+		}
+	}
+
+	for (int32 PaletteIndex = 0; PaletteIndex < Palette.Num(); PaletteIndex++)
+	{
+		PaletteIndices[Palette[PaletteIndex]] = PaletteIndex;
+	}
+
+	BitsPerVoxel = NewBits;
+	Words.Reset();
+	Words.SetNumZeroed((NumVoxels * BitsPerVoxel + 31) / 32);
+
+	for (int32 Index = 0; Index < NumVoxels; Index++)
+	{
+		SetIndex(Index, PaletteIndices[Voxels[Index]]);
+	}
+}
+
+int32 FPalettedVoxelArray::GetBitsForPaletteSize(const int32 PaletteSize)
+{
+	if (PaletteSize <= 1)
+	{
+		return 0;
+	}
+	if (PaletteSize <= 2)
+	{
+		return 1;
+	}
+	if (PaletteSize <= 4)
+	{
+		return 2;
+	}
+	if (PaletteSize <= 16)
+	{
+		return 4;
+	}
+	return 8;
+}
+
+namespace VoxelRLE
+{
+	void Encode(const TArray<uint8>& Voxels, TArray<uint8>& OutEncoded)
+	{
+		OutEncoded.Reset();
+
+		int32 Index = 0;
+		while (Index < Voxels.Num())
+		{
+			const uint8 Value = Voxels[Index];
+			int32 RunEnd = Index + 1;
+			while (RunEnd < Voxels.Num() && Voxels[RunEnd] == Value)
+			{
+				RunEnd++;
+			}
+
+			OutEncoded.Add(Value);
+
+			uint32 RunLength = static_cast<uint32>(RunEnd - Index);
+			do
+			{
+				const uint8 Byte = RunLength & 0x7F;
+				RunLength >>= 7;
+				OutEncoded.Add(RunLength ? Byte | 0x80 : Byte);
+			}
+			while (RunLength);
+
+			Index = RunEnd;
+		}
+	}
+
+	bool Decode(const TArray<uint8>& Encoded, const int32 ExpectedNum, TArray<uint8>& OutVoxels)
+	{
+		OutVoxels.Reset(ExpectedNum);
+
+		int32 Offset = 0;
+		while (Offset < Encoded.Num())
+		{
+			const uint8 Value = Encoded[Offset++];
+
+			uint32 RunLength = 0;
+			for (int32 Shift = 0;; Shift += 7)
+			{
+				if (Offset >= Encoded.Num() || Shift > 28)
+				{
+					return false;
+				}
+
+				const uint8 Byte = Encoded[Offset++];
+				RunLength |= static_cast<uint32>(Byte & 0x7F) << Shift;
+
+				if (!(Byte & 0x80))
+				{
+					break;
+				}
+			}
+
+			if (RunLength == 0 || RunLength > static_cast<uint32>(ExpectedNum - OutVoxels.Num()))
+			{
+				return false;
+			}
+
+			const int32 Start = OutVoxels.AddUninitialized(RunLength);
+			FMemory::Memset(OutVoxels.GetData() + Start, Value, RunLength);
+		}
+
+		return OutVoxels.Num() == ExpectedNum;
+	}
+}
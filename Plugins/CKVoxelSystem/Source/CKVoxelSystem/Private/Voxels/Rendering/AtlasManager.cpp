@@ -1,5 +1,7 @@
 ﻿// Fill out your copyright notice in the Description page of Project Settings.
 #include "Voxels/Rendering/AtlasManager.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "TimerManager.h"
 
 
 // Sets default values
@@ -24,11 +26,87 @@ UTexture* AAtlasManager::GetAtlas(const int64 AtlasID) const
 	return AtlasMap[AtlasID];
 }
 
+UMaterialInstanceDynamic* AAtlasManager::AcquireAtlasMaterial(UMaterialInterface* BaseMaterial, const int64 AtlasID, const int32 Flags)
+{
+	if (!BaseMaterial)
+	{
+		return nullptr;
+	}
+
+	const FAtlasMaterialKey Key { BaseMaterial, AtlasID, Flags };
+
+	if (FAtlasMaterialEntry* Entry = AtlasMaterials.Find(Key))
+	{
+		Entry->RefCount++;
+		return Entry->Material;
+	}
+
+	UTexture* Atlas = AtlasID == DEFAULT_ATLAS_ID ? DefaultAtlas.Get() : FindAtlas(AtlasID);
+	if (!Atlas && AtlasID != DEFAULT_ATLAS_ID)
+	{
+		return nullptr;
+	}
+
+	FAtlasMaterialEntry& Entry = AtlasMaterials.Add(Key);
+	Entry.Material = UMaterialInstanceDynamic::Create(BaseMaterial, this);
+	Entry.RefCount = 1;
+
+	if (Atlas)
+	{
+		Entry.Material->SetTextureParameterValue(FName("TextureAtlas"), Atlas);
+	}
+
+	return Entry.Material;
+}
+
+void AAtlasManager::ReleaseAtlasMaterial(UMaterialInterface* BaseMaterial, const int64 AtlasID, const int32 Flags)
+{
+	FAtlasMaterialEntry* Entry = AtlasMaterials.Find(FAtlasMaterialKey { BaseMaterial, AtlasID, Flags });
+	if (!Entry || Entry->RefCount <= 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Released atlas material %lld that is not held"), AtlasID);
+		return;
+	}
+
+	if (--Entry->RefCount == 0)
+	{
+		Entry->UnusedSince = FPlatformTime::Seconds();
+	}
+}
+
+void AAtlasManager::SetDefaultAtlas(UTexture* Atlas)
+{
+	DefaultAtlas = Atlas;
+
+	for (const TPair<FAtlasMaterialKey, FAtlasMaterialEntry>& Pair : AtlasMaterials)
+	{
+		if (Pair.Key.AtlasID == DEFAULT_ATLAS_ID && Pair.Value.Material)
+		{
+			Pair.Value.Material->SetTextureParameterValue(FName("TextureAtlas"), Atlas);
+		}
+	}
+}
+
+void AAtlasManager::ReleaseUnusedMaterials()
+{
+	const double Now = FPlatformTime::Seconds();
+
+	for (auto It = AtlasMaterials.CreateIterator(); It; ++It)
+	{
+		if (It.Value().RefCount == 0 && Now - It.Value().UnusedSince >= UnusedMaterialLifetime)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
 // Called when the game starts or when spawned
 void AAtlasManager::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	GetWorldTimerManager().SetTimer(ReleaseUnusedMaterialsTimer, this, &AAtlasManager::ReleaseUnusedMaterials,
+	                                FMath::Max(UnusedMaterialLifetime, 1.0f), true);
 }
 
 // Called every frame
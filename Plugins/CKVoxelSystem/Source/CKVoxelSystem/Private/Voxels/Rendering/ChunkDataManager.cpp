@@ -1,7 +1,11 @@
 #include "Voxels/Rendering/ChunkDataManager.h"
 #include "Async/Async.h"
+#include "Containers/Ticker.h"
+#include "Network/Services/GameData/CDNServiceSubsystem.h"
 #include "Network/Services/GameData/ChunkServiceSubsystem.h"
 #include "Network/Services/GameData/VoxelServiceSubsystem.h"
+#include "Shared/Types/Core/Common.h"
+#include "Shared/Types/Core/GameSessionSubsystem.h"
 #include "Voxels/Core/VoxelWorldSubsystem.h"
 
 DEFINE_LOG_CATEGORY(LogChunkLoader);
@@ -9,13 +13,35 @@ DEFINE_LOG_CATEGORY(LogChunkLoader);
 void UChunkDataManager::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
+
+	WorkAvailableEvent = FPlatformProcess::GetSynchEventFromPool(false);
 }
 
 void UChunkDataManager::Deinitialize()
 {
-	// Proper cleanup
 	bShouldShutdown = true;
+
+	if (WorkAvailableEvent)
+	{
+		WorkAvailableEvent->Trigger();
+
+		// The worker waits on the event, it has to be gone before the event is returned
+		if (WorkerFuture.IsValid())
+		{
+			WorkerFuture.Wait();
+		}
+
+		FPlatformProcess::ReturnSynchEventToPool(WorkAvailableEvent);
+		WorkAvailableEvent = nullptr;
+	}
+
 	bIsTicking = false;
+
+	for (TUniquePtr<IChunkDataSource>& Source : Sources)
+	{
+		Source.Reset();
+	}
+	ProceduralSource = nullptr;
 	
 	Super::Deinitialize();
 }
@@ -31,39 +57,137 @@ void UChunkDataManager::PostSubsystemInit()
 		UE_LOG(LogChunkLoader, Error, TEXT("Subsystem(s) reference is invalid."));
 	}
 
+	// Chunk queries are pushed by UChunkServiceSubsystem and have no source to ask
+	Sources[static_cast<int32>(EChunkDataSource::VoxelList)] = MakeUnique<FGraphQLChunkDataSource>(VoxelServiceSubsystem);
+	Sources[static_cast<int32>(EChunkDataSource::CDN)] = MakeUnique<FCDNChunkDataSource>(CDNServiceSubsystem);
+	Sources[static_cast<int32>(EChunkDataSource::Disk)] = MakeUnique<FDiskChunkDataSource>(this,
+		GetWorld()->GetGameInstance()->GetSubsystem<UGameSessionSubsystem>());
+
+	TUniquePtr<FProceduralChunkDataSource> Procedural = MakeUnique<FProceduralChunkDataSource>(this, ProceduralSettings);
+	ProceduralSource = Procedural.Get();
+	Sources[static_cast<int32>(EChunkDataSource::Procedural)] = MoveTemp(Procedural);
+
 	ProcessDirtyChunks();
 }
 
 void UChunkDataManager::EnqueueChunksForRequesting(const TArray<FInt64Vector>& ChunkCoordinates)
 {
-	// Create a copy of the coordinates to sort
-	TArray<FInt64Vector> SortedCoordinates = ChunkCoordinates;
-
-	// Sort by distance to CurrentCenterChunkCoordinate (closest first)
-	SortedCoordinates.Sort([this](const FInt64Vector& A, const FInt64Vector& B)
 	{
-		// Calculate squared distance to avoid expensive sqrt operations
-		const int64 DistanceA = FMath::Square(A.X - CurrentCenterChunkCoordinate.X) +
-			FMath::Square(A.Y - CurrentCenterChunkCoordinate.Y) +
-			FMath::Square(A.Z - CurrentCenterChunkCoordinate.Z);
+		FScopeLock Lock(&DataLock);
+		for (const FInt64Vector& ChunkCoordinate : ChunkCoordinates)
+		{
+			if (!PendingRequestSet.Contains(ChunkCoordinate) && IsInStreamingRange(ChunkCoordinate))
+			{
+				PendingRequestSet.Add(ChunkCoordinate);
+				PendingRequests.Add(ChunkCoordinate);
+			}
+		}
 
-		const int64 DistanceB = FMath::Square(B.X - CurrentCenterChunkCoordinate.X) +
-			FMath::Square(B.Y - CurrentCenterChunkCoordinate.Y) +
-			FMath::Square(B.Z - CurrentCenterChunkCoordinate.Z);
+		SortPendingRequests();
+	}
 
-		return DistanceA < DistanceB; // Sort in ascending order (closest first)
-	});
+	DequeueChunksForRequesting();
+}
 
-	// Enqueue the sorted coordinates
+void UChunkDataManager::UpdateStreamingView(const FChunkStreamingView& NewView, const TArray<FInt64Vector>& NewChunks)
+{
 	{
 		FScopeLock Lock(&DataLock);
-		for (const FInt64Vector& ChunkCoordinate : SortedCoordinates)
+		StreamingView = NewView;
+
+		// Drop whatever the view moved away from before it takes a slot
+		PendingRequests.RemoveAll([this](const FInt64Vector& ChunkCoordinate)
 		{
-			ChunksToRequest.Enqueue(ChunkCoordinate);
+			if (IsInStreamingRange(ChunkCoordinate))
+			{
+				return false;
+			}
+
+			PendingRequestSet.Remove(ChunkCoordinate);
+			return true;
+		});
+
+		int32 NumCancelled = 0;
+		for (auto It = RequestedChunks.CreateIterator(); It; ++It)
+		{
+			if (!IsInStreamingRange(It.Key()))
+			{
+				// The response is ignored once its chunk state is gone
+				LoadedChunks.Remove(It.Key());
+				It.RemoveCurrent();
+				NumCancelled++;
+			}
 		}
+
+		for (auto It = ChunkRetryAttempts.CreateIterator(); It; ++It)
+		{
+			if (!IsInStreamingRange(It.Key()))
+			{
+				ChunkRetryTimes.Remove(It.Key());
+				It.RemoveCurrent();
+			}
+		}
+
+		UE_LOG(LogChunkLoader, Verbose, TEXT("Streaming view moved to %lld, %lld, %lld: %d new chunks, %d in-flight requests cancelled"),
+		       NewView.CenterChunk.X, NewView.CenterChunk.Y, NewView.CenterChunk.Z, NewChunks.Num(), NumCancelled);
 	}
 
-	DequeueChunksForRequesting();
+	// Re-ranks the chunks still pending against the new view as well
+	EnqueueChunksForRequesting(NewChunks);
+}
+
+void UChunkDataManager::SetNewCenterCoordinate(const FInt64Vector& NewCenter)
+{
+	FScopeLock Lock(&DataLock);
+	StreamingView.CenterChunk = NewCenter;
+	StreamingView.PredictedCenter = FVector(NewCenter.X, NewCenter.Y, NewCenter.Z);
+}
+
+float UChunkDataManager::GetRequestPriority(const FInt64Vector& ChunkCoordinate) const
+{
+	const FVector Chunk(ChunkCoordinate.X, ChunkCoordinate.Y, ChunkCoordinate.Z);
+	const FVector ToChunk = Chunk - FVector(StreamingView.CenterChunk.X, StreamingView.CenterChunk.Y, StreamingView.CenterChunk.Z);
+	const double Length = ToChunk.Size();
+
+	// The chunks around the player are needed whichever way they look
+	const double Alignment = Length > 1.5 ? FVector::DotProduct(ToChunk / Length, StreamingView.ViewForward) : 1.0;
+
+	const double Distance = FVector::Dist(Chunk, StreamingView.PredictedCenter);
+	return Distance * (1.0 + ViewAlignmentWeight * 0.5 * (1.0 - Alignment));
+}
+
+void UChunkDataManager::SortPendingRequests()
+{
+	TArray<TPair<float, FInt64Vector>> RankedRequests;
+	RankedRequests.Reserve(PendingRequests.Num());
+
+	for (const FInt64Vector& ChunkCoordinate : PendingRequests)
+	{
+		RankedRequests.Emplace(GetRequestPriority(ChunkCoordinate), ChunkCoordinate);
+	}
+
+	RankedRequests.Sort([](const TPair<float, FInt64Vector>& A, const TPair<float, FInt64Vector>& B)
+	{
+		return A.Key > B.Key;
+	});
+
+	for (int32 i = 0; i < RankedRequests.Num(); i++)
+	{
+		PendingRequests[i] = RankedRequests[i].Value;
+	}
+}
+
+bool UChunkDataManager::IsInStreamingRange(const FInt64Vector& ChunkCoordinate) const
+{
+	// No radius until the world sets a view, e.g. for LoadInitialChunks
+	if (StreamingView.Radius <= 0)
+	{
+		return true;
+	}
+
+	const FInt64Vector& Center = StreamingView.CenterChunk;
+	return FMath::Max3(FMath::Abs(ChunkCoordinate.X - Center.X), FMath::Abs(ChunkCoordinate.Y - Center.Y),
+	                   FMath::Abs(ChunkCoordinate.Z - Center.Z)) <= StreamingView.Radius;
 }
 
 void UChunkDataManager::LoadInitialChunks()
@@ -95,8 +219,10 @@ void UChunkDataManager::UnloadFarOffChunksData(const TArray<FInt64Vector>& Chunk
 	FScopeLock Lock(&DataLock);
 	for (auto ChunkToRemove : ChunkCoordinates)
 	{
-		if (LoadedChunks.Contains(ChunkToRemove))
+		if (FChunkDataState* ChunkState = LoadedChunks.Find(ChunkToRemove))
 		{
+			// Records how long the chunk was on screen
+			EnterStage(*ChunkState, EChunkPipelineStage::Evicting);
 			LoadedChunks.Remove(ChunkToRemove);
 			UE_LOG(LogTemp, Log, TEXT("Removed chunk from Loaded Chunks: %lld, %lld, %lld"),ChunkToRemove.X, ChunkToRemove.Y, ChunkToRemove.Z)
 		}
@@ -106,6 +232,13 @@ void UChunkDataManager::UnloadFarOffChunksData(const TArray<FInt64Vector>& Chunk
 			RequestedChunks.Remove(ChunkToRemove);
 			UE_LOG(LogTemp, Log, TEXT("Removed chunk from Requested Chunks: %lld, %lld, %lld"),ChunkToRemove.X, ChunkToRemove.Y, ChunkToRemove.Z)
 		}
+
+		if (PendingRequestSet.Remove(ChunkToRemove) > 0)
+		{
+			PendingRequests.Remove(ChunkToRemove);
+		}
+
+		ForgetChunkRetry(ChunkToRemove);
 	}
 	
 }
@@ -115,101 +248,123 @@ void UChunkDataManager::UnloadAllChunkData()
 	FScopeLock Lock(&DataLock);
 	LoadedChunks.Empty();
 	RequestedChunks.Empty();
+	PendingRequests.Empty();
+	PendingRequestSet.Empty();
+	ChunkRetryAttempts.Empty();
+	ChunkRetryTimes.Empty();
 	DirtyChunksQueue.Empty();
+	NumQueuedDirtyChunks.Reset();
 	UE_LOG(LogTemp, Log, TEXT("Unloaded all chunk data."))
 }
 
 void UChunkDataManager::DequeueChunksForRequesting()
 {
-	const int32 Timestamp = 0;
+	TArray<FInt64Vector> ChunksToSend[NUM_CHUNK_DATA_SOURCES];
 
 	{
-		FInt64Vector ChunkCoordinate;
 		FScopeLock Lock(&DataLock);
+		const int32 Now = FDateTime::UtcNow().ToUnixTimestamp();
 
-		//FThreadSafeBool bSentGetChunkRequest = false;
-		
-		while (ChunksToRequest.Dequeue(ChunkCoordinate))
+		for (auto It = RequestedChunks.CreateIterator(); It; ++It)
 		{
-			if (RequestedChunks.Contains(ChunkCoordinate))
+			if (Now - It.Value() > RequestTimeoutSeconds)
 			{
-				continue;
+				UE_LOG(LogChunkLoader, Warning, TEXT("Request for chunk %lld, %lld, %lld timed out, retrying"),
+				       It.Key().X, It.Key().Y, It.Key().Z);
+
+				// Retried once everything better ranked went out
+				if (!PendingRequestSet.Contains(It.Key()))
+				{
+					PendingRequestSet.Add(It.Key());
+					PendingRequests.Insert(It.Key(), 0);
+				}
+				It.RemoveCurrent();
 			}
+		}
 
-			RequestedChunks.Add(ChunkCoordinate, FDateTime::UtcNow().ToUnixTimestamp());
-			FChunkDataState NewChunkDataState;
+		// Chunks every source failed, queued like timed out ones once their backoff passed
+		const double NowSeconds = FPlatformTime::Seconds();
+		for (auto It = ChunkRetryTimes.CreateIterator(); It; ++It)
+		{
+			if (!IsInStreamingRange(It.Key()))
+			{
+				ChunkRetryAttempts.Remove(It.Key());
+				It.RemoveCurrent();
+			}
+			else if (NowSeconds >= It.Value())
+			{
+				if (!PendingRequestSet.Contains(It.Key()) && !RequestedChunks.Contains(It.Key()))
+				{
+					PendingRequestSet.Add(It.Key());
+					PendingRequests.Insert(It.Key(), 0);
+				}
+				It.RemoveCurrent();
+			}
+		}
 
-			LoadedChunks.Add(ChunkCoordinate, NewChunkDataState);
+		while (RequestedChunks.Num() < MaxInFlightRequests && PendingRequests.Num() > 0)
+		{
+			const FInt64Vector ChunkCoordinate = PendingRequests.Pop(EAllowShrinking::No);
+			PendingRequestSet.Remove(ChunkCoordinate);
 
-			// if (CDNServiceSubsystem)
-			// {
-			// 	CDNServiceSubsystem->GetChunkCDN(ChunkCoordinate.X, ChunkCoordinate.Y, ChunkCoordinate.Z);
-			// }
+			if (RequestedChunks.Contains(ChunkCoordinate))
+			{
+				continue;
+			}
 
-			// if (!bSentGetChunkRequest)
-			// {
-			// 	if (ChunkServiceSubsystem)
-			// 	{
-			// 		ChunkServiceSubsystem->GetChunkByDistance(CurrentCenterChunkCoordinate.X, CurrentCenterChunkCoordinate.Y,
-			// 												  CurrentCenterChunkCoordinate.Z, 8, 0, 0);
-			// 		bSentGetChunkRequest = true;
-			// 	}
-			// }
+			FChunkDataState& ChunkState = LoadedChunks.FindOrAdd(ChunkCoordinate);
 
-			if (VoxelServiceSubsystem)
+			// Every source already answered, asking again would only bring the same data
+			if (ChunkState.PendingSources == 0 && ChunkState.ReceivedSources != 0)
 			{
-				VoxelServiceSubsystem->SendVoxelListRequest(ChunkCoordinate.X, ChunkCoordinate.Y, ChunkCoordinate.Z,
-				                                            Timestamp);
+				continue;
 			}
-		}
-		
-	}
-}
 
-void UChunkDataManager::OnCDNDataReceived(const bool bSuccess, const FInt64Vector& ChunkCoordinate,
-                                          const FChunkDataContainer& CDNData)
-{
-	if (!bSuccess)
-	{
-		UE_LOG(LogChunkLoader, Error, TEXT("CDN data request failed"));
-		return;
-	}
-
-	bool bShouldMarkDirty = false;
+			// Timed out requests only ask the sources that did not answer
+			const uint8 SourcesToAsk = ChunkState.PendingSources != 0 ? ChunkState.PendingSources : EnabledSources;
+			if (SourcesToAsk == 0)
+			{
+				LoadedChunks.Remove(ChunkCoordinate);
+				continue;
+			}
 
-	{
-		FScopeLock Lock(&DataLock);
-		if (FChunkDataState* ChunkState = LoadedChunks.Find(ChunkCoordinate))
-		{
-			const bool bDataChanged = HasDataChanged(ChunkState->CDNChunkData, CDNData);
+			if (ChunkState.StageEnterTime == 0.0)
+			{
+				ChunkState.StageEnterTime = FPlatformTime::Seconds();
+			}
 
-			ChunkState->CDNChunkData = CDNData;
-			ChunkState->bCDNResponseReceived = true;
-			ChunkState->LastCDNUpdateTime = FDateTime::UtcNow().ToUnixTimestamp();
-			ChunkState->bProcessed = false;
+			ChunkState.PendingSources = SourcesToAsk;
+			RequestedChunks.Add(ChunkCoordinate, Now);
 
-			if (bDataChanged)
+			for (int32 SourceIndex = 0; SourceIndex < NUM_CHUNK_DATA_SOURCES; SourceIndex++)
 			{
-				ChunkState->bCDNDataDirty = true;
-				bShouldMarkDirty = true;
-				UE_LOG(LogChunkLoader, Log, TEXT("CDN data changed for chunk: %lld, %lld, %lld"),
-				       ChunkCoordinate.X, ChunkCoordinate.Y, ChunkCoordinate.Z);
+				if (SourcesToAsk & GetSourceBit(static_cast<EChunkDataSource>(SourceIndex)))
+				{
+					ChunksToSend[SourceIndex].Add(ChunkCoordinate);
+				}
 			}
-
-			RequestedChunks.Remove(ChunkCoordinate);
 		}
-		else
+	}
+
+	for (int32 SourceIndex = 0; SourceIndex < NUM_CHUNK_DATA_SOURCES; SourceIndex++)
+	{
+		if (ChunksToSend[SourceIndex].Num() > 0 && Sources[SourceIndex])
 		{
-			UE_LOG(LogChunkLoader, Error, TEXT("CDN data received for unknown chunk: %lld, %lld, %lld"),
-			       ChunkCoordinate.X, ChunkCoordinate.Y, ChunkCoordinate.Z);
+			Sources[SourceIndex]->RequestChunks(ChunksToSend[SourceIndex]);
 		}
 	}
+}
 
-	// Enqueue outside the lock to avoid deadlocks
-	if (bShouldMarkDirty)
+void UChunkDataManager::OnCDNDataReceived(const bool bSuccess, const FInt64Vector& ChunkCoordinate,
+                                          const FChunkDataContainer& CDNData)
+{
+	if (!bSuccess)
 	{
-		DirtyChunksQueue.Enqueue(ChunkCoordinate);
+		UE_LOG(LogChunkLoader, Warning, TEXT("CDN data request failed for chunk: %lld, %lld, %lld"),
+		       ChunkCoordinate.X, ChunkCoordinate.Y, ChunkCoordinate.Z);
 	}
+
+	OnSourceDataReceived(EChunkDataSource::CDN, bSuccess, ChunkCoordinate, CDNData);
 }
 
 void UChunkDataManager::OnGetChunkDataReceived(const bool bSuccess, TArray<FChunkDataContainer>& AllChunkData)
@@ -226,45 +381,18 @@ void UChunkDataManager::OnGetChunkDataReceived(const bool bSuccess, TArray<FChun
 		return;
 	}
 
-	TArray<FInt64Vector> ChunksToMarkDirty;
-
 	{
 		FScopeLock Lock(&DataLock);
 
+		// Pushed without being asked for, so the chunks are taken even if they were never requested
 		for (const FChunkDataContainer& ChunkData : AllChunkData)
 		{
-			const FInt64Vector ChunkCoordinate = ChunkData.ChunkCoordinate;
-
-			FChunkDataState* ChunkState = LoadedChunks.Find(ChunkCoordinate);
-			if (!ChunkState)
-			{
-				FChunkDataState NewChunkState;
-				LoadedChunks.Add(ChunkCoordinate, NewChunkState);
-				ChunkState = LoadedChunks.Find(ChunkCoordinate);
-			}
-
-			const bool bDataChanged = HasDataChanged(ChunkState->GetChunkData, ChunkData);
-
-			ChunkState->GetChunkData = ChunkData;
-			ChunkState->bChunkGetResponseReceived = true;
-			ChunkState->LastGetChunkUpdateTime = FDateTime::UtcNow().ToUnixTimestamp();
-			ChunkState->bProcessed = false;
-
-			if (bDataChanged)
-			{
-				ChunkState->bGetChunkDataDirty = true;
-				ChunksToMarkDirty.Add(ChunkCoordinate);
-			}
-
-			RequestedChunks.Remove(ChunkCoordinate);
+			FChunkDataState& ChunkState = LoadedChunks.FindOrAdd(ChunkData.ChunkCoordinate);
+			ReceiveSourceData(EChunkDataSource::ChunkQuery, ChunkData.ChunkCoordinate, ChunkState, ChunkData);
 		}
 	}
 
-	// Enqueue outside the lock
-	for (const FInt64Vector& ChunkCoord : ChunksToMarkDirty)
-	{
-		DirtyChunksQueue.Enqueue(ChunkCoord);
-	}
+	DequeueChunksForRequesting();
 }
 
 void UChunkDataManager::OnVoxelListDataReceived(const bool bSuccess, const FInt64Vector& ChunkCoordinate,
@@ -272,113 +400,252 @@ void UChunkDataManager::OnVoxelListDataReceived(const bool bSuccess, const FInt6
 {
 	if (!bSuccess)
 	{
-		UE_LOG(LogChunkLoader, Error, TEXT("Voxel list request failed"));
-		return;
+		UE_LOG(LogChunkLoader, Warning, TEXT("Voxel list request failed for chunk: %lld, %lld, %lld"),
+		       ChunkCoordinate.X, ChunkCoordinate.Y, ChunkCoordinate.Z);
 	}
 
-	bool bShouldMarkDirty = false;
+	OnSourceDataReceived(EChunkDataSource::VoxelList, bSuccess, ChunkCoordinate, VoxelListData);
+}
 
+void UChunkDataManager::OnSourceDataReceived(const EChunkDataSource Source, const bool bSuccess,
+                                             const FInt64Vector& ChunkCoordinate, const FChunkDataContainer& Data)
+{
 	{
 		FScopeLock Lock(&DataLock);
 		if (FChunkDataState* ChunkState = LoadedChunks.Find(ChunkCoordinate))
 		{
-			const bool bDataChanged = HasDataChanged(ChunkState->VoxelUpdates, VoxelListData);
-
-			ChunkState->VoxelUpdates = VoxelListData;
-			ChunkState->bVoxelListResponseReceived = true;
-			ChunkState->LastVoxelListUpdateTime = FDateTime::UtcNow().ToUnixTimestamp();
-			ChunkState->bProcessed = false;
+			ChunkState->PendingSources &= ~GetSourceBit(Source);
 
-			if (bDataChanged)
+			if (bSuccess)
 			{
-				ChunkState->bVoxelListDataDirty = true;
-				bShouldMarkDirty = true;
+				ReceiveSourceData(Source, ChunkCoordinate, *ChunkState, Data);
 			}
 
-			RequestedChunks.Remove(ChunkCoordinate);
+			if (ChunkState->PendingSources == 0)
+			{
+				RequestedChunks.Remove(ChunkCoordinate);
+
+				// Nothing had the chunk, forget it and ask again after a backoff
+				if (ChunkState->ReceivedSources == 0)
+				{
+					LoadedChunks.Remove(ChunkCoordinate);
+					ScheduleChunkRetry(ChunkCoordinate);
+				}
+			}
 		}
 		else
 		{
-			UE_LOG(LogChunkLoader, Error, TEXT("Voxel list data received for unknown chunk: %lld, %lld, %lld"),
-			       ChunkCoordinate.X, ChunkCoordinate.Y, ChunkCoordinate.Z);
+			// Cancelled when the streaming view moved away
+			UE_LOG(LogChunkLoader, Verbose, TEXT("%s data received for unknown chunk: %lld, %lld, %lld"),
+			       *UEnum::GetValueAsString(Source), ChunkCoordinate.X, ChunkCoordinate.Y, ChunkCoordinate.Z);
 		}
 	}
 
-	if (bShouldMarkDirty)
+	DequeueChunksForRequesting();
+}
+
+void UChunkDataManager::ScheduleChunkRetry(const FInt64Vector& ChunkCoordinate)
+{
+	if (!IsInStreamingRange(ChunkCoordinate))
 	{
-		DirtyChunksQueue.Enqueue(ChunkCoordinate);
+		ForgetChunkRetry(ChunkCoordinate);
+		return;
+	}
+
+	const int32 Attempts = ++ChunkRetryAttempts.FindOrAdd(ChunkCoordinate);
+	const float Delay = FMath::Min(FailedChunkRetryDelay * FMath::Pow(2.0f, FMath::Min(Attempts - 1, 16)),
+	                               static_cast<float>(RequestTimeoutSeconds));
+	ChunkRetryTimes.Add(ChunkCoordinate, FPlatformTime::Seconds() + Delay);
+
+	UE_LOG(LogChunkLoader, Warning, TEXT("No source had chunk %lld, %lld, %lld, retrying in %.1f s"),
+	       ChunkCoordinate.X, ChunkCoordinate.Y, ChunkCoordinate.Z, Delay);
+
+	// Nothing else may call DequeueChunksForRequesting in the meantime
+	FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateWeakLambda(this, [this](float)
+	{
+		DequeueChunksForRequesting();
+		return false;
+	}), Delay);
+}
+
+void UChunkDataManager::ForgetChunkRetry(const FInt64Vector& ChunkCoordinate)
+{
+	ChunkRetryAttempts.Remove(ChunkCoordinate);
+	ChunkRetryTimes.Remove(ChunkCoordinate);
+}
+
+void UChunkDataManager::ReceiveSourceData(const EChunkDataSource Source, const FInt64Vector& ChunkCoordinate,
+                                          FChunkDataState& ChunkState, const FChunkDataContainer& Data)
+{
+	const int32 SourceIndex = static_cast<int32>(Source);
+	const uint32 DataHash = HashChunkData(Data);
+
+	ChunkState.ReceivedSources |= GetSourceBit(Source);
+	ForgetChunkRetry(ChunkCoordinate);
+
+	// Same as what was merged last time, e.g. a retried request answered twice
+	if (DataHash == ChunkState.SourceDataHash[SourceIndex])
+	{
+		return;
 	}
+
+	ChunkState.SourceData[SourceIndex] = Data;
+	ChunkState.SourceData[SourceIndex].ChunkCoordinate = ChunkCoordinate;
+	ChunkState.SourceDataHash[SourceIndex] = DataHash;
+
+	// Chunks already on their way to the screen go through the pipeline again
+	if (ChunkState.Stage != EChunkPipelineStage::Fetched)
+	{
+		EnterStage(ChunkState, EChunkPipelineStage::Fetched);
+	}
+
+	MarkChunkDirty(ChunkCoordinate, ChunkState);
 }
 
-bool UChunkDataManager::IsChunkDirty(const FInt64Vector& ChunkCoordinate) const
+void UChunkDataManager::EnterStage(FChunkDataState& ChunkState, const EChunkPipelineStage NewStage)
 {
-	if (const FChunkDataState* ChunkState = LoadedChunks.Find(ChunkCoordinate))
+	const double Now = FPlatformTime::Seconds();
+
+	// Chunks pushed without a request have no start time
+	if (ChunkState.StageEnterTime > 0.0)
 	{
-		return ChunkState->bCDNDataDirty || ChunkState->bGetChunkDataDirty || ChunkState->bVoxelListDataDirty;
+		FChunkPipelineStageStats& Stats = StageStats[static_cast<int32>(NewStage)];
+		const double Milliseconds = (Now - ChunkState.StageEnterTime) * 1000.0;
+
+		Stats.NumSamples++;
+		Stats.TotalMilliseconds += Milliseconds;
+		Stats.AverageMilliseconds = Stats.TotalMilliseconds / Stats.NumSamples;
+		Stats.MaxMilliseconds = FMath::Max(Stats.MaxMilliseconds, Milliseconds);
 	}
 
-	return false;
+	ChunkState.Stage = NewStage;
+	ChunkState.StageEnterTime = Now;
 }
 
-TArray<FInt64Vector> UChunkDataManager::GetDirtyChunks() const
+void UChunkDataManager::AdvanceChunkStage(const FInt64Vector& ChunkCoordinate, const EChunkPipelineStage NewStage)
 {
-	TArray<FInt64Vector> DirtyChunksList;
+	FScopeLock Lock(&DataLock);
 
-	for (const auto& ChunkPair : LoadedChunks)
+	// Only ever one stage forward, so a chunk re-meshed for other reasons or still waiting on newer data is not counted
+	FChunkDataState* ChunkState = LoadedChunks.Find(ChunkCoordinate);
+	if (ChunkState && static_cast<int32>(NewStage) == static_cast<int32>(ChunkState->Stage) + 1)
 	{
-		if (IsChunkDirty(ChunkPair.Key))
-		{
-			DirtyChunksList.Add(ChunkPair.Key);
-		}
+		EnterStage(*ChunkState, NewStage);
 	}
+}
+
+EChunkPipelineStage UChunkDataManager::GetChunkStage(const FInt64Vector& ChunkCoordinate, bool& bOutIsLoaded) const
+{
+	FScopeLock Lock(&DataLock);
+
+	const FChunkDataState* ChunkState = LoadedChunks.Find(ChunkCoordinate);
+	bOutIsLoaded = ChunkState != nullptr;
+
+	return ChunkState ? ChunkState->Stage : EChunkPipelineStage::Requested;
+}
+
+FChunkPipelineStageStats UChunkDataManager::GetStageLatency(const EChunkPipelineStage Stage) const
+{
+	if (Stage >= EChunkPipelineStage::Num)
+	{
+		return FChunkPipelineStageStats();
+	}
+
+	FScopeLock Lock(&DataLock);
+	return StageStats[static_cast<int32>(Stage)];
+}
+
+void UChunkDataManager::ResetStageLatencies()
+{
+	FScopeLock Lock(&DataLock);
+
+	for (FChunkPipelineStageStats& Stats : StageStats)
+	{
+		Stats = FChunkPipelineStageStats();
+	}
+}
+
+void UChunkDataManager::SetSourceEnabled(const EChunkDataSource Source, const bool bEnabled)
+{
+	if (Source >= EChunkDataSource::Num || !Sources[static_cast<int32>(Source)])
+	{
+		UE_LOG(LogChunkLoader, Warning, TEXT("%s can't be requested from"), *UEnum::GetValueAsString(Source));
+		return;
+	}
+
+	FScopeLock Lock(&DataLock);
+
+	if (bEnabled)
+	{
+		EnabledSources |= GetSourceBit(Source);
+	}
+	else
+	{
+		EnabledSources &= ~GetSourceBit(Source);
+	}
+}
+
+void UChunkDataManager::SetProceduralSettings(const FTerrainGenerationSettings& Settings)
+{
+	ProceduralSettings = Settings;
+
+	if (ProceduralSource)
+	{
+		ProceduralSource->SetSettings(Settings);
+	}
+}
+
+void UChunkDataManager::MarkChunkDirty(const FInt64Vector& ChunkCoordinate, FChunkDataState& ChunkState)
+{
+	ChunkState.bProcessed = false;
 
-	return DirtyChunksList;
+	if (!ChunkState.bQueuedForProcessing)
+	{
+		ChunkState.bQueuedForProcessing = true;
+		DirtyChunksQueue.Enqueue(ChunkCoordinate);
+		NumQueuedDirtyChunks.Increment();
+		WorkAvailableEvent->Trigger();
+	}
 }
 
 void UChunkDataManager::ProcessDirtyChunks()
 {
-	if (bIsTicking)
+	if (bIsTicking || WorkAvailableEvent == nullptr)
 	{
 		return; // Already running
 	}
 
-    // Use a dedicated OS thread to avoid blocking the task graph in packaged builds
-    Async(EAsyncExecution::Thread, [this]()
-    {
-        double LastTime = FPlatformTime::Seconds();
-
-        while (!bShouldShutdown)
-        {
-            bool bProcessedWork = false;
-            const double CurrentTime = FPlatformTime::Seconds();
-            const double DeltaTime = CurrentTime - LastTime;
+	bIsTicking = true;
 
-            if (DeltaTime >= TickInterval)
-            {
-                ProcessDirtyChunksBatch();
-                bProcessedWork = true;
-                LastTime = CurrentTime;
-            }
+	// Use a dedicated OS thread to avoid blocking the task graph in packaged builds. It sleeps on the event whenever
+	// there is nothing queued, so an idle world costs no CPU
+	WorkerFuture = Async(EAsyncExecution::Thread, [this]()
+	{
+		while (!bShouldShutdown)
+		{
+			WorkAvailableEvent->Wait();
 
-            // Only sleep if no work was processed
-            if (!bProcessedWork)
-            {
-                FPlatformProcess::Sleep(0.0016f);
-            }
-        }
+			// The event is auto-reset and one trigger may stand for many chunks, so drain the queue before waiting again
+			while (!bShouldShutdown && !DirtyChunksQueue.IsEmpty())
+			{
+				const int32 BatchSize = FMath::Clamp(NumQueuedDirtyChunks.GetValue() / 4, MinBatchSize, MaxBatchSize);
+				ProcessDirtyChunksBatch(BatchSize);
+			}
+		}
 
-        bIsTicking = false;
-    });
+		bIsTicking = false;
+	});
 }
 
-void UChunkDataManager::ProcessDirtyChunksBatch()
+void UChunkDataManager::ProcessDirtyChunksBatch(const int32 BatchSize)
 {
 	// Collect dirty chunks from queue
 	TArray<FInt64Vector> DirtyChunks;
 	FInt64Vector ChunkCoord;
 
-	while (DirtyChunksQueue.Dequeue(ChunkCoord) && DirtyChunks.Num() < MaxBatchSize)
+	while (DirtyChunks.Num() < BatchSize && DirtyChunksQueue.Dequeue(ChunkCoord))
 	{
+		NumQueuedDirtyChunks.Decrement();
 		DirtyChunks.Add(ChunkCoord);
 	}
 
@@ -389,182 +656,170 @@ void UChunkDataManager::ProcessDirtyChunksBatch()
 
 	// Process the batch
 	TArray<FChunkDataContainer> ProcessedChunks;
+	uint8 NotifiedSources = 0;
 
 	{
 		FScopeLock Lock(&DataLock);
 
 		for (const FInt64Vector& ChunkCoordinate : DirtyChunks)
 		{
-			// Skip if already being processed
-			if (CurrentlyProcessing.Contains(ChunkCoordinate))
+			// Unloaded since it was queued
+			FChunkDataState* ChunkState = LoadedChunks.Find(ChunkCoordinate);
+			if (!ChunkState)
 			{
 				continue;
 			}
 
-			FChunkDataState* ChunkState = LoadedChunks.Find(ChunkCoordinate);
-			if (!ChunkState || ChunkState->bProcessed)
+			ChunkState->bQueuedForProcessing = false;
+
+			// Still on its way to the game thread, requeued from there once it arrived
+			if (ChunkState->bProcessed || CurrentlyProcessing.Contains(ChunkCoordinate))
 			{
 				continue;
 			}
 
-			CurrentlyProcessing.Add(ChunkCoordinate);
-
-			FChunkDataContainer FinalChunkData;
+			ChunkState->bProcessed = true;
 
-			// Apply your existing logic for combining data sources
-			bool bHasGetChunkData = ChunkState->bChunkGetResponseReceived;
-			bool bHasCDNData = ChunkState->bCDNResponseReceived;
-			bool bHasVoxelUpdates = ChunkState->VoxelUpdates.VoxelStatesMap.Num() > 0;
+			FChunkDataContainer MergedData = MergeSources(ChunkCoordinate, *ChunkState);
+			EnterStage(*ChunkState, EChunkPipelineStage::Merged);
 
-			if (!bHasVoxelUpdates)
-			{
-				break;
-			}
-			// Priority: GetChunk > CDN > Empty
-			/*
-			if (bHasGetChunkData)
-			{
-				FinalChunkData.VoxelData = ChunkState->GetChunkData.VoxelData;
-			}
-			else if (bHasCDNData)
-			{
-				FinalChunkData.VoxelData = ChunkState->CDNChunkData.VoxelData;
-			}
-			else
+			// Nothing to hand over, e.g. an empty voxel list on its own
+			if (MergedData.VoxelData.Num() == 0 && MergedData.VoxelStatesMap.Num() == 0)
 			{
-				constexpr int32 ChunkSize = 16 * 16 * 16;
-				FinalChunkData.VoxelData.Init(0, ChunkSize);
+				continue;
 			}
-			*/
-
-			//constexpr int32 ChunkSize = 16 * 16 * 16;
-			//FinalChunkData.VoxelData.Init(0, ChunkSize);
 
-			// Apply voxel updates
-			//ApplyVoxelUpdates(FinalChunkData, ChunkState->VoxelUpdates);
-			
-			FinalChunkData = ChunkState->VoxelUpdates;
-			FinalChunkData.ChunkCoordinate = ChunkCoordinate;
+			CurrentlyProcessing.Add(ChunkCoordinate);
+			ProcessedChunks.Add(MoveTemp(MergedData));
+		}
 
-			ChunkState->bProcessed = true;
-			ChunkState->bCDNDataDirty = false;
-			ChunkState->bGetChunkDataDirty = false;
-			ChunkState->bVoxelListDataDirty = false;
+		NotifiedSources = EnabledSources;
+	}
 
-			ProcessedChunks.Add(MoveTemp(FinalChunkData));
+	for (int32 SourceIndex = 0; SourceIndex < NUM_CHUNK_DATA_SOURCES; SourceIndex++)
+	{
+		if (Sources[SourceIndex] && (NotifiedSources & GetSourceBit(static_cast<EChunkDataSource>(SourceIndex))))
+		{
+			for (const FChunkDataContainer& ChunkData : ProcessedChunks)
+			{
+				Sources[SourceIndex]->OnChunkMerged(ChunkData);
+			}
 		}
 	}
 
 	// Send to game thread if we have processed chunks
 	if (ProcessedChunks.Num() > 0)
 	{
-		// Capture by value to avoid lifetime issues
-		UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, ProcessedChunks = MoveTemp(ProcessedChunks)]()
+		// Capture by value to avoid lifetime issues. The world queues the chunks into state Tick reads, so this has to
+		// run on the game thread
+		AsyncTask(ENamedThreads::GameThread, [this, ProcessedChunks = MoveTemp(ProcessedChunks)]()
 		{
 			if (UVoxelWorldSubsystem* VoxelWorld = GetWorld()->GetSubsystem<UVoxelWorldSubsystem>())
 			{
 				//VoxelWorld->UpdateChunks(ProcessedChunks);
 				for (const FChunkDataContainer& ChunkData : ProcessedChunks)
 				{
-					UE_LOG(LogTemp, Log, TEXT("Chunk Data: %lld, %lld, %lld"), ChunkData.ChunkCoordinate.X, ChunkData.ChunkCoordinate.Y, ChunkData.ChunkCoordinate.Z)
+					UE_LOG(LogChunkLoader, Verbose, TEXT("Chunk Data: %lld, %lld, %lld"), ChunkData.ChunkCoordinate.X, ChunkData.ChunkCoordinate.Y, ChunkData.ChunkCoordinate.Z)
 				}
 				VoxelWorld->ApplyVoxelUpdatesOnChunks(ProcessedChunks);
 			}
 
-			// Remove from a processing set
+			// Remove from a processing set, and requeue chunks that got new data in the meantime
 			{
 				FScopeLock Lock(&DataLock);
 				for (const FChunkDataContainer& Chunk : ProcessedChunks)
 				{
 					CurrentlyProcessing.Remove(Chunk.ChunkCoordinate);
+
+					if (FChunkDataState* ChunkState = LoadedChunks.Find(Chunk.ChunkCoordinate); ChunkState && !ChunkState->bProcessed)
+					{
+						MarkChunkDirty(Chunk.ChunkCoordinate, *ChunkState);
+					}
 				}
 			}
-		}, LowLevelTasks::ETaskPriority::Normal, UE::Tasks::EExtendedTaskPriority::GameThreadNormalPri);
+		});
 	}
 }
 
-void UChunkDataManager::ApplyVoxelUpdates(FChunkDataContainer& ChunkData,
-                                          const FChunkDataContainer& VoxelUpdates)
+FChunkDataContainer UChunkDataManager::MergeSources(const FInt64Vector& ChunkCoordinate, const FChunkDataState& ChunkState)
 {
-	ChunkData.VoxelStatesMap = VoxelUpdates.VoxelStatesMap;
+	FChunkDataContainer MergedData;
+	MergedData.ChunkCoordinate = ChunkCoordinate;
 
-	for (const auto& UpdatePair : VoxelUpdates.VoxelStatesMap)
+	for (int32 SourceIndex = NUM_CHUNK_DATA_SOURCES - 1; SourceIndex >= 0; SourceIndex--)
 	{
-		const FVoxelCoordinate& VoxelCoord = UpdatePair.Key;
-		const FVoxelDefinition& VoxelDef = UpdatePair.Value;
-
-		// Validate coordinates
-		if (VoxelCoord.X < 0 || VoxelCoord.X >= 16 ||
-			VoxelCoord.Y < 0 || VoxelCoord.Y >= 16 ||
-			VoxelCoord.Z < 0 || VoxelCoord.Z >= 16)
+		if (ChunkState.SourceData[SourceIndex].VoxelData.Num() == NUM_VOXELS_IN_CHUNK)
 		{
-			UE_LOG(LogChunkLoader, Warning, TEXT("Invalid voxel coordinate: %d, %d, %d"),
-			       VoxelCoord.X, VoxelCoord.Y, VoxelCoord.Z);
-			continue;
+			MergedData.VoxelData = ChunkState.SourceData[SourceIndex].VoxelData;
+			break;
 		}
+	}
 
-		const int32 Index = VoxelCoord.X + VoxelCoord.Y * 16 + VoxelCoord.Z * 16 * 16;
+	for (int32 SourceIndex = 0; SourceIndex < NUM_CHUNK_DATA_SOURCES; SourceIndex++)
+	{
+		const bool bIsDelta = SourceIndex == static_cast<int32>(EChunkDataSource::VoxelList);
 
-		if (ChunkData.VoxelData.IsValidIndex(Index))
+		for (const auto& UpdatePair : ChunkState.SourceData[SourceIndex].VoxelStatesMap)
 		{
-			ChunkData.VoxelData[Index] = VoxelDef.VoxelType;
-		}
-	}
-}
+			const FVoxelCoordinate& VoxelCoord = UpdatePair.Key;
+			const FVoxelDefinition& VoxelDef = UpdatePair.Value;
 
-bool UChunkDataManager::HasDataChanged(const FChunkDataContainer& OldData, const FChunkDataContainer& NewData)
-{
-	if (OldData.VoxelData.Num() != NewData.VoxelData.Num())
-	{
-		return true;
-	}
+			// Validate coordinates
+			if (VoxelCoord.X < 0 || VoxelCoord.X >= CHUNK_SIZE ||
+				VoxelCoord.Y < 0 || VoxelCoord.Y >= CHUNK_SIZE ||
+				VoxelCoord.Z < 0 || VoxelCoord.Z >= CHUNK_SIZE)
+			{
+				UE_LOG(LogChunkLoader, Warning, TEXT("Invalid voxel coordinate: %d, %d, %d"),
+				       VoxelCoord.X, VoxelCoord.Y, VoxelCoord.Z);
+				continue;
+			}
 
-	if (OldData.VoxelData != NewData.VoxelData)
-	{
-		return true;
-	}
+			// Same layout as AVoxelChunk::ApplyVoxelUpdates
+			const int32 Index = VoxelCoord.X + VoxelCoord.Y * CHUNK_SIZE + VoxelCoord.Z * CHUNK_SIZE * CHUNK_SIZE;
 
-	// Check if VoxelStatesMap has different number of entries
-	if (OldData.VoxelStatesMap.Num() != NewData.VoxelStatesMap.Num())
-	{
-		return true;
-	}
+			if (bIsDelta)
+			{
+				const FVoxelDefinition* Existing = MergedData.VoxelStatesMap.Find(VoxelCoord);
+				const bool bUnchanged = Existing
+					? Existing->VoxelType == VoxelDef.VoxelType && Existing->VoxelState == VoxelDef.VoxelState
+					: MergedData.VoxelData.IsValidIndex(Index) && MergedData.VoxelData[Index] == VoxelDef.VoxelType
+					  && VoxelDef.VoxelState == FVoxelState();
 
-	// Iterate through the old map and compare with a new map
-	for (const auto& OldVoxelPair : OldData.VoxelStatesMap)
-	{
-		const FVoxelCoordinate& VoxelCoord = OldVoxelPair.Key;
-		const FVoxelDefinition& OldVoxelDef = OldVoxelPair.Value;
+				if (bUnchanged)
+				{
+					continue;
+				}
+			}
 
-		// Check if this voxel coordinate exists in the new map
-		const FVoxelDefinition* NewVoxelDef = NewData.VoxelStatesMap.Find(VoxelCoord);
-		if (!NewVoxelDef)
-		{
-			// Voxel exists in old but not in new - data has changed
-			return true;
-		}
+			MergedData.VoxelStatesMap.Add(VoxelCoord, VoxelDef);
 
-		// Compare the voxel definitions
-		if (OldVoxelDef.Version != NewVoxelDef->Version ||
-			OldVoxelDef.VoxelType != NewVoxelDef->VoxelType ||
-			OldVoxelDef.VoxelState != NewVoxelDef->VoxelState)
-		{
-			// Voxel definition has changed
-			return true;
+			if (MergedData.VoxelData.IsValidIndex(Index))
+			{
+				MergedData.VoxelData[Index] = VoxelDef.VoxelType;
+			}
 		}
 	}
 
-	// Check if a new map has any voxels that an old map doesn't have
-	for (const auto& NewVoxelPair : NewData.VoxelStatesMap)
-	{
-		const FVoxelCoordinate& VoxelCoord = NewVoxelPair.Key;
+	return MergedData;
+}
 
-		if (!OldData.VoxelStatesMap.Contains(VoxelCoord))
-		{
-			// New voxel exists that wasn't in the old map-data has changed
-			return true;
-		}
+uint32 UChunkDataManager::HashChunkData(const FChunkDataContainer& Data)
+{
+	uint32 Hash = FCrc::MemCrc32(Data.VoxelData.GetData(), Data.VoxelData.Num());
+
+	// Summed so the map's iteration order does not matter
+	uint32 StatesHash = 0;
+	for (const auto& VoxelPair : Data.VoxelStatesMap)
+	{
+		uint32 EntryHash = GetTypeHash(VoxelPair.Key);
+		EntryHash = HashCombine(EntryHash, GetTypeHash(VoxelPair.Value.Version));
+		EntryHash = HashCombine(EntryHash, GetTypeHash(VoxelPair.Value.VoxelType));
+		EntryHash = HashCombine(EntryHash, GetTypeHash(VoxelPair.Value.VoxelState));
+		StatesHash += EntryHash;
 	}
 
-	return false;
+	Hash = HashCombine(Hash, HashCombine(StatesHash, GetTypeHash(Data.VoxelStatesMap.Num())));
+
+	// 0 is reserved for "nothing received yet"
+	return Hash != 0 ? Hash : 1;
 }
@@ -0,0 +1,236 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Voxels/Rendering/ChunkInstanceBatcher.h"
+#include "Components/InstancedStaticMeshComponent.h"
+
+void FChunkInstanceBatcher::BeginRebuild()
+{
+	bRebuilding = true;
+
+	for (TPair<TObjectKey<UInstancedStaticMeshComponent>, FComponentInstances>& Pair : Components)
+	{
+		Pair.Value.Kept.Reset();
+	}
+}
+
+void FChunkInstanceBatcher::SetInstance(UInstancedStaticMeshComponent* Component, const uint64 Key,
+                                        const FTransform& WorldTransform)
+{
+	if (!Component)
+	{
+		return;
+	}
+
+	FComponentInstances& Instances = FindOrAddComponent(Component);
+	Instances.Pending.Add(Key, WorldTransform.GetRelativeTransform(Component->GetComponentTransform()));
+
+	if (bRebuilding)
+	{
+		Instances.Kept.Add(Key);
+	}
+}
+
+void FChunkInstanceBatcher::RemoveInstance(UInstancedStaticMeshComponent* Component, const uint64 Key)
+{
+	FComponentInstances* Instances = Components.Find(Component);
+	if (!Instances)
+	{
+		return;
+	}
+
+	Instances->Pending.Add(Key, TOptional<FTransform>());
+	Instances->Kept.Remove(Key);
+	DirtyComponents.Add(Component);
+}
+
+bool FChunkInstanceBatcher::FindInstanceKey(const UInstancedStaticMeshComponent* Component, const int32 InstanceIndex,
+                                            uint64& OutKey) const
+{
+	const FComponentInstances* Instances = Components.Find(Component);
+	if (!Instances || !Instances->KeyByIndex.IsValidIndex(InstanceIndex) || Instances->KeyByIndex[InstanceIndex] == FREE_SLOT)
+	{
+		return false;
+	}
+
+	OutKey = Instances->KeyByIndex[InstanceIndex];
+	return true;
+}
+
+FChunkInstanceBatcher::FComponentInstances& FChunkInstanceBatcher::FindOrAddComponent(UInstancedStaticMeshComponent* Component)
+{
+	DirtyComponents.Add(Component);
+
+	FComponentInstances& Instances = Components.FindOrAdd(Component);
+	Instances.Component = Component;
+	return Instances;
+}
+
+void FChunkInstanceBatcher::Flush()
+{
+	for (auto It = Components.CreateIterator(); It; ++It)
+	{
+		// A rebuild touches every component, instances nobody set again are removed
+		if (!bRebuilding && !DirtyComponents.Contains(It.Key()))
+		{
+			continue;
+		}
+
+		if (!It.Value().Component.IsValid())
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		FlushComponent(It.Value(), bRebuilding);
+	}
+
+	DirtyComponents.Reset();
+	bRebuilding = false;
+}
+
+void FChunkInstanceBatcher::FlushComponent(FComponentInstances& Instances, const bool bRebuilding)
+{
+	UInstancedStaticMeshComponent* Component = Instances.Component.Get();
+
+	if (bRebuilding)
+	{
+		// Adds queued before the rebuild were not set again either
+		for (TPair<uint64, TOptional<FTransform>>& Change : Instances.Pending)
+		{
+			if (!Instances.Kept.Contains(Change.Key))
+			{
+				Change.Value.Reset();
+			}
+		}
+
+		for (const uint64 Key : Instances.KeyByIndex)
+		{
+			if (!Instances.Kept.Contains(Key))
+			{
+				Instances.Pending.Add(Key, TOptional<FTransform>());
+			}
+		}
+		Instances.Kept.Reset();
+	}
+
+	TArray<int32> FreeSlots;
+	TArray<uint64> AddedKeys;
+	TArray<FTransform> AddedTransforms;
+	bool bUpdated = false;
+
+	for (const TPair<uint64, TOptional<FTransform>>& Change : Instances.Pending)
+	{
+		const int32* FoundIndex = Instances.IndexByKey.Find(Change.Key);
+
+		if (!Change.Value.IsSet())
+		{
+			if (FoundIndex)
+			{
+				const int32 Index = *FoundIndex;
+				FreeSlots.Add(Index);
+				Instances.KeyByIndex[Index] = FREE_SLOT;
+				Instances.IndexByKey.Remove(Change.Key);
+			}
+			continue;
+		}
+
+		if (!FoundIndex)
+		{
+			AddedKeys.Add(Change.Key);
+			AddedTransforms.Add(Change.Value.GetValue());
+			continue;
+		}
+
+		if (!Instances.Transforms[*FoundIndex].Equals(Change.Value.GetValue()))
+		{
+			Instances.Transforms[*FoundIndex] = Change.Value.GetValue();
+			Component->UpdateInstanceTransform(*FoundIndex, Instances.Transforms[*FoundIndex], false, false, true);
+			bUpdated = true;
+		}
+	}
+
+	Instances.Pending.Reset();
+
+	auto MoveInto = [&Instances, Component](const int32 Slot, const uint64 Key, const FTransform& Transform)
+	{
+		Instances.KeyByIndex[Slot] = Key;
+		Instances.Transforms[Slot] = Transform;
+		Instances.IndexByKey.Add(Key, Slot);
+		Component->UpdateInstanceTransform(Slot, Transform, false, false, true);
+	};
+
+	// Added instances take the slots of removed ones, an update instead of a remove and an add
+	while (!FreeSlots.IsEmpty() && !AddedKeys.IsEmpty())
+	{
+		MoveInto(FreeSlots.Pop(EAllowShrinking::No), AddedKeys.Pop(EAllowShrinking::No), AddedTransforms.Pop(EAllowShrinking::No));
+		bUpdated = true;
+	}
+
+	if (!FreeSlots.IsEmpty())
+	{
+		// The last instances fill the remaining slots, so only the end of the array is removed
+		FreeSlots.Sort();
+
+		int32 Tail = Instances.KeyByIndex.Num();
+		for (const int32 Slot : FreeSlots)
+		{
+			while (Tail > 0 && Instances.KeyByIndex[Tail - 1] == FREE_SLOT)
+			{
+				Tail--;
+			}
+
+			if (Slot >= Tail)
+			{
+				break;
+			}
+
+			const int32 Last = Tail - 1;
+			const uint64 LastKey = Instances.KeyByIndex[Last];
+			Instances.KeyByIndex[Last] = FREE_SLOT;
+			MoveInto(Slot, LastKey, Instances.Transforms[Last]);
+			Tail = Last;
+			bUpdated = true;
+		}
+
+		while (Tail > 0 && Instances.KeyByIndex[Tail - 1] == FREE_SLOT)
+		{
+			Tail--;
+		}
+
+		// Highest first, nothing shifts
+		TArray<int32> Removed;
+		for (int32 Index = Instances.KeyByIndex.Num() - 1; Index >= Tail; Index--)
+		{
+			Removed.Add(Index);
+		}
+
+		Component->RemoveInstances(Removed);
+		Instances.KeyByIndex.SetNum(Tail);
+		Instances.Transforms.SetNum(Tail);
+	}
+
+	if (!AddedKeys.IsEmpty())
+	{
+		const TArray<int32> Indices = Component->AddInstances(AddedTransforms, true, false);
+
+		for (int32 Added = 0; Added < Indices.Num(); Added++)
+		{
+			const int32 Index = Indices[Added];
+			if (Index >= Instances.KeyByIndex.Num())
+			{
+				Instances.KeyByIndex.SetNum(Index + 1);
+				Instances.Transforms.SetNum(Index + 1);
+			}
+
+			Instances.KeyByIndex[Index] = AddedKeys[Added];
+			Instances.Transforms[Index] = AddedTransforms[Added];
+			Instances.IndexByKey.Add(AddedKeys[Added], Index);
+		}
+	}
+
+	// Adds and removes mark it themselves
+	if (bUpdated)
+	{
+		Component->MarkRenderStateDirty();
+	}
+}
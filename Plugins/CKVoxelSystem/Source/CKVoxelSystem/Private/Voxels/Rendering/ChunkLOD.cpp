@@ -0,0 +1,166 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Voxels/Rendering/ChunkLOD.h"
+#include "Shared/Types/Core/Common.h"
+#include "Shared/Types/Enums/Voxels/EVoxelType.h"
+#include "Shared/Types/Structures/Voxels/FVoxelState.h"
+#include "Voxels/Core/VoxelChunk.h"
+#include "Voxels/Data/VoxelStorage.h"
+#include "Voxels/Rendering/VoxelTypeTable.h"
+
+namespace ChunkLOD
+{
+	void Downsample(const FPalettedVoxelArray& Voxels, const int32 ChunkSize, const int32 Factor, const FVoxelTypeTable& TypeTable,
+	                TArray<uint8>& OutCells)
+	{
+		check(Factor > 0 && ChunkSize % Factor == 0);
+
+		const int32 CellsPerAxis = ChunkSize / Factor;
+		const int32 NumCells = CellsPerAxis * CellsPerAxis * CellsPerAxis;
+		constexpr uint8 EmptyCell = static_cast<uint8>(EVoxelType::AIR);
+
+		if (Voxels.IsUniform())
+		{
+			OutCells.Init(TypeTable.bEmpty[Voxels.GetUniformValue()] ? EmptyCell : Voxels.GetUniformValue(), NumCells);
+			return;
+		}
+
+		OutCells.SetNumUninitialized(NumCells);
+
+		const int32 BlockVolume = Factor * Factor * Factor;
+
+		// Only the types seen in the block are reset afterwards
+		int32 Counts[FVoxelTypeTable::NUM_TYPES] = {};
+		TArray<uint8, TInlineAllocator<64>> SeenTypes;
+
+		for (int32 CellZ = 0; CellZ < CellsPerAxis; CellZ++)
+		{
+			for (int32 CellY = 0; CellY < CellsPerAxis; CellY++)
+			{
+				for (int32 CellX = 0; CellX < CellsPerAxis; CellX++)
+				{
+					int32 SolidCount = 0;
+					SeenTypes.Reset();
+
+					for (int32 Z = CellZ * Factor; Z < (CellZ + 1) * Factor; Z++)
+					{
+						for (int32 Y = CellY * Factor; Y < (CellY + 1) * Factor; Y++)
+						{
+							const int32 RowStart = Y * ChunkSize + Z * ChunkSize * ChunkSize;
+							for (int32 X = CellX * Factor; X < (CellX + 1) * Factor; X++)
+							{
+								const uint8 Type = Voxels.Get(RowStart + X);
+								if (TypeTable.bEmpty[Type])
+								{
+									continue;
+								}
+
+								SolidCount++;
+								if (Counts[Type]++ == 0)
+								{
+									SeenTypes.Add(Type);
+								}
+							}
+						}
+					}
+
+					uint8 CellType = EmptyCell;
+					if (SolidCount * 2 >= BlockVolume)
+					{
+						int32 BestCount = 0;
+						for (const uint8 Type : SeenTypes)
+						{
+							if (Counts[Type] > BestCount || (Counts[Type] == BestCount && Type < CellType))
+							{
+								BestCount = Counts[Type];
+								CellType = Type;
+							}
+						}
+					}
+
+					for (const uint8 Type : SeenTypes)
+					{
+						Counts[Type] = 0;
+					}
+
+					OutCells[CellX + CellY * CellsPerAxis + CellZ * CellsPerAxis * CellsPerAxis] = CellType;
+				}
+			}
+		}
+	}
+
+	void BuildMesh(const TArray<uint8>& Cells, const FIntVector& GridSize, const float CellSize, const FVector& Origin,
+	               const FVoxelTypeTable& TypeTable, FMeshData& OutMesh)
+	{
+		check(Cells.Num() == GridSize.X * GridSize.Y * GridSize.Z);
+
+		auto IsEmpty = [&](const int32 X, const int32 Y, const int32 Z)
+		{
+			return TypeTable.bEmpty[Cells[X + Y * GridSize.X + Z * GridSize.X * GridSize.Y]];
+		};
+
+		// GenerateCubeMesh places cubes at Position * CellSize - HalfSize
+		const FVector HalfSize = -Origin;
+
+		// LOD cells are never rotated
+		FVoxelState CellState;
+		int32 CulledFaces = 0;
+
+		for (int32 Z = 0; Z < GridSize.Z; Z++)
+		{
+			for (int32 Y = 0; Y < GridSize.Y; Y++)
+			{
+				for (int32 X = 0; X < GridSize.X; X++)
+				{
+					const uint8 CellType = Cells[X + Y * GridSize.X + Z * GridSize.X * GridSize.Y];
+					if (TypeTable.bEmpty[CellType])
+					{
+						continue;
+					}
+
+					// Bottom Front Top Right Back Left, as in AVoxelChunk::RegenerateChunk
+					const bool VisibleFaces[6] = {
+						Z == 0               || IsEmpty(X, Y, Z - 1),
+						X == 0               || IsEmpty(X - 1, Y, Z),
+						Z == GridSize.Z - 1  || IsEmpty(X, Y, Z + 1),
+						Y == GridSize.Y - 1  || IsEmpty(X, Y + 1, Z),
+						X == GridSize.X - 1  || IsEmpty(X + 1, Y, Z),
+						Y == 0               || IsEmpty(X, Y - 1, Z)
+					};
+
+					AVoxelChunk::GenerateCubeMesh(FVector(X, Y, Z), HalfSize, CellSize, VisibleFaces, OutMesh.Vertices,
+					                              OutMesh.Triangles, OutMesh.Normals, OutMesh.UVs, OutMesh.VertexOffset,
+					                              CulledFaces, OutMesh.VertexColors, TypeTable.AtlasIndex[CellType], CellState,
+					                              OutMesh.Tangents);
+				}
+			}
+		}
+	}
+
+	int32 SelectLevel(const double Distance, const double ScreenScale, const double MaxScreenSpaceError)
+	{
+		const double PixelsPerUnit = ScreenScale / FMath::Max(Distance, 1.0);
+
+		for (int32 Level = IMPOSTOR_LEVEL; Level > 0; Level--)
+		{
+			// A cell of Factor voxels misplaces a surface by up to Factor - 1 voxels
+			const double Error = (GetDownsampleFactor(Level) - 1) * VOXEL_SIZE;
+			if (Error * PixelsPerUnit <= MaxScreenSpaceError)
+			{
+				return Level;
+			}
+		}
+
+		return 0;
+	}
+
+	FInt64Vector GetRegion(const FInt64Vector& ChunkCoordinate)
+	{
+		auto FloorDiv = [](const int64 Value)
+		{
+			return Value >= 0 ? Value / IMPOSTOR_REGION_SIZE : (Value - IMPOSTOR_REGION_SIZE + 1) / IMPOSTOR_REGION_SIZE;
+		};
+
+		return FInt64Vector(FloorDiv(ChunkCoordinate.X), FloorDiv(ChunkCoordinate.Y), FloorDiv(ChunkCoordinate.Z));
+	}
+}
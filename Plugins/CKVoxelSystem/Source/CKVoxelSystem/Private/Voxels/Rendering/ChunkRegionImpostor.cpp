@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Voxels/Rendering/ChunkRegionImpostor.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "Voxels/Rendering/AtlasManager.h"
+
+AChunkRegionImpostor::AChunkRegionImpostor()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	Mesh = CreateDefaultSubobject<UProceduralMeshComponent>(TEXT("ImpostorMesh"));
+	RootComponent = Mesh;
+
+	// Only ever seen from afar, never walked on
+	Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Mesh->SetCastShadow(false);
+}
+
+void AChunkRegionImpostor::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Same material as AVoxelChunk, so the far field matches the chunks it replaces
+	BaseMaterial = LoadObject<UMaterialInterface>(nullptr, TEXT("/Game/Assets/Materials/MI_NewVoxelMaterial.MI_NewVoxelMaterial"));
+	if (!BaseMaterial)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Failed to load material instance."));
+	}
+}
+
+void AChunkRegionImpostor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (IsValid(AtlasManager) && Material)
+	{
+		AtlasManager->ReleaseAtlasMaterial(BaseMaterial, AAtlasManager::DEFAULT_ATLAS_ID);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AChunkRegionImpostor::Initialize(const FInt64Vector& InRegion, AAtlasManager* InAtlasManager)
+{
+	Region = InRegion;
+	AtlasManager = InAtlasManager;
+
+	if (IsValid(AtlasManager))
+	{
+		Material = AtlasManager->AcquireAtlasMaterial(BaseMaterial, AAtlasManager::DEFAULT_ATLAS_ID);
+	}
+	else if (BaseMaterial)
+	{
+		Material = UMaterialInstanceDynamic::Create(BaseMaterial, this);
+	}
+}
+
+void AChunkRegionImpostor::UpdateAtlas(UTexture* TextureAtlas)
+{
+	if (IsValid(AtlasManager))
+	{
+		return;
+	}
+
+	if (UMaterialInstanceDynamic* DynamicMaterial = Cast<UMaterialInstanceDynamic>(Material))
+	{
+		DynamicMaterial->SetTextureParameterValue(FName("TextureAtlas"), TextureAtlas);
+	}
+}
+
+void AChunkRegionImpostor::UpdateMesh(const ChunkLOD::FMeshData& MeshData)
+{
+	Mesh->ClearAllMeshSections();
+	bBuilt = true;
+
+	if (MeshData.Vertices.IsEmpty())
+	{
+		return;
+	}
+
+	Mesh->CreateMeshSection_LinearColor(0, MeshData.Vertices, MeshData.Triangles, MeshData.Normals, MeshData.UVs,
+	                                    MeshData.VertexColors, MeshData.Tangents, false);
+	Mesh->SetMaterial(0, Material);
+}
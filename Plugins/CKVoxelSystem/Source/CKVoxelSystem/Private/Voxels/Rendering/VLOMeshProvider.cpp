@@ -18,13 +18,6 @@ void AVLOMeshProvider::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// Filling empty VLO types with base mesh
-	for (int32 i = 12; i < 256; i++)
-	{
-		SetVLOMesh(static_cast<uint8>(i), DefaultVLOMesh);
-	}
-
-	
 	UE_LOG(LogVLOMeshProvider, Log, TEXT("VLO Mesh Provider initialized with %d mesh mappings"), VLOMeshMappings.Num());
 }
 
@@ -41,12 +34,14 @@ UStaticMesh* AVLOMeshProvider::GetVLOMesh(uint8 VoxelType) const
 	{
 		return *FoundMesh;
 	}
-	return nullptr;
+
+	// Empty VLO types use the base mesh
+	return VoxelType >= FIRST_DEFAULT_VLO_TYPE ? DefaultVLOMesh : nullptr;
 }
 
 bool AVLOMeshProvider::HasVLOMesh(uint8 VoxelType) const
 {
-	return VLOMeshMappings.Contains(VoxelType);
+	return GetVLOMesh(VoxelType) != nullptr;
 }
 
 
@@ -62,12 +57,15 @@ void AVLOMeshProvider::SetVLOMesh(uint8 VoxelType, UStaticMesh* Mesh)
 		VLOMeshMappings.Remove(VoxelType);
 		UE_LOG(LogVLOMeshProvider, Log, TEXT("Removed VLO mesh for voxel type %d"), VoxelType);
 	}
+
+	OnVLOMeshesChanged.Broadcast();
 }
 
 
 void AVLOMeshProvider::RemoveVLOMesh(uint8 VoxelType)
 {
 	VLOMeshMappings.Remove(VoxelType);
+	OnVLOMeshesChanged.Broadcast();
 }
 
 
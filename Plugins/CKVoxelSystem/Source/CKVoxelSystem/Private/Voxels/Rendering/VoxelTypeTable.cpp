@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Voxels/Rendering/VoxelTypeTable.h"
+#include "Shared/Types/Enums/Voxels/EVoxelType.h"
+#include "Voxels/Rendering/VLOMeshProvider.h"
+
+TSharedRef<const FVoxelTypeTable, ESPMode::ThreadSafe> FVoxelTypeTable::Build(const AVLOMeshProvider* VLOMeshProvider)
+{
+	const TSharedRef<FVoxelTypeTable, ESPMode::ThreadSafe> Table = MakeShared<FVoxelTypeTable, ESPMode::ThreadSafe>();
+
+	const UEnum* EnumPtr = StaticEnum<EVoxelType>();
+	const float AtlasRowScale = 1.0f / static_cast<float>(EnumPtr->GetMaxEnumValue() - 1);
+
+	for (int32 VoxelType = 0; VoxelType < NUM_TYPES; VoxelType++)
+	{
+		UStaticMesh* VLOMesh = VLOMeshProvider ? VLOMeshProvider->GetVLOMesh(static_cast<uint8>(VoxelType)) : nullptr;
+
+		Table->bEmpty[VoxelType] = VoxelType == static_cast<int32>(EVoxelType::AIR);
+		Table->bHasVLOMesh[VoxelType] = VLOMesh != nullptr;
+		Table->VLOMeshes[VoxelType] = VLOMesh;
+		Table->AtlasIndex[VoxelType] = static_cast<float>(VoxelType - 1) * AtlasRowScale;
+	}
+
+	return Table;
+}
@@ -0,0 +1,552 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "World/Terrain/TerrainGenerator.h"
+#include "Shared/Types/Core/Common.h"
+#include "Math/RandomStream.h"
+#include "Tasks/Task.h"
+
+DEFINE_LOG_CATEGORY(LogTerrainGenerator);
+
+namespace
+{
+	constexpr EGenerationPass PASS_ORDER[] = {
+		EGenerationPass::Foundation,
+		EGenerationPass::Carving,
+		EGenerationPass::Surface,
+		EGenerationPass::Decoration,
+		EGenerationPass::Structures,
+		EGenerationPass::Infrastructure,
+		EGenerationPass::Details
+	};
+
+	constexpr int32 NUM_PASSES = UE_ARRAY_COUNT(PASS_ORDER);
+
+	// Decorrelates the cave noise from the foundation noise
+	constexpr float CAVE_NOISE_OFFSET = 7919.5f;
+
+	// Per voxel hash salts, one per pass that rolls per voxel
+	constexpr uint64 DECORATION_SALT = 1;
+	constexpr uint64 DETAIL_SALT = 2;
+
+	FORCEINLINE uint64 MixBits(uint64 Value)
+	{
+		// splitmix64 finaliser
+		Value ^= Value >> 30;
+		Value *= 0xBF58476D1CE4E5B9ull;
+		Value ^= Value >> 27;
+		Value *= 0x94D049BB133111EBull;
+		Value ^= Value >> 31;
+		return Value;
+	}
+
+	FORCEINLINE uint64 HashCoordinate(const uint64 Seed, const FInt64Vector& Coordinate)
+	{
+		uint64 Hash = MixBits(Seed + 0x9E3779B97F4A7C15ull);
+		Hash = MixBits(Hash ^ static_cast<uint64>(Coordinate.X));
+		Hash = MixBits(Hash ^ static_cast<uint64>(Coordinate.Y));
+		Hash = MixBits(Hash ^ static_cast<uint64>(Coordinate.Z));
+		return Hash;
+	}
+
+	// Uniform [0, 1) roll for a voxel
+	FORCEINLINE float RollVoxel(const uint32 ChunkSeed, const uint64 Salt, const FInt64Vector& WorldVoxel)
+	{
+		return static_cast<float>(HashCoordinate((static_cast<uint64>(ChunkSeed) << 8) ^ Salt, WorldVoxel) >> 40) * (1.0f / 16777216.0f);
+	}
+
+	FORCEINLINE int32 VoxelIndex(const int32 X, const int32 Y, const int32 Z)
+	{
+		return (X * CHUNK_SIZE * CHUNK_SIZE) + (Y * CHUNK_SIZE) + Z;
+	}
+
+	FORCEINLINE int32 NeighbourSlot(const int32 Dx, const int32 Dy, const int32 Dz)
+	{
+		return (Dx + 1) + 3 * ((Dy + 1) + 3 * (Dz + 1));
+	}
+
+	FORCEINLINE FInt64Vector ToWorldVoxel(const FInt64Vector& Chunk, const int32 X, const int32 Y, const int32 Z)
+	{
+		return FInt64Vector(Chunk.X * CHUNK_SIZE + X, Chunk.Y * CHUNK_SIZE + Y, Chunk.Z * CHUNK_SIZE + Z);
+	}
+}
+
+FTerrainGenerator::FTerrainGenerator(const FTerrainGenerationSettings& InSettings)
+	: Settings(InSettings)
+{
+	Settings.SubsurfaceDepth = FMath::Clamp(Settings.SubsurfaceDepth, 0, CHUNK_SIZE - 1);
+	Settings.NumBiomes = FMath::Max(Settings.NumBiomes, 1);
+}
+
+uint32 FTerrainGenerator::GetChunkSeed(const int32 WorldSeed, const FInt64Vector& ChunkCoordinate)
+{
+	return static_cast<uint32>(HashCoordinate(static_cast<uint32>(WorldSeed), ChunkCoordinate) >> 32);
+}
+
+int32 FTerrainGenerator::GetPassHalo(const EGenerationPass Pass)
+{
+	switch (Pass)
+	{
+	// Look at the voxels above / below a chunk's top / bottom layer
+	case EGenerationPass::Surface:
+	case EGenerationPass::Decoration:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+int32 FTerrainGenerator::GetBiome(const FInt64Vector& ChunkCoordinate) const
+{
+	const float Scale = FMath::Max(Settings.BiomeScale, 1.0f);
+	const float Noise = FMath::PerlinNoise2D(FVector2D((ChunkCoordinate.X + Settings.Seed) / Scale + 0.5f,
+	                                                   (ChunkCoordinate.Y + Settings.Seed) / Scale + 0.5f));
+	const float Normalized = FMath::Clamp((Noise + 1.0f) * 0.5f, 0.0f, 1.0f);
+	return FMath::Min(FMath::FloorToInt32(Normalized * Settings.NumBiomes), Settings.NumBiomes - 1);
+}
+
+TArray<FChunkData> FTerrainGenerator::GenerateChunks(const FInt64Vector& MinChunk, const FInt64Vector& MaxChunk) const
+{
+	TArray<FChunkData> Chunks;
+
+	const int32 NumX = MaxChunk.X - MinChunk.X + 1;
+	const int32 NumY = MaxChunk.Y - MinChunk.Y + 1;
+	const int32 NumZ = MaxChunk.Z - MinChunk.Z + 1;
+	if (NumX <= 0 || NumY <= 0 || NumZ <= 0)
+	{
+		return Chunks;
+	}
+
+	const int32 NumChunks = NumX * NumY * NumZ;
+	auto GetJobIndex = [NumX, NumY, NumZ](const int32 X, const int32 Y, const int32 Z)
+	{
+		if (X < 0 || Y < 0 || Z < 0 || X >= NumX || Y >= NumY || Z >= NumZ)
+		{
+			return static_cast<int32>(INDEX_NONE);
+		}
+		return X + NumX * (Y + NumY * Z);
+	};
+
+	TArray<FChunkJob> Jobs;
+	Jobs.SetNum(NumChunks);
+
+	for (int32 z = 0; z < NumZ; z++)
+	{
+		for (int32 y = 0; y < NumY; y++)
+		{
+			for (int32 x = 0; x < NumX; x++)
+			{
+				FChunkJob& Job = Jobs[GetJobIndex(x, y, z)];
+				Job.Coordinate = MinChunk + FInt64Vector(x, y, z);
+				Job.Seed = GetChunkSeed(Settings.Seed, Job.Coordinate);
+				Job.Buffers[0].SetNumUninitialized(NUM_VOXELS_IN_CHUNK);
+				Job.Buffers[1].SetNumUninitialized(NUM_VOXELS_IN_CHUNK);
+
+				for (int32 Dz = -1; Dz <= 1; Dz++)
+				{
+					for (int32 Dy = -1; Dy <= 1; Dy++)
+					{
+						for (int32 Dx = -1; Dx <= 1; Dx++)
+						{
+							const int32 NeighbourIndex = GetJobIndex(x + Dx, y + Dy, z + Dz);
+							Job.Neighbours[NeighbourSlot(Dx, Dy, Dz)] = NeighbourIndex != INDEX_NONE ? &Jobs[NeighbourIndex] : nullptr;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// Pass N of a chunk depends on pass N-1 of the chunks it reads (its halo) and of the chunks that read it during
+	// pass N-1 (their halo), since pass N writes the buffer those were reading
+	TArray<UE::Tasks::FTask> PreviousTasks;
+	TArray<UE::Tasks::FTask> CurrentTasks;
+	PreviousTasks.SetNum(NumChunks);
+	CurrentTasks.SetNum(NumChunks);
+	int32 PreviousHalo = 0;
+
+	for (int32 PassIndex = 0; PassIndex < NUM_PASSES; PassIndex++)
+	{
+		const EGenerationPass Pass = PASS_ORDER[PassIndex];
+		const int32 Halo = FMath::Max(GetPassHalo(Pass), PreviousHalo);
+
+		for (int32 z = 0; z < NumZ; z++)
+		{
+			for (int32 y = 0; y < NumY; y++)
+			{
+				for (int32 x = 0; x < NumX; x++)
+				{
+					const int32 JobIndex = GetJobIndex(x, y, z);
+
+					TArray<UE::Tasks::FTask, TInlineAllocator<27>> Prerequisites;
+					if (PassIndex > 0)
+					{
+						for (int32 Dz = -Halo; Dz <= Halo; Dz++)
+						{
+							for (int32 Dy = -Halo; Dy <= Halo; Dy++)
+							{
+								for (int32 Dx = -Halo; Dx <= Halo; Dx++)
+								{
+									const int32 NeighbourIndex = GetJobIndex(x + Dx, y + Dy, z + Dz);
+									if (NeighbourIndex != INDEX_NONE)
+									{
+										Prerequisites.Add(PreviousTasks[NeighbourIndex]);
+									}
+								}
+							}
+						}
+					}
+
+					CurrentTasks[JobIndex] = UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, &Jobs, JobIndex, Pass, PassIndex]()
+					{
+						FChunkJob& Job = Jobs[JobIndex];
+						const int32 InputBuffer = PassIndex & 1;
+						FPassContext Context{Job, Job.Buffers[InputBuffer].GetData(), Job.Buffers[InputBuffer ^ 1].GetData(), InputBuffer};
+						RunPass(Pass, Context);
+					}, Prerequisites);
+				}
+			}
+		}
+
+		Swap(PreviousTasks, CurrentTasks);
+		PreviousHalo = GetPassHalo(Pass);
+	}
+
+	// Every chunk's last pass transitively waits on all of its earlier ones
+	UE::Tasks::Wait(PreviousTasks);
+
+	Chunks.SetNum(NumChunks);
+	for (int32 JobIndex = 0; JobIndex < NumChunks; JobIndex++)
+	{
+		FChunkJob& Job = Jobs[JobIndex];
+		FChunkData& Chunk = Chunks[JobIndex];
+		Chunk.ChunkX = Job.Coordinate.X;
+		Chunk.ChunkY = Job.Coordinate.Y;
+		Chunk.ChunkZ = Job.Coordinate.Z;
+		Chunk.VoxelData = MoveTemp(Job.Buffers[NUM_PASSES & 1]);
+	}
+
+	return Chunks;
+}
+
+void FTerrainGenerator::RunPass(const EGenerationPass Pass, FPassContext& Context) const
+{
+	switch (Pass)
+	{
+	case EGenerationPass::Foundation: RunFoundation(Context); break;
+	case EGenerationPass::Carving: RunCarving(Context); break;
+	case EGenerationPass::Surface: RunSurface(Context); break;
+	case EGenerationPass::Decoration: RunDecoration(Context); break;
+	case EGenerationPass::Structures: RunStructures(Context); break;
+	case EGenerationPass::Infrastructure: RunInfrastructure(Context); break;
+	case EGenerationPass::Details: RunDetails(Context); break;
+	}
+}
+
+bool FTerrainGenerator::IsFoundationSolid(const FInt64Vector& WorldVoxel) const
+{
+	const float NoiseX = (WorldVoxel.X + Settings.Seed * VOXEL_SIZE) / Settings.Frequency;
+	const float NoiseY = (WorldVoxel.Y + Settings.Seed * VOXEL_SIZE) / Settings.Frequency;
+	const float NoiseZ = (WorldVoxel.Z + Settings.Seed * VOXEL_SIZE) / Settings.Frequency;
+	return FMath::PerlinNoise3D(FVector(NoiseX, NoiseY, NoiseZ)) * Settings.Amplitude < Settings.Threshold;
+}
+
+bool FTerrainGenerator::IsCarved(const FInt64Vector& WorldVoxel) const
+{
+	if (Settings.CaveThreshold <= 0.0f)
+	{
+		return false;
+	}
+
+	const float NoiseX = (WorldVoxel.X + Settings.Seed * VOXEL_SIZE) / Settings.CaveFrequency + CAVE_NOISE_OFFSET;
+	const float NoiseY = (WorldVoxel.Y + Settings.Seed * VOXEL_SIZE) / Settings.CaveFrequency + CAVE_NOISE_OFFSET;
+	const float NoiseZ = (WorldVoxel.Z + Settings.Seed * VOXEL_SIZE) / Settings.CaveFrequency + CAVE_NOISE_OFFSET;
+	return FMath::Abs(FMath::PerlinNoise3D(FVector(NoiseX, NoiseY, NoiseZ))) < Settings.CaveThreshold;
+}
+
+bool FTerrainGenerator::IsSolid(const FPassContext& Context, const int32 X, const int32 Y, const int32 Z) const
+{
+	const int32 Dx = X < 0 ? -1 : (X >= CHUNK_SIZE ? 1 : 0);
+	const int32 Dy = Y < 0 ? -1 : (Y >= CHUNK_SIZE ? 1 : 0);
+	const int32 Dz = Z < 0 ? -1 : (Z >= CHUNK_SIZE ? 1 : 0);
+
+	if (Dx == 0 && Dy == 0 && Dz == 0)
+	{
+		return Context.Input[VoxelIndex(X, Y, Z)] != 0;
+	}
+
+	if (const FChunkJob* Neighbour = Context.Job.Neighbours[NeighbourSlot(Dx, Dy, Dz)])
+	{
+		return Neighbour->Buffers[Context.InputBuffer][VoxelIndex(X - Dx * CHUNK_SIZE, Y - Dy * CHUNK_SIZE, Z - Dz * CHUNK_SIZE)] != 0;
+	}
+
+	// Not generated alongside us, solidity after Carving is a pure function of the world position
+	const FInt64Vector WorldVoxel = ToWorldVoxel(Context.Job.Coordinate, X, Y, Z);
+	return IsFoundationSolid(WorldVoxel) && !IsCarved(WorldVoxel);
+}
+
+void FTerrainGenerator::RunFoundation(FPassContext& Context) const
+{
+	for (int32 x = 0; x < CHUNK_SIZE; x++)
+	{
+		for (int32 y = 0; y < CHUNK_SIZE; y++)
+		{
+			for (int32 z = 0; z < CHUNK_SIZE; z++)
+			{
+				const bool bSolid = IsFoundationSolid(ToWorldVoxel(Context.Job.Coordinate, x, y, z));
+				Context.Output[VoxelIndex(x, y, z)] = bSolid ? Settings.StoneVoxel : 0;
+			}
+		}
+	}
+}
+
+void FTerrainGenerator::RunCarving(FPassContext& Context) const
+{
+	FMemory::Memcpy(Context.Output, Context.Input, NUM_VOXELS_IN_CHUNK);
+
+	if (Settings.CaveThreshold <= 0.0f)
+	{
+		return;
+	}
+
+	for (int32 Index = 0; Index < NUM_VOXELS_IN_CHUNK; Index++)
+	{
+		if (Context.Output[Index] == 0)
+		{
+			continue;
+		}
+
+		const int32 x = Index / (CHUNK_SIZE * CHUNK_SIZE);
+		const int32 y = (Index / CHUNK_SIZE) % CHUNK_SIZE;
+		const int32 z = Index % CHUNK_SIZE;
+
+		if (IsCarved(ToWorldVoxel(Context.Job.Coordinate, x, y, z)))
+		{
+			Context.Output[Index] = 0;
+		}
+	}
+}
+
+void FTerrainGenerator::RunSurface(FPassContext& Context) const
+{
+	FMemory::Memcpy(Context.Output, Context.Input, NUM_VOXELS_IN_CHUNK);
+
+	const int32 MaxDepth = Settings.SubsurfaceDepth;
+
+	for (int32 x = 0; x < CHUNK_SIZE; x++)
+	{
+		for (int32 y = 0; y < CHUNK_SIZE; y++)
+		{
+			// Solid voxels directly above the chunk's top layer, only counted as far as the result can change
+			int32 SolidAbove = 0;
+			while (SolidAbove <= MaxDepth && IsSolid(Context, x, y, CHUNK_SIZE + SolidAbove))
+			{
+				SolidAbove++;
+			}
+
+			for (int32 z = CHUNK_SIZE - 1; z >= 0; z--)
+			{
+				uint8& Voxel = Context.Output[VoxelIndex(x, y, z)];
+				if (Voxel == 0)
+				{
+					SolidAbove = 0;
+					continue;
+				}
+
+				if (SolidAbove == 0)
+				{
+					Voxel = Settings.SurfaceVoxel != 0 ? Settings.SurfaceVoxel : Voxel;
+				}
+				else if (SolidAbove <= MaxDepth)
+				{
+					Voxel = Settings.SubsurfaceVoxel != 0 ? Settings.SubsurfaceVoxel : Voxel;
+				}
+
+				SolidAbove = FMath::Min(SolidAbove + 1, MaxDepth + 1);
+			}
+		}
+	}
+}
+
+void FTerrainGenerator::RunDecoration(FPassContext& Context) const
+{
+	FMemory::Memcpy(Context.Output, Context.Input, NUM_VOXELS_IN_CHUNK);
+
+	if (Settings.DecorationVoxel == 0 || Settings.DecorationDensity <= 0.0f)
+	{
+		return;
+	}
+
+	for (int32 x = 0; x < CHUNK_SIZE; x++)
+	{
+		for (int32 y = 0; y < CHUNK_SIZE; y++)
+		{
+			for (int32 z = 0; z < CHUNK_SIZE; z++)
+			{
+				const int32 Index = VoxelIndex(x, y, z);
+				if (Context.Input[Index] != 0 || !IsSolid(Context, x, y, z - 1))
+				{
+					continue;
+				}
+
+				if (RollVoxel(Context.Job.Seed, DECORATION_SALT, ToWorldVoxel(Context.Job.Coordinate, x, y, z)) < Settings.DecorationDensity)
+				{
+					Context.Output[Index] = Settings.DecorationVoxel;
+				}
+			}
+		}
+	}
+}
+
+void FTerrainGenerator::RunStructures(FPassContext& Context) const
+{
+	FMemory::Memcpy(Context.Output, Context.Input, NUM_VOXELS_IN_CHUNK);
+
+	FChunkJob& Job = Context.Job;
+	Job.Structures.Reset();
+
+	if (Settings.Structures.IsEmpty() || Settings.StructureVoxel == 0)
+	{
+		return;
+	}
+
+	// Only the chunk seed drives placement, so it reproduces without any neighbour
+	FRandomStream Random(static_cast<int32>(Job.Seed));
+	const int32 Biome = GetBiome(Job.Coordinate);
+
+	for (const FStructureTemplate& Template : Settings.Structures)
+	{
+		// Always draw the same amount per template so one template's outcome never shifts the next one's rolls
+		const float Roll = Random.FRand();
+		const int32 AnchorX = Random.RandHelper(CHUNK_SIZE);
+		const int32 AnchorY = Random.RandHelper(CHUNK_SIZE);
+
+		const FIntVector& Size = Template.Size;
+		if (Roll >= Template.SpawnProbability
+			|| (Template.RequiredBiomes.Num() > 0 && !Template.RequiredBiomes.Contains(Biome))
+			|| Size.X < 3 || Size.Y < 3 || Size.Z < 3
+			|| Size.X > CHUNK_SIZE || Size.Y > CHUNK_SIZE || Size.Z > CHUNK_SIZE)
+		{
+			continue;
+		}
+
+		const int32 MinX = FMath::Min(AnchorX, CHUNK_SIZE - Size.X);
+		const int32 MinY = FMath::Min(AnchorY, CHUNK_SIZE - Size.Y);
+
+		// Rest the floor on the highest ground under the footprint's centre that leaves room for the walls
+		const int32 CenterX = MinX + Size.X / 2;
+		const int32 CenterY = MinY + Size.Y / 2;
+		int32 FloorZ = INDEX_NONE;
+		for (int32 z = CHUNK_SIZE - Size.Z; z >= 0; z--)
+		{
+			if (Context.Input[VoxelIndex(CenterX, CenterY, z)] != 0)
+			{
+				FloorZ = z;
+				break;
+			}
+		}
+
+		if (FloorZ == INDEX_NONE)
+		{
+			continue;
+		}
+
+		const FIntVector Min(MinX, MinY, FloorZ);
+		const FIntVector Max = Min + Size - FIntVector(1);
+
+		bool bOverlaps = false;
+		for (const FStructurePlacement& Placed : Job.Structures)
+		{
+			const FIntVector PlacedMax = Placed.Min + Placed.Size - FIntVector(1);
+			if (Min.X <= PlacedMax.X && Max.X >= Placed.Min.X && Min.Y <= PlacedMax.Y && Max.Y >= Placed.Min.Y
+				&& Min.Z <= PlacedMax.Z && Max.Z >= Placed.Min.Z)
+			{
+				bOverlaps = true;
+				break;
+			}
+		}
+
+		if (bOverlaps)
+		{
+			continue;
+		}
+
+		// Hollow box: floor, walls and roof
+		for (int32 x = Min.X; x <= Max.X; x++)
+		{
+			for (int32 y = Min.Y; y <= Max.Y; y++)
+			{
+				for (int32 z = Min.Z; z <= Max.Z; z++)
+				{
+					const bool bShell = x == Min.X || x == Max.X || y == Min.Y || y == Max.Y || z == Min.Z || z == Max.Z;
+					Context.Output[VoxelIndex(x, y, z)] = bShell ? Settings.StructureVoxel : 0;
+				}
+			}
+		}
+
+		Job.Structures.Add({Min, Size});
+	}
+}
+
+void FTerrainGenerator::RunInfrastructure(FPassContext& Context) const
+{
+	FMemory::Memcpy(Context.Output, Context.Input, NUM_VOXELS_IN_CHUNK);
+
+	for (const FStructurePlacement& Placed : Context.Job.Structures)
+	{
+		const int32 DoorY = Placed.Min.Y + Placed.Size.Y / 2;
+		const int32 DoorTop = FMath::Min(Placed.Min.Z + 2, Placed.Min.Z + Placed.Size.Z - 2);
+
+		// Doorway in the -X wall
+		for (int32 z = Placed.Min.Z + 1; z <= DoorTop; z++)
+		{
+			Context.Output[VoxelIndex(Placed.Min.X, DoorY, z)] = 0;
+		}
+
+		if (Settings.PathVoxel == 0)
+		{
+			continue;
+		}
+
+		// Path leading away from the door, laid on the ground as far as it stays inside this chunk
+		const int32 PathEnd = FMath::Max(Placed.Min.X - Settings.PathLength, 0);
+		for (int32 x = Placed.Min.X - 1; x >= PathEnd; x--)
+		{
+			for (int32 z = FMath::Min(Placed.Min.Z + 1, CHUNK_SIZE - 1); z >= 0; z--)
+			{
+				uint8& Voxel = Context.Output[VoxelIndex(x, DoorY, z)];
+				if (Voxel != 0)
+				{
+					Voxel = Settings.PathVoxel;
+					break;
+				}
+			}
+		}
+	}
+}
+
+void FTerrainGenerator::RunDetails(FPassContext& Context) const
+{
+	FMemory::Memcpy(Context.Output, Context.Input, NUM_VOXELS_IN_CHUNK);
+
+	if (Settings.DetailVoxel == 0 || Settings.DetailDensity <= 0.0f)
+	{
+		return;
+	}
+
+	for (int32 Index = 0; Index < NUM_VOXELS_IN_CHUNK; Index++)
+	{
+		if (Context.Output[Index] != Settings.StoneVoxel)
+		{
+			continue;
+		}
+
+		const int32 x = Index / (CHUNK_SIZE * CHUNK_SIZE);
+		const int32 y = (Index / CHUNK_SIZE) % CHUNK_SIZE;
+		const int32 z = Index % CHUNK_SIZE;
+
+		if (RollVoxel(Context.Job.Seed, DETAIL_SALT, ToWorldVoxel(Context.Job.Coordinate, x, y, z)) < Settings.DetailDensity)
+		{
+			Context.Output[Index] = Settings.DetailVoxel;
+		}
+	}
+}
@@ -23,5 +23,11 @@ struct FAudioTrack
 	TObjectPtr<UAudioComponent> AudioComponent;
     
 	/** Buffer for audio playback */
-	FCircularAudioBuffer* PlaybackBuffer;
+	FCircularAudioBuffer* PlaybackBuffer = nullptr;
+
+	/** Smoothed RMS level of the incoming audio, used for speaker prioritisation */
+	float Loudness = 0.0f;
+
+	/** True while the track plays through its own audio component instead of the shared mixdown */
+	bool bFullFidelity = false;
 };
\ No newline at end of file
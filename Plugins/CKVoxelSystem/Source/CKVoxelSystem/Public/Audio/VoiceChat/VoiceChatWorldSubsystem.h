@@ -10,6 +10,8 @@
 #include "Shared/Types/Interfaces/Subsystems/SubsystemInitializable.h"
 #include "VoiceChatWorldSubsystem.generated.h"
 
+class UGameSessionSubsystem;
+
 DECLARE_LOG_CATEGORY_EXTERN(LogVoiceChat, Log, All);
 
 // Event Delegates for Audio Generation and Reception
@@ -30,6 +32,7 @@ public:
 
     virtual void Initialize(FSubsystemCollectionBase& Collection) override;
     virtual void Deinitialize() override;
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
 
     UFUNCTION(BlueprintCallable, Category = "Voice Chat")
     virtual void PostSubsystemInit() override;
@@ -67,6 +70,16 @@ public:
     /** Set the timeout threshold for inactive streams */
     UFUNCTION(BlueprintCallable, Category="Voice Chat")
     void SetStreamTimeoutThreshold(const float InSeconds) { StreamTimeoutThreshold = InSeconds; }
+
+    /** Set how many remote speakers keep their own audio component, the rest are downmixed */
+    UFUNCTION(BlueprintCallable, Category="Voice Chat")
+    void SetMaxFullFidelitySpeakers(const int32 InMaxSpeakers) { MaxFullFidelitySpeakers = FMath::Max(0, InMaxSpeakers); }
+
+    /** Record the chunk a remote speaker last transmitted from. Safe to call from any thread. */
+    void SetSpeakerChunk(const FString& PlayerID, const FInt64Vector& ChunkCoordinates);
+
+    /** Whether a speaker in the given chunk is within hearing range of the local player. Safe to call from any thread. */
+    bool IsSpeakerAudible(const FInt64Vector& ChunkCoordinates) const;
     
 protected:
     
@@ -107,6 +120,18 @@ protected:
     /** Time in seconds after which an inactive stream is considered timed out */
     UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voice Chat")
     float StreamTimeoutThreshold = 2.0f;
+
+    /** Number of loudest/nearest speakers played through their own audio component */
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voice Chat")
+    int32 MaxFullFidelitySpeakers = 8;
+
+    /** Chunk distance (Chebyshev) beyond which remote speakers are not decoded at all */
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voice Chat")
+    int32 MaxAudibleChunkDistance = 4;
+
+    /** Time in seconds between speaker priority re-evaluations */
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voice Chat")
+    float PriorityUpdateInterval = 0.25f;
     
 private:
     /** Buffer for captured audio data */
@@ -164,6 +189,43 @@ private:
     /** Process audio for a specific player's stream */
     void ProcessPlayerStream(FAudioTrack* AudioTrack);
 
+    /** Create the procedural sound wave and audio component used to play a track */
+    void CreateTrackPlayback(FAudioTrack& AudioTrack, uint32 SampleRate);
+
+    /** Convert float samples to 16-bit PCM and queue them on a track's sound wave */
+    static void QueueTrackAudio(FAudioTrack& AudioTrack, const TArray<float>& AudioChunk);
+
+    /**
+    * Ranks remote speakers by loudness and distance, keeping the top MaxFullFidelitySpeakers
+    * on their own audio component and downmixing everyone else into MixdownTrack
+    */
+    void UpdateSpeakerPriorities();
+
+    /** Shared stream every non-prioritised speaker is downmixed into */
+    UPROPERTY()
+    FAudioTrack MixdownTrack;
+
+    /** Scratch buffer the downmixed speakers are summed into */
+    TArray<float> MixdownBuffer;
+
+    /** Number of speakers summed into MixdownBuffer this tick */
+    int32 NumMixedSpeakers = 0;
+
+    /** Last chunk each remote speaker transmitted from */
+    TMap<FString, FInt64Vector> SpeakerChunks;
+
+    /** Local player's chunk, refreshed on the game thread */
+    FInt64Vector ListenerChunkCoordinates = {0, 0, 0};
+
+    /** Guards ListenerChunkCoordinates for reads from the network threads */
+    mutable FCriticalSection ListenerLock;
+
+    /** Time the speaker priorities were last recomputed */
+    double LastPriorityUpdateTime = 0.0;
+
+    UPROPERTY()
+    UGameSessionSubsystem* GameSessionSubsystem;
+
     /**
     * Checks for voice chat streams that have timed out and removes them
     * A stream times out when it hasn't received audio data for longer than StreamTimeoutThreshold
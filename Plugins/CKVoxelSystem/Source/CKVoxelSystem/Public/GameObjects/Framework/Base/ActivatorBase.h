@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameObjectBase.h"
 #include "Shared/Types/Interfaces/World/OriginRebasable.h"
+#include "Shared/Types/Interfaces/World/Poolable.h"
 #include "GameFramework/Actor.h"
 #include "Shared/Types/Enums/Events/EEventType.h"
 #include "Shared/Types/Interfaces/Interaction/Activatable.h"
@@ -13,7 +14,7 @@
 class AGameObjectsManager;
 
 UCLASS(Blueprintable, BlueprintType)
-class  AActivatorBase : public AActor, public IActivatable, public IOriginRebasable
+class  AActivatorBase : public AActor, public IActivatable, public IOriginRebasable, public IPoolable
 {
 	GENERATED_BODY()
 
@@ -30,8 +31,9 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Activatable")
 	void SetGameObjectManagerReference(AGameObjectsManager* InGameObjectManager);
 
-	UFUNCTION(BlueprintCallable, Category = "Activatable")
-	void SetActivatorUUID(const FString& inUUID);
+	// World stable ID the server routes activation notifications by, 0 while not registered
+	UFUNCTION(BlueprintPure, Category = "Activatable")
+	int64 GetActivatorID() const { return ActivatorID; }
 
 	UFUNCTION(BlueprintCallable, Category = "Activatable")
 	void RequestActivation_Implementation() override;
@@ -45,15 +47,22 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Activatable")
 	FVector GetActorOriginalLocation_Implementation() override;
 
+	virtual void OnAcquiredFromPool_Implementation() override;
+
+	virtual void OnReleasedToPool_Implementation() override;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Activatable")
 	AGameObjectBase* TargetObject;
 
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Activatable")
-	FString ActivatorUUID;
+	// Derived from chunk, placement and event type, see UActivatorRegistrySubsystem::MakeActivatorID
+	UPROPERTY(BlueprintReadOnly, VisibleInstanceOnly, Category = "Activatable")
+	int64 ActivatorID;
 
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Activatable")
 	int64 MapID;
@@ -72,9 +81,22 @@ protected:
 
 private:
 
+	// Original location and chunk coordinates from the current location
+	void UpdateSpawnLocation();
+
+	void RegisterActivator();
+
+	void UnregisterActivator();
+
+	// The manager of the world, from the activator registry unless set explicitly
+	AGameObjectsManager* GetGameObjectsManager();
+
 	UPROPERTY()
 	AGameObjectsManager* GameObjectsManager;
 
 	UPROPERTY()
 	FVector OriginalLocation;
+
+	// OriginalLocation relative to the origin of its chunk, hashed into the ActivatorID
+	FVector LocationInChunk = FVector::ZeroVector;
 };
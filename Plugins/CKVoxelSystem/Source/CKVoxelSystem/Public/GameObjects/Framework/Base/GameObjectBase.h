@@ -8,6 +8,19 @@
 #include "Shared/Types/Structures/GameObjects/FGameObjectState.h"
 #include "GameObjectBase.generated.h"
 
+class UStaticMesh;
+
+// A static mesh that draws part of a game object while it is instanced
+struct FGameObjectProxyMesh
+{
+	UStaticMesh* Mesh = nullptr;
+
+	// Relative to the actor
+	FTransform Transform;
+
+	bool bEnableCollision = false;
+};
+
 UCLASS(Blueprintable, BlueprintType)
 class  AGameObjectBase : public AActor, public IOriginRebasable
 {
@@ -29,6 +42,24 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "GameObjectBase|Origin Rebase")
 
 	FVector GetActorOriginalLocation_Implementation() override;
+
+	/**
+	 * Idle placed objects are drawn through their chunk's instanced meshes, see APlaceableObjectManager. While
+	 * instanced the actor is hidden, has no collision and does not tick.
+	 */
+	virtual void SetInstanced(bool bNewInstanced);
+
+	bool IsInstanced() const { return bInstanced; }
+
+	// Whether the object is in the middle of something only the actor can show, it is not instanced until done
+	virtual bool IsAnimating() const { return false; }
+
+	/**
+	 * Meshes that draw the object as it currently looks. By default every visible static mesh component, instanced
+	 * ones included, with the mesh's own materials.
+	 */
+	virtual void GetProxyMeshes(TArray<FGameObjectProxyMesh>& OutMeshes) const;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
@@ -41,5 +72,11 @@ protected:
 
 	UPROPERTY()
 	FVector OriginalLocation;
+
+private:
+	bool bInstanced = false;
+
+	// Restored when promoted back, doors for example only tick while they move
+	bool bTickEnabledBeforeInstancing = false;
 };
 
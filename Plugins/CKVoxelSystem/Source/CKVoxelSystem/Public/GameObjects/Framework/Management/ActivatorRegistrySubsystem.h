@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ActivatorRegistrySubsystem.generated.h"
+
+class AActivatorBase;
+class AGameObjectsManager;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogActivatorRegistry, Log, All);
+
+/**
+ * Activators of the world by their activator ID. Activators register themselves when they begin play, so the ones
+ * chunks spawn as they stream in are routable as soon as they exist, and unregister when they end play.
+ *
+ * The ID is hashed from the activator's chunk, placement and event type, so every client derives the same ID for the
+ * same activator without it ever being sent to them.
+ */
+UCLASS()
+class  UActivatorRegistrySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Deinitialize() override;
+
+	/**
+	 * World stable ID of an activator. Chunk coordinates are absolute and Location is relative to the chunk origin, so
+	 * neither depends on origin rebasing. Placement is quantized to whole centimeters, two activators of the same event
+	 * type need to be at least that far apart.
+	 * @return A positive ID, 0 is never returned
+	 */
+	static int64 MakeActivatorID(int64 ChunkX, int64 ChunkY, int64 ChunkZ, const FVector& Location, uint16 EventType);
+
+	// @return False if another activator already holds the ID
+	bool RegisterActivator(int64 ActivatorID, AActivatorBase* Activator);
+
+	void UnregisterActivator(int64 ActivatorID, const AActivatorBase* Activator);
+
+	UFUNCTION(BlueprintPure, Category = "Activator Registry")
+	AActivatorBase* FindActivator(int64 ActivatorID) const;
+
+	UFUNCTION(BlueprintPure, Category = "Activator Registry")
+	int32 GetNumActivators() const { return Activators.Num(); }
+
+	void SetGameObjectsManager(AGameObjectsManager* InGameObjectsManager) { GameObjectsManager = InGameObjectsManager; }
+
+	UFUNCTION(BlueprintPure, Category = "Activator Registry")
+	AGameObjectsManager* GetGameObjectsManager() const { return GameObjectsManager; }
+
+private:
+
+	UPROPERTY()
+	TMap<int64, AActivatorBase*> Activators;
+
+	UPROPERTY()
+	AGameObjectsManager* GameObjectsManager = nullptr;
+};
@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ActorPoolSubsystem.generated.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogActorPool, Log, All);
+
+USTRUCT()
+struct FPooledActors
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<AActor*> Actors;
+};
+
+/**
+ * Keeps released actors of event spawned classes, e.g. ABall, hidden and inactive so the next event of the class
+ * reuses one instead of spawning a new actor. Actors implementing IPoolable reset their own state on acquire and
+ * release, everything else gets the generic treatment only.
+ */
+UCLASS()
+class  UActorPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Deinitialize() override;
+
+	/**
+	 * Takes a pooled actor of ActorClass, or spawns one if the pool is empty.
+	 * @return The actor at Transform, visible, with collision and ticking as the class starts with
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Actor Pool", meta = (DeterminesOutputType = "ActorClass"))
+	AActor* AcquireActor(TSubclassOf<AActor> ActorClass, const FTransform& Transform);
+
+	template <typename T>
+	T* Acquire(const FTransform& Transform, TSubclassOf<T> ActorClass = T::StaticClass())
+	{
+		return Cast<T>(AcquireActor(TSubclassOf<AActor>(ActorClass), Transform));
+	}
+
+	// Returns the actor to its class' pool, destroys it instead if the pool is full
+	UFUNCTION(BlueprintCallable, Category = "Actor Pool")
+	void ReleaseActor(AActor* Actor);
+
+	// Spawns actors into the pool of ActorClass until it holds Count of them
+	UFUNCTION(BlueprintCallable, Category = "Actor Pool")
+	void Prewarm(TSubclassOf<AActor> ActorClass, int32 Count);
+
+	// Releases Actor to the pool of its world, or destroys it if there is none
+	static void ReleaseOrDestroy(AActor* Actor);
+
+	UFUNCTION(BlueprintPure, Category = "Actor Pool")
+	int32 GetNumPooled(TSubclassOf<AActor> ActorClass) const;
+
+	// Actors kept per class, further releases are destroyed
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Actor Pool")
+	int32 MaxPooledPerClass = 64;
+
+private:
+
+	AActor* SpawnPooledActor(UClass* ActorClass, const FTransform& Transform) const;
+
+	static void Deactivate(AActor* Actor);
+
+	static void Activate(AActor* Actor);
+
+	UPROPERTY()
+	TMap<UClass*, FPooledActors> Pools;
+};
@@ -11,10 +11,13 @@
 
 
 class UGameObjectsServiceSubsystem;
+class UActorPoolSubsystem;
+class UActivatorRegistrySubsystem;
 class AActivatorBase;
+class ABall;
 
-DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnGameObjectActivationNotificationReceived, const FString&, ObjectUUID, const FGameObjectState&, NewState);
-DECLARE_MULTICAST_DELEGATE_TwoParams(FOnBallEventReceived, const FString&, const FBallState&);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnGameObjectActivationNotificationReceived, int64, ActivatorID, const FGameObjectState&, NewState);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnBallEventReceived, int64, const FBallState&);
 
 UCLASS(Blueprintable, BlueprintType)
 class  AGameObjectsManager : public AActor
@@ -30,16 +33,14 @@ public:
 	virtual void Tick(float DeltaTime) override;
 
 	void DispatchActivationRequest(const int64 MapId, const int64 ChunkX, const int64 ChunkY,
-	const int64 ChunkZ, const FString& ActivatorUUID, const uint16 EventType, const FGameObjectState& State) const;
-	
-	bool DoesEventExist(const FString& EventUUID) const;
+	const int64 ChunkZ, const int64 ActivatorID, const uint16 EventType, const FGameObjectState& State) const;
 
 	void InitializeEventMaps();
 
 	UFUNCTION(BlueprintCallable, Category = "GameObjectsManager")
 	void SetGameObjectsServiceReference(UGameObjectsServiceSubsystem* InGOService);
 
-	void ProcessBallEvent(const FString& EventUUID, const FBallState& BallState) const;
+	void ProcessBallEvent(int64 EventID, const FBallState& BallState) const;
 
 	// Blueprint Only
 	UFUNCTION(BlueprintCallable, Category = "GameObjectsManager")
@@ -47,6 +48,14 @@ public:
 
 	// C++ Only
 	void SpawnBall(const FBallState& BallState) const;
+
+	// Takes an activator from the pool, it registers itself under the ID of its new placement
+	UFUNCTION(BlueprintCallable, Category = "GameObjectsManager")
+	AActivatorBase* SpawnActivator(TSubclassOf<AActivatorBase> ActivatorClass, const FTransform& SpawnTransform);
+
+	// Returns an activator from SpawnActivator to the pool, which unregisters it
+	UFUNCTION(BlueprintCallable, Category = "GameObjectsManager")
+	void ReleaseActivator(AActivatorBase* Activator);
 	
 	FOnGameObjectActivationNotificationReceived OnGameObjectActivationNotificationReceived;
 	FOnBallEventReceived OnBallEventReceived;
@@ -57,10 +66,17 @@ protected:
 	virtual void BeginPlay() override;
 
 	UFUNCTION(BlueprintCallable, Category = "GameObjectsManager")
-	void FindAndActivateObject(const FString& ObjectUUID, const FGameObjectState& NewState);
-	
-	UPROPERTY(BlueprintReadWrite, Category = "GameObjectsManager")
-	TMap<FString, AActivatorBase*> ActivatorsMap;
+	void FindAndActivateObject(int64 ActivatorID, const FGameObjectState& NewState);
+
+	// Balls created up front, so the first burst of ball events does not spawn actors
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GameObjectsManager")
+	int32 BallPoolPrewarmCount = 16;
+
+	UPROPERTY()
+	UActorPoolSubsystem* ActorPool;
+
+	UPROPERTY()
+	UActivatorRegistrySubsystem* ActivatorRegistry;
 
 	UPROPERTY(BlueprintReadWrite, Category = "GameObjectsManager")
 	UGameObjectsServiceSubsystem* GameObjectService;
@@ -70,6 +86,12 @@ protected:
 
 	TMap<EEventType, TSubclassOf<AActor>> EventActorClassMap;
 
-	TMap<FString, EEventType> EventTypeMap; 
+private:
+
+	/**
+	 * Pooled balls are already initialized, so the velocity ProjectileMovement would have taken as local space on
+	 * initialization is converted here.
+	 */
+	ABall* LaunchBall(const FTransform& SpawnTransform, const FVector& LocalVelocity, float Speed) const;
 
 };
@@ -24,6 +24,9 @@ public:
 	UPROPERTY(BlueprintAssignable, BlueprintCallable, Category = "Game Object|Door")
 	FOnDoorClosed OnDoorClosed;
 
+	// Moving, or open and waiting to close
+	virtual bool IsAnimating() const override;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
@@ -62,4 +65,7 @@ protected:
 
 	UPROPERTY(BlueprintReadWrite,EditAnywhere, Category = "Game Object|Door|Rotation")
 	bool bResetDoorAfterActivation;
+
+private:
+	FTimerHandle CloseDoorTimerHandle;
 };
@@ -20,6 +20,9 @@ public:
 
 	UFUNCTION(BlueprintCallable, Category = "Game Object|Light")
 	int32 GetLightOrder();
+
+	// Lit, instanced meshes cannot cast the light
+	virtual bool IsAnimating() const override;
 	
 	UPROPERTY(EditAnywhere, Category = "Game Object|Light")
 	ULightComponent* Light;
@@ -7,10 +7,11 @@
 #include "GameFramework/Actor.h"
 #include "GameFramework/ProjectileMovementComponent.h"
 #include "Shared/Types/Interfaces/World/OriginRebasable.h"
+#include "Shared/Types/Interfaces/World/Poolable.h"
 #include "Ball.generated.h"
 
 UCLASS(Blueprintable, BlueprintType)
-class  ABall : public AActor, public IOriginRebasable
+class  ABall : public AActor, public IOriginRebasable, public IPoolable
 {
 	GENERATED_BODY()
 
@@ -33,6 +34,14 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Ball")
 	FVector GetActorOriginalLocation_Implementation() override;
 
+	virtual void OnAcquiredFromPool_Implementation() override;
+
+	virtual void OnReleasedToPool_Implementation() override;
+
+	// Seconds after the first contact until the ball goes back to the pool
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ball")
+	float LifetimeAfterFirstContact = 10.0f;
+
 protected:
 	
 	// Called when the game starts or when spawned
@@ -64,6 +73,12 @@ protected:
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ball")
 	bool bFirstContact = false;
+
+private:
+
+	void ReleaseBall();
+
+	FTimerHandle ReleaseTimerHandle;
 	
 };
 
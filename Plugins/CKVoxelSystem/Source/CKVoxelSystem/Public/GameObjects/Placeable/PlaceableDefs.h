@@ -95,6 +95,13 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Actor")
 	bool bReplicates = false;
 
+	/**
+	 * Draw game objects placed in a chunk through the chunk's HISMs while idle and out of range, promoting them back to
+	 * the actor when needed. Only applies to AGameObjectBase classes.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Actor")
+	bool bInstanceWhenIdle = true;
+
 	virtual bool IsValidDef() const override
 	{
 		return Super::IsValidDef() && !ActorClass.IsNull();
@@ -3,18 +3,57 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StreamableManager.h"
 #include "Voxels/Core/VoxelChunk.h"
 #include "Shared/Types/Interfaces/World/OriginRebasable.h"
 #include "PlaceableDefs.h"
 #include "PlaceableObjectManager.generated.h"
 
+class AGameObjectBase;
+struct FChunkDataContainer;
+
 DECLARE_LOG_CATEGORY_EXTERN(LogPlaceableManager, Log, All);
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnCatalogThumbnailsLoaded);
+
+/** A game object placed in a chunk that is drawn through the chunk's HISMs while idle */
+USTRUCT()
+struct FInstancedGameObject
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TObjectPtr<AGameObjectBase> Actor;
+
+	UPROPERTY()
+	TWeakObjectPtr<AVoxelChunk> Chunk;
+
+	/** Components the object was last drawn with, its instances are keyed by ProxyID and proxy index, see ProxyKey */
+	UPROPERTY()
+	TArray<TObjectPtr<UInstancedStaticMeshComponent>> ProxyComponents;
+
+	/** Unique ID of the actor when it was added, its proxies can still be removed once the actor is gone */
+	UPROPERTY()
+	uint32 ProxyID = 0;
+};
+
+/** A chunk's object waiting for its mesh or actor class to finish loading */
+struct FDeferredPlaceableSpawn
+{
+	FName Id;
+	FTransform Transform;
+	TWeakObjectPtr<AVoxelChunk> Chunk;
+	uint64 InstanceKey;
+};
+
 /**
  * Central manager you place in the level (or spawn at runtime).
  * - Holds a reference to a UGameObjectCatalog you edit in the editor.
  * - Offers BP functions to list entries and spawn them.
  * - Pools HISM components per StaticMesh for efficient instancing.
+ * - Draws idle game objects placed in chunks through the chunk's HISMs, promoting them back to their actor while they
+ *   animate or a player is in range.
+ * - Loads meshes, actor classes and thumbnails asynchronously, one request per asset however many objects wait on it.
  */
 UCLASS(Blueprintable)
 class  APlaceableObjectManager : public AActor
@@ -32,7 +71,7 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Placeables")
 	void RebuildRegistry();
 
-	/** Returns UI-ready listing of all objects (IDs, names, thumbs, type flags) */
+	/** Returns UI-ready listing of all objects (IDs, names, thumbs, type flags). Thumbnails still loading are null. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Placeables")
 	void GetAllObjectsUI(TArray<FGameObjectUIEntry>& OutList) const;
 
@@ -40,19 +79,60 @@ public:
 	 * Spawn (place) an object by ID at a transform.
 	 * - For Actor entries: returns the spawned actor; OutInstanceIndex = -1, OutHISM = null.
 	 * - For StaticMesh entries: returns nullptr; fills OutHISM + OutInstanceIndex.
+	 *   Instances of a chunk's HISM are added with the chunk's next instance flush, OutInstanceIndex is then -1.
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Placeables")
 	AActor* SpawnById(FName Id, const FTransform& Transform, AVoxelChunk* OwningChunk,
 		/*out*/ UInstancedStaticMeshComponent*& OutHISM,
 		/*out*/ int32& OutInstanceIndex);
 
-	/** Removes a previously added instance from a given HISM (for undo/delete in UI) */
+	/** Fired once the thumbnails requested on RebuildRegistry have loaded, so UI listing them can refresh */
+	UPROPERTY(BlueprintAssignable, Category = "Placeables")
+	FOnCatalogThumbnailsLoaded OnCatalogThumbnailsLoaded;
+
+	/**
+	 * SpawnById once the object's mesh or actor class is loaded. Spawns right away if it already is, otherwise loads it
+	 * asynchronously and spawns when it arrives, unless the chunk was cleared or destroyed meanwhile.
+	 * @param InstanceKey Identifies a static mesh object's instance across the chunk's regenerations
+	 */
+	void RequestSpawnById(FName Id, const FTransform& Transform, AVoxelChunk* OwningChunk, uint64 InstanceKey);
+
+	/**
+	 * Starts loading the assets of the objects placed in chunk data that is queued to be applied. Game thread only, like
+	 * every other use of the registry and the asset handles
+	 */
+	void PrefetchChunkObjects(const FChunkDataContainer& ChunkData);
+
+	/** Removes a previously added instance from a given HISM (for undo/delete in UI), not for HISMs owned by a chunk */
 	UFUNCTION(BlueprintCallable, Category = "Placeables")
 	bool RemoveInstance(UInstancedStaticMeshComponent* HISM, int32 InstanceIndex);
 
+	/**
+	 * Destroys the instanced game objects of a chunk and drops its deferred spawns, called when the chunk clears its
+	 * instances to respawn its objects
+	 */
+	void ClearChunkObjects(const AVoxelChunk* Chunk);
+
+	/** Promotes an instanced game object right away, before it is activated and its proxy would show a stale state */
+	void PromoteGameObject(const AGameObjectBase* Actor);
+
+	/** Game objects closer than this to a player are promoted to their actor */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Placeables|Instancing")
+	float PromoteDistance = 2500.0f;
+
+	/** Promoted game objects are instanced again past this distance, once idle */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Placeables|Instancing")
+	float DemoteDistance = 3000.0f;
+
+	/** Seconds between promotion checks */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Placeables|Instancing")
+	float InstancingUpdateInterval = 0.25f;
+
 protected:
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	/** Map for quick lookup: Id -> Def */
 	UPROPERTY(VisibleAnywhere, Category = "Placeables")
 	TMap<FName, UGameObjectDef*> Registry;
@@ -70,4 +150,53 @@ protected:
 
 	/** Internal: spawn actor from actor def */
 	AActor* SpawnActorFromDef(UGameObjectActorDef* ActorDef, const FTransform& Transform, AVoxelChunk* Chunk) const;
+
+	UPROPERTY(Transient)
+	TArray<FInstancedGameObject> InstancedObjects;
+
+private:
+	/** Promotes game objects near players or animating, instances idle ones further away */
+	void UpdateInstancedObjects();
+
+	void GetPlayerLocations(TArray<FVector>& OutLocations) const;
+
+	static bool IsInRange(const FVector& Location, const TArray<FVector>& PlayerLocations, float Distance);
+
+	void InstanceObject(FInstancedGameObject& Object);
+
+	static void PromoteObject(FInstancedGameObject& Object);
+
+	/** Removes the object's proxy instances from its chunk, if the chunk is still around */
+	static void RemoveProxyInstances(const FInstancedGameObject& Object);
+
+	/** SpawnById with the key a chunk owned static mesh instance is set with */
+	AActor* SpawnInternal(FName Id, const FTransform& Transform, AVoxelChunk* OwningChunk, uint64 InstanceKey,
+		UInstancedStaticMeshComponent*& OutHISM, int32& OutInstanceIndex);
+
+	/** Keys above those chunks derive from voxel indices */
+	static constexpr uint64 BLUEPRINT_KEY_BIT = 1ull << 62;
+	static constexpr uint64 PROXY_KEY_BIT = 1ull << 63;
+
+	static uint64 ProxyKey(uint32 ProxyID, int32 ProxyIndex);
+
+	uint64 NextBlueprintKey = 0;
+
+	FTimerHandle InstancingTimerHandle;
+
+	/** The mesh or actor class an entry spawns */
+	static FSoftObjectPath GetAssetPath(const UGameObjectDef* Def);
+
+	/** @return False if the asset still has to load */
+	bool RequestAsset(const FSoftObjectPath& Path);
+
+	void OnAssetLoaded(FSoftObjectPath Path);
+
+	void RequestThumbnails();
+
+	/** Handles keep the assets loaded once they arrive, the catalog is small enough to keep all of it */
+	TMap<FSoftObjectPath, TSharedPtr<FStreamableHandle>> AssetHandles;
+
+	TMap<FSoftObjectPath, TArray<FDeferredPlaceableSpawn>> DeferredSpawns;
+
+	TSharedPtr<FStreamableHandle> ThumbnailsHandle;
 };
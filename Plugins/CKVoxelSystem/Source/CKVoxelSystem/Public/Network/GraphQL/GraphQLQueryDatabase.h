@@ -44,4 +44,17 @@ public:
 		}
 		return false;
 	}
+
+	// A hash saved with an older body, or never saved at all, would not match the text the server hashes
+	virtual void PostLoad() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+	virtual void PreSave(FObjectPreSaveContext ObjectSaveContext) override;
+#endif
+
+private:
+
+	// Hashes every query into its PersistedQueryHash
+	void UpdatePersistedQueryHashes();
 };
@@ -43,4 +43,11 @@ struct FGraphQLQueryDef
 	 */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GraphQL Query")
 	TMap<FString, FString> DefaultVariables;
+
+	/**
+	 * Lowercase hex sha256 of QueryBody, sent as the persisted query ID instead of the text.
+	 * Recomputed by UGraphQLQueryDatabase on load, edit and save, so it always matches the body.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "GraphQL Query")
+	FString PersistedQueryHash;
 };
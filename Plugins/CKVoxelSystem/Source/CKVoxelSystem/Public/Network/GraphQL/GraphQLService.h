@@ -10,6 +10,7 @@
 #include "Network//GraphQL/GraphQLQueryDatabase.h"
 #include "Shared/Types/Interfaces/Subsystems/SubsystemInitializable.h"
 #include "Shared/Types/Structures/Versioning/FGameVersion.h"
+#include "Shared/Types/Enums/Network/QueryResponseType.h"
 #include "GraphQLService.generated.h"
 
 class AAvatarDataManager;
@@ -47,6 +48,105 @@ struct  FGraphQLStats
 	bool bIsReceivingData;
 };
 
+/**
+ * Scheduling class of a query. Every lane has its own queue and concurrency limit, so a burst of chunk fetches can not
+ * hold back a login or a teleport. When slots free up, lanes are served in this order.
+ */
+UENUM(BlueprintType)
+enum class EGraphQLRequestLane : uint8
+{
+	// Somebody is waiting on the answer: login, teleport, user state
+	Interactive,
+	Gameplay,
+	// Chunk and voxel list fetches, which come in bursts
+	Bulk
+};
+
+USTRUCT(BlueprintType)
+struct FGraphQLLaneSettings
+{
+	GENERATED_BODY()
+
+	FGraphQLLaneSettings() = default;
+
+	FGraphQLLaneSettings(const int32 InMaxConcurrentRequests, const float InTimeoutSeconds, const int32 InMaxRetries)
+		: MaxConcurrentRequests(InMaxConcurrentRequests)
+		, TimeoutSeconds(InTimeoutSeconds)
+		, MaxRetries(InMaxRetries)
+	{
+	}
+
+	// Requests of the lane in flight at once, the rest wait in the lane's queue
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "GraphQL Service")
+	int32 MaxConcurrentRequests = 4;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "GraphQL Service")
+	float TimeoutSeconds = 30.0f;
+
+	// Attempts after the first one. Mutations are only retried when the server rejected them unprocessed
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "GraphQL Service")
+	int32 MaxRetries = 2;
+};
+
+// Built once per query from UGraphQLQueryDatabase. The prefixes are the UTF-8 request body up to the variables
+struct FGraphQLQueryTemplate
+{
+	EGraphQLRequestLane Lane = EGraphQLRequestLane::Gameplay;
+
+	// {"query":"...","variables":
+	TArray<uint8> QueryPrefix;
+
+	// {"extensions":{"persistedQuery":{...}},"variables": Empty if the query has no hash
+	TArray<uint8> PersistedPrefix;
+
+	// Query text and hash together, registers the hash with a server that does not know it yet
+	TArray<uint8> RegisterPrefix;
+
+	TMap<FString, FString> DefaultVariables;
+
+	bool bIsMutation = false;
+};
+
+enum class EGraphQLPayloadKind : uint8
+{
+	Query,
+	Persisted,
+	Register
+};
+
+struct FGraphQLScheduledRequest
+{
+	int64 RequestID = 0;
+	EGraphQLQuery QueryID = EGraphQLQuery::Login;
+	EGraphQLRequestLane Lane = EGraphQLRequestLane::Gameplay;
+
+	// Query and variables, identical requests share it. Empty for mutations
+	FString CacheKey;
+
+	// UGraphQLService::CacheGeneration when queued, the response is not cached if it moved on since
+	uint32 CacheGeneration = 0;
+
+	TSharedPtr<const FGraphQLQueryTemplate> Template;
+
+	// UTF-8 variables object, kept for retries and the persisted query fallback
+	TArray<uint8> Variables;
+
+	EGraphQLPayloadKind PayloadKind = EGraphQLPayloadKind::Query;
+
+	bool bIncludeAuthToken = true;
+	bool bIsMutation = false;
+	int32 Attempt = 0;
+
+	// Set while in flight
+	FHttpRequestPtr HttpRequest;
+};
+
+struct FGraphQLCachedResponse
+{
+	TSharedPtr<const TArray<uint8>> Content;
+	double ExpireTime = 0.0;
+};
+
 
 /**
  * @class UGraphQLService
@@ -125,11 +225,80 @@ public:
 	 * @param bIncludeAuthToken A boolean flag indicating whether to include the authentication token
 	 *                          in the GraphQL query. Set to true to include the token.
 	 * @param bUseNestedJson
+	 * @return Handle for CancelQuery, INDEX_NONE if the query could not be built. A query identical to a pending one
+	 *         returns the pending one's handle, and a query cached under CacheTimeToLive is answered without a request.
 	 */
 	UFUNCTION(BlueprintCallable, Category = "GraphQL Service")
-	void ExecuteQueryByID(EGraphQLQuery QueryID, const TMap<FString, FString>& RuntimeVariables, bool bIncludeAuthToken = true, bool
+	int64 ExecuteQueryByID(EGraphQLQuery QueryID, const TMap<FString, FString>& RuntimeVariables, bool bIncludeAuthToken = true, bool
 	                      bUseNestedJson = false);
 
+	/**
+	 * Drops a queued query, or aborts it in flight. Neither OnComplete nor the services hear about it afterwards.
+	 * @return False if the query already completed
+	 */
+	UFUNCTION(BlueprintCallable, Category = "GraphQL Service")
+	bool CancelQuery(int64 RequestID);
+
+	/**
+	 * Cancels every query of a lane, e.g. the bulk fetches around a position that was just teleported away from.
+	 * @return Number of queries cancelled
+	 */
+	UFUNCTION(BlueprintCallable, Category = "GraphQL Service")
+	int32 CancelLane(EGraphQLRequestLane Lane);
+
+	UFUNCTION(BlueprintPure, Category = "GraphQL Service")
+	static EGraphQLRequestLane GetLaneForQuery(EGraphQLQuery QueryID);
+
+	/**
+	 * Drops the cached response of a query, so the next execution goes to the server. For data changed behind the
+	 * client's back, e.g. a voxel update notification for a chunk whose voxel list is cached.
+	 * @param RuntimeVariables The variables the query was executed with
+	 */
+	UFUNCTION(BlueprintCallable, Category = "GraphQL Service")
+	void InvalidateCachedQuery(EGraphQLQuery QueryID, const TMap<FString, FString>& RuntimeVariables, bool bUseNestedJson = false);
+
+	// Drops the cached responses of a query for all variables
+	UFUNCTION(BlueprintCallable, Category = "GraphQL Service")
+	void InvalidateCachedQueries(EGraphQLQuery QueryID);
+
+	/**
+	 * Seconds a successful response is replayed to the services instead of asking the server again. Queries missing
+	 * here are not cached, mutations never are and drop the cached queries they change when they succeed.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "GraphQL Service|Cache")
+	TMap<EGraphQLQuery, float> CacheTimeToLive {
+		{ EGraphQLQuery::MyAvatars, 30.0f },
+		{ EGraphQLQuery::GetUserState, 10.0f },
+		{ EGraphQLQuery::VoxelList, 60.0f },
+		{ EGraphQLQuery::GetVersionInfo, 300.0f }
+	};
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "GraphQL Service|Cache")
+	int32 MaxCachedResponses = 1024;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "GraphQL Service|Scheduling")
+	FGraphQLLaneSettings InteractiveLane { 4, 10.0f, 2 };
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "GraphQL Service|Scheduling")
+	FGraphQLLaneSettings GameplayLane { 4, 20.0f, 2 };
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "GraphQL Service|Scheduling")
+	FGraphQLLaneSettings BulkLane { 6, 30.0f, 3 };
+
+	// Retry delay of the first retry, doubled for every further one up to RetryMaxDelay, then jittered
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "GraphQL Service|Scheduling")
+	float RetryBaseDelay = 0.5f;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "GraphQL Service|Scheduling")
+	float RetryMaxDelay = 8.0f;
+
+	/**
+	 * Sends the sha256 of the query, computed by UGraphQLQueryDatabase when it loads, instead of its text. A server
+	 * that does not know the hash yet gets the text once, one that does not support persisted queries turns them off.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "GraphQL Service")
+	bool bUsePersistedQueries = true;
+
 	/**
 	 * @brief Sets the endpoint URL for the GraphQL service.
 	 *
@@ -193,32 +362,65 @@ public:
 	
 private:
 
-	/**
-	 * @brief Executes a GraphQL query by sending an HTTP POST request to the configured GraphQL endpoint.
-	 *
-	 * This method handles the construction of the HTTP request, including authorization headers and payload serialization.
-	 * It supports optional query variables and invokes a callback upon completion with the response details.
-	 *
-	 * @param Query The GraphQL query string to execute. This should be a valid GraphQL query or mutation.
-	 * @param bIncludeAuthToken A boolean indicating whether to include an authorization token in the request headers.
-	 * @param Variables An optional map of GraphQL variables to be included with the query.
-	 *        If no variables are provided, this can be null.
-	 * This is only called Internally
-	 */
-	void ExecuteGraphQLQuery(const FString& Query, const bool bIncludeAuthToken, const TSharedPtr<FJsonObject>& Variables);
-	
+	// Template of QueryID, built on first use. Null and OnComplete failed if the query is not in the database
+	TSharedPtr<const FGraphQLQueryTemplate> GetQueryTemplate(EGraphQLQuery QueryID);
+
+	int64 EnqueueRequest(FGraphQLScheduledRequest&& Request);
+
+	// Starts queued requests while their lanes have free slots
+	void PumpRequestQueues();
+
+	// Called with SchedulerLock held. Headers come from the prebuilt auth header at send time, so queued requests
+	// pick up a token set after they were queued
+	FHttpRequestRef CreateHttpRequest(const FGraphQLScheduledRequest& Request);
+
+	// Removes a finished request from the in flight set, false if it was cancelled
+	bool TakeInFlightRequest(int64 RequestID, FGraphQLScheduledRequest& OutRequest);
+
+	bool ShouldRetry(const FGraphQLScheduledRequest& Request, const FHttpResponsePtr& Response, bool bWasSuccessful) const;
+
+	// Resends a persisted query the server does not know with its text, true if the response asked for it
+	bool HandlePersistedQueryError(FGraphQLScheduledRequest& Request, const FHttpResponsePtr& Response);
+
+	FString MakeCacheKey(EGraphQLQuery QueryID, const FString& Variables) const;
+
+	// Replays a cached response to the services, false on a miss
+	bool ReplayCachedResponse(const FString& CacheKey, int64& OutRequestID);
+
+	void StoreCachedResponse(const FGraphQLScheduledRequest& Request, const TArray<uint8>& Content);
+
+	// Called with SchedulerLock held, once a request will not be sent again
+	void ForgetPendingRequest(const FGraphQLScheduledRequest& Request);
+
+	// Drops the cached queries a successful mutation changed
+	void InvalidateAfterMutation(EGraphQLQuery QueryID);
+
+	// Routes a successful response to the services and OnComplete. Worker thread
+	void HandleResponseContent(const TArray<uint8>& Content) const;
+
+	static void SerializeVariables(const TMap<FString, FString>& DefaultVariables, const TMap<FString, FString>& RuntimeVariables,
+	                               bool bUseNestedJson, FString& OutVariables);
+
+	// Game thread only
+	void ScheduleRetry(FGraphQLScheduledRequest&& Request);
+
+	void RetryRequest(int64 RequestID);
+
+	const FGraphQLLaneSettings& GetLaneSettings(EGraphQLRequestLane Lane) const;
+
 	/**
 	 * @brief Callback method for handling the completion of an HTTPS request.
 	 *
 	 * This method is invoked automatically when an HTTP request to the GraphQL backend is completed.
-	 * It processes the server's response, logs relevant information, and invokes the provided callback
-	 * with the result of the request.
+	 * It frees the request's lane slot, schedules a retry for transient failures, and otherwise processes
+	 * the server's response and invokes the provided callback with the result of the request.
 	 *
 	 * @param Request The HTTP request object associated with the GraphQL query.
 	 * @param Response The HTTP response object returned by the server.
 	 * @param bWasSuccessful A flag indicating whether the HTTP request was successful or not.
+	 * @param RequestID Handle returned by ExecuteQueryByID.
 	 */
-	void OnHttpsRequestComplete(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful);
+	void OnHttpsRequestComplete(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful, int64 RequestID);
 
 	/**
 	 * @brief Parses and routes a GraphQL backend response to the appropriate services for processing.
@@ -226,17 +428,19 @@ private:
 	 * This function consumes a GraphQL response in the form of JSON-formatted text, parses it, and determines
 	 * the proper response type for dispatching to relevant subsystems or handlers within the game instance.
 	 *
-	 * If a message parser is not already initialized, it retrieves an instance of UQueryMessageParser
-	 * from the game instance's subsystems to handle the response parsing.
-	 *
-	 * The response is classified into types such as login, register, get chunk, update chunk, or various
-	 * avatar-related operations. Each type is logged and processed accordingly to ensure that the response
-	 * is handled in a manner specific to its purpose. An error response type is managed for cases where
-	 * parsing fails or other issues arise.
+	 * Runs on the background task of OnHttpsRequestComplete. Chunk and voxel list responses are decoded and
+	 * handed to UChunkDataManager on that task as well, every other response is parsed there and only its
+	 * handler runs on the game thread, through DispatchResponse or DispatchErrorResponse.
 	 *
 	 * @param ResponseContent A JSON-formatted string containing the raw response from the GraphQL server.
 	 */
 	void ParseAndDispatchToServices(const FString& ResponseContent) const;
+
+	// Game thread only
+	void DispatchResponse(EQueryResponseType ResponseType, const TSharedPtr<FJsonObject>& ParsedData) const;
+
+	// Game thread only, ErrorResponseType is the operation that failed
+	void DispatchErrorResponse(EQueryResponseType ErrorResponseType, const TSharedPtr<FJsonObject>& ParsedData) const;
 	
 
 	void HandleTeleportResponse(const TSharedPtr<FJsonObject>& Response) const;
@@ -284,4 +488,38 @@ private:
 	FThreadSafeBool bIsReceivingData;
 
 	FTimerHandle StatsTimerHandle;
+
+	static constexpr int32 NUM_LANES { 3 };
+
+	// Guards everything below, queries can be issued from any thread
+	FCriticalSection SchedulerLock;
+
+	TMap<EGraphQLQuery, TSharedPtr<const FGraphQLQueryTemplate>> QueryTemplates;
+
+	// "Bearer <token>", built once per token
+	FString AuthorizationHeader;
+
+	int64 NextRequestID = 1;
+
+	TArray<FGraphQLScheduledRequest> QueuedRequests[NUM_LANES];
+
+	TMap<int64, FGraphQLScheduledRequest> InFlightRequests;
+
+	TMap<FString, FGraphQLCachedResponse> ResponseCache;
+
+	// Queued, waiting or in flight requests by cache key, an identical request joins them instead of being sent
+	TMap<FString, int64> PendingByCacheKey;
+
+	// Bumped by every invalidation, so a response that was on its way while its data changed is not cached
+	uint32 CacheGeneration = 0;
+
+	// Cleared by a server answering PersistedQueryNotSupported
+	FThreadSafeBool bPersistedQueriesSupported { true };
+
+	int32 NumInFlight[NUM_LANES] = {};
+
+	TMap<int64, FGraphQLScheduledRequest> AwaitingRetry;
+
+	// Set by Deinitialize, cancelling the lanes must not start what is still queued
+	FThreadSafeBool bDeinitializing;
 };
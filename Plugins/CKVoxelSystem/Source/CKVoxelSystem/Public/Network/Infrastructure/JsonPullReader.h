@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Forward only JSON tokenizer over a UTF-8 buffer, for responses too large to go through the FJsonObject DOM. Keys and
+ * strings are returned as views into the buffer with their escapes left in place, so reading allocates nothing. Nesting
+ * is checked, the placement of commas and colons is not.
+ */
+class FJsonPullReader
+{
+public:
+	enum class EToken : uint8
+	{
+		// End of the buffer after the top level value
+		None,
+		BeginObject,
+		EndObject,
+		BeginArray,
+		EndArray,
+		Key,
+		String,
+		Number,
+		True,
+		False,
+		Null,
+		Error
+	};
+
+	explicit FJsonPullReader(TConstArrayView<uint8> InData);
+
+	EToken Next();
+
+	EToken GetToken() const { return Token; }
+
+	// Raw text of the current Key, String or Number
+	FUtf8StringView GetText() const { return Text; }
+
+	// Whether the current Key or String contains escape sequences
+	bool HasEscapes() const { return bHasEscapes; }
+
+	// Case sensitive, unlike FUtf8StringView's operator==
+	bool IsKey(FUtf8StringView Name) const
+	{
+		return Token == EToken::Key && Text.Equals(Name, ESearchCase::CaseSensitive);
+	}
+
+	// Reads the current String or Number as an integer, the backend sends most integers as strings
+	bool GetInt64(int64& OutValue) const;
+
+	// Current Key or String with its escapes resolved, replacing OutText
+	void GetUnescapedText(TArray<UTF8CHAR>& OutText) const;
+
+	/**
+	 * Skips the value the current token starts, nested containers included. Called on a Key it skips the key's value.
+	 * @return False on malformed input
+	 */
+	bool SkipValue();
+
+	// Nesting depth after the current token, 0 outside the top level value
+	int32 GetDepth() const { return Containers.Num(); }
+
+private:
+	EToken ReadLiteral(FUtf8StringView Literal, EToken LiteralToken);
+	EToken Fail();
+
+	const UTF8CHAR* Cursor = nullptr;
+	const UTF8CHAR* End = nullptr;
+
+	EToken Token = EToken::None;
+	FUtf8StringView Text;
+	bool bHasEscapes = false;
+
+	// The next string in an object is a key if no key preceded it
+	bool bExpectKey = false;
+
+	// true for objects, responses rarely nest deeper than this
+	TArray<bool, TInlineAllocator<16>> Containers;
+};
@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Shared/Types/Structures/Chunks/FChunkDataContainer.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogVoxelResponseDecoder, Log, All);
+
+/**
+ * Decodes the getVoxelList and getChunksByDistance GraphQL responses straight from their UTF-8 bytes with
+ * FJsonPullReader, without an FJsonObject DOM or an FString copy of the response. Coordinates are parsed in place,
+ * voxels and voxel states are Base64 decoded into the chunk's own arrays and one scratch buffer per response.
+ *
+ * Responses that carry errors, a null result or anything the schema does not expect are left to
+ * UQueryMessageParser, which logs and routes them as before.
+ *
+ * Non shipping builds can compare both paths on generated responses with CK.Network.BenchmarkVoxelDecoder.
+ */
+namespace VoxelResponseDecoder
+{
+	enum class EResult : uint8
+	{
+		// Another operation, an error response or malformed before the chunk was known
+		Unhandled,
+		// The chunk is known but its data is malformed
+		Failed,
+		Decoded
+	};
+
+	/**
+	 * @param OutChunkCoordinate Set from Failed on
+	 * @param OutData Voxel states of the chunk, VoxelData stays empty since the list only carries voxels with a state
+	 */
+	EResult DecodeVoxelList(TConstArrayView<uint8> Utf8Response, FInt64Vector& OutChunkCoordinate, FChunkDataContainer& OutData);
+
+	// Chunks missing their coordinates or voxels are skipped, as are voxel states missing a field
+	EResult DecodeChunksByDistance(TConstArrayView<uint8> Utf8Response, TArray<FChunkDataContainer>& OutChunks);
+}
@@ -45,18 +45,11 @@ public:
 	// Handler for Incoming Audio Data
 	void HandleClientAudioNotification(const TArray<uint8>& Payload);
 
-	// Called from the LEVEL_WORLD to set reference and bind event.
+	// Set by the world's voice chat subsystem when it initializes, null when it goes away
 	UFUNCTION(BlueprintCallable, Category = "Voice Chat Service")
-	void SetVoiceChatManager(UVoiceChatWorldSubsystem* InVoiceChatManager)
-	{
-		VoiceChatManager = InVoiceChatManager;
-		if (VoiceChatManager)
-		{
-			UE_LOG(LogVoiceService, Log, TEXT("Voice Chat Manager Set"));
-		}
-		VoiceChatManager->OnAudioDataGenerated.AddDynamic(this, &UVoiceChatServiceSubsystem::CompressAudioData);
-		VoiceChatManager->OnStreamTimeout.AddDynamic(this, &UVoiceChatServiceSubsystem::CleanupDecoder);
-	}
+	void SetVoiceChatManager(UVoiceChatWorldSubsystem* InVoiceChatManager);
+
+	UVoiceChatWorldSubsystem* GetVoiceChatManager() const { return VoiceChatManager; }
 
 	void SetUDPService(UUDPSubsystem* InUDPService);
 
@@ -1,8 +1,10 @@
 ﻿// Fill out your copyright notice in the Description page of Project Settings.
 #pragma once
 #include "CoreMinimal.h"
+#include "Containers/LruCache.h"
 #include "Interfaces/IHttpRequest.h"
 #include "Shared/Types/Interfaces/Subsystems/SubsystemInitializable.h"
+#include "Shared/Types/Structures/Chunks/FChunkDataContainer.h"
 #include "CDNServiceSubsystem.generated.h"
 
 class UChunkDataManager;
@@ -11,7 +13,6 @@ DECLARE_LOG_CATEGORY_EXTERN(LogCDNService, Log, All);
 
 class UChunkServiceSubsystem;
 class UVoxelServiceSubsystem;
-class UVoxelDataManager;
 class UGameSessionSubsystem;
 
 /**
@@ -38,6 +39,13 @@ struct FCDNStats
 	
 };
 
+// Last chunk the CDN sent for a coordinate, handed out again when revalidation says it did not change
+struct FCDNChunkCacheEntry
+{
+	FString ETag;
+	FChunkDataContainer Data;
+};
+
 UCLASS(Blueprintable, BlueprintType)
 class  UCDNServiceSubsystem : public UGameInstanceSubsystem, public ISubsystemInitializable
 {
@@ -60,11 +68,18 @@ public:
 	void StartCDNStatsTimer();
 
 	UFUNCTION(BlueprintCallable, Category = "CDN Service")
-	void SetCDNEndpoint(FString Endpoint) 
-	{ 
-		CDN_Endpoint = Endpoint;
-		UE_LOG(LogTemp, Log, TEXT("CDN Endpoint set to %s"), *CDN_Endpoint);
-	}
+	void SetCDNEndpoint(FString Endpoint);
+
+	UFUNCTION(BlueprintCallable, Category = "CDN Service")
+	void SetRequestCompressedChunks(const bool bCompressed) { bRequestCompressedChunks = bCompressed; }
+
+#if !UE_BUILD_SHIPPING
+	// Writes the d2.bin and d2.bin.lz4 fixture for a chunk below Directory, laid out like the CDN
+	void WriteEndpointFixture(const FString& Directory, const FInt64Vector& ChunkCoordinate) const;
+
+	// Fetches the fixture from Endpoint, checks the body against it and revalidates with the ETag, without touching the chunk manager
+	void CheckEndpoint(const FString& Endpoint, const FInt64Vector& ChunkCoordinate, bool bCompressed) const;
+#endif
 	
 protected:
 	
@@ -73,10 +88,29 @@ protected:
 
 private:
 
-	void OnCDNResponseReceived(FHttpRequestPtr Request,  FHttpResponsePtr Response, bool bWasSuccessful);
+	void OnCDNResponseReceived(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful,
+	                           FInt64Vector ChunkCoordinate, bool bCompressed);
+
+	// d2.bin layout: NUM_VOXELS_IN_CHUNK voxel bytes, uint16 states length, then x, y, z, type, uint16 length and state per voxel
+	static bool ParseChunkBody(const TArray<uint8>& RespContent, FChunkDataContainer& OutData);
+
+	// d2.bin.lz4 layout: uint32 size of the d2.bin body followed by the LZ4 compressed body
+	static bool DecompressChunkBody(const TArray<uint8>& Body, TArray<uint8>& OutBody);
 
 	UPROPERTY()
 	FString CDN_Endpoint;
+
+	// Fetch d2.bin.lz4 instead of d2.bin, both are expected next to each other on the CDN
+	UPROPERTY()
+	bool bRequestCompressedChunks = false;
+
+	// Chunks kept for If-None-Match revalidation, about 4 KB each
+	UPROPERTY()
+	int32 MaxCachedChunks = 4096;
+
+	// Least recently requested chunks are dropped first
+	TLruCache<FInt64Vector, FCDNChunkCacheEntry> ChunkCache;
+	FCriticalSection ChunkCacheLock;
 	
 	UPROPERTY()
 	UChunkServiceSubsystem* ChunkServiceSubsystem;
@@ -87,9 +121,6 @@ private:
 	UPROPERTY()
 	UGameSessionSubsystem* GameSessionSubsystem;
 
-	UPROPERTY()
-	UVoxelDataManager* VoxelDataManager;
-
 	UPROPERTY()
 	UChunkDataManager* ChunkDataManager;
 	
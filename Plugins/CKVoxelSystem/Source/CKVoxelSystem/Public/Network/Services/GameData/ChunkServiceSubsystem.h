@@ -9,7 +9,6 @@
 
 class UGameSessionSubsystem;
 class UGraphQLService;
-class UVoxelDataManager;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogChunkService, Log, All);
 
@@ -43,6 +42,9 @@ public:
 
 	void HandleGetChunkResponse(const TSharedPtr<FJsonObject>& Payload) const;
 
+	// Decodes a getChunksByDistance response without a DOM, false if it has to go through the FJsonObject overload instead
+	bool HandleGetChunkResponse(TConstArrayView<uint8> Utf8Response) const;
+
 	UPROPERTY(BlueprintAssignable, Category = "Chunk Service")
 	FOnChunkLoadedResponse OnChunkLoaded;
 
@@ -57,9 +59,6 @@ private:
 	UPROPERTY()
 	UCDNServiceSubsystem* CDNServiceSubsystem;
 
-	UPROPERTY()
-	UVoxelDataManager* VoxelDataManager;
-
 	UPROPERTY()
 	UChunkDataManager* ChunkDataManager;
 
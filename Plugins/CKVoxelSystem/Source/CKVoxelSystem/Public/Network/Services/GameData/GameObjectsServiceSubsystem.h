@@ -12,9 +12,13 @@ class AGameObjectsManager;
 class UUDPSubsystem;
 class UGameSessionSubsystem;
 
+DECLARE_LOG_CATEGORY_EXTERN(LogGameObjectsService, Log, All);
 
 /**
  * Used to handling GameObject Requests and responses
+ *
+ * Every event starts with the map ID, the chunk coordinates, the event kind as a uint16 and the int64 ID of the object
+ * or event, followed by its state.
  */
 UCLASS(Blueprintable, BlueprintType)
 class  UGameObjectsServiceSubsystem : public UGameInstanceSubsystem, public ISubsystemInitializable
@@ -30,10 +34,10 @@ public:
 	virtual void PostSubsystemInit() override;
 	
 	void SendGameObjectActivationRequest(const int64 MapId, const int64 ChunkX, const int64 ChunkY,
-	                                            const int64 ChunkZ, const FString& ActivatorUUID, const uint16 EventType, const FGameObjectState& State) const;
+	                                            const int64 ChunkZ, const int64 ActivatorID, const uint16 EventType, const FGameObjectState& State) const;
 	
 	UFUNCTION(BlueprintCallable, Category = "GameObject Service")
-	void SendTriggerBallEventRequest(int64 ChunkX, int64 ChunkY, int64 ChunkZ, const FString InUUID, const FBallState BallState);
+	void SendTriggerBallEventRequest(int64 ChunkX, int64 ChunkY, int64 ChunkZ, int64 EventID, const FBallState BallState);
 
 	void HandleGameEventNotification(const TArray<uint8>& Payload) const;
 	
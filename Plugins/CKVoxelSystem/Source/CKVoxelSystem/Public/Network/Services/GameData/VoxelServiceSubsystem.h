@@ -12,7 +12,6 @@
 class UChunkDataManager;
 class UGraphQLService;
 class UUDPSubsystem;
-class UVoxelDataManager;
 class UGameSessionSubsystem;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogVoxelService, Log, All);
@@ -51,6 +50,9 @@ public:
 	void HandleNewVoxelListResponse(const TArray<uint8>& Payload);
 
 	void HandleVoxelListGraphQLResponse(const TSharedPtr<FJsonObject>& Payload) const;
+
+	// Decodes a getVoxelList response without a DOM, false if it has to go through the FJsonObject overload instead
+	bool HandleVoxelListGraphQLResponse(TConstArrayView<uint8> Utf8Response) const;
 	
 	UPROPERTY(BlueprintAssignable, Category = "Voxel Service")
 	FOnVoxelUpdateResponse OnVoxelUpdateResponse;
@@ -60,8 +62,8 @@ public:
 	
 private:
 
-	UPROPERTY()
-	UVoxelDataManager* VoxelDataManager;
+	// Also rebuilt by the voxel update handlers to invalidate the cached list of the chunk
+	static TMap<FString, FString> MakeVoxelListVariables(int64 MapId, int64 X, int64 Y, int64 Z);
 
 	UPROPERTY()
 	UChunkDataManager* ChunkDataManager;
@@ -6,7 +6,7 @@
 #include "SkelotWorld.h"
 #include "SkelotUtils.h"
 #include "Shared/Types/Structures/Actors/FActorState.h"
-#include "Templates/SharedPointer.h"
+#include "Containers/Queue.h"
 #include "SkelotInstanceManager.generated.h"
 
 class UActorServiceSubsystem;
@@ -80,45 +80,85 @@ enum class EMovementDirection : uint8
 	ForwardLeft
 };
 
-// For Replicated Instances
+// Significance bucket of a crowd instance, picked from its distance to the viewer
+UENUM()
+enum class ECrowdLODBucket : uint8
+{
+	// Transform updated every frame, animation re-evaluated on every network update
+	Near,
+	// Transform updated every MidUpdateInterval frames, staggered across instances
+	Mid,
+	// Remote instances only snap on network updates with animation paused, local instances update every FarUpdateInterval frames
+	Far
+};
+
 USTRUCT()
-struct FRemoteActorState
+struct FCrowdLODSettings
 {
 	GENERATED_BODY()
 
-	UPROPERTY()
-	FVector LastKnownLocation;
+	UPROPERTY(EditAnywhere, Category = "Crowd LOD")
+	float NearDistance = 2500.0f;
 
-	UPROPERTY()
-	FRotator LastKnownRotation;
+	UPROPERTY(EditAnywhere, Category = "Crowd LOD")
+	float MidDistance = 8000.0f;
 
-	UPROPERTY()
-	FVector Velocity;
+	// Extra distance needed to leave a bucket, keeps instances on a boundary from flickering between buckets
+	UPROPERTY(EditAnywhere, Category = "Crowd LOD")
+	float Hysteresis = 250.0f;
 
-	UPROPERTY()
-	float LastUpdateTime;
+	UPROPERTY(EditAnywhere, Category = "Crowd LOD", meta = (ClampMin = 1))
+	int32 MidUpdateInterval = 3;
 
-	UPROPERTY()
-	float TimeSinceLastUpdate = 0.0f;
-	
-	ERemoteAnimState CurrentAnimState = ERemoteAnimState::None;
+	UPROPERTY(EditAnywhere, Category = "Crowd LOD", meta = (ClampMin = 1))
+	int32 FarUpdateInterval = 10;
 };
 
-// Data Wrapper for Replicated Instances
-USTRUCT()
-struct FRemoteInstanceData
+// Inbound change for a replicated instance, produced on network threads and applied on the game thread
+struct FRemoteInstanceUpdate
 {
-	GENERATED_BODY()
-
-	UPROPERTY()
-	FSkelotInstanceHandle InstanceHandle;
+	enum class EOp : uint8
+	{
+		Add,
+		// Dropped unless the instance is live when it is applied
+		Update,
+		Remove
+	};
 
-	UPROPERTY()
-	FRemoteActorState RemoteActorState;
-
-	UPROPERTY()
 	FString UUID;
-	
+	FActorState State;
+	EOp Op = EOp::Update;
+};
+
+// Dense storage for replicated instances. Every array is indexed by the same dense slot, removal swaps the
+// last slot into the hole. Handles stay stable across removals and map to dense slots through a free-listed table.
+struct FRemoteInstancePool
+{
+	TArray<FSkelotInstanceHandle> InstanceHandles;
+	TArray<FVector> LastKnownLocations;
+	TArray<FRotator> LastKnownRotations;
+	TArray<FVector> Velocities;
+	TArray<float> TimeSinceLastUpdate;
+	TArray<ERemoteAnimState> AnimStates;
+	TArray<bool> Crouching;
+	TArray<ECrowdLODBucket> LODBuckets;
+	TArray<float> TimeSinceVisualUpdate;
+	// Set by network updates, consumed by the next transform write (the only write far instances get)
+	TArray<bool> TransformDirty;
+
+	// Dense slot -> handle and handle -> dense slot (INDEX_NONE when the handle is free)
+	TArray<int32> DenseToHandle;
+	TArray<int32> HandleToDense;
+	TArray<int32> FreeHandles;
+
+	int32 Num() const { return InstanceHandles.Num(); }
+
+	int32 GetDenseIndex(const int32 Handle) const { return HandleToDense.IsValidIndex(Handle) ? HandleToDense[Handle] : INDEX_NONE; }
+
+	// Returns the handle of the new slot
+	int32 Add(const FSkelotInstanceHandle& InstanceHandle, const FVector& Location, const FRotator& Rotation);
+
+	void Remove(int32 Handle);
 };
 
 // For Locally Created Instances
@@ -161,6 +201,13 @@ struct FLocalInstanceData
 
 	UPROPERTY()
 	FString UUID;
+
+	UPROPERTY()
+	ECrowdLODBucket LODBucket = ECrowdLODBucket::Near;
+
+	// Simulation time not yet applied while throttled
+	UPROPERTY()
+	float PendingDeltaTime = 0.0f;
 };
 
 
@@ -178,6 +225,8 @@ public:
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
+	// Remote instance changes are staged and applied on the next Tick, so these are safe to call from any thread
+
 	//-- Add New Instance --
 	UFUNCTION()
 	void AddInstance(const FString& UUID, const FActorState& State);
@@ -226,6 +275,22 @@ public:
 
 	UPROPERTY(EditAnywhere, Category = "Skelot Instance Manager")
 	TMap<TEnumAsByte<ERemoteAnimState>, UAnimSequenceBase*> AnimationMap;
+
+	// When disabled every instance is treated as near
+	UPROPERTY(EditAnywhere, Category = "Skelot Instance Manager|LOD")
+	bool bEnableCrowdLOD = true;
+
+	UPROPERTY(EditAnywhere, Category = "Skelot Instance Manager|LOD")
+	FCrowdLODSettings CrowdLODSettings;
+
+	// Pure and frame-counter driven so bucket assignment can be reproduced headless on a synthetic crowd
+
+	static ECrowdLODBucket ComputeLODBucket(float DistanceSquared, ECrowdLODBucket CurrentBucket, const FCrowdLODSettings& Settings);
+
+	// StaggerKey spreads throttled instances across frames so they don't all update on the same one
+	static bool ShouldUpdateInBucket(ECrowdLODBucket Bucket, uint32 FrameNumber, int32 StaggerKey, const FCrowdLODSettings& Settings, bool bRemote);
+
+	static ERemoteAnimState EvaluateAnimationState(const FVector& Velocity, const FRotator& FacingRotation, bool bIsCrouching);
 	
 protected:
 
@@ -237,16 +302,33 @@ protected:
 	static ERemoteAnimState SelectAnimationState(const float Speed, bool bIsCrouching, const EMovementDirection Direction);
 
 	void SendActorUpdates() const;
+
+	// Reassigns LOD buckets from the viewer location and pauses/resumes animation on far transitions.
+	// A null view location puts every instance in the near bucket
+	void UpdateRemoteLODBuckets(const FVector* ViewLocation);
+
+	void PlayRemoteAnimation(int32 DenseIndex);
+
+	bool GetViewLocation(FVector& OutLocation) const;
+
+	// Drains PendingRemoteUpdates and applies every transform and animation change in one pass
+	void ApplyPendingRemoteUpdates();
+
+	// Stores a received state into a dense slot, returns true if the animation state changed
+	bool ApplyRemoteState(int32 DenseIndex, const FActorState& State);
 	
 	// Skelot World Reference -- used for managing instances
 	UPROPERTY()
 	ASkelotWorld* SkelotWorld;
 
-	// Map to store replicated instances of characters (Uses SharedPtr for Shared Ownership with Array)
-	TMap<FString, TSharedPtr<FRemoteInstanceData>> RemoteInstanceMap;
+	// Replicated instances, only touched on the game thread
+	FRemoteInstancePool RemoteInstances;
 
-	// Data Wrapper for storing replicated instances
-	TArray<TSharedPtr<FRemoteInstanceData>> RemoteInstancesData;
+	// UUID -> pool handle, resolved once per received update rather than per frame
+	TMap<FString, int32> RemoteHandleByUUID;
+
+	// Lock-free staging queue network threads write into, drained once per frame in Tick
+	TQueue<FRemoteInstanceUpdate, EQueueMode::Mpsc> PendingRemoteUpdates;
 
 	// Data Wrapper for storing local instances
 	UPROPERTY()
@@ -263,4 +345,7 @@ protected:
 
 	UPROPERTY()
 	FTimerHandle ActorUpdateTimerHandle;
+
+	// Advanced once per Tick, drives the throttled bucket schedule
+	uint32 LODFrameCounter = 0;
 };
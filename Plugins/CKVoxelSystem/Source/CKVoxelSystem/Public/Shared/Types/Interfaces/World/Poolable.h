@@ -0,0 +1,37 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "Poolable.generated.h"
+
+// This class does not need to be modified.
+UINTERFACE(BlueprintType, Blueprintable)
+class UPoolable : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * @brief Interface for actors reused through UActorPoolSubsystem instead of being spawned and destroyed.
+ *
+ * The pool hides a released actor, turns off its collision and ticking and deactivates its components, and undoes
+ * that on acquire. Implementers only reset their own gameplay state here, so a reused actor behaves like a freshly
+ * spawned one.
+ */
+class  IPoolable
+{
+	GENERATED_BODY()
+
+	// Add interface functions to this class. This is the class that will be inherited to implement this interface.
+public:
+
+	// Called after the actor was moved to its new transform and made visible again
+	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Pooling")
+	void OnAcquiredFromPool();
+
+	// Called before the actor is hidden, clear timers and per use state here
+	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Pooling")
+	void OnReleasedToPool();
+};
@@ -15,10 +15,13 @@
 #include "Shared/Types/Structures/Chunks/FChunkDataContainer.h"
 #include "Shared/Types/Structures/Voxels/FVoxelCoordinate.h"
 #include "Shared/Types/Structures/Voxels/FVoxelDefinition.h"
+#include "Voxels/Data/VoxelStorage.h"
+#include "Voxels/Rendering/ChunkInstanceBatcher.h"
 #include "VoxelChunk.generated.h"
 
 class AAtlasManager;
 class AVLOMeshProvider;
+struct FVoxelTypeTable;
 
 
 DECLARE_LOG_CATEGORY_EXTERN(LogVoxelChunk, Log, All);
@@ -54,8 +57,9 @@ public:
 	// Chebyshev distance from this chunk to chunkPos
 	int DistanceToChunk(FInt64Vector chunkPos) const;
 
+	// Without bRegenerateMesh the caller is responsible for calling RegenerateChunk afterwards
 	UFUNCTION(BlueprintCallable, Category = "Voxel")
-	void UpdateChunk(const TArray<uint8>& voxels);
+	void UpdateChunk(const TArray<uint8>& voxels, bool bRegenerateMesh = true);
 
 	UFUNCTION(BlueprintCallable, Category = "Voxel")
 	void UpdateVoxel(const int x, const int y, const int z, const uint8 voxelType);
@@ -81,7 +85,10 @@ public:
 	void FillChunk(const uint8 voxelType);
 
 	UFUNCTION(BlueprintCallable, Category = "Voxel")
-	const TArray<uint8>& GetVoxelArray();
+	TArray<uint8> GetVoxelArray() const;
+
+	// Whether the chunk already holds these voxels, without unpacking its own
+	bool HasVoxels(const TArray<uint8>& voxels) const { return Voxels.Matches(voxels); }
 
 	UFUNCTION(BlueprintCallable, Category = "Voxel")
 	const uint8 GetVoxel(const int x, const int y, const int z);
@@ -104,8 +111,22 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Voxel")
 	float GetOcclusionLvl() const;
 
+	// Without bRegenerateMesh the caller is responsible for calling RegenerateChunk afterwards
 	UFUNCTION(Category = "Voxel")
-	void ApplyVoxelUpdates(const FChunkDataContainer& VoxelUpdateData);
+	void ApplyVoxelUpdates(const FChunkDataContainer& VoxelUpdateData, bool bRegenerateMesh = true);
+
+	// Rebuilds the mesh sections and VLO instances from the voxel data
+	void RegenerateChunk();
+
+	// 0 is full resolution, higher levels are meshed from downsampled voxels, see ChunkLOD.
+	// Returns true if the level changed, the caller is then responsible for calling RegenerateChunk
+	bool SetLODLevel(int32 Level);
+
+	int32 GetLODLevel() const { return LODLevel; }
+
+	// Voxels reduced to (ChunkSize / Factor)^3 cells, see ChunkLOD::Downsample
+	void GetDownsampledVoxels(int32 Factor, const FVoxelTypeTable& TypeTable, TArray<uint8>& OutCells) const;
+
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
@@ -153,17 +174,38 @@ public:
 	UPROPERTY()
 	TMap<TObjectPtr<UStaticMesh>, TObjectPtr<UInstancedStaticMeshComponent>> ObjectInstancedMeshes;
 
+	/**
+	 * Sets an instance of one of this chunk's instanced mesh components by a key that stays the same across
+	 * regenerations. Changes are applied together once per frame, see FChunkInstanceBatcher. Instances of the chunk's
+	 * components must only be changed through here.
+	 */
+	void SetInstance(UInstancedStaticMeshComponent* Component, uint64 Key, const FTransform& WorldTransform);
+
+	void RemoveInstance(UInstancedStaticMeshComponent* Component, uint64 Key);
+
+	// RemoveInstance by the index the component currently holds the instance at, false if the batcher does not own it
+	bool RemoveInstanceAt(UInstancedStaticMeshComponent* Component, int32 InstanceIndex);
+
+	// Applies the queued instance changes, called by the voxel world subsystem
+	void FlushInstances();
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	void DrawChunkBounds();
 
 	UPROPERTY()
 	UProceduralMeshComponent* mesh;
 
+	// Only created when there is no atlas manager to share the default atlas material from
 	UPROPERTY()
-	UMaterialInstanceDynamic* DynamicMaterialInstance;
+	UMaterialInstanceDynamic* DynamicMaterialInstance = nullptr;
+
+	UPROPERTY()
+	TObjectPtr<UTexture> DefaultAtlasTexture = nullptr;
 
 	UPROPERTY()
 	TObjectPtr<UMaterialInstanceDynamic> DynamicColorMaterialInstance;
@@ -174,20 +216,27 @@ protected:
 	UPROPERTY()
 	TMap<uint8, UInstancedStaticMeshComponent*> VLOInstancedMeshes;
 
-	void ClearAllVLOInstances();
-
 	UInstancedStaticMeshComponent* GetOrCreateVLOComponent(uint8 VoxelType, UStaticMesh* Mesh);
 
 	float OcclusionLevel = 0.0F;
 	float SingleVoxelOcclusion = 0.0F;
 
 private:
-	void RegenerateChunk();
-	
 	float VoxelSize = 0.0F;
 	uint32 ChunkSize = 0;
 	uint32 NumOfVoxels = 0;
-	TArray<uint8> Voxels;
+	FPalettedVoxelArray Voxels;
+
+	int32 LODLevel = 0;
+
+	FChunkInstanceBatcher InstanceBatcher;
+
+	bool bInstanceFlushQueued = false;
+
+	void QueueInstanceFlush();
+
+	// Single section without VLOs or atlas overrides
+	void RegenerateLODMesh(const FVoxelTypeTable& TypeTable);
 
 	UPROPERTY()
 	UTextRenderComponent* ChunkAddressText = nullptr;
@@ -211,7 +260,17 @@ private:
 	static void RotateUVs(int32 Rotation, FVector2D& UV0, FVector2D& UV1, FVector2D& UV2, FVector2D& UV3);
 	static void DetermineVoxelFaceRotations(const uint8& FaceOneDirection, const uint8& Rotation, const int32& FaceIndex, int32& RotationAngle);
 	static void DetermineVoxelFaces(const uint8& FaceOneDirection, const uint8& Rotation, const int32& FaceIndex, float& AtlasFace);
-	UMaterialInstanceDynamic* CreateNewMaterialInstance(UTexture* InTexture);
+	/**
+	 * Shared atlas material from the atlas manager, or this chunk's own default atlas material without one.
+	 * @param OutHeldAtlasIDs Receives AtlasID if a shared material was acquired
+	 * @return null if the atlas is not loaded yet
+	 */
+	UMaterialInterface* AcquireAtlasMaterial(int64 AtlasID, TArray<int64>& OutHeldAtlasIDs);
+
+	// Atlas IDs this chunk holds shared materials of, released when the chunk is remeshed or removed
+	TArray<int64> HeldAtlasMaterials;
+
+	void ReleaseAtlasMaterials(const TArray<int64>& AtlasIDs);
 
 	UFUNCTION()
 	void HandleAtlasOverrides(UTexture* inAtlas);
@@ -219,13 +278,14 @@ private:
 	/**
 	 * Determines if a voxel should be treated as transparent for face culling purposes.
 	 * VLO voxels and air voxels are considered transparent.
+	 * @param TypeTable Voxel type table of the current regeneration pass
 	 * @param Vx X coordinate of the voxel
 	 * @param Vy Y coordinate of the voxel  
 	 * @param Vz Z coordinate of the voxel
 	 * @return true if the voxel should be treated as transparent for culling, false otherwise
 	 */
 
-	bool IsVoxelTransparentForCulling(const uint32 Vx, const uint32 Vy, const uint32 Vz);
+	bool IsVoxelTransparentForCulling(const FVoxelTypeTable& TypeTable, const uint32 Vx, const uint32 Vy, const uint32 Vz);
 	
 	/**
 	 * Calculates the rotation for a VLO based on face direction and rotation value.
@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogVoxelNoise, Log, All);
+
+namespace VoxelNoise
+{
+	/**
+	 * Evaluates 3D Perlin noise for Num samples sharing the same X and Y, the way terrain is generated column by column.
+	 * Lattice hashing and fading for X/Y happen once per column, Z is evaluated four samples per SIMD register.
+	 * @param X Noise space X shared by the column
+	 * @param Y Noise space Y shared by the column
+	 * @param Z Noise space Z of every sample
+	 * @param Num Number of samples
+	 * @param OutNoise Receives Num noise values
+	 */
+	void PerlinNoise3DColumn(float X, float Y, const float* Z, int32 Num, float* OutNoise);
+
+	/**
+	 * Whether PerlinNoise3DColumn reproduces FMath::PerlinNoise3D bit for bit on this build and platform.
+	 * Checked once against a set of sample points on first call, generation falls back to the engine noise otherwise.
+	 */
+	bool IsBatchedKernelExact();
+}
@@ -7,6 +7,7 @@
 
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
+#include "Tasks/Pipe.h"
 #include "VoxelChunk.h"
 #include "Shared/Types/Structures/Voxels/FVoxelListItem.h"
 #include "Shared/Types/Structures/Voxels/FChunkData.h"
@@ -15,10 +16,14 @@
 #include "Shared/Types/Structures/Chunks/FChunkDataContainer.h"
 #include "Shared/Types/Structures/Voxels/FOriginOffset.h"
 #include "Shared/Types/Structures/Voxels/FChunkVoxelState.h"
+#include "Voxels/Rendering/VoxelTypeTable.h"
+#include "World/Terrain/Structures/FTerrainGenerationSettings.h"
 #include "VoxelWorldSubsystem.generated.h"
 
 // Struct for exporting OriginOffset to BPs as FInt64Vector is not supported. 
 
+class AChunkRegionImpostor;
+class APlaceableObjectManager;
 class UChunkServiceSubsystem;
 
 USTRUCT(Blueprintable, BlueprintType)
@@ -47,6 +52,32 @@ public:
 	int VoxelZ;
 };
 
+// Snapshot of the game thread chunk work queue
+USTRUCT(BlueprintType)
+struct FChunkWorkQueueStats
+{
+	GENERATED_BODY()
+
+	// Chunks waiting for their actor to be spawned
+	UPROPERTY(BlueprintReadOnly, Category = "Chunk Work Queue")
+	int32 PendingSpawns = 0;
+
+	// Chunks with voxel updates waiting to be applied
+	UPROPERTY(BlueprintReadOnly, Category = "Chunk Work Queue")
+	int32 PendingApplies = 0;
+
+	// Chunks waiting for their mesh to be rebuilt and uploaded
+	UPROPERTY(BlueprintReadOnly, Category = "Chunk Work Queue")
+	int32 PendingMeshUploads = 0;
+
+	// Work items (spawn, apply or mesh upload) done last frame
+	UPROPERTY(BlueprintReadOnly, Category = "Chunk Work Queue")
+	int32 ItemsLastFrame = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Chunk Work Queue")
+	float MillisecondsLastFrame = 0.0f;
+};
+
 DECLARE_LOG_CATEGORY_EXTERN(LogVoxel, Log, All);
 
 // Delegate for loading map section based on two corner voxel chunks
@@ -59,7 +90,7 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnOriginRebased);
  * Class that manages voxel chunks of the world
  */
 UCLASS(Blueprintable, BlueprintType)
-class   UVoxelWorldSubsystem : public UWorldSubsystem
+class   UVoxelWorldSubsystem : public UTickableWorldSubsystem
 {
 	GENERATED_BODY()
 	
@@ -68,6 +99,9 @@ public:
 	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
 	virtual void Deinitialize() override;
 
+	virtual TStatId GetStatId() const override;
+	virtual void Tick(float DeltaTime) override;
+
 	UFUNCTION(BlueprintCallable, Category = "Voxel World Controller")
 	void SetReferences(APawn* PawnReference, UTexture* DefaultAtlas);
 	
@@ -109,12 +143,26 @@ public:
 	UFUNCTION()
 	void UpdateChunks(const TArray<FChunkDataContainer>& NewChunksData);
 
+	// Queues the updates, chunks are spawned, updated and meshed within the per frame budget, nearest to the camera first.
+	// Game thread only, Tick drains the queue without a lock
 	UFUNCTION()
 	void ApplyVoxelUpdatesOnChunks(const TArray<FChunkDataContainer>& VoxelUpdateData);
+
+	// Game thread time per frame spent on spawning, updating and meshing queued chunks. At least one item runs every frame
+	UFUNCTION(BlueprintCallable, Category = "Voxel World Controller")
+	void SetChunkWorkBudget(float Milliseconds);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Voxel World Controller")
+	FChunkWorkQueueStats GetChunkWorkQueueStats() const;
 	
+	// Picks every chunk's LOD by screen space error, swaps far regions for impostors and unloads chunks beyond LoadDistance
 	UFUNCTION(BlueprintCallable, Category = "Voxel World Controller")
 	void UnloadFarChunks();
 
+	// Pixels the geometric error of a chunk LOD may project to before a finer level is used
+	UFUNCTION(BlueprintCallable, Category = "Voxel World Controller")
+	void SetMaxScreenSpaceError(float Pixels);
+
 	UFUNCTION(BlueprintCallable, Category = "Voxel World Controller")
 	void UnloadAllChunks();
 
@@ -151,6 +199,20 @@ public:
 
 	UFUNCTION(BlueprintCallable, Category = "Voxel World Controller")
 	TArray<FChunkData> PopulateChunksFromPerlinNoise(TArray<uint8> GeneratedVoxels, int64 Xmin, int64 Ymin, int64 Zmin, int64 Xmax, int64 Ymax, int64 Zmax);
+
+	// Chunk-parallel equivalent of GenerateVoxelsWithPerlinNoise + PopulateChunksFromPerlinNoise, producing the same chunks in the same order.
+	// Each chunk is generated by its own task, straight into its voxel array
+	UFUNCTION(BlueprintCallable, Category = "Voxel World Controller")
+	TArray<FChunkData> GenerateChunksWithPerlinNoise(int64 Xmin, int64 Ymin, int64 Zmin, int64 Xmax, int64 Ymax, int64 Zmax, const uint8 voxelType, const float frequencyInput, const float amplitudeInput, const float thresholdInput, int
+	                                                 seedValue);
+
+	// Logs chunks per second of the legacy generator against the chunk generator, single and multi threaded, and checks their output matches
+	UFUNCTION(BlueprintCallable, Category = "Voxel World Controller")
+	void BenchmarkPerlinGeneration(int32 ChunksPerAxis = 4);
+
+	// Runs every EGenerationPass over the chunk range, see FTerrainGenerator. Chunks are ordered like GenerateChunksWithPerlinNoise
+	UFUNCTION(BlueprintCallable, Category = "Voxel World Controller")
+	TArray<FChunkData> GenerateTerrainChunks(int64 Xmin, int64 Ymin, int64 Zmin, int64 Xmax, int64 Ymax, int64 Zmax, const FTerrainGenerationSettings& Settings);
 	
 	UFUNCTION(BlueprintCallable, Category = "Voxel World Controller")
 	TArray<FChunkData> CalculateAllChunkCoordinates(int64 Xmin, int64 Ymin, int64 Zmin, int64 Xmax, int64 Ymax, int64 Zmax);
@@ -168,7 +230,7 @@ public:
 	bool ValidateOriginChunks();
 
 	UFUNCTION(BlueprintCallable, Category = "Voxel World Controller")
-	void SetAtlasManager(AAtlasManager* InAtlasManager){AtlasManager = InAtlasManager;}
+	void SetAtlasManager(AAtlasManager* InAtlasManager);
 
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Voxel World Controller")
 	AAtlasManager* GetAtlasManager() const {return AtlasManager;}
@@ -185,6 +247,18 @@ public:
 
 	UFUNCTION(BlueprintCallable, Category = "Voxel World Controller")
 	void SetVLOMeshProvider(AVLOMeshProvider* InVLOMeshProvider);
+
+	// Set by the manager itself when it begins play
+	void SetPlaceableObjectManager(APlaceableObjectManager* InPlaceableObjectManager) { PlaceableObjectManager = InPlaceableObjectManager; }
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Voxel World Controller")
+	APlaceableObjectManager* GetPlaceableObjectManager() const { return PlaceableObjectManager; }
+
+	// The chunk's instance changes are applied once this frame, after its chunk work
+	void QueueInstanceFlush(AVoxelChunk* Chunk) { ChunksWithPendingInstances.Add(Chunk); }
+
+	// Copy on the game thread; the table behind it is immutable and safe to read from mesher threads
+	FVoxelTypeTablePtr GetVoxelTypeTable() const { return VoxelTypeTable; }
 	
 	
 	//Perlin Noise Helper Functions
@@ -256,8 +330,71 @@ private:
 	UPROPERTY()
 	AVLOMeshProvider* VLOMeshProvider = nullptr;
 
+	UPROPERTY()
+	APlaceableObjectManager* PlaceableObjectManager = nullptr;
+
+	// Everything a chunk still needs, done in this order
+	struct FPendingChunkWork
+	{
+		// Updates that arrived while earlier ones were still queued are merged in
+		FChunkDataContainer Updates;
+		bool bHasUpdates = false;
+		bool bNeedsMesh = false;
+	};
+
+	TMap<FInt64Vector, FPendingChunkWork> PendingChunkWork;
+
+	// Reused every frame to sort PendingChunkWork by distance
+	TArray<TPair<double, FInt64Vector>> ChunkWorkOrder;
+
+	UPROPERTY()
+	float ChunkWorkBudgetMs = 4.0f;
+
+	FChunkWorkQueueStats ChunkWorkStats;
+
+	void ProcessChunkWork();
+
+	// Spawned, placed and registered with empty voxels, without building a mesh
+	AVoxelChunk* SpawnVoxelChunk(int64 X, int64 Y, int64 Z);
+
+	// Runs the next step of the chunk's work, returns false once nothing is left
+	bool RunNextChunkWorkItem(const FInt64Vector& ChunkCoordinate, FPendingChunkWork& Work);
+
+	bool GetViewLocation(FVector& OutLocation) const;
+
+	// Pixels per unit at a distance of one unit, for ChunkLOD::SelectLevel
+	double GetScreenScale() const;
+
+	// Far regions drawn as a single mesh instead of their chunks, see ChunkLOD
+	UPROPERTY()
+	TMap<FInt64Vector, TObjectPtr<AChunkRegionImpostor>> RegionImpostors;
+
+	// Regions whose impostor has to be rebuilt, done within what is left of the chunk work budget
+	TSet<FInt64Vector> DirtyImpostorRegions;
+
+	UPROPERTY()
+	float MaxScreenSpaceError = 2.0f;
+
+	void ProcessImpostorWork();
+
+	TSet<TWeakObjectPtr<AVoxelChunk>> ChunksWithPendingInstances;
+
+	void FlushChunkInstances();
+
+	void RebuildImpostor(AChunkRegionImpostor& Impostor);
+
+	void DestroyImpostors();
+
+	FDelegateHandle VLOMeshesChangedHandle;
+
+	// Rebuilt and swapped whenever the VLO mappings change
+	FVoxelTypeTablePtr VoxelTypeTable;
+
+	void RebuildVoxelTypeTable();
+
+	// Requests the chunks within Radius that the previous call did not cover, ranked by the player's view and velocity
 	UFUNCTION()
-	void RequestChunksAround(const FInt64Vector& CenterChunk, int32 Radius) const;
+	void RequestChunksAround(const FInt64Vector& CenterChunk, int32 Radius);
 
 	UPROPERTY()
 	UChunkServiceSubsystem* ChunkServiceSubsystem;
@@ -266,6 +403,16 @@ private:
 	
 	UPROPERTY()
 	FInt64Vector LastRequestedCenterChunk = FInt64Vector(0, 0, 0);
+
+	// 0 when nothing has been requested yet
+	UPROPERTY()
+	int32 LastRequestedRadius = 0;
+
+	// How far ahead along the player's velocity chunk requests are ranked from
+	UPROPERTY()
+	float StreamingPredictionSeconds = 1.0f;
+
+	UE::Tasks::FPipe StreamingPipe { UE_SOURCE_LOCATION };
 	
 	
 };
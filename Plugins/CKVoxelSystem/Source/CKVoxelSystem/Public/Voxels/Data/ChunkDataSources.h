@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Shared/Types/Structures/Chunks/FChunkDataContainer.h"
+#include "World/Terrain/Structures/FTerrainGenerationSettings.h"
+#include "ChunkDataSources.generated.h"
+
+class FTerrainGenerator;
+class UCDNServiceSubsystem;
+class UChunkDataManager;
+class UGameSessionSubsystem;
+class UVoxelServiceSubsystem;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogChunkDataSource, Log, All);
+
+// Where chunk data came from. Base voxels are taken from the last source in this order that has them, voxel lists go on top
+UENUM(BlueprintType)
+enum class EChunkDataSource : uint8
+{
+	Procedural,
+	Disk,
+	CDN,
+	// GraphQL getChunk, only ever pushed by UChunkServiceSubsystem
+	ChunkQuery,
+	// GraphQL getVoxelList
+	VoxelList,
+	Num UMETA(Hidden)
+};
+
+static constexpr int32 NUM_CHUNK_DATA_SOURCES { static_cast<int32>(EChunkDataSource::Num) };
+
+/**
+ * Something UChunkDataManager can ask for chunk data. Every requested chunk is answered exactly once through
+ * UChunkDataManager::OnSourceDataReceived, with bSuccess false if the source has nothing for it, so chunks never
+ * wait on a source until the request times out.
+ */
+class IChunkDataSource
+{
+public:
+	virtual ~IChunkDataSource() = default;
+
+	virtual EChunkDataSource GetSourceType() const = 0;
+
+	// Called outside of UChunkDataManager's lock, from whichever thread released the request slots
+	virtual void RequestChunks(const TArray<FInt64Vector>& ChunkCoordinates) = 0;
+
+	// Called from the merge worker with everything merged for a chunk
+	virtual void OnChunkMerged(const FChunkDataContainer& MergedData) {}
+};
+
+// getVoxelList through UVoxelServiceSubsystem, answered in UVoxelServiceSubsystem's response handlers
+class FGraphQLChunkDataSource : public IChunkDataSource
+{
+public:
+	explicit FGraphQLChunkDataSource(UVoxelServiceSubsystem* InVoxelService);
+
+	virtual EChunkDataSource GetSourceType() const override { return EChunkDataSource::VoxelList; }
+	virtual void RequestChunks(const TArray<FInt64Vector>& ChunkCoordinates) override;
+
+private:
+	TWeakObjectPtr<UVoxelServiceSubsystem> VoxelService;
+};
+
+// Chunk binaries through UCDNServiceSubsystem, answered in its HTTP callback
+class FCDNChunkDataSource : public IChunkDataSource
+{
+public:
+	explicit FCDNChunkDataSource(UCDNServiceSubsystem* InCDNService);
+
+	virtual EChunkDataSource GetSourceType() const override { return EChunkDataSource::CDN; }
+	virtual void RequestChunks(const TArray<FInt64Vector>& ChunkCoordinates) override;
+
+private:
+	TWeakObjectPtr<UCDNServiceSubsystem> CDNService;
+};
+
+// Merged voxels cached under Saved/ChunkCache, one VoxelRLE encoded file per chunk and map
+class FDiskChunkDataSource : public IChunkDataSource
+{
+public:
+	FDiskChunkDataSource(UChunkDataManager* InManager, UGameSessionSubsystem* InGameSession);
+
+	virtual EChunkDataSource GetSourceType() const override { return EChunkDataSource::Disk; }
+	virtual void RequestChunks(const TArray<FInt64Vector>& ChunkCoordinates) override;
+	virtual void OnChunkMerged(const FChunkDataContainer& MergedData) override;
+
+private:
+	FString GetChunkFilePath(const FInt64Vector& ChunkCoordinate) const;
+
+	TWeakObjectPtr<UChunkDataManager> Manager;
+	TWeakObjectPtr<UGameSessionSubsystem> GameSession;
+};
+
+// FTerrainGenerator, one task per chunk since generation does not depend on which neighbours are generated with it
+class FProceduralChunkDataSource : public IChunkDataSource
+{
+public:
+	FProceduralChunkDataSource(UChunkDataManager* InManager, const FTerrainGenerationSettings& Settings);
+
+	virtual EChunkDataSource GetSourceType() const override { return EChunkDataSource::Procedural; }
+	virtual void RequestChunks(const TArray<FInt64Vector>& ChunkCoordinates) override;
+
+	// Chunks already generating finish with the previous settings
+	void SetSettings(const FTerrainGenerationSettings& Settings);
+
+private:
+	TWeakObjectPtr<UChunkDataManager> Manager;
+
+	FCriticalSection GeneratorLock;
+	TSharedPtr<const FTerrainGenerator, ESPMode::ThreadSafe> Generator;
+};
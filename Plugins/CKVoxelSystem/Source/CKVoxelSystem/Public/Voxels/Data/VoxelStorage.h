@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Voxel types of a chunk, stored as indices into a palette of the types the chunk actually uses.
+ * A chunk of a single type stores nothing but the palette, up to 2, 4 and 16 types take 1, 2 and 4 bits per voxel,
+ * anything more one byte per voxel with the type as its own index.
+ * Reads are O(1) for every width. Writes widen the indices when a new type does not fit the palette, Assign picks the
+ * narrowest width again.
+ */
+class FPalettedVoxelArray
+{
+public:
+	void Init(uint8 Value, int32 InNum);
+
+	void Assign(const TArray<uint8>& Voxels);
+
+	// Bulk decode, one pass over the packed words
+	void Decode(TArray<uint8>& OutVoxels) const;
+
+	bool Matches(const TArray<uint8>& Voxels) const;
+
+	FORCEINLINE uint8 Get(const int32 Index) const
+	{
+		checkSlow(Index >= 0 && Index < NumVoxels);
+
+		if (BitsPerVoxel == 0)
+		{
+			return Palette[0];
+		}
+
+		const uint32 BitIndex = static_cast<uint32>(Index) * BitsPerVoxel;
+		return Palette[(Words[BitIndex >> 5] >> (BitIndex & 31)) & ((1u << BitsPerVoxel) - 1)];
+	}
+
+	void Set(int32 Index, uint8 Value);
+
+	FORCEINLINE int32 Num() const { return NumVoxels; }
+	FORCEINLINE bool IsValidIndex(const int32 Index) const { return Index >= 0 && Index < NumVoxels; }
+
+	// Every voxel has the same type, GetUniformValue returns it
+	FORCEINLINE bool IsUniform() const { return BitsPerVoxel == 0; }
+	FORCEINLINE uint8 GetUniformValue() const { return Palette[0]; }
+
+	int32 GetBitsPerVoxel() const { return BitsPerVoxel; }
+	SIZE_T GetAllocatedSize() const { return Palette.GetAllocatedSize() + Words.GetAllocatedSize(); }
+
+private:
+	// Repacks every voxel with NewBits per index, the palette must already hold every type in use
+	void Repack(int32 NewBits);
+
+	FORCEINLINE void SetIndex(const int32 Index, const uint32 PaletteIndex)
+	{
+		const uint32 BitIndex = static_cast<uint32>(Index) * BitsPerVoxel;
+		const uint32 Shift = BitIndex & 31;
+		const uint32 Mask = ((1u << BitsPerVoxel) - 1) << Shift;
+		uint32& Word = Words[BitIndex >> 5];
+		Word = (Word & ~Mask) | (PaletteIndex << Shift);
+	}
+
+	static int32 GetBitsForPaletteSize(int32 PaletteSize);
+
+	int32 NumVoxels = 0;
+
+	// 0, 1, 2, 4 or 8. Always divides 32, so an index never straddles two words
+	int32 BitsPerVoxel = 0;
+
+	// Identity at 8 bits per voxel
+	TArray<uint8> Palette {0};
+
+	TArray<uint32> Words;
+};
+
+// Run-length encoding of voxel types for the chunk cache and transport
+namespace VoxelRLE
+{
+	/**
+	 * Encodes runs as the type followed by the run length as a LEB128 varint. A uniform chunk takes 3 bytes.
+	 * @param Voxels Voxel types to encode
+	 * @param OutEncoded Receives the encoded runs, previous contents are replaced
+	 */
+	void Encode(const TArray<uint8>& Voxels, TArray<uint8>& OutEncoded);
+
+	/**
+	 * Decodes what Encode wrote.
+	 * @param Encoded Encoded runs
+	 * @param ExpectedNum Number of voxels the runs have to add up to
+	 * @param OutVoxels Receives the voxel types
+	 * @return false if the data is malformed or does not add up to ExpectedNum
+	 */
+	bool Decode(const TArray<uint8>& Encoded, int32 ExpectedNum, TArray<uint8>& OutVoxels);
+}
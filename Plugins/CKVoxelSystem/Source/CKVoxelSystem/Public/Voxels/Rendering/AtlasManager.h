@@ -9,6 +9,50 @@
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnAtlasLoaded, UTexture*, Atlas);
 
+class UMaterialInstanceDynamic;
+class UMaterialInterface;
+
+// Identifies a shared atlas material, see AAtlasManager::AcquireAtlasMaterial
+USTRUCT()
+struct FAtlasMaterialKey
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TObjectPtr<UMaterialInterface> BaseMaterial = nullptr;
+
+	UPROPERTY()
+	int64 AtlasID = 0;
+
+	// Caller defined variant bits, instances with different flags are never shared
+	UPROPERTY()
+	int32 Flags = 0;
+
+	bool operator==(const FAtlasMaterialKey& Other) const
+	{
+		return BaseMaterial == Other.BaseMaterial && AtlasID == Other.AtlasID && Flags == Other.Flags;
+	}
+
+	friend uint32 GetTypeHash(const FAtlasMaterialKey& Key)
+	{
+		return HashCombine(HashCombine(GetTypeHash(Key.BaseMaterial), GetTypeHash(Key.AtlasID)), GetTypeHash(Key.Flags));
+	}
+};
+
+USTRUCT()
+struct FAtlasMaterialEntry
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TObjectPtr<UMaterialInstanceDynamic> Material = nullptr;
+
+	int32 RefCount = 0;
+
+	// When RefCount last dropped to 0
+	double UnusedSince = 0.0;
+};
+
 UCLASS(Blueprintable, BlueprintType)
 class   AAtlasManager : public AActor
 {
@@ -26,6 +70,29 @@ public:
 
 	UFUNCTION(BlueprintCallable, Category = "Atlas Manager")
 	UTexture* GetAtlas(int64 AtlasID) const;
+
+	// Single lookup variant of DoesAtlasExist + GetAtlas, returns null if the atlas is not loaded yet
+	UTexture* FindAtlas(int64 AtlasID) const { return AtlasMap.FindRef(AtlasID); }
+
+	// Materials acquired with this ID are bound to the atlas set through SetDefaultAtlas
+	static constexpr int64 DEFAULT_ATLAS_ID { 0 };
+
+	/**
+	 * Instance of BaseMaterial with the atlas bound, shared by everyone acquiring the same key.
+	 * Every successful acquire has to be matched by a ReleaseAtlasMaterial with the same key. Instances nobody holds
+	 * are kept for UnusedMaterialLifetime seconds in case they are acquired again.
+	 * @return null if the atlas is not loaded yet, nothing is acquired then
+	 */
+	UMaterialInstanceDynamic* AcquireAtlasMaterial(UMaterialInterface* BaseMaterial, int64 AtlasID, int32 Flags = 0);
+
+	void ReleaseAtlasMaterial(UMaterialInterface* BaseMaterial, int64 AtlasID, int32 Flags = 0);
+
+	// Rebinds every shared DEFAULT_ATLAS_ID material
+	UFUNCTION(BlueprintCallable, Category = "Atlas Manager")
+	void SetDefaultAtlas(UTexture* Atlas);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Atlas Manager")
+	int32 GetNumAtlasMaterials() const { return AtlasMaterials.Num(); }
 	
 	UPROPERTY(BlueprintAssignable, BlueprintCallable, Category = "Atlas Manager")
 	FOnAtlasLoaded OnAtlasLoaded;
@@ -39,5 +106,19 @@ protected:
 
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Atlas Manager")
 	TMap<int64, UTexture*> AtlasMap;
-	
+
+	// Seconds an instance nobody holds is kept before it is released
+	UPROPERTY(EditAnywhere, Category = "Atlas Manager")
+	float UnusedMaterialLifetime = 10.0f;
+
+private:
+	void ReleaseUnusedMaterials();
+
+	UPROPERTY()
+	TMap<FAtlasMaterialKey, FAtlasMaterialEntry> AtlasMaterials;
+
+	UPROPERTY()
+	TObjectPtr<UTexture> DefaultAtlas = nullptr;
+
+	FTimerHandle ReleaseUnusedMaterialsTimer;
 };
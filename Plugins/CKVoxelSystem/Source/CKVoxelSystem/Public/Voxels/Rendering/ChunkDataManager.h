@@ -2,8 +2,12 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "HAL/Event.h"
 #include "Shared/Types/Interfaces/Subsystems/SubsystemInitializable.h"
 #include "Shared/Types/Structures/Chunks/FChunkDataContainer.h"
+#include "Voxels/Data/ChunkDataSources.h"
+#include "World/Terrain/Structures/FTerrainGenerationSettings.h"
 #include "ChunkDataManager.generated.h"
 
 class UCDNServiceSubsystem;
@@ -12,25 +16,74 @@ class UVoxelServiceSubsystem;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogChunkLoader, Log, All);
 
+// Where a chunk is on its way from the sources to the screen. New source data moves a chunk back to Fetched
+UENUM(BlueprintType)
+enum class EChunkPipelineStage : uint8
+{
+	Requested,
+	// At least one source answered with data
+	Fetched,
+	// Sources merged and handed to UVoxelWorldSubsystem
+	Merged,
+	Meshed,
+	Visible,
+	Evicting,
+	Num UMETA(Hidden)
+};
+
+// Time chunks took to reach a stage from the one they were in before
+USTRUCT(BlueprintType)
+struct FChunkPipelineStageStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Chunk Data Manager")
+	int32 NumSamples = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Chunk Data Manager")
+	double AverageMilliseconds = 0.0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Chunk Data Manager")
+	double MaxMilliseconds = 0.0;
+
+	double TotalMilliseconds = 0.0;
+};
+
 struct FChunkDataState
 {
-	FChunkDataContainer GetChunkData;
-	FChunkDataContainer CDNChunkData;
-	FChunkDataContainer VoxelUpdates;
-	
-	bool bCDNResponseReceived = false;
-	bool bChunkGetResponseReceived = false;
-	bool bVoxelListResponseReceived = false;
+	EChunkPipelineStage Stage = EChunkPipelineStage::Requested;
 
-	bool bCDNDataDirty = false;
-	bool bGetChunkDataDirty = false;
-	bool bVoxelListDataDirty = false;
+	// FPlatformTime::Seconds() when Stage was entered
+	double StageEnterTime = 0.0;
 
-	int32 LastCDNUpdateTime = 0;
-	int32 LastGetChunkUpdateTime = 0;
-	int32 LastVoxelListUpdateTime = 0;
+	// Latest data of every source, indexed by EChunkDataSource
+	FChunkDataContainer SourceData[NUM_CHUNK_DATA_SOURCES];
+
+	// UChunkDataManager::HashChunkData of SourceData, 0 before any
+	uint32 SourceDataHash[NUM_CHUNK_DATA_SOURCES] = {};
+
+	// Bits of EChunkDataSource: asked and not answered yet, and answered with data
+	uint8 PendingSources = 0;
+	uint8 ReceivedSources = 0;
 
 	bool bProcessed = false;
+
+	// Set while the chunk sits in DirtyChunksQueue, so it is queued at most once
+	bool bQueuedForProcessing = false;
+};
+
+// Where the player is and is heading, used to rank chunk requests
+struct FChunkStreamingView
+{
+	FInt64Vector CenterChunk {0, 0, 0};
+
+	// In chunks, already extrapolated along the player's velocity
+	FVector PredictedCenter = FVector::ZeroVector;
+
+	FVector ViewForward = FVector::ForwardVector;
+
+	// Chunks further than this (max axis distance) from CenterChunk are not requested
+	int32 Radius = 0;
 };
 
 UCLASS(Blueprintable, BlueprintType)
@@ -49,6 +102,9 @@ public:
 	UFUNCTION()
 	void EnqueueChunksForRequesting(const TArray<FInt64Vector>& ChunkCoordinates);
 
+	// Moves the streaming view, drops pending and in-flight requests it left behind and queues NewChunks
+	void UpdateStreamingView(const FChunkStreamingView& NewView, const TArray<FInt64Vector>& NewChunks);
+
 	UFUNCTION(BlueprintCallable, Category = "Chunk Data Manager")
 	void LoadInitialChunks();
 
@@ -59,7 +115,7 @@ public:
 	void UnloadAllChunkData();
 
 	UFUNCTION()
-	void SetNewCenterCoordinate(const FInt64Vector& NewCenter){CurrentCenterChunkCoordinate = NewCenter;}
+	void SetNewCenterCoordinate(const FInt64Vector& NewCenter);
 
 	UFUNCTION()
 	void OnCDNDataReceived(bool bSuccess, const FInt64Vector& ChunkCoordinate, const FChunkDataContainer& CDNData);
@@ -69,40 +125,116 @@ public:
 
 	UFUNCTION()
 	void OnVoxelListDataReceived(bool bSuccess, const FInt64Vector& ChunkCoordinate, const FChunkDataContainer& VoxelListData);
+
+	// Single entry point of every source, thread safe. Data for chunks that are not loaded is dropped
+	void OnSourceDataReceived(EChunkDataSource Source, bool bSuccess, const FInt64Vector& ChunkCoordinate,
+	                          const FChunkDataContainer& Data);
+
+	// Called by UVoxelWorldSubsystem for Meshed and Visible, earlier stages are tracked here
+	UFUNCTION()
+	void AdvanceChunkStage(const FInt64Vector& ChunkCoordinate, EChunkPipelineStage NewStage);
+
+	UFUNCTION(BlueprintCallable, Category = "Chunk Data Manager")
+	EChunkPipelineStage GetChunkStage(const FInt64Vector& ChunkCoordinate, bool& bOutIsLoaded) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Chunk Data Manager")
+	FChunkPipelineStageStats GetStageLatency(EChunkPipelineStage Stage) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Chunk Data Manager")
+	void ResetStageLatencies();
+
+	// Takes effect for chunks requested from now on
+	UFUNCTION(BlueprintCallable, Category = "Chunk Data Manager")
+	void SetSourceEnabled(EChunkDataSource Source, bool bEnabled);
+
+	UFUNCTION(BlueprintCallable, Category = "Chunk Data Manager")
+	void SetProceduralSettings(const FTerrainGenerationSettings& Settings);
 	
 private:
 
 	UFUNCTION()
 	void DequeueChunksForRequesting();
 
-	UFUNCTION()
-	bool IsChunkDirty(const FInt64Vector& ChunkCoordinate) const;
+	// Lower is requested first. Caller holds DataLock
+	float GetRequestPriority(const FInt64Vector& ChunkCoordinate) const;
 
-	UFUNCTION()
-	TArray<FInt64Vector> GetDirtyChunks() const;
+	// Keeps the best chunk at the back of PendingRequests. Caller holds DataLock
+	void SortPendingRequests();
+
+	// Caller holds DataLock
+	bool IsInStreamingRange(const FInt64Vector& ChunkCoordinate) const;
+
+	// Requests a chunk no source had again after a backoff, while it stays in range. Caller holds DataLock
+	void ScheduleChunkRetry(const FInt64Vector& ChunkCoordinate);
+
+	// Forgets the retries of a chunk that arrived or left the streaming range. Caller holds DataLock
+	void ForgetChunkRetry(const FInt64Vector& ChunkCoordinate);
 
+	// Caller holds DataLock
+	void ReceiveSourceData(EChunkDataSource Source, const FInt64Vector& ChunkCoordinate, FChunkDataState& ChunkState,
+	                       const FChunkDataContainer& Data);
+
+	// Records how long the chunk took to get from its current stage to NewStage. Caller holds DataLock
+	void EnterStage(FChunkDataState& ChunkState, EChunkPipelineStage NewStage);
+
+	// Base voxels of the last source in EChunkDataSource order that has them, every source's states on top in that order.
+	// Voxel list entries the result already has are left out, so only actual changes reach the chunk
+	static FChunkDataContainer MergeSources(const FInt64Vector& ChunkCoordinate, const FChunkDataState& ChunkState);
+
+	static uint8 GetSourceBit(const EChunkDataSource Source) { return 1 << static_cast<uint8>(Source); }
+
+	// Starts the worker thread, which sleeps until MarkChunkDirty signals it
 	UFUNCTION()
 	void ProcessDirtyChunks();
 
 	UFUNCTION()
-	void ProcessDirtyChunksBatch();
+	void ProcessDirtyChunksBatch(int32 BatchSize);
 
-	UFUNCTION()
-	static void ApplyVoxelUpdates(FChunkDataContainer& ChunkData, const FChunkDataContainer& VoxelUpdates);
+	// Caller holds DataLock and has stored the new source data
+	void MarkChunkDirty(const FInt64Vector& ChunkCoordinate, FChunkDataState& ChunkState);
 
-	static bool HasDataChanged(const FChunkDataContainer& OldData, const FChunkDataContainer& NewData);
+	// Independent of VoxelStatesMap iteration order, never 0
+	static uint32 HashChunkData(const FChunkDataContainer& Data);
 
 	
 	TQueue<FInt64Vector, EQueueMode::Mpsc> DirtyChunksQueue;
-	
-	UPROPERTY()
-	FInt64Vector CurrentCenterChunkCoordinate {0, 0, 0};
+	FThreadSafeCounter NumQueuedDirtyChunks;
 
+	// Auto-reset, triggered on every enqueue and on shutdown
+	FEvent* WorkAvailableEvent = nullptr;
+	TFuture<void> WorkerFuture;
 	
-	TQueue<FInt64Vector> ChunksToRequest;
 
+	FChunkStreamingView StreamingView;
+
+	// Waiting for an in-flight slot, sorted by GetRequestPriority with the best last
+	TArray<FInt64Vector> PendingRequests;
+	TSet<FInt64Vector> PendingRequestSet;
+
+	// In-flight requests and the unix time they were sent at
 	UPROPERTY()
 	TMap<FInt64Vector, int32> RequestedChunks;
+
+	UPROPERTY()
+	int32 MaxInFlightRequests = 32;
+
+	// Responses are not guaranteed, in-flight requests older than this give their slot back
+	UPROPERTY()
+	int32 RequestTimeoutSeconds = 30;
+
+	// Delay before a chunk every source failed is requested again, doubled per failure up to RequestTimeoutSeconds
+	UPROPERTY()
+	float FailedChunkRetryDelay = 1.0f;
+
+	// Failures in a row of a chunk, cleared once a source has it or it leaves the streaming range
+	TMap<FInt64Vector, int32> ChunkRetryAttempts;
+
+	// FPlatformTime::Seconds at which a failed chunk is queued again
+	TMap<FInt64Vector, double> ChunkRetryTimes;
+
+	// How much further away a chunk directly behind the camera is treated than one straight ahead, 1 means twice
+	UPROPERTY()
+	float ViewAlignmentWeight = 1.0f;
 	
 	
 	TMap<FInt64Vector, FChunkDataState> LoadedChunks;
@@ -116,23 +248,32 @@ private:
 	UPROPERTY()
 	UCDNServiceSubsystem* CDNServiceSubsystem;
 
+	// Indexed by EChunkDataSource, null for sources that are only pushed
+	TUniquePtr<IChunkDataSource> Sources[NUM_CHUNK_DATA_SOURCES];
+
+	// Not owned, points into Sources
+	FProceduralChunkDataSource* ProceduralSource = nullptr;
+
+	// Bits of EChunkDataSource asked for every newly requested chunk. The CDN has the bulk, the voxel list what changed since
+	uint8 EnabledSources = 1 << static_cast<uint8>(EChunkDataSource::CDN) | 1 << static_cast<uint8>(EChunkDataSource::VoxelList);
+
 	UPROPERTY()
-	int32 MaxBatchSize = 8;
+	FTerrainGenerationSettings ProceduralSettings;
 
+	FChunkPipelineStageStats StageStats[static_cast<int32>(EChunkPipelineStage::Num)];
+
+	// A batch takes a quarter of the backlog within these bounds: small backlogs go out right away, large ones in few hand-offs
 	UPROPERTY()
-	float TickInterval = 0.016f;
+	int32 MinBatchSize = 8;
 
 	UPROPERTY()
-	TArray<FChunkDataContainer> ProcessingBatch;
+	int32 MaxBatchSize = 128;
 
 	mutable FCriticalSection DataLock;
-	mutable FCriticalSection ProcessingLock;
 
 	FThreadSafeBool bIsTicking;
 	FThreadSafeBool bShouldShutdown;
 
-	UE::Tasks::FTask ProcessingTask;
-
 	// Track the processing state better
 	TSet<FInt64Vector> CurrentlyProcessing;
 
@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+class UInstancedStaticMeshComponent;
+
+/**
+ * Instances of a chunk's instanced static mesh components by caller chosen keys. The chunk states which instances it
+ * wants, and Flush applies only the difference to the components. Removed instances are filled by added ones or by the
+ * last instance of the component, so only the end of the instance array is ever removed and indices of the instances
+ * left in place never shift.
+ *
+ * Every instance of a component added through the batcher has to go through it, it keeps track of their indices.
+ */
+class FChunkInstanceBatcher
+{
+public:
+	// Instances not set again before the next Flush are removed
+	void BeginRebuild();
+
+	void SetInstance(UInstancedStaticMeshComponent* Component, uint64 Key, const FTransform& WorldTransform);
+
+	void RemoveInstance(UInstancedStaticMeshComponent* Component, uint64 Key);
+
+	// Key of the instance the component holds at InstanceIndex as of the last Flush, e.g. for a trace hit
+	bool FindInstanceKey(const UInstancedStaticMeshComponent* Component, int32 InstanceIndex, uint64& OutKey) const;
+
+	bool HasPendingChanges() const { return bRebuilding || !DirtyComponents.IsEmpty(); }
+
+	// Applies the changes since the last Flush with one add and one remove call per component
+	void Flush();
+
+private:
+	// Slot of a removed instance until it is filled or dropped
+	static constexpr uint64 FREE_SLOT = MAX_uint64;
+
+	struct FComponentInstances
+	{
+		TWeakObjectPtr<UInstancedStaticMeshComponent> Component;
+
+		TMap<uint64, int32> IndexByKey;
+		TArray<uint64> KeyByIndex;
+
+		// Relative to the component, what the component currently holds
+		TArray<FTransform> Transforms;
+
+		// Changes since the last Flush, unset for removals
+		TMap<uint64, TOptional<FTransform>> Pending;
+
+		// Keys set since BeginRebuild
+		TSet<uint64> Kept;
+	};
+
+	FComponentInstances& FindOrAddComponent(UInstancedStaticMeshComponent* Component);
+
+	static void FlushComponent(FComponentInstances& Instances, bool bRebuilding);
+
+	TMap<TObjectKey<UInstancedStaticMeshComponent>, FComponentInstances> Components;
+
+	TSet<TObjectKey<UInstancedStaticMeshComponent>> DirtyComponents;
+
+	bool bRebuilding = false;
+};
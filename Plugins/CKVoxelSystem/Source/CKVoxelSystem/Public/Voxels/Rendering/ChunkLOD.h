@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProceduralMeshComponent.h"
+
+class FPalettedVoxelArray;
+struct FVoxelTypeTable;
+
+/**
+ * Reduced meshes for chunks away from the camera. Levels 1 and 2 mesh a single chunk from 2x and 4x downsampled voxels,
+ * IMPOSTOR_LEVEL merges IMPOSTOR_REGION_SIZE^3 chunks, 8x downsampled, into one mesh. The level is picked per chunk by
+ * how many pixels the geometric error of a level projects to at the chunk's distance.
+ */
+namespace ChunkLOD
+{
+	static constexpr int32 IMPOSTOR_LEVEL { 3 };
+
+	// Chunks per axis merged into one impostor
+	static constexpr int32 IMPOSTOR_REGION_SIZE { 4 };
+
+	FORCEINLINE int32 GetDownsampleFactor(const int32 Level) { return 1 << Level; }
+
+	struct FMeshData
+	{
+		TArray<FVector> Vertices;
+		TArray<FLinearColor> VertexColors;
+		TArray<int32> Triangles;
+		TArray<FVector> Normals;
+		TArray<FVector2D> UVs;
+		TArray<FProcMeshTangent> Tangents;
+		int32 VertexOffset = 0;
+	};
+
+	/**
+	 * Reduces every Factor^3 block of voxels to one cell by majority vote: the cell is solid if at least half of the block
+	 * is, and takes the most common solid type of the block.
+	 * @param Voxels ChunkSize^3 voxels, x fastest
+	 * @param OutCells Receives (ChunkSize / Factor)^3 cells, x fastest
+	 */
+	void Downsample(const FPalettedVoxelArray& Voxels, int32 ChunkSize, int32 Factor, const FVoxelTypeTable& TypeTable,
+	                TArray<uint8>& OutCells);
+
+	/**
+	 * Appends a cube per solid cell, without the faces between two solid cells. Faces on the border of the grid are kept
+	 * since the neighbouring grids may be at another level.
+	 * @param Cells GridSize cells, x fastest
+	 * @param Origin Position of the grid's minimum corner
+	 */
+	void BuildMesh(const TArray<uint8>& Cells, const FIntVector& GridSize, float CellSize, const FVector& Origin,
+	               const FVoxelTypeTable& TypeTable, FMeshData& OutMesh);
+
+	/**
+	 * Coarsest level whose geometric error stays within MaxScreenSpaceError pixels.
+	 * @param Distance Distance from the view to the nearest point of the chunk
+	 * @param ScreenScale Pixels per unit at a distance of one unit, viewport width / (2 * tan(FOV / 2))
+	 */
+	int32 SelectLevel(double Distance, double ScreenScale, double MaxScreenSpaceError);
+
+	// Region of IMPOSTOR_REGION_SIZE^3 chunks the chunk belongs to
+	FInt64Vector GetRegion(const FInt64Vector& ChunkCoordinate);
+}
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "ProceduralMeshComponent.h"
+#include "Voxels/Rendering/ChunkLOD.h"
+#include "ChunkRegionImpostor.generated.h"
+
+class AAtlasManager;
+
+/**
+ * Far field stand-in for a region of ChunkLOD::IMPOSTOR_REGION_SIZE^3 chunks, drawn as a single mesh section while the
+ * chunks themselves are hidden. Placed at the region's minimum corner.
+ */
+UCLASS()
+class   AChunkRegionImpostor : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AChunkRegionImpostor();
+
+	// Shares the default atlas material of the chunks through InAtlasManager if there is one
+	void Initialize(const FInt64Vector& InRegion, AAtlasManager* InAtlasManager);
+
+	const FInt64Vector& GetRegion() const { return Region; }
+
+	// Only needed without an atlas manager, shared materials are rebound through AAtlasManager::SetDefaultAtlas
+	void UpdateAtlas(UTexture* TextureAtlas);
+
+	// Replaces the whole mesh
+	void UpdateMesh(const ChunkLOD::FMeshData& MeshData);
+
+	// Whether a mesh was built yet, the region's chunks stay visible until then
+	bool IsBuilt() const { return bBuilt; }
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	UPROPERTY()
+	UProceduralMeshComponent* Mesh = nullptr;
+
+	UPROPERTY()
+	UMaterialInterface* BaseMaterial = nullptr;
+
+	UPROPERTY()
+	UMaterialInterface* Material = nullptr;
+
+	UPROPERTY()
+	AAtlasManager* AtlasManager = nullptr;
+
+	FInt64Vector Region { 0, 0, 0 };
+
+	bool bBuilt = false;
+};
@@ -8,6 +8,8 @@
 
 DECLARE_LOG_CATEGORY_EXTERN(LogVLOMeshProvider, Log, All);
 
+DECLARE_MULTICAST_DELEGATE(FOnVLOMeshesChanged);
+
 UCLASS(Blueprintable, BlueprintType)
 class   AVLOMeshProvider : public AActor
 {
@@ -35,6 +37,12 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "VLO")
 	void RemoveVLOMesh(uint8 VoxelType);
 
+	// Fired whenever a mapping changes, so cached voxel type tables can be rebuilt
+	FOnVLOMeshesChanged OnVLOMeshesChanged;
+
+	// Voxel types from here up fall back to DefaultVLOMesh when they have no explicit mapping
+	static constexpr uint8 FIRST_DEFAULT_VLO_TYPE = 12;
+
 	
 protected:
 	// Called when the game starts or when spawned
@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AVLOMeshProvider;
+class UStaticMesh;
+
+/**
+ * Per voxel type properties resolved once up front, so meshing classifies a voxel with a single indexed load
+ * instead of enum reflection and map lookups. Every column is indexed by the raw voxel type byte.
+ * The table is immutable once built; when its inputs change a new one is built and swapped in, so a copy of the
+ * shared reference can be read from any thread.
+ */
+struct FVoxelTypeTable
+{
+	static constexpr int32 NUM_TYPES = 256;
+
+	// Empty types never occlude their neighbours' faces
+	bool bEmpty[NUM_TYPES];
+
+	// Whether the type can be rendered as a VLO instance
+	bool bHasVLOMesh[NUM_TYPES];
+
+	// Kept alive by the UPROPERTY references of the VLO mesh provider the table was built from
+	UStaticMesh* VLOMeshes[NUM_TYPES];
+
+	// Normalised atlas row passed to AVoxelChunk::GenerateCubeMesh
+	float AtlasIndex[NUM_TYPES];
+
+	// Provider may be null, in which case no type has a VLO mesh
+	static TSharedRef<const FVoxelTypeTable, ESPMode::ThreadSafe> Build(const AVLOMeshProvider* VLOMeshProvider);
+};
+
+using FVoxelTypeTablePtr = TSharedPtr<const FVoxelTypeTable, ESPMode::ThreadSafe>;
@@ -1,6 +1,10 @@
 ﻿#pragma once
 
-UENUM()
+#include "CoreMinimal.h"
+#include "EGenerationPass.generated.h"
+
+// Run in declaration order by FTerrainGenerator
+UENUM(BlueprintType)
 enum class EGenerationPass : uint8
 {
 	Foundation,
@@ -12,16 +12,19 @@ struct FStructureTemplate
 	//UPROPERTY()
 	//TArray<FVoxelData> VoxelPattern;
 
-	UPROPERTY()
-	FIntVector Size;
+	// Bounding box in voxels, has to fit inside a single chunk
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Structure")
+	FIntVector Size = FIntVector(5, 5, 4);
 
-	UPROPERTY()
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Structure")
 	FString StructureName;
 
-	UPROPERTY()
-	float SpawnProbability;
+	// Chance per chunk
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Structure")
+	float SpawnProbability = 0.0f;
 
-	UPROPERTY()
+	// Empty means any biome
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Structure")
 	TArray<int32> RequiredBiomes;
 	
 };
\ No newline at end of file
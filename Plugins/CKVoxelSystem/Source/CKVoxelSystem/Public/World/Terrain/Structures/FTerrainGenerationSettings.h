@@ -0,0 +1,90 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "World/Terrain/Structures/FStructureTemplate.h"
+#include "FTerrainGenerationSettings.generated.h"
+
+// Inputs of every generation pass. A voxel type of 0 disables whatever would place it
+USTRUCT(BlueprintType)
+struct FTerrainGenerationSettings
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain")
+	int32 Seed = 0;
+
+	// -- Foundation: solid where scaled Perlin noise is below Threshold, same as GenerateVoxelsWithPerlinNoise --
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Foundation")
+	float Frequency = 20.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Foundation")
+	float Amplitude = 1.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Foundation")
+	float Threshold = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Foundation")
+	uint8 StoneVoxel = 6;
+
+	// -- Carving: tunnels where the absolute cave noise is below CaveThreshold --
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Carving")
+	float CaveFrequency = 12.0f;
+
+	// 0 disables caves
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Carving")
+	float CaveThreshold = 0.0f;
+
+	// -- Surface: top voxel and the layer below it are recoloured --
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Surface")
+	uint8 SurfaceVoxel = 2;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Surface")
+	uint8 SubsurfaceVoxel = 8;
+
+	// Clamped so the pass never looks further than one chunk up
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Surface", meta = (ClampMin = 0, ClampMax = 15))
+	int32 SubsurfaceDepth = 3;
+
+	// -- Decoration: single voxels scattered on top of the ground --
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Decoration")
+	uint8 DecorationVoxel = 0;
+
+	// Chance per exposed ground voxel
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Decoration")
+	float DecorationDensity = 0.0f;
+
+	// -- Structures --
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Structures")
+	TArray<FStructureTemplate> Structures;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Structures")
+	uint8 StructureVoxel = 9;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Structures", meta = (ClampMin = 1))
+	int32 NumBiomes = 4;
+
+	// Biome noise period in chunks
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Structures")
+	float BiomeScale = 8.0f;
+
+	// -- Infrastructure: doorway and a path leading out of every structure --
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Infrastructure")
+	uint8 PathVoxel = 6;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Infrastructure")
+	int32 PathLength = 6;
+
+	// -- Details: stone speckled with another type --
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Details")
+	uint8 DetailVoxel = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Details")
+	float DetailDensity = 0.0f;
+};
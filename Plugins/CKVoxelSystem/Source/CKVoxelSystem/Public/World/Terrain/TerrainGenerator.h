@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "World/Terrain/Enums/EGenerationPass.h"
+#include "World/Terrain/Structures/FTerrainGenerationSettings.h"
+#include "Shared/Types/Structures/Voxels/FChunkData.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogTerrainGenerator, Log, All);
+
+/**
+ * Pass-scheduled procedural terrain. Every EGenerationPass is a pure function of the chunk's output from the previous
+ * pass, the settings and, for passes with a halo, the previous pass output of the chunks around it.
+ *
+ * Chunks are scheduled as a task graph: pass N of a chunk waits only for pass N-1 of itself and of the chunks inside the
+ * halo, so chunks move through the passes in parallel instead of in lockstep.
+ *
+ * Halo reads only ever ask whether a voxel is solid, which is settled once Carving ran. Neighbours outside the requested
+ * range are evaluated from the density functions instead, and structures are placed from the chunk seed alone, so a
+ * chunk generates identically whether or not its neighbours are generated with it.
+ */
+class FTerrainGenerator
+{
+public:
+	explicit FTerrainGenerator(const FTerrainGenerationSettings& InSettings);
+
+	// Generates every chunk in the inclusive range, ordered x fastest, then y, then z
+	TArray<FChunkData> GenerateChunks(const FInt64Vector& MinChunk, const FInt64Vector& MaxChunk) const;
+
+	// Seed for everything placed per chunk, only depends on the world seed and the chunk coordinate
+	static uint32 GetChunkSeed(int32 WorldSeed, const FInt64Vector& ChunkCoordinate);
+
+	// How many chunks around its own a pass reads, at most 1
+	static int32 GetPassHalo(EGenerationPass Pass);
+
+	int32 GetBiome(const FInt64Vector& ChunkCoordinate) const;
+
+private:
+	struct FStructurePlacement
+	{
+		FIntVector Min;
+		FIntVector Size;
+	};
+
+	struct FChunkJob
+	{
+		FInt64Vector Coordinate;
+		uint32 Seed = 0;
+
+		// Passes alternate between the two, reading one and writing the other
+		TArray<uint8> Buffers[2];
+
+		// Written by Structures, read by Infrastructure of the same chunk
+		TArray<FStructurePlacement> Structures;
+
+		// 3x3x3 block around the chunk, null when the neighbour is not part of this generation
+		const FChunkJob* Neighbours[27] = {};
+	};
+
+	struct FPassContext
+	{
+		FChunkJob& Job;
+		const uint8* Input;
+		uint8* Output;
+		int32 InputBuffer;
+	};
+
+	void RunPass(EGenerationPass Pass, FPassContext& Context) const;
+
+	void RunFoundation(FPassContext& Context) const;
+	void RunCarving(FPassContext& Context) const;
+	void RunSurface(FPassContext& Context) const;
+	void RunDecoration(FPassContext& Context) const;
+	void RunStructures(FPassContext& Context) const;
+	void RunInfrastructure(FPassContext& Context) const;
+	void RunDetails(FPassContext& Context) const;
+
+	// Local coordinates may be up to one chunk outside of the context's chunk
+	bool IsSolid(const FPassContext& Context, int32 X, int32 Y, int32 Z) const;
+
+	bool IsFoundationSolid(const FInt64Vector& WorldVoxel) const;
+	bool IsCarved(const FInt64Vector& WorldVoxel) const;
+
+	FTerrainGenerationSettings Settings;
+};
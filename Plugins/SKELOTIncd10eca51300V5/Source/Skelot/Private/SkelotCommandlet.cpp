@@ -3,10 +3,109 @@
 #include "SkelotCommandlet.h"
 #include "SkelotPrivate.h"
 #include "SkelotPrivateUtils.h"
+#include "SkelotSpatialGrid.h"
+#include "Math/RandomStream.h"
 
 
+/*
+compares FSkelotSpatialGrid against a linear scan over a synthetic crowd. runs headless:
+UnrealEditor-Cmd <Project> -run=Skelot -SpatialGridBenchmark
+*/
+static void Skelot_RunSpatialGridBenchmark()
+{
+	const int32 InstanceCounts[] = { 1000, 10000, 100000 };
+	constexpr int32 NumQueries = 1000;
+	constexpr double QueryRadius = 1500;
+	constexpr int32 NumNearest = 8;
+
+	for (int32 NumInstance : InstanceCounts)
+	{
+		//constant crowd density, ~ one instance per 2x2 meters
+		FRandomStream Rand(1234);
+		const double HalfExtent = FMath::Sqrt(double(NumInstance)) * 100;
+
+		TArray<FVector> Locations;
+		Locations.SetNumUninitialized(NumInstance);
+		for (FVector& L : Locations)
+			L = FVector(Rand.FRandRange(-HalfExtent, HalfExtent), Rand.FRandRange(-HalfExtent, HalfExtent), Rand.FRandRange(0, 200));
+
+		TArray<FVector> Centers;
+		Centers.SetNumUninitialized(NumQueries);
+		for (FVector& C : Centers)
+			C = FVector(Rand.FRandRange(-HalfExtent, HalfExtent), Rand.FRandRange(-HalfExtent, HalfExtent), 100);
+
+		FSkelotSpatialGrid Grid;
+		Grid.Reset(GSkelot_SpatialGridCellSize);
+
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumInstance; i++)
+			Grid.Add(i, Locations[i]);
+		const double BuildTime = FPlatformTime::Seconds() - StartTime;
+
+		//incremental update, move everyone by a small step like a crowd does per frame
+		for (FVector& L : Locations)
+			L += FVector(Rand.FRandRange(-50, 50), Rand.FRandRange(-50, 50), 0);
+
+		StartTime = FPlatformTime::Seconds();
+		int32 NumCellChanges = 0;
+		for (int32 i = 0; i < NumInstance; i++)
+			NumCellChanges += Grid.Move(i, Locations[i]) ? 1 : 0;
+		const double UpdateTime = FPlatformTime::Seconds() - StartTime;
+
+		TArray<int32> Result;
+		int64 LinearHits = 0;
+		StartTime = FPlatformTime::Seconds();
+		for (const FVector& C : Centers)
+		{
+			Result.Reset();
+			for (int32 i = 0; i < NumInstance; i++)
+				if ((Locations[i] - C).SizeSquared() < QueryRadius * QueryRadius)
+					Result.Add(i);
+
+			LinearHits += Result.Num();
+		}
+		const double LinearSphereTime = FPlatformTime::Seconds() - StartTime;
+
+		int64 GridHits = 0;
+		StartTime = FPlatformTime::Seconds();
+		for (const FVector& C : Centers)
+		{
+			Result.Reset();
+			Grid.QuerySphere(C, QueryRadius, Locations.GetData(), Result);
+			GridHits += Result.Num();
+		}
+		const double GridSphereTime = FPlatformTime::Seconds() - StartTime;
+
+		int64 BoxHits = 0;
+		StartTime = FPlatformTime::Seconds();
+		for (const FVector& C : Centers)
+		{
+			Result.Reset();
+			Grid.QueryBox(FBox(C - FVector(QueryRadius), C + FVector(QueryRadius)), Locations.GetData(), Result);
+			BoxHits += Result.Num();
+		}
+		const double GridBoxTime = FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		for (const FVector& C : Centers)
+		{
+			Result.Reset();
+			Grid.QueryKNearest(C, NumNearest, HalfExtent * 4, Locations.GetData(), Result);
+		}
+		const double GridKNearestTime = FPlatformTime::Seconds() - StartTime;
+
+		UE_LOG(LogSkelot, Display, TEXT("SpatialGrid N=%d build:%.3fms update:%.3fms (%d cell changes) | sphere x%d linear:%.3fms grid:%.3fms (hits %lld/%lld) | box grid:%.3fms (hits %lld) | %d-nearest grid:%.3fms"),
+			NumInstance, BuildTime * 1000, UpdateTime * 1000, NumCellChanges, NumQueries, LinearSphereTime * 1000, GridSphereTime * 1000, LinearHits, GridHits, GridBoxTime * 1000, BoxHits, NumNearest, GridKNearestTime * 1000);
+
+		if (LinearHits != GridHits)
+			UE_LOG(LogSkelot, Error, TEXT("SpatialGrid sphere query mismatch for N=%d"), NumInstance);
+	}
+}
+
 int32 USkelotCommandlet::Main(const FString& Params)
 {
+	if (FParse::Param(*Params, TEXT("SpatialGridBenchmark")))
+		Skelot_RunSpatialGridBenchmark();
 
 	return 0;
 }
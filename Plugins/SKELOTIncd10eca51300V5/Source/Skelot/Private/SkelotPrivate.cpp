@@ -66,6 +66,12 @@ FAutoConsoleVariableRef CV_ForcePerInstanceLocalBounds(TEXT("skelot.ForcePerInst
 bool GSkelot_ForceDefaultMaterial = false;
 FAutoConsoleVariableRef CV_ForceDefaultMaterial(TEXT("skelot.ForceDefaultMaterial"), GSkelot_ForceDefaultMaterial, TEXT(""), ECVF_Default);
 
+bool GSkelot_EnableSpatialGrid = true;
+FAutoConsoleVariableRef CV_EnableSpatialGrid(TEXT("skelot.EnableSpatialGrid"), GSkelot_EnableSpatialGrid, TEXT("if true location queries use the spatial grid instead of scanning every instance."), ECVF_Default);
+
+float GSkelot_SpatialGridCellSize = 1000;
+FAutoConsoleVariableRef CV_SpatialGridCellSize(TEXT("skelot.SpatialGridCellSize"), GSkelot_SpatialGridCellSize, TEXT("cell size of the spatial grid used for location queries."), ECVF_Default);
+
 
 #if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
 
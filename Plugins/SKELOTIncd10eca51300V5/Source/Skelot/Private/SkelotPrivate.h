@@ -51,6 +51,8 @@ extern bool		GSkelot_UseStaticDrawList;
 extern float	GSkelot_ClusterCellSize;
 extern bool		GSkelot_ForcePerInstanceLocalBounds;
 extern bool		GSkelot_ForceDefaultMaterial;
+extern bool		GSkelot_EnableSpatialGrid;
+extern float	GSkelot_SpatialGridCellSize;
 
 
 //CVars available in debug but excluded in shipping
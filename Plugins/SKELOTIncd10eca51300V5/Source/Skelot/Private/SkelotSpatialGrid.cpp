@@ -0,0 +1,210 @@
+// Copyright 2024 Lazy Marmot Games. All Rights Reserved.
+
+#include "SkelotSpatialGrid.h"
+
+
+void FSkelotSpatialGrid::Reset(double InCellSize)
+{
+	CellSize = FMath::Max(InCellSize, 1.0);
+	InvCellSize = 1.0 / CellSize;
+	NumEntries = 0;
+	Cells.Reset();
+	InstanceCells.Reset();
+	InstanceSlots.Reset();
+}
+
+void FSkelotSpatialGrid::Add(int32 InstanceIndex, const FVector& Location)
+{
+	if (InstanceIndex >= InstanceSlots.Num())
+	{
+		const int32 NewSize = FMath::Max(InstanceIndex + 1, InstanceSlots.Num() * 2);
+		InstanceCells.SetNumZeroed(NewSize);
+
+		const int32 OldSize = InstanceSlots.Num();
+		InstanceSlots.SetNumUninitialized(NewSize);
+		for (int32 i = OldSize; i < NewSize; i++)
+			InstanceSlots[i] = INDEX_NONE;
+	}
+
+	check(InstanceSlots[InstanceIndex] == INDEX_NONE);
+
+	const FIntVector Cell = LocationToCell(Location);
+	InstanceCells[InstanceIndex] = Cell;
+	InstanceSlots[InstanceIndex] = Cells.FindOrAdd(Cell).Add(InstanceIndex);
+	NumEntries++;
+}
+
+void FSkelotSpatialGrid::Remove(int32 InstanceIndex)
+{
+	if (!Contains(InstanceIndex))
+		return;
+
+	const FIntVector Cell = InstanceCells[InstanceIndex];
+	const int32 Slot = InstanceSlots[InstanceIndex];
+	TArray<int32>& CellInstances = Cells.FindChecked(Cell);
+	check(CellInstances[Slot] == InstanceIndex);
+
+	//swap remove and patch the slot of the instance that took our place
+	CellInstances.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	if (CellInstances.IsValidIndex(Slot))
+		InstanceSlots[CellInstances[Slot]] = Slot;
+
+	if (CellInstances.Num() == 0)
+		Cells.Remove(Cell);
+
+	InstanceSlots[InstanceIndex] = INDEX_NONE;
+	NumEntries--;
+}
+
+bool FSkelotSpatialGrid::Move(int32 InstanceIndex, const FVector& Location)
+{
+	if (!Contains(InstanceIndex))
+	{
+		Add(InstanceIndex, Location);
+		return true;
+	}
+
+	if (InstanceCells[InstanceIndex] == LocationToCell(Location))
+		return false;
+
+	Remove(InstanceIndex);
+	Add(InstanceIndex, Location);
+	return true;
+}
+
+template<typename TLambda> void FSkelotSpatialGrid::ForEachCellInRange(const FIntVector& MinCell, const FIntVector& MaxCell, TLambda Proc) const
+{
+	const int64 Volume = int64(MaxCell.X - MinCell.X + 1) * int64(MaxCell.Y - MinCell.Y + 1) * int64(MaxCell.Z - MinCell.Z + 1);
+
+	//range covers more cells than are populated, walking the map is cheaper than probing every cell
+	if (Volume > Cells.Num())
+	{
+		for (const auto& Pair : Cells)
+		{
+			const FIntVector& C = Pair.Key;
+			if (C.X >= MinCell.X && C.X <= MaxCell.X && C.Y >= MinCell.Y && C.Y <= MaxCell.Y && C.Z >= MinCell.Z && C.Z <= MaxCell.Z)
+				Proc(C, Pair.Value);
+		}
+		return;
+	}
+
+	for (int32 Z = MinCell.Z; Z <= MaxCell.Z; Z++)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+			{
+				const FIntVector C(X, Y, Z);
+				if (const TArray<int32>* CellInstances = Cells.Find(C))
+					Proc(C, *CellInstances);
+			}
+		}
+	}
+}
+
+void FSkelotSpatialGrid::QuerySphere(const FVector& Center, double Radius, const FVector* Locations, TArray<int32>& OutInstances) const
+{
+	if (NumEntries == 0 || Radius <= 0)
+		return;
+
+	const double RadiusSq = Radius * Radius;
+	ForEachCellInRange(LocationToCell(Center - FVector(Radius)), LocationToCell(Center + FVector(Radius)), [&](const FIntVector&, const TArray<int32>& CellInstances)
+	{
+		for (int32 InstanceIndex : CellInstances)
+		{
+			if ((Locations[InstanceIndex] - Center).SizeSquared() < RadiusSq)
+				OutInstances.Add(InstanceIndex);
+		}
+	});
+}
+
+void FSkelotSpatialGrid::QueryBox(const FBox& Box, const FVector* Locations, TArray<int32>& OutInstances) const
+{
+	if (NumEntries == 0 || !Box.IsValid)
+		return;
+
+	ForEachCellInRange(LocationToCell(Box.Min), LocationToCell(Box.Max), [&](const FIntVector&, const TArray<int32>& CellInstances)
+	{
+		for (int32 InstanceIndex : CellInstances)
+		{
+			if (Box.IsInsideOrOn(Locations[InstanceIndex]))
+				OutInstances.Add(InstanceIndex);
+		}
+	});
+}
+
+void FSkelotSpatialGrid::QueryKNearest(const FVector& Center, int32 K, double MaxRadius, const FVector* Locations, TArray<int32>& OutInstances) const
+{
+	if (NumEntries == 0 || K <= 0 || MaxRadius <= 0)
+		return;
+
+	using FCandidate = TPair<double, int32>;
+	//max-heap on distance, top is the farthest of the current K best
+	auto FarthestFirst = [](const FCandidate& A, const FCandidate& B) { return A.Key > B.Key; };
+	TArray<FCandidate, TInlineAllocator<32>> Heap;
+	Heap.Reserve(K);
+
+	const double MaxRadiusSq = MaxRadius * MaxRadius;
+	auto ConsiderCell = [&](const FIntVector&, const TArray<int32>& CellInstances)
+	{
+		for (int32 InstanceIndex : CellInstances)
+		{
+			const double DistSq = (Locations[InstanceIndex] - Center).SizeSquared();
+			if (DistSq > MaxRadiusSq)
+				continue;
+
+			if (Heap.Num() < K)
+			{
+				Heap.HeapPush(FCandidate(DistSq, InstanceIndex), FarthestFirst);
+			}
+			else if (DistSq < Heap.HeapTop().Key)
+			{
+				FCandidate Discarded;
+				Heap.HeapPop(Discarded, FarthestFirst, EAllowShrinking::No);
+				Heap.HeapPush(FCandidate(DistSq, InstanceIndex), FarthestFirst);
+			}
+		}
+	};
+
+	const FIntVector CenterCell = LocationToCell(Center);
+	const int32 MaxRing = FMath::Min(FMath::CeilToInt32(MaxRadius * InvCellSize), 1 << 20);
+
+	//visit shells of cells at increasing Chebyshev distance, stop once nothing unvisited can beat the current K-th candidate
+	for (int32 Ring = 0; Ring <= MaxRing; Ring++)
+	{
+		const int64 Side = 2 * Ring + 1;
+		if (Side * Side * Side > Cells.Num())
+		{
+			//shell is larger than the populated grid, finish with a single pass over the remaining cells
+			ForEachCellInRange(CenterCell - FIntVector(MaxRing), CenterCell + FIntVector(MaxRing), [&](const FIntVector& Cell, const TArray<int32>& CellInstances)
+			{
+				const FIntVector D = Cell - CenterCell;
+				if (FMath::Max3(FMath::Abs(D.X), FMath::Abs(D.Y), FMath::Abs(D.Z)) >= Ring)
+					ConsiderCell(Cell, CellInstances);
+			});
+			break;
+		}
+
+		for (int32 Y = -Ring; Y <= Ring; Y++)
+		{
+			for (int32 X = -Ring; X <= Ring; X++)
+			{
+				const bool bOnSide = FMath::Abs(X) == Ring || FMath::Abs(Y) == Ring;
+				const int32 ZStep = (bOnSide || Ring == 0) ? 1 : Ring * 2;
+				for (int32 Z = -Ring; Z <= Ring; Z += ZStep)
+				{
+					const FIntVector Cell = CenterCell + FIntVector(X, Y, Z);
+					if (const TArray<int32>* CellInstances = Cells.Find(Cell))
+						ConsiderCell(Cell, *CellInstances);
+				}
+			}
+		}
+
+		if (Heap.Num() == K && Heap.HeapTop().Key <= FMath::Square(Ring * CellSize))
+			break;
+	}
+
+	Heap.Sort([](const FCandidate& A, const FCandidate& B) { return A.Key < B.Key; });
+	for (const FCandidate& C : Heap)
+		OutInstances.Add(C.Value);
+}
@@ -165,6 +165,18 @@ void USkelotWorldSubsystem::SkelotQueryLocationOverlappingSphere(const UObject*
 		Singleton->QueryLocationOverlappingSphere(Center, Radius, Instances);
 }
 
+void USkelotWorldSubsystem::SkelotQueryLocationOverlappingBox(const UObject* WorldContextObject, const FBox& Box, TArray<FSkelotInstanceHandle>& Instances)
+{
+	if (ASkelotWorld* Singleton = GetSingleton(WorldContextObject))
+		Singleton->QueryLocationOverlappingBox(Box, Instances);
+}
+
+void USkelotWorldSubsystem::SkelotQueryLocationKNearest(const UObject* WorldContextObject, const FVector& Center, int32 K, float MaxRadius, TArray<FSkelotInstanceHandle>& Instances)
+{
+	if (ASkelotWorld* Singleton = GetSingleton(WorldContextObject))
+		Singleton->QueryLocationKNearest(Center, K, MaxRadius, Instances);
+}
+
 void USkelotWorldSubsystem::Skelot_RemoveInvalidHandles(const UObject* WorldContextObject, bool bMaintainOrder, TArray<FSkelotInstanceHandle>& Handles)
 {
 	if (ASkelotWorld* Singleton = GetSingleton(WorldContextObject))
@@ -759,6 +759,29 @@ public:
 		return FVector((Coord.X + 0.5) * TileSize, (Coord.Y + 0.5) * TileSize, 0);
 	}
 	//
+	//move instances that changed cell since the last pass, rebuilds if the cell size cvar changed
+	void UpdateSpatialGrid()
+	{
+		SKELOT_SCOPE_CYCLE_COUNTER(UpdateSpatialGrid);
+
+		if (!GSkelot_EnableSpatialGrid)
+		{
+			if (SpatialGrid.Num() != 0)
+				SpatialGrid.Reset(GSkelot_SpatialGridCellSize);
+
+			return;
+		}
+
+		if (SpatialGrid.GetCellSize() != FMath::Max(GSkelot_SpatialGridCellSize, 1.0f))
+			SpatialGrid.Reset(GSkelot_SpatialGridCellSize);
+
+		for (int32 InstanceIndex = 0; InstanceIndex < GetNumInstance(); InstanceIndex++)
+		{
+			if (IsInstanceAlive(InstanceIndex))
+				SpatialGrid.Move(InstanceIndex, SOA.Locations[InstanceIndex]);
+		}
+	}
+	//
 	void LowLevelDestroyInstance(int32 InstanceIndex)
 	{
 		FSkelotInstancesSOA::FSlotData& Slot = SOA.Slots[InstanceIndex];
@@ -777,6 +800,8 @@ public:
 		HandleAllocator.Free(InstanceIndex);
 		Slot.IncVersion();
 		Slot.bDestroyed = true;
+
+		SpatialGrid.Remove(InstanceIndex);
 		
 
 		DestructItem(&SOA.AnimDatas[InstanceIndex]);
@@ -1124,6 +1149,9 @@ FSkelotInstanceHandle ASkelotWorld::CreateInstance(const FTransform& Transform,
 
 	SOA.RootMotions[InstanceIdx] = FTransform3f::Identity;
 
+	if (GSkelot_EnableSpatialGrid)
+		SpatialGrid.Add(InstanceIdx, SOA.Locations[InstanceIdx]);
+
 	InstancesNeedCluster.Add(InstanceIdx);
 	return FSkelotInstanceHandle{ InstanceIdx, SOA.Slots[InstanceIdx].Version };
 }
@@ -1989,6 +2017,18 @@ void ASkelotWorld::Internal_CallOnAnimationNotify()
 
 void ASkelotWorld::QueryLocationOverlappingSphere(const FVector& Center, float Radius, TArray<FSkelotInstanceHandle>& Instances)
 {
+	SKELOT_SCOPE_CYCLE_COUNTER(QueryLocationOverlappingSphere);
+
+	if (GSkelot_EnableSpatialGrid)
+	{
+		TArray<int32> Indices;
+		SpatialGrid.QuerySphere(Center, Radius, SOA.Locations.GetData(), Indices);
+		for (int32 InstanceIndex : Indices)
+			Instances.Add(this->IndexToHandle(InstanceIndex));
+
+		return;
+	}
+
 	for (int32 InstanceIndex = 0; InstanceIndex < GetNumInstance(); InstanceIndex++)
 	{
 		if (IsInstanceAlive(InstanceIndex))
@@ -2002,6 +2042,59 @@ void ASkelotWorld::QueryLocationOverlappingSphere(const FVector& Center, float R
 	}
 }
 
+void ASkelotWorld::QueryLocationOverlappingBox(const FBox& Box, TArray<FSkelotInstanceHandle>& Instances)
+{
+	SKELOT_SCOPE_CYCLE_COUNTER(QueryLocationOverlappingBox);
+
+	if (GSkelot_EnableSpatialGrid)
+	{
+		TArray<int32> Indices;
+		SpatialGrid.QueryBox(Box, SOA.Locations.GetData(), Indices);
+		for (int32 InstanceIndex : Indices)
+			Instances.Add(this->IndexToHandle(InstanceIndex));
+
+		return;
+	}
+
+	for (int32 InstanceIndex = 0; InstanceIndex < GetNumInstance(); InstanceIndex++)
+	{
+		if (IsInstanceAlive(InstanceIndex) && Box.IsInsideOrOn(SOA.Locations[InstanceIndex]))
+			Instances.Add(this->IndexToHandle(InstanceIndex));
+	}
+}
+
+void ASkelotWorld::QueryLocationKNearest(const FVector& Center, int32 K, float MaxRadius, TArray<FSkelotInstanceHandle>& Instances)
+{
+	SKELOT_SCOPE_CYCLE_COUNTER(QueryLocationKNearest);
+
+	TArray<int32> Indices;
+
+	if (GSkelot_EnableSpatialGrid)
+	{
+		SpatialGrid.QueryKNearest(Center, K, MaxRadius, SOA.Locations.GetData(), Indices);
+	}
+	else if (K > 0)
+	{
+		TArray<TPair<double, int32>> Candidates;
+		for (int32 InstanceIndex = 0; InstanceIndex < GetNumInstance(); InstanceIndex++)
+		{
+			if (!IsInstanceAlive(InstanceIndex))
+				continue;
+
+			const double DistSQ = (SOA.Locations[InstanceIndex] - Center).SizeSquared();
+			if (DistSQ <= FMath::Square(MaxRadius))
+				Candidates.Emplace(DistSQ, InstanceIndex);
+		}
+
+		Candidates.Sort([](const TPair<double, int32>& A, const TPair<double, int32>& B) { return A.Key < B.Key; });
+		for (int32 i = 0; i < FMath::Min(K, Candidates.Num()); i++)
+			Indices.Add(Candidates[i].Value);
+	}
+
+	for (int32 InstanceIndex : Indices)
+		Instances.Add(this->IndexToHandle(InstanceIndex));
+}
+
 void ASkelotWorld::RemoveInvalidHandles(bool bMaintainOrder, TArray<FSkelotInstanceHandle>& InOutHandles)
 {
 	if (bMaintainOrder)
@@ -2559,6 +2652,7 @@ void ASkelotWorld::OnWorldPreActorTick(ELevelTick TickType, float DeltaSeconds)
 	Impl()->UpdateAnimations(DeltaSeconds);
 	Impl()->TickTimers();
 	Impl()->ConsumeRootMotions();
+	Impl()->UpdateSpatialGrid();
 
 
 	OnWorldPreActorTick_End.ExecuteIfBound(this, TickType, DeltaSeconds);
@@ -2575,6 +2669,7 @@ void ASkelotWorld::OnWorldPostActorTick(ELevelTick TickType, float DeltaSeconds)
 	TickLifeSpans();
 
 	Impl()->UpdateHierarchyTransforms(DeltaSeconds);
+	Impl()->UpdateSpatialGrid();
 	Impl()->CalculateBounds(DeltaSeconds);
 	Impl()->UpdateDeterminant(DeltaSeconds);
 	Impl()->UpdateClusters();
@@ -0,0 +1,54 @@
+// Copyright 2024 Lazy Marmot Games. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+uniform hash grid over instance locations, used as broad-phase for proximity queries.
+instances are bucketed by the cell containing their location. buckets are only touched when an instance changes cell, so keeping it in sync is a cheap linear pass over locations.
+queries return instance indices, the caller is responsible for filtering dead instances (the grid only contains what was added and not removed).
+*/
+struct SKELOT_API FSkelotSpatialGrid
+{
+	//clears the grid and sets the cell size
+	void Reset(double InCellSize);
+	//
+	double GetCellSize() const { return CellSize; }
+	//returns number of instances inside the grid
+	int32 Num() const { return NumEntries; }
+	//
+	bool Contains(int32 InstanceIndex) const { return InstanceSlots.IsValidIndex(InstanceIndex) && InstanceSlots[InstanceIndex] != INDEX_NONE; }
+
+	//insert an instance, must not be inside the grid already
+	void Add(int32 InstanceIndex, const FVector& Location);
+	//remove an instance if its inside the grid
+	void Remove(int32 InstanceIndex);
+	//update the location of an instance, adds it if not inside the grid. returns true if the instance changed cell
+	bool Move(int32 InstanceIndex, const FVector& Location);
+
+	//append indices of instances whose location is inside the sphere. @Locations is used for the narrow phase test
+	void QuerySphere(const FVector& Center, double Radius, const FVector* Locations, TArray<int32>& OutInstances) const;
+	//append indices of instances whose location is inside the box
+	void QueryBox(const FBox& Box, const FVector* Locations, TArray<int32>& OutInstances) const;
+	//append indices of the K closest instances within MaxRadius, sorted by distance (closest first)
+	void QueryKNearest(const FVector& Center, int32 K, double MaxRadius, const FVector* Locations, TArray<int32>& OutInstances) const;
+
+	FIntVector LocationToCell(const FVector& Location) const
+	{
+		return FIntVector(FMath::FloorToInt32(Location.X * InvCellSize), FMath::FloorToInt32(Location.Y * InvCellSize), FMath::FloorToInt32(Location.Z * InvCellSize));
+	}
+
+private:
+	//calls Proc(const TArray<int32>& CellInstances) for every populated cell in the inclusive cell range
+	template<typename TLambda> void ForEachCellInRange(const FIntVector& MinCell, const FIntVector& MaxCell, TLambda Proc) const;
+
+	double CellSize = 1000;
+	double InvCellSize = 1.0 / 1000;
+	int32 NumEntries = 0;
+	//instance indices per cell
+	TMap<FIntVector, TArray<int32>> Cells;
+	//per instance: the cell it is bucketed in and its index inside that bucket (INDEX_NONE if not in grid)
+	TArray<FIntVector> InstanceCells;
+	TArray<int32> InstanceSlots;
+};
@@ -96,6 +96,13 @@ public:
 	static void SkelotQueryLocationOverlappingSphere(const UObject* WorldContextObject, const FVector& Center, float Radius, TArray<FSkelotInstanceHandle>& Instances);
 	//////////////////////////////////////////////////////////////////////////
 	UFUNCTION(BlueprintCallable, Category="Skelot|Utils", meta=(WorldContext="WorldContextObject"))
+	static void SkelotQueryLocationOverlappingBox(const UObject* WorldContextObject, const FBox& Box, TArray<FSkelotInstanceHandle>& Instances);
+	//////////////////////////////////////////////////////////////////////////
+	//returns up to K closest instances within MaxRadius, sorted by distance
+	UFUNCTION(BlueprintCallable, Category="Skelot|Utils", meta=(WorldContext="WorldContextObject", AutoCreateRefTerm = "Center"))
+	static void SkelotQueryLocationKNearest(const UObject* WorldContextObject, const FVector& Center, int32 K, float MaxRadius, TArray<FSkelotInstanceHandle>& Instances);
+	//////////////////////////////////////////////////////////////////////////
+	UFUNCTION(BlueprintCallable, Category="Skelot|Utils", meta=(WorldContext="WorldContextObject"))
 	static void Skelot_RemoveInvalidHandles(const UObject* WorldContextObject, bool bMaintainOrder, TArray<FSkelotInstanceHandle>& Handles);
 	//////////////////////////////////////////////////////////////////////////
 	//returns all the valid instance handles
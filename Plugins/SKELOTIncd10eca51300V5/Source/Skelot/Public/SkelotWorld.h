@@ -4,6 +4,7 @@
 
 
 #include "SkelotWorldBase.h"
+#include "SkelotSpatialGrid.h"
 
 
 
@@ -37,6 +38,8 @@ public:
 
 	UPROPERTY(Transient)
 	FSkelotInstancesSOA SOA;
+	//broad-phase for location queries, synced with SOA.Locations in OnWorldPreActorTick and OnWorldPostActorTick
+	FSkelotSpatialGrid SpatialGrid;
 	//current render descriptors
 	UPROPERTY(Transient)
 	TSet<FSkelotInstanceRenderDescFinal> RenderDescs;
@@ -356,7 +359,11 @@ public:
 	virtual void OnAnimationNotify(const TArray<FSkelotAnimNotifyEvent>& Events) {}
 
 	
+	//location queries use SpatialGrid (see skelot.EnableSpatialGrid). instances that moved to another cell after the last Pre/PostActorTick pass may be missed until the next pass
 	void QueryLocationOverlappingSphere(const FVector& Center, float Radius, TArray<FSkelotInstanceHandle>& OutInstances);
+	void QueryLocationOverlappingBox(const FBox& Box, TArray<FSkelotInstanceHandle>& OutInstances);
+	//returns up to K closest instances within MaxRadius, sorted by distance
+	void QueryLocationKNearest(const FVector& Center, int32 K, float MaxRadius, TArray<FSkelotInstanceHandle>& OutInstances);
 	void RemoveInvalidHandles(bool bMaintainOrder, TArray<FSkelotInstanceHandle>& InOutHandles);
 	//function to get handles of all the valid instances
 	void GetAllHandles(TArray<FSkelotInstanceHandle>& OutHandles);